@@ -3,9 +3,12 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <optional>
 #include <vector>
+#include <array>
 #include <iostream>
 #include <algorithm>
 #include <chrono>
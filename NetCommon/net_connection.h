@@ -25,7 +25,7 @@ namespace olc
 			// Constructor: Specify Owner, connect to context, transfer the socket
 			//				Provide reference to incoming message queue
 			connection(owner parent, asio::io_context& asioContext, asio::ip::tcp::socket socket, tsqueue<owned_message<T>>& qIn)
-				: m_asioContext(asioContext), m_socket(std::move(socket)), m_qMessagesIn(qIn)
+				: m_socket(std::move(socket)), m_asioContext(asioContext), m_strand(asio::make_strand(asioContext)), m_qMessagesIn(qIn)
 			{
 				m_nOwnerType = parent;
 			}
@@ -48,7 +48,10 @@ namespace olc
 					if (m_socket.is_open())
 					{
 						id = uid;
-						ReadHeader();
+
+						// The acceptor runs on its own thread, so hand the first
+						// read over to the connection's strand
+						asio::post(m_strand, [this]() { ReadHeader(); });
 					}
 				}
 			}
@@ -74,7 +77,7 @@ namespace olc
 			void Disconnect()
 			{
 				if (IsConnected())
-					asio::post(m_asioContext, [this]() { m_socket.close(); });
+					asio::post(m_strand, [this]() { m_socket.close(); });
 			}
 
 			bool IsConnected() const
@@ -93,7 +96,15 @@ namespace olc
 			// the target, for a client, the target is the server and vice versa
 			void Send(const message<T>& msg)
 			{
-				asio::post(m_asioContext,
+				Send(std::make_shared<const message<T>>(msg));
+			}
+
+			// ASYNC - Send a message that may be shared with other connections. The
+			// message is never copied, so a broadcast encodes its body only once no
+			// matter how many clients it goes out to.
+			void Send(std::shared_ptr<const message<T>> msg)
+			{
+				asio::post(m_strand,
 					[this, msg]()
 					{
 						// If the queue has a message in it, then we must 
@@ -105,46 +116,49 @@ namespace olc
 						m_qMessagesOut.push_back(msg);
 						if (!bWritingMessage)
 						{
-							WriteHeader();
+							WriteMessage();
 						}
 					});
 			}
 
+			// Returns the strand that serialises all work on this connection
+			asio::strand<asio::io_context::executor_type>& GetStrand()
+			{
+				return m_strand;
+			}
+
 
 
 		private:
-			// ASYNC - Prime context to write a message header
-			void WriteHeader()
+			// ASYNC - Prime context to write the message at the front of the queue
+			void WriteMessage()
 			{
 				// If this function is called, we know the outgoing message queue must have 
-				// at least one message to send. So allocate a transmission buffer to hold
-				// the message, and issue the work - asio, send these bytes
-				asio::async_write(m_socket, asio::buffer(&m_qMessagesOut.front().header, sizeof(message_header<T>)),
+				// at least one message to send. The header and body go out in a single
+				// gathered write, straight from the (possibly shared) message, so no
+				// transmission buffer needs to be allocated.
+				const message<T>& msg = *m_qMessagesOut.front();
+				std::array<asio::const_buffer, 2> buffers = {
+					asio::buffer(&msg.header, sizeof(message_header<T>)),
+					asio::buffer(msg.body.data(), msg.body.size())
+				};
+
+				asio::async_write(m_socket, buffers, asio::bind_executor(m_strand,
 					[this](std::error_code ec, std::size_t length)
 					{
 						// asio has now sent the bytes - if there was a problem
 						// an error would be available...
 						if (!ec)
 						{
-							// ... no error, so check if the message header just sent also
-							// has a message body...
-							if (m_qMessagesOut.front().body.size() > 0)
-							{
-								// ...it does, so issue the task to write the body bytes
-								WriteBody();
-							}
-							else
+							// ...no error, so we are done with this message. Remove it from 
+							// the outgoing message queue
+							m_qMessagesOut.pop_front();
+
+							// If the queue is not empty, there are more messages to send, so
+							// make this happen by issuing the task to send the next one.
+							if (!m_qMessagesOut.empty())
 							{
-								// ...it didnt, so we are done with this message. Remove it from 
-								// the outgoing message queue
-								m_qMessagesOut.pop_front();
-
-								// If the queue is not empty, there are more messages to send, so
-								// make this happen by issuing the task to send the next header.
-								if (!m_qMessagesOut.empty())
-								{
-									WriteHeader();
-								}
+								WriteMessage();
 							}
 						}
 						else
@@ -153,41 +167,10 @@ namespace olc
 							// for now simply assume the connection has died by closing the
 							// socket. When a future attempt to write to this client fails due
 							// to the closed socket, it will be tidied up.
-							std::cout << "[" << id << "] Write Header Fail.\n";
+							std::cout << "[" << id << "] Write Fail.\n";
 							m_socket.close();
 						}
-					});
-			}
-
-			// ASYNC - Prime context to write a message body
-			void WriteBody()
-			{
-				// If this function is called, a header has just been sent, and that header
-				// indicated a body existed for this message. Fill a transmission buffer
-				// with the body data, and send it!
-				asio::async_write(m_socket, asio::buffer(m_qMessagesOut.front().body.data(), m_qMessagesOut.front().body.size()),
-					[this](std::error_code ec, std::size_t length)
-					{
-						if (!ec)
-						{
-							// Sending was successful, so we are done with the message
-							// and remove it from the queue
-							m_qMessagesOut.pop_front();
-
-							// If the queue still has messages in it, then issue the task to 
-							// send the next messages' header.
-							if (!m_qMessagesOut.empty())
-							{
-								WriteHeader();
-							}
-						}
-						else
-						{
-							// Sending failed, see WriteHeader() equivalent for description :P
-							std::cout << "[" << id << "] Write Body Fail.\n";
-							m_socket.close();
-						}
-					});
+					}));
 			}
 
 			// ASYNC - Prime context ready to read a message header
@@ -198,7 +181,7 @@ namespace olc
 				// size, so allocate a transmission buffer large enough to store it. In fact, 
 				// we will construct the message in a "temporary" message object as it's 
 				// convenient to work with.
-				asio::async_read(m_socket, asio::buffer(&m_msgTemporaryIn.header, sizeof(message_header<T>)),
+				asio::async_read(m_socket, asio::buffer(&m_msgTemporaryIn.header, sizeof(message_header<T>)), asio::bind_executor(m_strand,
 					[this](std::error_code ec, std::size_t length)
 					{
 						if (!ec)
@@ -226,7 +209,7 @@ namespace olc
 							std::cout << "[" << id << "] Read Header Fail.\n";
 							m_socket.close();
 						}
-					});
+					}));
 			}
 
 			// ASYNC - Prime context ready to read a message body
@@ -235,7 +218,7 @@ namespace olc
 				// If this function is called, a header has already been read, and that header
 				// request we read a body, The space for that body has already been allocated
 				// in the temporary message object, so just wait for the bytes to arrive...
-				asio::async_read(m_socket, asio::buffer(m_msgTemporaryIn.body.data(), m_msgTemporaryIn.body.size()),
+				asio::async_read(m_socket, asio::buffer(m_msgTemporaryIn.body.data(), m_msgTemporaryIn.body.size()), asio::bind_executor(m_strand,
 					[this](std::error_code ec, std::size_t length)
 					{
 						if (!ec)
@@ -253,7 +236,7 @@ namespace olc
 							std::cout << "[" << id << "] Read Body Fail.\n";
 							m_socket.close();
 						}
-					});
+					}));
 			}
 
 			// Once a full message is received, add it to the incoming queue
@@ -276,12 +259,16 @@ namespace olc
 			// Each connection has a unique socket to a remote 
 			asio::ip::tcp::socket m_socket;
 
-			// This context is shared with the whole asio instance
+			// This context is shared with every other connection pinned to it
 			asio::io_context& m_asioContext;
 
+			// All handlers for this connection run through this strand, so they
+			// never overlap even if several threads run the context
+			asio::strand<asio::io_context::executor_type> m_strand;
+
 			// This queue holds all messages to be sent to the remote side
-			// of this connection
-			tsqueue<message<T>> m_qMessagesOut;
+			// of this connection. It is only touched from the strand.
+			std::deque<std::shared_ptr<const message<T>>> m_qMessagesOut;
 
 			// This references the incoming queue of the parent object
 			tsqueue<owned_message<T>>& m_qMessagesIn;
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "net_common.h"
+
+namespace olc
+{
+	namespace net
+	{
+		// A pool of asio contexts, each run by exactly one thread. Rather than
+		// have many threads contending over one context, every connection is
+		// pinned to a single context for its whole life, so its handlers never
+		// migrate between cores and idle connections cost nothing but a socket.
+		class context_pool
+		{
+		public:
+			// Create a pool of nSize contexts - zero means "one per core"
+			explicit context_pool(size_t nSize = 0)
+			{
+				if (nSize == 0)
+					nSize = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+				for (size_t i = 0; i < nSize; i++)
+				{
+					m_vContexts.push_back(std::make_unique<asio::io_context>(1));
+					m_vWork.push_back(std::make_unique<work_guard>(asio::make_work_guard(*m_vContexts.back())));
+				}
+			}
+
+			context_pool(const context_pool&) = delete;
+			context_pool& operator=(const context_pool&) = delete;
+
+			virtual ~context_pool()
+			{
+				Stop();
+			}
+
+		public:
+			// Launch one thread per context
+			void Start()
+			{
+				for (auto& context : m_vContexts)
+				{
+					asio::io_context* pContext = context.get();
+					m_vThreads.emplace_back([pContext]() { pContext->run(); });
+				}
+			}
+
+			// Stop all contexts and wait for their threads to finish
+			void Stop()
+			{
+				// Release the work first so that contexts are allowed to run dry...
+				m_vWork.clear();
+
+				// ...then make sure they actually do
+				for (auto& context : m_vContexts)
+					context->stop();
+
+				for (auto& thread : m_vThreads)
+					if (thread.joinable()) thread.join();
+
+				m_vThreads.clear();
+			}
+
+			// Pick the context for a new connection, round-robin
+			asio::io_context& GetNextContext()
+			{
+				size_t n = m_nNextContext.fetch_add(1, std::memory_order_relaxed);
+				return *m_vContexts[n % m_vContexts.size()];
+			}
+
+			size_t size() const
+			{
+				return m_vContexts.size();
+			}
+
+		private:
+			typedef asio::executor_work_guard<asio::io_context::executor_type> work_guard;
+
+			// Contexts are held by pointer since io_context is not movable
+			std::vector<std::unique_ptr<asio::io_context>> m_vContexts;
+			std::vector<std::unique_ptr<work_guard>> m_vWork;
+			std::vector<std::thread> m_vThreads;
+
+			std::atomic<size_t> m_nNextContext{ 0 };
+		};
+	}
+}
@@ -4,6 +4,7 @@
 #include "net_tsqueue.h"
 #include "net_message.h"
 #include "net_connection.h"
+#include "net_context_pool.h"
 
 namespace olc
 {
@@ -13,9 +14,11 @@ namespace olc
 		class server_interface
 		{
 		public:
-			// Create a server, ready to listen on specified port
-			server_interface(uint16_t port)
-				: m_asioAcceptor(m_asioContext, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port))
+			// Create a server, ready to listen on specified port. Connections are
+			// spread over nThreads contexts - zero means one per core.
+			server_interface(uint16_t port, size_t nThreads = 0)
+				: m_contextPool(nThreads),
+				m_asioAcceptor(m_asioContext, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port))
 			{
 
 			}
@@ -24,6 +27,10 @@ namespace olc
 			{
 				// May as well try and tidy up
 				Stop();
+
+				// Sockets belong to the pooled contexts, so must go before they do
+				m_qMessagesIn.clear();
+				m_deqConnections.clear();
 			}
 
 			// Starts the server!
@@ -38,7 +45,10 @@ namespace olc
 					// connect.
 					WaitForClientConnection();
 
-					// Launch the asio context in its own thread
+					// Launch the connection contexts, one thread each...
+					m_contextPool.Start();
+
+					// ...and the acceptor's context in its own thread
 					m_threadContext = std::thread([this]() { m_asioContext.run(); });
 				}
 				catch (std::exception & e)
@@ -48,7 +58,7 @@ namespace olc
 					return false;
 				}
 
-				std::cout << "[SERVER] Started!\n";
+				std::cout << "[SERVER] Started on " << m_contextPool.size() << " threads!\n";
 				return true;
 			}
 
@@ -61,6 +71,9 @@ namespace olc
 				// Tidy up the context thread
 				if (m_threadContext.joinable()) m_threadContext.join();
 
+				// And the connection contexts
+				m_contextPool.Stop();
+
 				// Inform someone, anybody, if they care...
 				std::cout << "[SERVER] Stopped!\n";
 			}
@@ -70,9 +83,11 @@ namespace olc
 			{
 				// Prime context with an instruction to wait until a socket connects. This
 				// is the purpose of an "acceptor" object. It will provide a unique socket
-				// for each incoming connection attempt
-				m_asioAcceptor.async_accept(
-					[this](std::error_code ec, asio::ip::tcp::socket socket)
+				// for each incoming connection attempt. The socket is created on the
+				// next context in the pool, which will then service it for good.
+				asio::io_context& connContext = m_contextPool.GetNextContext();
+				m_asioAcceptor.async_accept(connContext,
+					[this, &connContext](std::error_code ec, asio::ip::tcp::socket socket)
 					{
 						// Triggered by incoming connection request
 						if (!ec)
@@ -83,21 +98,22 @@ namespace olc
 							// Create a new connection to handle this client 
 							std::shared_ptr<connection<T>> newconn =
 								std::make_shared<connection<T>>(connection<T>::owner::server,
-									m_asioContext, std::move(socket), m_qMessagesIn);
+									connContext, std::move(socket), m_qMessagesIn);
 
 
 
 							// Give the user server a chance to deny connection
 							if (OnClientConnect(newconn))
 							{
-								// Connection allowed, so add to container of new connections
-								m_deqConnections.push_back(std::move(newconn));
-
-								// And very important! Issue a task to the connection's
+								// Very important! Issue a task to the connection's
 								// asio context to sit and wait for bytes to arrive!
-								m_deqConnections.back()->ConnectToClient(nIDCounter++);
+								newconn->ConnectToClient(nIDCounter++);
+
+								std::cout << "[" << newconn->GetID() << "] Connection Approved\n";
 
-								std::cout << "[" << m_deqConnections.back()->GetID() << "] Connection Approved\n";
+								// Connection allowed, so add to container of new connections
+								std::scoped_lock lock(m_muxConnections);
+								m_deqConnections.push_back(std::move(newconn));
 							}
 							else
 							{
@@ -135,10 +151,8 @@ namespace olc
 					// be tracking it somehow
 					OnClientDisconnect(client);
 
-					// Off you go now, bye bye!
-					client.reset();
-
 					// Then physically remove it from the container
+					std::scoped_lock lock(m_muxConnections);
 					m_deqConnections.erase(
 						std::remove(m_deqConnections.begin(), m_deqConnections.end(), client), m_deqConnections.end());
 				}
@@ -147,35 +161,48 @@ namespace olc
 			// Send message to all clients
 			void MessageAllClients(const message<T>& msg, std::shared_ptr<connection<T>> pIgnoreClient = nullptr)
 			{
-				bool bInvalidClientExists = false;
+				// Copy the message once, then share that one buffer between every send
+				MessageAllClients(std::make_shared<const message<T>>(msg), pIgnoreClient);
+			}
+
+			// Send an already shared message to all clients
+			void MessageAllClients(std::shared_ptr<const message<T>> msg, std::shared_ptr<connection<T>> pIgnoreClient = nullptr)
+			{
+				// Dead clients are collected under the lock and only reported once
+				// it is released, since OnClientDisconnect() may message clients
+				std::vector<std::shared_ptr<connection<T>>> vDeadClients;
 
-				// Iterate through all clients in container
-				for (auto& client : m_deqConnections)
 				{
-					// Check client is connected...
-					if (client && client->IsConnected())
+					std::scoped_lock lock(m_muxConnections);
+
+					// Iterate through all clients in container
+					for (auto& client : m_deqConnections)
 					{
-						// ..it is!
-						if (client != pIgnoreClient)
-							client->Send(msg);
+						// Check client is connected...
+						if (client && client->IsConnected())
+						{
+							// ..it is!
+							if (client != pIgnoreClient)
+								client->Send(msg);
+						}
+						else
+						{
+							// The client couldnt be contacted, so assume it has
+							// disconnected.
+							vDeadClients.push_back(std::move(client));
+						}
 					}
-					else
-					{
-						// The client couldnt be contacted, so assume it has
-						// disconnected.
-						OnClientDisconnect(client);
-						client.reset();
 
-						// Set this flag to then remove dead clients from container
-						bInvalidClientExists = true;
-					}
+					// Remove dead clients, all in one go - this way, we dont invalidate the
+					// container as we iterated through it.
+					if (!vDeadClients.empty())
+						m_deqConnections.erase(
+							std::remove(m_deqConnections.begin(), m_deqConnections.end(), nullptr), m_deqConnections.end());
 				}
 
-				// Remove dead clients, all in one go - this way, we dont invalidate the
-				// container as we iterated through it.
-				if (bInvalidClientExists)
-					m_deqConnections.erase(
-						std::remove(m_deqConnections.begin(), m_deqConnections.end(), nullptr), m_deqConnections.end());
+				// Let the server know, it may be tracking them somehow
+				for (auto& client : vDeadClients)
+					OnClientDisconnect(client);
 			}
 
 			// Force server to respond to incoming messages
@@ -228,10 +255,16 @@ namespace olc
 			// Container of active validated connections
 			std::deque<std::shared_ptr<connection<T>>> m_deqConnections;
 
+			// Connections are accepted on one thread and used from another
+			std::mutex m_muxConnections;
+
 			// Order of declaration is important - it is also the order of initialisation
 			asio::io_context m_asioContext;
 			std::thread m_threadContext;
 
+			// Connections are sharded across these contexts
+			context_pool m_contextPool;
+
 			// These things need an asio context
 			asio::ip::tcp::acceptor m_asioAcceptor; // Handles new incoming connection attempts...
 
@@ -18,21 +18,21 @@ namespace olc
 			// Returns and maintains item at front of Queue
 			const T& front()
 			{
-		//		std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				return deqQueue.front();
 			}
 
 			// Returns and maintains item at back of Queue
 			const T& back()
 			{
-		//		std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				return deqQueue.back();
 			}
 
 			// Removes and returns item from front of Queue
 			T pop_front()
 			{
-			//	std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				auto t = std::move(deqQueue.front());
 				deqQueue.pop_front();
 				return t;
@@ -41,7 +41,7 @@ namespace olc
 			// Removes and returns item from back of Queue
 			T pop_back()
 			{
-			//	std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				auto t = std::move(deqQueue.back());
 				deqQueue.pop_back();
 				return t;
@@ -50,8 +50,12 @@ namespace olc
 			// Adds an item to back of Queue
 			void push_back(const T& item)
 			{
-		//		std::scoped_lock lock(muxQueue);
-				deqQueue.emplace_back(std::move(item));
+				{
+					// Release the queue before waking a waiter, as wait() takes
+					// the locks in the opposite order
+					std::scoped_lock lock(muxQueue);
+					deqQueue.emplace_back(std::move(item));
+				}
 
 				std::unique_lock<std::mutex> ul(muxBlocking);
 				cvBlocking.notify_one();
@@ -60,8 +64,10 @@ namespace olc
 			// Adds an item to front of Queue
 			void push_front(const T& item)
 			{
-				//std::scoped_lock lock(muxQueue);
-				deqQueue.emplace_front(std::move(item));
+				{
+					std::scoped_lock lock(muxQueue);
+					deqQueue.emplace_front(std::move(item));
+				}
 
 				std::unique_lock<std::mutex> ul(muxBlocking);
 				cvBlocking.notify_one();
@@ -70,31 +76,31 @@ namespace olc
 			// Returns true if Queue has no items
 			bool empty()
 			{
-				//std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				return deqQueue.empty();
 			}
 
 			// Returns number of items in Queue
 			size_t count()
 			{
-		//		std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				return deqQueue.size();
 			}
 
 			// Clears Queue
 			void clear()
 			{
-			//	std::scoped_lock lock(muxQueue);
+				std::scoped_lock lock(muxQueue);
 				deqQueue.clear();
 			}
 
 			void wait()
 			{
+				// Check under the blocking mutex so a push between the test and
+				// the wait cannot be missed now that producers run on other threads
+				std::unique_lock<std::mutex> ul(muxBlocking);
 				while (empty())
-				{
-					std::unique_lock<std::mutex> ul(muxBlocking);
 					cvBlocking.wait(ul);
-				}
 			}
 
 		protected:
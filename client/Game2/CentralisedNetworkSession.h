@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include "../../engine/Util/ClockSync.h"
+
 #include "ClientSession.h"
 #include "RoomList.h"
 #include "CentralisedNetInterface.h"
@@ -63,6 +65,8 @@ namespace HoverRace {
 			BOOL mTimeToSendCharacterCreation;		  // 0 mean sended
 			BOOL mSended12SecClockUpdate;			  // User by server to adjust client clock
 			BOOL mSended8SecClockUpdate;
+			HoverRace::Util::ClockSync mClockSync;	  // Offset from our clock to the server's
+			DWORD mLastClockPingTime;
 			int mMajorID;
 			int mMinorID;
 
@@ -97,6 +101,8 @@ namespace HoverRace {
 			void BroadcastMainElementStats(MR_SimulationTime pFinishTime, MR_SimulationTime pBestLap, int pNbLap);
 			void BroadcastChatMessage(const char* pMessage);
 			void BroadcastTime();
+			void SendClockPing();
+			void AddClockSample(DWORD pPingTime, MR_SimulationTime pServerTime);
 			void BroadcastHit(int pHoverIdSrc);
 
 			void AddChatMessage(int pPlayerIndex, const char* Message, int pMessageLen);
@@ -119,7 +125,7 @@ namespace HoverRace {
 			// Simulation control
 			void Process(int pSpeedFactor = 1);		  // Simulation, speed factor can be used to reduce processing speed to create AVI files
 
-			BOOL LoadNew(const char* pTitle, HoverRace::Parcel::RecordFilePtr pMazeFile, int pNbLap, char pGameOpts, VideoServices::VideoBuffer* pVideo);
+			BOOL FinishLoadNew(VideoServices::VideoBuffer* pVideo);
 
 			BOOL CreateMainCharacter();
 
@@ -24,9 +24,10 @@
 #include <boost/thread/locks.hpp>
 
 #include "../../engine/MainCharacter/MainCharacter.h"
-#include "../../engine/Model/TrackFileCommon.h"
 #include "../../engine/VideoServices/VideoBuffer.h"
 
+#include "TrackLoader.h"
+
 #include "ClientSession.h"
 
 using namespace HoverRace::Parcel;
@@ -37,7 +38,8 @@ namespace Client {
 
 ClientSession::ClientSession() :
 	mSession(TRUE),
-	frameCount(0), lastTimestamp(0), fps(0.0)
+	frameCount(0), lastTimestamp(0), fps(0.0),
+	lastFrameTimestamp(0), frameTime(0)
 {
 	for (int i = 0; i < MAX_PLAYERS; ++i) {
 		mainCharacter[i] = NULL;
@@ -46,10 +48,12 @@ ClientSession::ClientSession() :
 	mMap = NULL;
 	mNbLap = 1;
 	mGameOpts = 0;
+	mLoader = NULL;
 }
 
 ClientSession::~ClientSession()
 {
+	delete mLoader;
 	delete[]mBackImage;
 	delete mMap;
 }
@@ -60,79 +64,140 @@ void ClientSession::Process(int pSpeedFactor)
 	mSession.Simulate();
 }
 
-void ClientSession::ReadLevelAttrib(Parcel::RecordFilePtr pRecordFile, VideoServices::VideoBuffer * pVideo)
+/**
+ * Simulate up to a moment earlier in the current frame.
+ * Used to apply input at the time it was captured; the rest of the frame is
+ * simulated by the next Process().
+ * @param pTime The time to simulate up to (from OS::Time()).
+ */
+void ClientSession::SimulateUntil(OS::timestamp_t pTime)
 {
-	// Read level background palette
-	if((pVideo != NULL) && (pRecordFile->GetNbRecords() >= 3)) {
-		pRecordFile->SelectRecord(2);
+	UpdateCharacterSimulationTimes();
+	mSession.SimulateUntil(pTime);
+	UpdateCharacterSimulationTimes();
+}
 
-		{
-			ObjStreamPtr archivePtr(pRecordFile->StreamIn());
-			ObjStream &lArchive = *archivePtr;
+void ClientSession::ApplyLevelAttrib(TrackLoader &pLoader, VideoServices::VideoBuffer *pVideo)
+{
+	// Level background palette
+	MR_UInt8 *lPalette = pLoader.ReleaseBackPalette();
+	MR_UInt8 *lBackImage = pLoader.ReleaseBackImage();
+	if((pVideo != NULL) && (lPalette != NULL)) {
+		delete[]mBackImage;
+		mBackImage = lBackImage;
+
+		pVideo->SetBackPalette(lPalette);
+	}
+	else {
+		delete[]lPalette;
+		delete[]lBackImage;
+	}
 
-			int lImageType;
+	// Map section
+	int lX0;
+	int lX1;
+	int lY0;
+	int lY1;
 
-			lArchive >> lImageType;
+	VideoServices::Sprite *lMapSprite = pLoader.ReleaseMap(lX0, lY0, lX1, lY1);
+	if(lMapSprite != NULL) {
+		SetMap(lMapSprite, lX0, lY0, lX1, lY1);
+	}
+}
 
-			if(lImageType == MR_RAWBITMAP) {
-				MR_UInt8 *lPalette = new MR_UInt8[MR_BACK_COLORS * 3];
+BOOL ClientSession::LoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile,
+                            int pNbLap, char pGameOpts, VideoServices::VideoBuffer *pVideo)
+{
+	StartLoadNew(pTitle, pMazeFile, pNbLap, pGameOpts);
+	return FinishLoadNew(pVideo);
+}
 
-				if(mBackImage == NULL) {
-					mBackImage = new MR_UInt8[MR_BACK_X_RES * MR_BACK_Y_RES];
-				}
+/**
+ * Start loading a new level in the background.
+ * The caller is free to do other work (e.g. keep a dialog responsive or
+ * talk to the server) while the track loads; FinishLoadNew() must be
+ * called afterwards to wait for the level and start the session.
+ * @param pTitle The track title.
+ * @param pMazeFile The track file.
+ * @param pNbLap The number of laps.
+ * @param pGameOpts The game options.
+ */
+void ClientSession::StartLoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile,
+                                 int pNbLap, char pGameOpts)
+{
+	delete mLoader;
+	mLoader = NULL;
 
-				lArchive.Read(lPalette, MR_BACK_COLORS * 3);
-				lArchive.Read(mBackImage, MR_BACK_X_RES * MR_BACK_Y_RES);
+	mLoadTitle = pTitle;
+	mNbLap = pNbLap;
+	mGameOpts = pGameOpts;
 
-				pVideo->SetBackPalette(lPalette);
-			}
-		}
+	if(pMazeFile != NULL) {
+		mLoader = new TrackLoader(pMazeFile, mSession.IsRenderingAllowed(), pGameOpts);
 	}
-	// Read map section
-	if(pRecordFile->GetNbRecords() >= 4) {
-		pRecordFile->SelectRecord(3);
-		{
-			ObjStreamPtr archivePtr(pRecordFile->StreamIn());
-			ObjStream &lArchive = *archivePtr;
+}
 
-			int lX0;
-			int lX1;
-			int lY0;
-			int lY1;
+/**
+ * Retrieve the title of the level being loaded by StartLoadNew().
+ * @return The title.
+ */
+const std::string &ClientSession::GetLoadTitle() const
+{
+	return mLoadTitle;
+}
 
-			VideoServices::Sprite *lMapSprite = new VideoServices::Sprite;
+/**
+ * Retrieve the progress of the level being loaded by StartLoadNew().
+ * @return The progress, from 0.0 to 1.0.
+ */
+double ClientSession::GetLoadProgress() const
+{
+	return (mLoader == NULL) ? 1.0 : mLoader->GetProgress();
+}
 
-			lArchive >> lX0;
-			lArchive >> lX1;
-			lArchive >> lY0;
-			lArchive >> lY1;
+/**
+ * Check if the level being loaded by StartLoadNew() is ready.
+ * @return @c true if FinishLoadNew() will return immediately.
+ */
+bool ClientSession::IsLoadDone() const
+{
+	return (mLoader == NULL) || mLoader->IsDone();
+}
 
-			lMapSprite->Serialize(lArchive);
+/**
+ * Wait for the level started by StartLoadNew() to finish loading and start
+ * the session with it.
+ * @param pVideo The video buffer to receive the background palette
+ *               (may be @c NULL).
+ * @return @c TRUE if successful.
+ * @throws Parcel::ObjStreamExn The level could not be loaded.
+ */
+BOOL ClientSession::FinishLoadNew(VideoServices::VideoBuffer *pVideo)
+{
+	if(mLoader == NULL) {
+		// Nothing to load; this just clears the session.
+		return mSession.LoadNew(mLoadTitle.c_str(), Parcel::RecordFilePtr(), (Model::Level*)NULL);
+	}
 
-			SetMap(lMapSprite, lX0, lY0, lX1, lY1);
-		}
+	try {
+		mLoader->Wait();
 	}
-	// Read level midi stream
-	if(pRecordFile->GetNbRecords() >= 5) {
-		pRecordFile->SelectRecord(4);
-		{
-			// TODO
-		}
+	catch (Parcel::ObjStreamExn&) {
+		delete mLoader;
+		mLoader = NULL;
+		throw;
 	}
-}
 
-BOOL ClientSession::LoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile,
-                            int pNbLap, char pGameOpts, VideoServices::VideoBuffer *pVideo)
-{
-	BOOL lReturnValue;
-	mNbLap = pNbLap;
-	mGameOpts = pGameOpts;
-	lReturnValue = mSession.LoadNew(pTitle, pMazeFile, pGameOpts);
+	Model::Level *lLevel = mLoader->ReleaseLevel();
+	BOOL lReturnValue = mSession.LoadNew(mLoadTitle.c_str(), mLoader->GetMazeFile(), lLevel);
 
 	if(lReturnValue) {
-		ReadLevelAttrib(pMazeFile, pVideo);
+		ApplyLevelAttrib(*mLoader, pVideo);
 	}
 
+	delete mLoader;
+	mLoader = NULL;
+
 	return lReturnValue;
 }
 
@@ -396,6 +461,10 @@ void ClientSession::IncFrameCount()
 
 	++frameCount;
 	OS::timestamp_t curTimestamp = OS::Time();
+	if (lastFrameTimestamp != 0) {
+		frameTime = OS::TimeDiff(curTimestamp, lastFrameTimestamp);
+	}
+	lastFrameTimestamp = curTimestamp;
 	OS::timestamp_t diff = OS::TimeDiff(curTimestamp, lastTimestamp);
 
 	if (diff > 1000) {
@@ -420,5 +489,45 @@ double ClientSession::GetCurrentFramerate() const
 	return fps;
 }
 
+/**
+ * Retrieve the time between the last two frames.
+ * @return The frame time in milliseconds (zero until two frames have been
+ *         counted).
+ */
+OS::timestamp_t ClientSession::GetLastFrameTime() const
+{
+	return frameTime;
+}
+
+/**
+ * Retrieve the number of simulation slices run by the last Process().
+ * @return The slice count.
+ */
+int ClientSession::GetLastSliceCount() const
+{
+	return mSession.GetLastSliceCount();
+}
+
+/**
+ * Retrieve the number of simulation slices run since the session started.
+ * @return The slice count.
+ */
+MR_UInt32 ClientSession::GetTotalSliceCount() const
+{
+	return mSession.GetTotalSliceCount();
+}
+
+/**
+ * Retrieve how much outgoing network traffic is waiting to be sent.
+ * Local sessions have no network, so this is always zero.
+ * @param[out] pOutBytes Bytes waiting in the stream output queues.
+ * @param[out] pReliableMsgs Reliable messages not yet acknowledged.
+ */
+void ClientSession::GetNetQueueDepth(int &pOutBytes, int &pReliableMsgs) const
+{
+	pOutBytes = 0;
+	pReliableMsgs = 0;
+}
+
 }  // namespace Client
 }  // namespace HoverRace
@@ -36,6 +36,8 @@ namespace HoverRace {
 namespace HoverRace {
 namespace Client {
 
+class TrackLoader;
+
 class ClientSession
 {
 	protected:
@@ -72,8 +74,13 @@ class ClientSession
 		unsigned int frameCount;
 		Util::OS::timestamp_t lastTimestamp;
 		double fps;
+		Util::OS::timestamp_t lastFrameTimestamp;
+		Util::OS::timestamp_t frameTime;
+
+		std::string mLoadTitle;
+		TrackLoader *mLoader;
 
-		void ReadLevelAttrib(Parcel::RecordFilePtr pFile, VideoServices::VideoBuffer *pVideo);
+		void ApplyLevelAttrib(TrackLoader &pLoader, VideoServices::VideoBuffer *pVideo);
 	public:
 		// Creation and destruction
 		ClientSession();
@@ -82,9 +89,17 @@ class ClientSession
 		// Simulation control
 												  // Simulation, speed factor can be used to reduce processing speed to create AVI files
 		virtual void Process(int pSpeedFactor = 1);
+		void SimulateUntil(Util::OS::timestamp_t pTime);
 
 		virtual BOOL LoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile, int pNbLap, char pGameOpts, VideoServices::VideoBuffer *pVideo);
 
+		// Background loading (LoadNew() is StartLoadNew() + FinishLoadNew())
+		void StartLoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile, int pNbLap, char pGameOpts);
+		const std::string &GetLoadTitle() const;
+		double GetLoadProgress() const;
+		bool IsLoadDone() const;
+		virtual BOOL FinishLoadNew(VideoServices::VideoBuffer *pVideo);
+
 		// Main character control and interrogation
 		bool CreateMainCharacter(int i);
 
@@ -118,6 +133,10 @@ class ClientSession
 		// Client stats.
 		void IncFrameCount();
 		double GetCurrentFramerate() const;
+		Util::OS::timestamp_t GetLastFrameTime() const;
+		int GetLastSliceCount() const;
+		MR_UInt32 GetTotalSliceCount() const;
+		virtual void GetNetQueueDepth(int &pOutBytes, int &pReliableMsgs) const;
 };
 
 }  // namespace Client
@@ -10,6 +10,7 @@
 #	include "SDL/SDLInputManager.h"
 #endif
 
+#include "../ClientSession.h"
 #include "InputHandler.h"
 #include "UiHandler.h"
 
@@ -42,6 +43,10 @@ InputEventController::InputEventController(Util::OS::wnd_t mainWindow, UiHandler
 	joys = NULL;
 	joyIds = NULL;
 
+	actionTableShift = 0;
+	actionTableDirty = true;
+	inputThread = NULL;
+
 //	mouseXLast = 0;
 //	mouseYLast = 0;
 //	mouseZLast = 0;
@@ -55,6 +60,8 @@ InputEventController::InputEventController(Util::OS::wnd_t mainWindow, UiHandler
 
 InputEventController::~InputEventController()
 {
+	StopInputThread();
+
 	// clean up all our ControlActions
 	for(map<string, ActionMap>::iterator it = allActionMaps.begin(); it != allActionMaps.end(); it++) {
 		for(ActionMap::iterator itm = it->second.begin(); itm != it->second.end(); itm++) {
@@ -72,7 +79,60 @@ InputEventController::~InputEventController()
 	delete[] joys;
 }
 
-void InputEventController::Poll() 
+void InputEventController::Poll(ClientSession *session)
+{
+	if(inputThread == NULL)
+		Capture();
+
+	// Events are in the order they were captured, so the session only ever
+	// moves forward.
+	InputEventQueue::Event evt;
+	while(eventQueue.Pop(evt)) {
+		if(session != NULL)
+			session->SimulateUntil(evt.time);
+		HandleEvent(evt.hash, evt.value);
+	}
+}
+
+void InputEventController::StartInputThread(int rate)
+{
+	// The devices must only be captured by one thread at a time, so this
+	// must not be called while another thread is in Poll().
+	if(inputThread != NULL || rate <= 0)
+		return;
+
+	inputThread = new boost::thread(&InputEventController::InputThreadProc, this, rate);
+}
+
+void InputEventController::StopInputThread()
+{
+	if(inputThread != NULL) {
+		inputThread->interrupt();
+		inputThread->join();
+		delete inputThread;
+		inputThread = NULL;
+	}
+}
+
+void InputEventController::InputThreadProc(int rate)
+{
+	boost::posix_time::time_duration period = boost::posix_time::microseconds(1000000 / rate);
+
+	try {
+		for(;;) {
+			Capture();
+			boost::this_thread::sleep(period);
+		}
+	} catch(boost::thread_interrupted&) {
+		// Asked to stop.
+	}
+}
+
+/**
+ * Capture all devices.  The OIS callbacks queue up the events; they are
+ * only acted on in Poll().
+ */
+void InputEventController::Capture()
 {
 	try {
 		if(kbd)
@@ -105,7 +165,7 @@ bool InputEventController::keyPressed(const KeyEvent& arg)
 	int value = arg.text;
 	if(value == 0)
 		value = 1; // just in case there is no text
-	HandleEvent(HashKeyboardEvent(kc), value);
+	QueueEvent(HashKeyboardEvent(kc), value);
 	return true;
 }
 
@@ -126,7 +186,9 @@ bool InputEventController::keyReleased(const KeyEvent& arg)
 		 * http://www.wreckedgames.com/forum/index.php?topic=893.0
 		 */
 #ifdef WIN32
-		if((GetKeyState(VK_RSHIFT) & 0x80) > 0)
+		// GetAsyncKeyState() since we may be on the input thread, which has
+		// no message queue for GetKeyState() to look at.
+		if((GetAsyncKeyState(VK_RSHIFT) & 0x8000) != 0)
 			return true; // ignore faulty event
 #endif
 		kc = KC_LSHIFT;
@@ -136,7 +198,7 @@ bool InputEventController::keyReleased(const KeyEvent& arg)
 		kc = KC_LMENU;
 
 	// value will be 0 (since the key was released)
-	HandleEvent(HashKeyboardEvent(kc), 0);
+	QueueEvent(HashKeyboardEvent(kc), 0);
 	return true;
 }
 
@@ -168,36 +230,36 @@ bool InputEventController::mouseMoved(const MouseEvent& arg)
 
 	// send up to three events if necessary
 	if(ax > 0)
-		HandleEvent(HashMouseAxisEvent(arg, AXIS_X, (x > 0) ? 1 : 0), ax);
+		QueueEvent(HashMouseAxisEvent(arg, AXIS_X, (x > 0) ? 1 : 0), ax);
 	if(ay > 0)
-		HandleEvent(HashMouseAxisEvent(arg, AXIS_Y, (y > 0) ? 1 : 0), ay);
+		QueueEvent(HashMouseAxisEvent(arg, AXIS_Y, (y > 0) ? 1 : 0), ay);
 	if(az > 0)
-		HandleEvent(HashMouseAxisEvent(arg, AXIS_Z, (z > 0) ? 1 : 0), az);
+		QueueEvent(HashMouseAxisEvent(arg, AXIS_Z, (z > 0) ? 1 : 0), az);
 
 	return true;
 }
 
 bool InputEventController::mousePressed(const MouseEvent& arg, MouseButtonID id)
 {
-	HandleEvent(HashMouseButtonEvent(arg, id), 1);
+	QueueEvent(HashMouseButtonEvent(arg, id), 1);
 	return true;
 }
 
 bool InputEventController::mouseReleased(const MouseEvent& arg, MouseButtonID id)
 {
-	HandleEvent(HashMouseButtonEvent(arg, id), 0);
+	QueueEvent(HashMouseButtonEvent(arg, id), 0);
 	return true;
 }
 
 bool InputEventController::buttonPressed(const JoyStickEvent& arg, int button)
 {
-	HandleEvent(HashJoystickButtonEvent(arg, button), 1);
+	QueueEvent(HashJoystickButtonEvent(arg, button), 1);
 	return true;
 }
 
 bool InputEventController::buttonReleased(const JoyStickEvent& arg, int button)
 {
-	HandleEvent(HashJoystickButtonEvent(arg, button), 0);
+	QueueEvent(HashJoystickButtonEvent(arg, button), 0);
 	return true;
 }
 
@@ -209,13 +271,13 @@ bool InputEventController::axisMoved(const JoyStickEvent& arg, int axis)
 	else
 		value = arg.state.mAxes[axis].rel;
 
-	HandleEvent(HashJoystickAxisEvent(arg, axis, (value > 0) ? 1 : 0), value);
+	QueueEvent(HashJoystickAxisEvent(arg, axis, (value > 0) ? 1 : 0), value);
 	return true;
 }
 
 bool InputEventController::povMoved(const JoyStickEvent& arg, int pov)
 {
-	HandleEvent(HashJoystickPovEvent(arg, pov, arg.state.mPOV[pov].direction), 0);
+	QueueEvent(HashJoystickPovEvent(arg, pov, arg.state.mPOV[pov].direction), 0);
 	return true;
 }
 
@@ -244,8 +306,63 @@ void InputEventController::HandleEvent(int hash, int value)
 	}
 
 	// fire the action bound to the given input hash code
-	if(actionMap.count(hash) == 1)
-		(*actionMap[hash])(value);
+	ControlAction *action = FindAction(hash);
+	if(action != NULL)
+		(*action)(value);
+}
+
+void InputEventController::QueueEvent(int hash, int value)
+{
+	InputEventQueue::Event evt;
+	evt.time = OS::Time();
+	evt.hash = hash;
+	evt.value = value;
+
+	eventQueue.Push(evt); // if full, the event is lost (like a DirectInput overflow)
+}
+
+void InputEventController::RebuildActionTable()
+{
+	// keep the table at most half full so probes stay short
+	unsigned int bits = 6;
+	while((1u << bits) < actionMap.size() * 2)
+		bits++;
+
+	ActionSlot empty = { 0, NULL };
+	actionTable.assign(1u << bits, empty);
+	actionTableShift = 32 - bits;
+
+	unsigned int mask = (1u << bits) - 1;
+	for(ActionMap::iterator it = actionMap.begin(); it != actionMap.end(); it++) {
+		if(it->second == NULL)
+			continue;
+
+		unsigned int i = ((unsigned int) it->first * 2654435761u) >> actionTableShift;
+		while(actionTable[i].action != NULL)
+			i = (i + 1) & mask;
+
+		actionTable[i].hash = it->first;
+		actionTable[i].action = it->second;
+	}
+
+	actionTableDirty = false;
+}
+
+ControlAction *InputEventController::FindAction(int hash)
+{
+	if(actionTableDirty)
+		RebuildActionTable();
+
+	// most hashes have their low bits clear, so scramble them with a
+	// multiplicative hash and use the top bits
+	unsigned int mask = (unsigned int) actionTable.size() - 1;
+	for(unsigned int i = ((unsigned int) hash * 2654435761u) >> actionTableShift; ; i = (i + 1) & mask) {
+		const ActionSlot &slot = actionTable[i];
+		if(slot.action == NULL)
+			return NULL;
+		if(slot.hash == hash)
+			return slot.action;
+	}
 }
 
 void InputEventController::CaptureNextInput(int oldhash, string mapname)
@@ -285,6 +402,7 @@ void InputEventController::ClearActionMap()
 	// remove all active bindings
 	actionMap.clear();
 	activeMaps.clear();
+	actionTableDirty = true;
 }
 
 bool InputEventController::AddActionMap(string mapname)
@@ -295,6 +413,7 @@ bool InputEventController::AddActionMap(string mapname)
 	for(ActionMap::iterator it = allActionMaps[mapname].begin(); it != allActionMaps[mapname].end(); it++)
 		actionMap[it->first] = it->second; // add to active controls
 	activeMaps.push_back(mapname);
+	actionTableDirty = true;
 	return true;
 }
 
@@ -339,6 +458,7 @@ void InputEventController::AddPlayerMaps(int numPlayers, MainCharacter::MainChar
 			actionMap[it->first] = it->second; // add to active controls
 		}
 		activeMaps.push_back(mapname);
+		actionTableDirty = true;
 	}
 
 	AddActionMap(_("Console"));
@@ -463,6 +583,7 @@ void InputEventController::ReloadConfig()
 	allActionMaps.clear();
 	activeMaps.clear();
 	actionMap.clear();
+	actionTableDirty = true;
 	LoadConfig();
 	LoadConsoleMap();
 }
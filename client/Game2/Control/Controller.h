@@ -10,6 +10,8 @@
 #include <vector>
 #include <string>
 
+#include <boost/thread/thread.hpp>
+
 #include "OIS/OIS.h"
 #include "OIS/OISInputManager.h"
 #include "OIS/OISException.h"
@@ -24,6 +26,7 @@
 #include "../Observer.h"
 
 #include "ControlAction.h"
+#include "InputEventQueue.h"
 
 #define	CTL_MOTOR_ON	1
 #define CTL_LEFT		2
@@ -45,6 +48,12 @@
 // maybe later... TODO
 //#include "OIS/OISForceFeedback.h"
 
+namespace HoverRace {
+namespace Client {
+	class ClientSession;
+}
+}
+
 namespace HoverRace {
 namespace Client {
 namespace Control {
@@ -91,9 +100,31 @@ class InputEventController : public KeyListener, public MouseListener, public Jo
 		bool axisMoved(const JoyStickEvent &arg, int axis);
 		bool povMoved(const JoyStickEvent &arg, int pov);
 
-		void Poll();
+		/***
+		 * Fire the actions for all input received since the last call.
+		 * If the input thread is not running, the devices are captured first.
+		 *
+		 * @param session If not NULL, the session is simulated up to the time
+		 *                of each event before its action is fired, so that
+		 *                controls take effect when they were actually pressed.
+		 */
+		void Poll(ClientSession *session = NULL);
 		void HandleEvent(int hash, int value);
 
+		/***
+		 * Capture the input devices on a separate thread instead of in Poll().
+		 * Events are timestamped as they are captured and queued until the
+		 * next Poll().
+		 *
+		 * @param rate Number of captures per second.
+		 */
+		void StartInputThread(int rate);
+
+		/***
+		 * Stop the input thread; Poll() will capture the devices again.
+		 */
+		void StopInputThread();
+
 		/***
 		 * This function tells the InputEventController to capture the next user input
 		 * event and assign the action currently residing at 'oldhash' to the hash of
@@ -202,6 +233,20 @@ class InputEventController : public KeyListener, public MouseListener, public Jo
 	private:
 		void InitInputManager(Util::OS::wnd_t mainWindow);
 
+		void Capture();
+		void InputThreadProc(int rate);
+		void QueueEvent(int hash, int value);
+
+		// Flat open-addressed copy of actionMap, so that dispatching an event
+		// is a probe into one array instead of a walk through the tree.
+		// Rebuilt lazily whenever actionMap changes.
+		struct ActionSlot {
+			int hash;
+			ControlAction *action;
+		};
+		void RebuildActionTable();
+		ControlAction *FindAction(int hash);
+
 		// Auxiliary functions
 		void RebindKey(std::string mapname, int oldhash, int newhash);
 
@@ -247,6 +292,9 @@ class InputEventController : public KeyListener, public MouseListener, public Jo
 		 * They are referenced by string.  See ClearActionMap(), AddActionMap().
 		 */
 		ActionMap actionMap;
+		std::vector<ActionSlot> actionTable;
+		unsigned int actionTableShift;
+		bool actionTableDirty;
 		std::vector<std::string> activeMaps;
 		std::map<std::string, ActionMap> allActionMaps;
 
@@ -262,6 +310,9 @@ class InputEventController : public KeyListener, public MouseListener, public Jo
 		JoyStick **joys;
 		int *joyIds;
 
+		InputEventQueue eventQueue;
+		boost::thread *inputThread;
+
 		int nextAvailableDisabledHash;
 
 		bool captureNextInput;
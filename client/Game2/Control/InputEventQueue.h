@@ -0,0 +1,102 @@
+// InputEventQueue.h
+// Lock-free queue that carries input events from the input thread to the
+// game thread.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+//
+
+#ifndef __INPUT_EVENT_QUEUE_H
+#define __INPUT_EVENT_QUEUE_H
+
+#include <boost/atomic.hpp>
+
+#include "../../../engine/Util/OS.h"
+
+namespace HoverRace {
+namespace Client {
+namespace Control {
+
+/***
+ * \class InputEventQueue
+ *
+ * A fixed-size, single-producer single-consumer queue of timestamped input
+ * events.  One thread captures the input devices and pushes; the game thread
+ * pops.  Neither side ever waits for the other.
+ *
+ * If the queue is full, new events are dropped, the same way they would be
+ * if the DirectInput buffer overflowed.
+ */
+class InputEventQueue {
+	public:
+		struct Event {
+			Util::OS::timestamp_t time;
+			int hash;
+			int value;
+		};
+
+	public:
+		InputEventQueue() : head(0), tail(0) { }
+
+		/***
+		 * Add an event to the queue (producer side only).
+		 * @return false if the queue is full and the event was dropped.
+		 */
+		bool Push(const Event &evt)
+		{
+			unsigned int t = tail.load(boost::memory_order_relaxed);
+			if(t - head.load(boost::memory_order_acquire) >= CAPACITY)
+				return false;
+
+			events[t % CAPACITY] = evt;
+			tail.store(t + 1, boost::memory_order_release);
+			return true;
+		}
+
+		/***
+		 * Remove the oldest event from the queue (consumer side only).
+		 * @return false if the queue is empty.
+		 */
+		bool Pop(Event &evt)
+		{
+			unsigned int h = head.load(boost::memory_order_relaxed);
+			if(h == tail.load(boost::memory_order_acquire))
+				return false;
+
+			evt = events[h % CAPACITY];
+			head.store(h + 1, boost::memory_order_release);
+			return true;
+		}
+
+	private:
+		static const unsigned int CAPACITY = 256;  // must be a power of two
+
+		Event events[CAPACITY];
+
+		// Keep the two indices on separate cache lines so the threads don't
+		// keep stealing the line from each other.
+		boost::atomic<unsigned int> head;  /// written by the consumer
+		char pad[64];
+		boost::atomic<unsigned int> tail;  /// written by the producer
+};
+
+} // namespace Control
+} // namespace Client
+} // namespace HoverRace
+
+#endif
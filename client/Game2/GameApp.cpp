@@ -48,6 +48,7 @@
 #include "Rulebook.h"
 #include "TrackSelectDialog.h"
 #include "TrackDownloadDialog.h"
+#include "TrackLoadDialog.h"
 #include "../../engine/Util/DllObjectFactory.h"
 #include "../../engine/VideoServices/ColorPalette.h"
 #include "../../engine/VideoServices/VideoBuffer.h"
@@ -748,6 +749,7 @@ BOOL GameApp::CreateMainWindow()
 
 	// set up controller
 	controller = new Control::InputEventController(mMainWindow, uiInput);
+	controller->StartInputThread(cfg->misc.inputPollRate);
 
 	return lReturnValue;
 }
@@ -1114,7 +1116,7 @@ void GameApp::RefreshView()
 
 void GameApp::PollController()
 {
-	controller->Poll();
+	controller->Poll(mCurrentSession);
 }
 
 bool GameApp::SetVideoMode(int pX, int pY, const std::string *monitor, bool testing)
@@ -1308,9 +1310,11 @@ void GameApp::NewLocalSession(RulebookPtr rules)
 				Model::TrackPtr track = Config::GetInstance()->
 					GetTrackBundle()->OpenTrack(rules->GetTrackName());
 				if (track.get() == NULL) throw Parcel::ObjStreamExn("Track does not exist.");
-				lSuccess = (lCurrentSession->LoadNew(
+				lCurrentSession->StartLoadNew(
 					rules->GetTrackName().c_str(), track->GetRecordFile(),
-					rules->GetLaps(), rules->GetGameOpts(), mVideoBuffer) != FALSE);
+					rules->GetLaps(), rules->GetGameOpts());
+				TrackLoadDialog(lCurrentSession).ShowModal(mInstance, mMainWindow);
+				lSuccess = (lCurrentSession->FinishLoadNew(mVideoBuffer) != FALSE);
 			}
 			catch (Parcel::ObjStreamExn &ex) {
 				TrackOpenFailMessageBox(mMainWindow, rules->GetTrackName(), ex.what());
@@ -1407,9 +1411,11 @@ void GameApp::NewSplitSession(int pSplitPlayers)
 				Model::TrackPtr track = Config::GetInstance()->
 					GetTrackBundle()->OpenTrack(rules->GetTrackName());
 				if (track.get() == NULL) throw Parcel::ObjStreamExn("Track does not exist.");
-				lSuccess = (lCurrentSession->LoadNew(
+				lCurrentSession->StartLoadNew(
 					lCurrentTrack.c_str(), track->GetRecordFile(),
-					lNbLap, lGameOpts, mVideoBuffer) != FALSE);
+					lNbLap, lGameOpts);
+				TrackLoadDialog(lCurrentSession).ShowModal(mInstance, mMainWindow);
+				lSuccess = (lCurrentSession->FinishLoadNew(mVideoBuffer) != FALSE);
 			}
 			catch (Parcel::ObjStreamExn &ex) {
 				TrackOpenFailMessageBox(mMainWindow, rules->GetTrackName(), ex.what());
@@ -1572,7 +1578,7 @@ void GameApp::NewCentralisedNetworkSession(BOOL pServer)
 
 				lSuccess = TrackDownloadDialog(lCurrentTrack).ShowModal(mInstance, mMainWindow);
 				if (lSuccess) {
-					Model::TrackPtr track = Config::GetInstance()->
+					track = Config::GetInstance()->
 						GetTrackBundle()->OpenTrack(lCurrentTrack.c_str());
 					if (track.get() == NULL) {
 						throw Parcel::ObjStreamExn("Track failed to download.");
@@ -1587,9 +1593,11 @@ void GameApp::NewCentralisedNetworkSession(BOOL pServer)
 	}
 
 	if (lSuccess) {
-		lSuccess = (lCurrentSession->LoadNew(
+		// The track loads in the background while we wait for the other
+		// players to connect.
+		lCurrentSession->StartLoadNew(
 			lCurrentTrack.c_str(), track->GetRecordFile(),
-			lNbLap, lGameOpts, mVideoBuffer) != FALSE);
+			lNbLap, lGameOpts);
 	}
 
 	if (lSuccess) {
@@ -1630,6 +1638,17 @@ void GameApp::NewCentralisedNetworkSession(BOOL pServer)
 			lSuccess = (lCurrentSession->ConnectToServer(mMainWindow) != FALSE);
 	}
 
+	if (lSuccess) {
+		TrackLoadDialog(lCurrentSession).ShowModal(mInstance, mMainWindow);
+		try {
+			lSuccess = (lCurrentSession->FinishLoadNew(mVideoBuffer) != FALSE);
+		}
+		catch (Parcel::ObjStreamExn &ex) {
+			TrackOpenFailMessageBox(mMainWindow, lCurrentTrack, ex.what());
+			lSuccess = false;
+		}
+	}
+
 	if (lSuccess) {
 		// start in 13 seconds
 		lCurrentSession->SetSimulationTime(-13000);
@@ -1780,7 +1799,7 @@ void GameApp::NewNetworkSession(BOOL pServer)
 
 				lSuccess = TrackDownloadDialog(lCurrentTrack).ShowModal(mInstance, mMainWindow);
 				if (lSuccess) {
-					Model::TrackPtr track = Config::GetInstance()->
+					track = Config::GetInstance()->
 						GetTrackBundle()->OpenTrack(lCurrentTrack.c_str());
 					if (track.get() == NULL) {
 						throw Parcel::ObjStreamExn("Track failed to download.");
@@ -1795,9 +1814,11 @@ void GameApp::NewNetworkSession(BOOL pServer)
 	}
 
 	if(lSuccess) {
-		lSuccess = (lCurrentSession->LoadNew(
+		// The track loads in the background while we wait for the other
+		// players to connect.
+		lCurrentSession->StartLoadNew(
 			lCurrentTrack.c_str(), track->GetRecordFile(),
-			lNbLap, lGameOpts, mVideoBuffer) != FALSE);
+			lNbLap, lGameOpts);
 	}
 
 	if(lSuccess) {
@@ -1837,6 +1858,17 @@ void GameApp::NewNetworkSession(BOOL pServer)
 			lSuccess = (lCurrentSession->ConnectToServer(mMainWindow) != FALSE);
 	}
 
+	if(lSuccess) {
+		TrackLoadDialog(lCurrentSession).ShowModal(mInstance, mMainWindow);
+		try {
+			lSuccess = (lCurrentSession->FinishLoadNew(mVideoBuffer) != FALSE);
+		}
+		catch (Parcel::ObjStreamExn &ex) {
+			TrackOpenFailMessageBox(mMainWindow, lCurrentTrack, ex.what());
+			lSuccess = false;
+		}
+	}
+
 	if(lSuccess) {
 												  // start in 13 seconds
 		lCurrentSession->SetSimulationTime(-13000);
@@ -1880,7 +1912,9 @@ void GameApp::NewNetworkSession(BOOL pServer)
 HoverRace::Client::Control::InputEventController *GameApp::ReloadController()
 {
 	delete controller;
-	return (controller = new Control::InputEventController(This->mMainWindow, This->uiInput));
+	controller = new Control::InputEventController(This->mMainWindow, This->uiInput);
+	controller->StartInputThread(Config::GetInstance()->misc.inputPollRate);
+	return controller;
 }
 
 void GameApp::NewInternetSession()
@@ -25,6 +25,8 @@
 #include "../../engine/Model/Track.h"
 #include "../../engine/Parcel/TrackBundle.h"
 #include "../../engine/VideoServices/SoundServer.h"
+#include "../../engine/VideoServices/VideoBuffer.h"
+#include "../../engine/VideoServices/Viewport2D.h"
 
 #include "Control/Controller.h"
 #include "HoverScript/GamePeer.h"
@@ -46,7 +48,8 @@ GameScene::GameScene(GameDirector *director, VideoServices::VideoBuffer *videoBu
                      Script::Core *scripting, HoverScript::GamePeer *gamePeer,
                      RulebookPtr rules) :
 	SUPER(),
-	frame(0), numPlayers(1), videoBuf(videoBuf),
+	director(director), frame(0), numPlayers(1), loaded(false),
+	videoBuf(videoBuf), loadViewport(NULL),
 	session(NULL), highObserver(NULL), highConsole(NULL)
 {
 	memset(observers, 0, sizeof(observers[0]) * MAX_OBSERVERS);
@@ -55,30 +58,22 @@ GameScene::GameScene(GameDirector *director, VideoServices::VideoBuffer *videoBu
 	session = new ClientSession();
 	sessionPeer = boost::make_shared<SessionPeer>(scripting, session);
 
-	// Load the selected track
+	// Start loading the selected track; the scene shows the progress until
+	// the track is ready (see FinishLoad()).
 	try {
 		Model::TrackPtr track = Config::GetInstance()->
 			GetTrackBundle()->OpenTrack(rules->GetTrackName());
 		if (track.get() == NULL) throw Parcel::ObjStreamExn("Track does not exist.");
-		if (!session->LoadNew(
+		session->StartLoadNew(
 			rules->GetTrackName().c_str(), track->GetRecordFile(),
-			rules->GetLaps(), rules->GetGameOpts(), videoBuf))
-		{
-			throw Parcel::ObjStreamExn("Track load failed.");
-		}
+			rules->GetLaps(), rules->GetGameOpts());
 	}
 	catch (Parcel::ObjStreamExn&) {
 		Cleanup();
 		throw;
 	}
 
-	session->SetSimulationTime(-6000);
-
-	if (!session->CreateMainCharacter(0)) {
-		Cleanup();
-		throw Exception("Main character creation failed");
-	}
-
+	loadViewport = new VideoServices::Viewport2D();
 	observers[0] = Observer::New();
 	highObserver = new HighObserver();
 
@@ -97,6 +92,7 @@ void GameScene::Cleanup()
 {
 	delete highConsole;
 	delete highObserver;
+	delete loadViewport;
 	delete session;
 	for (int i = 0; i < numPlayers; i++) {
 		if (observers[i] != NULL) {
@@ -105,8 +101,36 @@ void GameScene::Cleanup()
 	}
 }
 
+/**
+ * Start the session once the track has finished loading.
+ * @throws Parcel::ObjStreamExn The track failed to load.
+ * @throws Exception The main character could not be created.
+ */
+void GameScene::FinishLoad()
+{
+	loaded = true;
+
+	if (!session->FinishLoadNew(videoBuf)) {
+		throw Parcel::ObjStreamExn("Track load failed.");
+	}
+
+	session->SetSimulationTime(-6000);
+
+	if (!session->CreateMainCharacter(0)) {
+		throw Exception("Main character creation failed");
+	}
+
+	// The track brought its own background palette.
+	director->AssignPalette();
+}
+
 void GameScene::Advance(Util::OS::timestamp_t tick)
 {
+	if (!loaded) {
+		if (!session->IsLoadDone()) return;
+		FinishLoad();
+	}
+
 	if (highConsole != NULL && highConsole->IsVisible()) {
 		highConsole->Advance(tick);
 	}
@@ -114,8 +138,27 @@ void GameScene::Advance(Util::OS::timestamp_t tick)
 	session->Process();
 }
 
+/// Draw a progress bar while the track is loading.
+void GameScene::RenderLoadProgress()
+{
+	loadViewport->Setup(videoBuf, 0, 0, videoBuf->GetXRes(), videoBuf->GetYRes());
+
+	int xRes = loadViewport->GetXRes();
+	int yRes = loadViewport->GetYRes();
+	int len = xRes / 2;
+	int height = yRes / 40 + 1;
+
+	loadViewport->DrawHorizontalMeter((xRes - len) / 2, len, (yRes - height) / 2, height,
+		static_cast<int>(session->GetLoadProgress() * len), 54, 56);
+}
+
 void GameScene::Render()
 {
+	if (!loaded) {
+		RenderLoadProgress();
+		return;
+	}
+
 	MR_SimulationTime simTime = session->GetSimulationTime();
 
 	for (int i = 0; i < MAX_OBSERVERS; ++i) {
@@ -48,6 +48,9 @@ namespace HoverRace {
 	namespace Script {
 		class Core;
 	}
+	namespace VideoServices {
+		class Viewport2D;
+	}
 }
 
 namespace HoverRace {
@@ -64,6 +67,7 @@ class GameScene : public Scene
 
 	private:
 		void Cleanup();
+		void FinishLoad();
 
 	public:
 		void Advance(Util::OS::timestamp_t tick);
@@ -71,10 +75,16 @@ class GameScene : public Scene
 		void Render();
 
 	private:
+		void RenderLoadProgress();
+
+	private:
+		GameDirector *director;
 		int frame;
 		int numPlayers;
+		bool loaded;
 
 		VideoServices::VideoBuffer *videoBuf;
+		VideoServices::Viewport2D *loadViewport;
 
 		static const int MAX_OBSERVERS = Util::Config::MAX_PLAYERS;
 		Observer *observers[MAX_OBSERVERS];
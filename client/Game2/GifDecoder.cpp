@@ -22,27 +22,189 @@
 
 #include "StdAfx.h"
 
-#include "GifDecoder.h"
-#include "GameApp.h"
-#include "../../engine/Util/OS.h"
-#include "../../engine/Util/Str.h"
-#include "resource.h"
+#include "../../engine/Util/Profiler.h"
 
-#include <olectl.h>
+#include "GifDecoder.h"
 
 using namespace HoverRace::Util;
 
+namespace {
+	/// Largest image (and frame) width or height we agree to decode.
+	const int MAX_SIZE = 2048;
+
+	/// Frame delay used when the GIF asks for (almost) none, like browsers do.
+	const int DEFAULT_DELAY = 100;
+
+	/// Read a little-endian 16-bit value.
+	inline int ReadLe16(const MR_UInt8 *pData)
+	{
+		return pData[0] | (pData[1] << 8);
+	}
+
+	/**
+	 * Skip a chain of data sub-blocks.
+	 * @param pStream The GIF stream.
+	 * @param[in,out] pPos The offset of the first sub-block; set to the
+	 *                     offset after the terminator.
+	 * @return @c false if the stream ended before the terminator.
+	 */
+	bool SkipSubBlocks(const std::vector<MR_UInt8> &pStream, size_t &pPos)
+	{
+		while(pPos < pStream.size()) {
+			int lLen = pStream[pPos++];
+			if(lLen == 0) {
+				return true;
+			}
+			pPos += lLen;
+		}
+		return false;
+	}
+
+	/**
+	 * Decode the LZW-compressed pixels of one frame.
+	 * Corrupt data does not abort the decode; the pixels that could not be
+	 * decoded are left as zero.
+	 * @param pStream The GIF stream.
+	 * @param[in,out] pPos The offset of the LZW minimum code size; set to
+	 *                     the offset after the image data.
+	 * @param[out] pOut The color indices (must be sized to the frame).
+	 */
+	void DecodeLzw(const std::vector<MR_UInt8> &pStream, size_t &pPos, std::vector<MR_UInt8> &pOut)
+	{
+		std::fill(pOut.begin(), pOut.end(), 0);
+
+		int lMinCodeSize = pStream[pPos++];
+
+		// Gather the sub-blocks into one buffer.
+		std::vector<MR_UInt8> lData;
+		while(pPos < pStream.size()) {
+			size_t lLen = pStream[pPos++];
+			if(lLen == 0) {
+				break;
+			}
+			lLen = std::min(lLen, pStream.size() - pPos);
+			lData.insert(lData.end(), pStream.begin() + pPos, pStream.begin() + pPos + lLen);
+			pPos += lLen;
+		}
+
+		if(lMinCodeSize < 2 || lMinCodeSize > 8) {
+			return;
+		}
+
+		MR_UInt16 lPrefix[4096];
+		MR_UInt8 lSuffix[4096];
+		MR_UInt8 lStack[4097];
+
+		const int lClear = 1 << lMinCodeSize;
+		const int lEnd = lClear + 1;
+		for(int lCode = 0; lCode < lClear; lCode++) {
+			lPrefix[lCode] = 0;
+			lSuffix[lCode] = static_cast<MR_UInt8>(lCode);
+		}
+
+		int lCodeSize = lMinCodeSize + 1;
+		int lNext = lClear + 2;
+		int lPrev = -1;
+		MR_UInt8 lFirst = 0;
+
+		size_t lOut = 0;
+		MR_UInt32 lBits = 0;
+		int lNbBits = 0;
+		size_t lIn = 0;
+
+		while(lOut < pOut.size()) {
+			while(lNbBits < lCodeSize && lIn < lData.size()) {
+				lBits |= static_cast<MR_UInt32>(lData[lIn++]) << lNbBits;
+				lNbBits += 8;
+			}
+			if(lNbBits < lCodeSize) {
+				break;
+			}
+
+			int lCode = lBits & ((1 << lCodeSize) - 1);
+			lBits >>= lCodeSize;
+			lNbBits -= lCodeSize;
+
+			if(lCode == lClear) {
+				lCodeSize = lMinCodeSize + 1;
+				lNext = lClear + 2;
+				lPrev = -1;
+				continue;
+			}
+			if(lCode == lEnd) {
+				break;
+			}
+			if(lPrev == -1) {
+				if(lCode >= lClear) {
+					break;
+				}
+				lFirst = lSuffix[lCode];
+				pOut[lOut++] = lFirst;
+				lPrev = lCode;
+				continue;
+			}
+
+			int lThis = lCode;
+			int lTop = 0;
+			if(lCode >= lNext) {
+				if(lCode > lNext) {
+					break;
+				}
+				// The code being defined: previous string + its first char.
+				lStack[lTop++] = lFirst;
+				lCode = lPrev;
+			}
+			while(lCode >= lClear) {
+				lStack[lTop++] = lSuffix[lCode];
+				lCode = lPrefix[lCode];
+			}
+			lFirst = lSuffix[lCode];
+			lStack[lTop++] = lFirst;
+
+			while(lTop > 0 && lOut < pOut.size()) {
+				pOut[lOut++] = lStack[--lTop];
+			}
+
+			if(lNext < 4096) {
+				lPrefix[lNext] = static_cast<MR_UInt16>(lPrev);
+				lSuffix[lNext] = lFirst;
+				lNext++;
+				if(lNext == (1 << lCodeSize) && lCodeSize < 12) {
+					lCodeSize++;
+				}
+			}
+			lPrev = lThis;
+		}
+	}
+
+#	ifdef _DEBUG
+		/// Time from Decode() until the first frame is handed to the UI.
+		ProfilerSampler gFirstFrameSampler("GifDecoder first frame");
+#	endif
+}
+
 namespace HoverRace {
 namespace Client {
 
 GifDecoder::GifDecoder()
 {
+	mFirstBlock = 0;
+	mWidth = 0;
+	mHeight = 0;
 	mNbImages = 0;
+	mBackground = 0;
+	mPaletteSize = 0;
+
 	mGlobalPalette = NULL;
+	mBitmap[0] = mBitmap[1] = NULL;
+	mBits[0] = mBits[1] = NULL;
+	mCurrentBitmap = 0;
+	mFirstFrameShown = false;
 
-	for(int lCounter = 0; lCounter < MR_MAX_IMAGES; lCounter++) {
-		mBitmap[lCounter] = NULL;
-	}
+	mRingHead = 0;
+	mRingCount = 0;
+	mDecodeDone = true;
+	mQuit = false;
 }
 
 GifDecoder::~GifDecoder()
@@ -52,7 +214,23 @@ GifDecoder::~GifDecoder()
 
 void GifDecoder::Clean()
 {
+	// Stop the decoding thread first; it reads the stream and fills the ring.
+	{
+		boost::mutex::scoped_lock lLock(mMutex);
+		mQuit = true;
+	}
+	mRingCond.notify_all();
+	if(mThread.joinable()) {
+		mThread.join();
+	}
+
+	mQuit = false;
+	mDecodeDone = true;
+	mRingHead = 0;
+	mRingCount = 0;
+
 	mNbImages = 0;
+	mStream.clear();
 
 	if(mGlobalPalette != NULL) {
 		UnrealizeObject(mGlobalPalette);
@@ -60,11 +238,11 @@ void GifDecoder::Clean()
 		mGlobalPalette = NULL;
 	}
 
-	for(int lCounter = 0; lCounter < MR_MAX_IMAGES; lCounter++) {
+	for(int lCounter = 0; lCounter < 2; lCounter++) {
 		if(mBitmap[lCounter] != NULL) {
 			DeleteObject(mBitmap[lCounter]);
 			mBitmap[lCounter] = NULL;
-			mDelay[lCounter] = 0;
+			mBits[lCounter] = NULL;
 		}
 	}
 }
@@ -72,8 +250,8 @@ void GifDecoder::Clean()
 /**
  * Load a GIF image.
  * This will replace the currently-loaded image.
- * Animated GIFs are not yet supported -- only the first frame of an
- * animated GIF will be loaded.
+ * Only the header is read here; the frames are decoded in the background
+ * and retrieved with NextFrame().
  * @param pGifStream The GIF data buffer (may not be NULL).
  * @param pStreamLen The length of the buffer.
  * @return @c true if the load succeeded, @c false otherwise (current
@@ -81,35 +259,362 @@ void GifDecoder::Clean()
  */
 bool GifDecoder::Decode(const unsigned char *pGifStream, int pStreamLen)
 {
+	MR_SAMPLE_CONTEXT("GifDecoder::Decode");
+
 	// Delete current image.
 	Clean();
 
-	bool retv = false;
-	HGLOBAL buf = GlobalAlloc(GPTR, pStreamLen);
-	memcpy((void*)buf, pGifStream, pStreamLen);
+	if(pStreamLen <= 0) {
+		return false;
+	}
+
+	mStream.assign(pGifStream, pGifStream + pStreamLen);
+
+	if(!Scan() || !CreateBitmaps()) {
+		Clean();
+		return false;
+	}
+
+#	ifdef _DEBUG
+		gFirstFrameSampler.StartSample();
+#	endif
+	mFirstFrameShown = false;
+	mCurrentBitmap = 0;
 
-	IStream *stream = NULL;
-	IPicture *pic = NULL;
+	mDecodeDone = false;
+	mThread = boost::thread(boost::bind(&GifDecoder::DecodeProc, this));
+
+	return true;
+}
 
-	// We currently don't support animated GIFs, so set big delay for
-	// the first frame.
-	mDelay[0] = 3600000;
+/**
+ * Read the header and check the structure of the stream.
+ * This is cheap: the image data is skipped, not decoded.
+ * @return @c true if the stream is a GIF with at least one frame.
+ */
+bool GifDecoder::Scan()
+{
+	const std::vector<MR_UInt8> &lStream = mStream;
 
-	// Use OleLoadPicture() to convert the GIF stream to an HBITMAP.
-	if (SUCCEEDED(CreateStreamOnHGlobal(buf, false, &stream))) {
-		if (SUCCEEDED(OleLoadPicture(stream, 0, false, IID_IPicture, (void**)&pic))) {
-			HBITMAP hb = NULL;
-			pic->get_Handle((OLE_HANDLE*)&hb);
-			mBitmap[0] = (HBITMAP)CopyImage(hb, IMAGE_BITMAP, 0, 0, LR_COPYRETURNORG);
-			retv = true;
+	if(lStream.size() < 13 ||
+		(memcmp(&lStream[0], "GIF87a", 6) != 0 && memcmp(&lStream[0], "GIF89a", 6) != 0))
+	{
+		return false;
+	}
+
+	mWidth = ReadLe16(&lStream[6]);
+	mHeight = ReadLe16(&lStream[8]);
+	int lFlags = lStream[10];
+	mBackground = lStream[11];
+
+	if(mWidth <= 0 || mHeight <= 0 || mWidth > MAX_SIZE || mHeight > MAX_SIZE) {
+		return false;
+	}
+
+	size_t lPos = 13;
+	mPaletteSize = 0;
+
+	if(lFlags & 0x80) {
+		mPaletteSize = 2 << (lFlags & 7);
+		if(lPos + mPaletteSize * 3 > lStream.size()) {
+			return false;
 		}
+		memcpy(mPalette, &lStream[lPos], mPaletteSize * 3);
+		lPos += mPaletteSize * 3;
 	}
+	mFirstBlock = lPos;
+
+	while(lPos < lStream.size()) {
+		MR_UInt8 lBlock = lStream[lPos++];
+
+		if(lBlock == 0x21) {
+			// Extension
+			lPos++;
+			if(!SkipSubBlocks(lStream, lPos)) {
+				break;
+			}
+		}
+		else if(lBlock == 0x2C) {
+			// Image descriptor
+			if(lPos + 9 > lStream.size()) {
+				break;
+			}
+			int lImageFlags = lStream[lPos + 8];
+			if(ReadLe16(&lStream[lPos + 4]) > MAX_SIZE || ReadLe16(&lStream[lPos + 6]) > MAX_SIZE) {
+				break;
+			}
+			lPos += 9;
 
-	if (pic != NULL) pic->Release();
-	if (stream != NULL) stream->Release();
-	GlobalFree(buf);
+			if(lImageFlags & 0x80) {
+				int lLocalSize = 2 << (lImageFlags & 7);
+				if(lPos + lLocalSize * 3 > lStream.size()) {
+					break;
+				}
 
-	return retv;
+				// No global color table; the first local one will do.
+				if(mPaletteSize == 0) {
+					mPaletteSize = lLocalSize;
+					memcpy(mPalette, &lStream[lPos], mPaletteSize * 3);
+				}
+				lPos += lLocalSize * 3;
+			}
+
+			lPos++;								  // LZW minimum code size
+			if(!SkipSubBlocks(lStream, lPos)) {
+				break;
+			}
+			mNbImages++;
+		}
+		else {
+			// Trailer (or trailing garbage)
+			break;
+		}
+	}
+
+	if(mPaletteSize == 0) {
+		// No color table at all; use shades of gray.
+		mPaletteSize = 256;
+		for(int lCounter = 0; lCounter < 256; lCounter++) {
+			mPalette[lCounter][0] = mPalette[lCounter][1] = mPalette[lCounter][2] =
+				static_cast<MR_UInt8>(lCounter);
+		}
+	}
+	if(mBackground >= mPaletteSize) {
+		mBackground = 0;
+	}
+
+	return (mNbImages > 0);
+}
+
+/// Create the palette and the bitmaps that frames are copied into.
+bool GifDecoder::CreateBitmaps()
+{
+	struct {
+		WORD palVersion;
+		WORD palNumEntries;
+		PALETTEENTRY palPalEntry[256];
+	} lLogPalette;
+
+	struct {
+		BITMAPINFOHEADER bmiHeader;
+		RGBQUAD bmiColors[256];
+	} lInfo;
+
+	lLogPalette.palVersion = 0x300;
+	lLogPalette.palNumEntries = static_cast<WORD>(mPaletteSize);
+
+	memset(&lInfo, 0, sizeof(lInfo));
+	lInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	lInfo.bmiHeader.biWidth = mWidth;
+	lInfo.bmiHeader.biHeight = -mHeight;		  // Top-down
+	lInfo.bmiHeader.biPlanes = 1;
+	lInfo.bmiHeader.biBitCount = 8;
+	lInfo.bmiHeader.biCompression = BI_RGB;
+	lInfo.bmiHeader.biClrUsed = mPaletteSize;
+
+	for(int lCounter = 0; lCounter < mPaletteSize; lCounter++) {
+		lLogPalette.palPalEntry[lCounter].peRed = mPalette[lCounter][0];
+		lLogPalette.palPalEntry[lCounter].peGreen = mPalette[lCounter][1];
+		lLogPalette.palPalEntry[lCounter].peBlue = mPalette[lCounter][2];
+		lLogPalette.palPalEntry[lCounter].peFlags = 0;
+
+		lInfo.bmiColors[lCounter].rgbRed = mPalette[lCounter][0];
+		lInfo.bmiColors[lCounter].rgbGreen = mPalette[lCounter][1];
+		lInfo.bmiColors[lCounter].rgbBlue = mPalette[lCounter][2];
+	}
+
+	mGlobalPalette = CreatePalette(reinterpret_cast<LOGPALETTE*>(&lLogPalette));
+
+	for(int lCounter = 0; lCounter < 2; lCounter++) {
+		void *lBits = NULL;
+		mBitmap[lCounter] = CreateDIBSection(NULL, reinterpret_cast<BITMAPINFO*>(&lInfo),
+			DIB_RGB_COLORS, &lBits, NULL, 0);
+		mBits[lCounter] = static_cast<MR_UInt8*>(lBits);
+
+		if(mBitmap[lCounter] == NULL) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Decoding thread.
+ * Composites each frame onto the canvas (handling transparency and the
+ * disposal methods), converts it to the global palette and queues it.
+ */
+void GifDecoder::DecodeProc()
+{
+	const std::vector<MR_UInt8> &lStream = mStream;
+
+	std::vector<MR_UInt8> lCanvas(mWidth * mHeight);
+	std::vector<MR_UInt8> lSaved;
+	std::vector<MR_UInt8> lIndices;
+
+	for(;;) {
+		std::fill(lCanvas.begin(), lCanvas.end(), mBackground);
+
+		// Scan() checked the structure of the first mNbImages frames only.
+		int lFrame = 0;
+
+		int lDelay = 0;
+		int lDisposal = 0;
+		int lTransparent = -1;
+
+		size_t lPos = mFirstBlock;
+		while(lPos < lStream.size()) {
+			MR_UInt8 lBlock = lStream[lPos++];
+
+			if(lBlock == 0x21) {
+				if(lPos >= lStream.size()) {
+					break;
+				}
+				MR_UInt8 lLabel = lStream[lPos++];
+
+				// Graphic control extension
+				if(lLabel == 0xF9 && lPos + 5 <= lStream.size() && lStream[lPos] >= 4) {
+					int lFlags = lStream[lPos + 1];
+					lDisposal = (lFlags >> 2) & 7;
+					lDelay = ReadLe16(&lStream[lPos + 2]) * 10;
+					lTransparent = (lFlags & 1) ? lStream[lPos + 4] : -1;
+				}
+				SkipSubBlocks(lStream, lPos);
+			}
+			else if(lBlock == 0x2C && lFrame++ < mNbImages) {
+				const MR_UInt8 *lDesc = &lStream[lPos];
+				int lLeft = ReadLe16(lDesc);
+				int lTop = ReadLe16(lDesc + 2);
+				int lFrameWidth = ReadLe16(lDesc + 4);
+				int lFrameHeight = ReadLe16(lDesc + 6);
+				int lFlags = lDesc[8];
+				lPos += 9;
+
+				// Map the frame's colors to the global palette.
+				MR_UInt8 lMap[256];
+				int lNbColors = mPaletteSize;
+				for(int lCounter = 0; lCounter < 256; lCounter++) {
+					lMap[lCounter] = static_cast<MR_UInt8>((lCounter < mPaletteSize) ? lCounter : 0);
+				}
+				if(lFlags & 0x80) {
+					lNbColors = 2 << (lFlags & 7);
+					for(int lCounter = 0; lCounter < lNbColors; lCounter++) {
+						const MR_UInt8 *lColor = &lStream[lPos + lCounter * 3];
+						int lBest = 0;
+						int lBestDist = 3 * 256 * 256;
+						for(int lEntry = 0; lEntry < mPaletteSize && lBestDist > 0; lEntry++) {
+							int lDr = lColor[0] - mPalette[lEntry][0];
+							int lDg = lColor[1] - mPalette[lEntry][1];
+							int lDb = lColor[2] - mPalette[lEntry][2];
+							int lDist = lDr * lDr + lDg * lDg + lDb * lDb;
+							if(lDist < lBestDist) {
+								lBest = lEntry;
+								lBestDist = lDist;
+							}
+						}
+						lMap[lCounter] = static_cast<MR_UInt8>(lBest);
+					}
+					lPos += lNbColors * 3;
+				}
+
+				lIndices.resize(lFrameWidth * lFrameHeight);
+				DecodeLzw(lStream, lPos, lIndices);
+
+				if(lDisposal == 3) {
+					lSaved = lCanvas;
+				}
+
+				// Draw the frame, de-interlacing the rows if necessary.
+				static const int lPassStart[] = { 0, 4, 2, 1 };
+				static const int lPassStep[] = { 8, 8, 4, 2 };
+				int lPass = 0;
+				int lNextY = 0;
+				for(int lRow = 0; lRow < lFrameHeight; lRow++) {
+					int lY = lRow;
+					if(lFlags & 0x40) {
+						lY = lNextY;
+						lNextY += lPassStep[lPass];
+						while(lNextY >= lFrameHeight && lPass < 3) {
+							lNextY = lPassStart[++lPass];
+						}
+					}
+
+					int lCanvasY = lTop + lY;
+					if(lCanvasY < mHeight) {
+						const MR_UInt8 *lSrc = &lIndices[lRow * lFrameWidth];
+						MR_UInt8 *lDest = &lCanvas[lCanvasY * mWidth];
+						for(int lX = 0; lX < lFrameWidth && lLeft + lX < mWidth; lX++) {
+							if(lSrc[lX] != lTransparent) {
+								lDest[lLeft + lX] = lMap[lSrc[lX]];
+							}
+						}
+					}
+				}
+
+				// A still image is shown once; animations need a sane delay.
+				int lFrameDelay = 0;
+				if(mNbImages > 1) {
+					lFrameDelay = (lDelay <= 10) ? DEFAULT_DELAY : lDelay;
+				}
+				if(!PushFrame(lCanvas, lFrameDelay)) {
+					return;
+				}
+
+				if(lDisposal == 2) {
+					for(int lY = lTop; lY < lTop + lFrameHeight && lY < mHeight; lY++) {
+						for(int lX = lLeft; lX < lLeft + lFrameWidth && lX < mWidth; lX++) {
+							lCanvas[lY * mWidth + lX] = mBackground;
+						}
+					}
+				}
+				else if(lDisposal == 3 && !lSaved.empty()) {
+					lCanvas.swap(lSaved);
+				}
+
+				lDelay = 0;
+				lDisposal = 0;
+				lTransparent = -1;
+			}
+			else {
+				break;
+			}
+		}
+
+		if(mNbImages <= 1) {
+			break;
+		}
+	}
+
+	boost::mutex::scoped_lock lLock(mMutex);
+	mDecodeDone = true;
+}
+
+/**
+ * Add a frame to the ring, waiting for a free slot.
+ * @param pCanvas The frame.
+ * @param pDelay The delay (in ms) before the next frame.
+ * @return @c false if decoding should stop.
+ */
+bool GifDecoder::PushFrame(const std::vector<MR_UInt8> &pCanvas, int pDelay)
+{
+	int lSlot;
+	{
+		boost::mutex::scoped_lock lLock(mMutex);
+		while(!mQuit && mRingCount == eRingSize) {
+			mRingCond.wait(lLock);
+		}
+		if(mQuit) {
+			return false;
+		}
+		lSlot = (mRingHead + mRingCount) % eRingSize;
+	}
+
+	// The UI thread does not touch a slot until it is counted.
+	mRing[lSlot].mPixels = pCanvas;
+	mRing[lSlot].mDelay = pDelay;
+
+	boost::mutex::scoped_lock lLock(mMutex);
+	mRingCount++;
+	return true;
 }
 
 HPALETTE GifDecoder::GetGlobalPalette() const
@@ -119,7 +624,7 @@ HPALETTE GifDecoder::GetGlobalPalette() const
 
 /**
  * Retrieve the number of frames in the current image.
- * @return Either zero (no image loaded) or one.
+ * @return The frame count (zero if no image is loaded).
  */
 int GifDecoder::GetImageCount() const
 {
@@ -127,24 +632,61 @@ int GifDecoder::GetImageCount() const
 }
 
 /**
- * Retrieve a frame from the current image.
- * @param pImage The frame index (zero is the first frame).
- * @return The bitmap data, or NULL if no frame at that index.
+ * Retrieve the next decoded frame, if it is ready.
+ * The returned bitmap belongs to the decoder and stays valid until the
+ * frame after next is retrieved (or the image is replaced).
+ * @param[out] pBitmap The frame.
+ * @param[out] pDelay The amount of time (in ms) to display the frame
+ *                    before the next one; zero if it is the last one.
+ * @return @c true if a frame was retrieved, @c false if none is ready yet.
  */
-HBITMAP GifDecoder::GetImage(int pImage) const
+bool GifDecoder::NextFrame(HBITMAP &pBitmap, int &pDelay)
 {
-	return mBitmap[pImage];
+	MR_SAMPLE_CONTEXT("GifDecoder::NextFrame");
+
+	boost::mutex::scoped_lock lLock(mMutex);
+
+	if(mRingCount == 0) {
+		return false;
+	}
+
+	const Frame &lFrame = mRing[mRingHead];
+	int lStride = (mWidth + 3) & ~3;
+	MR_UInt8 *lDest = mBits[mCurrentBitmap];
+
+	GdiFlush();
+	for(int lY = 0; lY < mHeight; lY++) {
+		memcpy(lDest + lY * lStride, &lFrame.mPixels[lY * mWidth], mWidth);
+	}
+
+	pBitmap = mBitmap[mCurrentBitmap];
+	pDelay = lFrame.mDelay;
+
+	mCurrentBitmap ^= 1;
+	mRingHead = (mRingHead + 1) % eRingSize;
+	mRingCount--;
+	lLock.unlock();
+	mRingCond.notify_all();
+
+	if(!mFirstFrameShown) {
+		mFirstFrameShown = true;
+#		ifdef _DEBUG
+			gFirstFrameSampler.EndSample();
+#		endif
+	}
+
+	return true;
 }
 
 /**
- * Retrieve the amount of time to display the frame before
- * the next frame should be displayed.
- * @param pImage The frame index (zero is the first frame).
- * @return The delay (in ms) (never negative).
+ * Check if more frames can still be retrieved with NextFrame().
+ * @return @c false once the image has been fully decoded and every frame
+ *         has been retrieved (or no image is loaded).
  */
-int GifDecoder::GetDelay(int pImage) const
+bool GifDecoder::HasMoreFrames()
 {
-	return mDelay[pImage];
+	boost::mutex::scoped_lock lLock(mMutex);
+	return !mDecodeDone || mRingCount > 0;
 }
 
 }  // namespace Client
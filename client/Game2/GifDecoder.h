@@ -22,22 +22,67 @@
 
 #pragma once
 
-#define MR_MAX_IMAGES  32
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../../engine/Util/MR_Types.h"
 
 namespace HoverRace {
 namespace Client {
 
-/// GIF image loader.
+/**
+ * GIF image loader.
+ *
+ * Frames are decoded on a background thread into a small ring of 8-bit
+ * buffers that already use the image's global palette; the UI thread only
+ * copies a ready frame into a bitmap.  Animated GIFs loop until the image
+ * is replaced.
+ */
 class GifDecoder
 {
 	private:
+		enum { eRingSize = 4 };
+
+		struct Frame
+		{
+			std::vector<MR_UInt8> mPixels;
+			int mDelay;
+		};
+
+		// Header information (read-only once decoding starts)
+		std::vector<MR_UInt8> mStream;
+		size_t mFirstBlock;
+		int mWidth;
+		int mHeight;
 		int mNbImages;
+		MR_UInt8 mBackground;
+		MR_UInt8 mPalette[256][3];
+		int mPaletteSize;
 
+		// UI thread
 		HPALETTE mGlobalPalette;
-		HBITMAP mBitmap[MR_MAX_IMAGES];
-		int mDelay[MR_MAX_IMAGES];
+		HBITMAP mBitmap[2];
+		MR_UInt8 *mBits[2];
+		int mCurrentBitmap;
+		bool mFirstFrameShown;
+
+		// Shared with the decoding thread
+		Frame mRing[eRingSize];
+		int mRingHead;
+		int mRingCount;
+		bool mDecodeDone;
+		bool mQuit;
+		boost::mutex mMutex;
+		boost::condition_variable mRingCond;
+		boost::thread mThread;
 
 		void Clean();
+		bool Scan();
+		bool CreateBitmaps();
+
+		void DecodeProc();
+		bool PushFrame(const std::vector<MR_UInt8> &pCanvas, int pDelay);
 
 	public:
 		GifDecoder();
@@ -47,8 +92,9 @@ class GifDecoder
 
 		HPALETTE GetGlobalPalette() const;
 		int GetImageCount() const;
-		HBITMAP GetImage(int pImage) const;
-		int GetDelay(int pImage) const;
+
+		bool NextFrame(HBITMAP &pBitmap, int &pDelay);
+		bool HasMoreFrames();
 
 };
 
@@ -26,6 +26,7 @@
 
 #include "ConfigPeer.h"
 #include "GamePeer.h"
+#include "PerfPeer.h"
 #include "SessionPeer.h"
 
 #include "ClientScriptCore.h"
@@ -50,6 +51,7 @@ Script::Core *ClientScriptCore::Reset()
 
 		ConfigPeer::Register(this);
 		GamePeer::Register(this);
+		PerfPeer::Register(this);
 		SessionPeer::Register(this);
 
 		classesRegistered = true;
@@ -32,6 +32,7 @@
 #include "../GameDirector.h"
 #include "../Rulebook.h"
 #include "ConfigPeer.h"
+#include "PerfPeer.h"
 #include "SessionPeer.h"
 
 #include "GamePeer.h"
@@ -44,13 +45,16 @@ namespace HoverScript {
 
 GamePeer::GamePeer(Script::Core *scripting, GameDirector *gameDirector) :
 	SUPER(scripting, "Game"), gameDirector(gameDirector), initialized(false),
-	onInit(scripting), onShutdown(scripting),
-	onSessionStart(scripting), onSessionEnd(scripting)
+	onInit(scripting, "on_init"), onShutdown(scripting, "on_shutdown"),
+	onSessionStart(scripting, "on_session_begin"),
+	onSessionEnd(scripting, "on_session_end")
 {
+	perfPeer = new PerfPeer(scripting);
 }
 
 GamePeer::~GamePeer()
 {
+	delete perfPeer;
 }
 
 /**
@@ -109,6 +113,8 @@ void GamePeer::OnShutdown()
  */
 void GamePeer::OnSessionStart(SessionPeerPtr sessionPeer)
 {
+	perfPeer->SetSession(sessionPeer->GetSession());
+
 	luabind::object sessionObj(GetScripting()->GetState(), sessionPeer);
 	onSessionStart.CallHandlers(sessionObj);
 }
@@ -123,6 +129,8 @@ void GamePeer::OnSessionEnd(SessionPeerPtr sessionPeer)
 {
 	luabind::object sessionObj(GetScripting()->GetState(), sessionPeer);
 	onSessionEnd.CallHandlers(sessionObj);
+
+	perfPeer->SetSession(NULL);
 }
 
 /**
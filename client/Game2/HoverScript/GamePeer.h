@@ -32,6 +32,7 @@ namespace HoverRace {
 	namespace Client {
 		namespace HoverScript {
 			class ConfigPeer;
+			class PerfPeer;
 			class SessionPeer;
 			typedef boost::shared_ptr<SessionPeer> SessionPeerPtr;
 		}
@@ -69,6 +70,8 @@ class GamePeer : public Script::Peer {
 
 		RulebookPtr RequestedNewSession();
 
+		PerfPeer *GetPerfPeer() const { return perfPeer; }
+
 	protected:
 		void VerifyInitialized() const;
 
@@ -103,6 +106,7 @@ class GamePeer : public Script::Peer {
 		Script::Handlers onSessionStart;
 		Script::Handlers onSessionEnd;
 		RulebookPtr deferredStart;
+		PerfPeer *perfPeer;
 };
 
 }  // namespace HoverScript
@@ -40,6 +40,7 @@
 #include "../Control/InputHandler.h"
 #include "../GameDirector.h"
 #include "GamePeer.h"
+#include "PerfPeer.h"
 #include "SessionPeer.h"
 
 #include "HighConsole.h"
@@ -194,6 +195,7 @@ void HighConsole::InitEnv()
 
 	object env(from_stack(L, -1));
 	env["game"] = gamePeer;
+	env["perf"] = gamePeer->GetPerfPeer();
 	env["session"] = sessionPeer;
 }
 
@@ -0,0 +1,250 @@
+
+// PerfPeer.cpp
+// Scripting peer for performance counters.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <lua.hpp>
+
+#include "../../../engine/Script/Core.h"
+#include "../../../engine/Util/Profiler.h"
+#include "../../../engine/VideoServices/SoundMixer.h"
+#include "../../../engine/VideoServices/SoundServer.h"
+#include "../ClientSession.h"
+
+#include "PerfPeer.h"
+
+using namespace HoverRace::Util;
+using HoverRace::VideoServices::SoundMixer;
+
+namespace HoverRace {
+namespace Client {
+namespace HoverScript {
+
+PerfPeer::PerfPeer(Script::Core *scripting) :
+	SUPER(scripting, "Perf"), session(NULL)
+{
+}
+
+PerfPeer::~PerfPeer()
+{
+}
+
+/**
+ * Register this peer in an environment.
+ */
+void PerfPeer::Register(Script::Core *scripting)
+{
+	using namespace luabind;
+	lua_State *L = scripting->GetState();
+
+	module(L) [
+		class_<PerfPeer,SUPER>("Perf")
+			.def("get_fps", &PerfPeer::LGetFps)
+			.def("get_frame_time", &PerfPeer::LGetFrameTime)
+			.def("get_sim_slices", &PerfPeer::LGetSimSlices)
+			.def("get_net_queue", &PerfPeer::LGetNetQueue)
+			.def("get_profiler", &PerfPeer::LGetProfiler)
+			.def("get_script_stats", &PerfPeer::LGetScriptStats)
+			.def("reset_script_stats", &PerfPeer::LResetScriptStats)
+			.def("get_sound", &PerfPeer::LGetSound)
+			.def("get_budget", &PerfPeer::LGetBudget)
+			.def("set_budget", &PerfPeer::LSetBudget)
+			.def("set_budget", &PerfPeer::LSetBudget_M)
+	];
+}
+
+/**
+ * Attach the counters to a session.
+ * @param session The current session (may be @c NULL when the session ends).
+ */
+void PerfPeer::SetSession(ClientSession *session)
+{
+	this->session = session;
+}
+
+double PerfPeer::LGetFps() const
+{
+	// function get_fps()
+	// Returns the framerate, updated about once per second.
+	// Returns zero when there is no session.
+	return (session == NULL) ? 0.0 : session->GetCurrentFramerate();
+}
+
+int PerfPeer::LGetFrameTime() const
+{
+	// function get_frame_time()
+	// Returns the time between the last two frames, in milliseconds.
+	return (session == NULL) ? 0 : (int)session->GetLastFrameTime();
+}
+
+luabind::object PerfPeer::LGetSimSlices() const
+{
+	// function get_sim_slices()
+	// Returns a table with the number of simulation slices run:
+	//   last - In the last frame.
+	//   total - Since the session started.
+	lua_State *L = GetScripting()->GetState();
+	luabind::object retv = luabind::newtable(L);
+	retv["last"] = (session == NULL) ? 0 : session->GetLastSliceCount();
+	retv["total"] = (session == NULL) ? 0 : session->GetTotalSliceCount();
+	return retv;
+}
+
+luabind::object PerfPeer::LGetNetQueue() const
+{
+	// function get_net_queue()
+	// Returns a table with the outgoing network traffic that is still waiting:
+	//   bytes - Bytes queued on the stream connections.
+	//   reliable - Reliable messages not yet acknowledged.
+	int bytes = 0;
+	int reliable = 0;
+	if (session != NULL) {
+		session->GetNetQueueDepth(bytes, reliable);
+	}
+
+	lua_State *L = GetScripting()->GetState();
+	luabind::object retv = luabind::newtable(L);
+	retv["bytes"] = bytes;
+	retv["reliable"] = reliable;
+	return retv;
+}
+
+luabind::object PerfPeer::LGetProfiler() const
+{
+	// function get_profiler()
+	// Returns a table of the profiler samplers, keyed by name.  Each entry
+	// has "calls", "total", "min" and "max" (times are in ms).
+	// The table is empty unless this is a debug build.
+	std::vector<ProfilerSample> samples;
+	GetProfilerSamples(samples);
+
+	lua_State *L = GetScripting()->GetState();
+	luabind::object retv = luabind::newtable(L);
+	for (std::vector<ProfilerSample>::const_iterator iter = samples.begin();
+		iter != samples.end(); ++iter)
+	{
+		luabind::object entry = luabind::newtable(L);
+		entry["calls"] = iter->calls;
+		entry["total"] = iter->totalTime;
+		entry["min"] = iter->minTime;
+		entry["max"] = iter->maxTime;
+		retv[iter->name] = entry;
+	}
+	return retv;
+}
+
+luabind::object PerfPeer::LGetScriptStats() const
+{
+	// function get_script_stats()
+	// Returns a table of the script callbacks that have run, keyed by name.
+	// Each entry has "calls", "over_budget", "total" and "max" (times are
+	// in ms).
+	Script::Core *scripting = GetScripting();
+	const Script::Core::callStats_t &stats = scripting->GetCallStats();
+
+	lua_State *L = scripting->GetState();
+	luabind::object retv = luabind::newtable(L);
+	for (Script::Core::callStats_t::const_iterator iter = stats.begin();
+		iter != stats.end(); ++iter)
+	{
+		luabind::object entry = luabind::newtable(L);
+		entry["calls"] = iter->second.calls;
+		entry["over_budget"] = iter->second.overBudget;
+		entry["total"] = (int)iter->second.totalTime;
+		entry["max"] = (int)iter->second.maxTime;
+		retv[iter->first] = entry;
+	}
+	return retv;
+}
+
+void PerfPeer::LResetScriptStats()
+{
+	// function reset_script_stats()
+	// Clears the script callback stats.
+	GetScripting()->ResetCallStats();
+}
+
+luabind::object PerfPeer::LGetSound() const
+{
+	// function get_sound()
+	// Returns a table with the sound mixer counters, or nil if the software
+	// mixer is not in use:
+	//   voices - Voices mixed in the last block.
+	//   virtual_voices - Voices skipped in the last block.
+	//   blocks - Blocks mixed so far.
+	//   mix_time - Total time spent mixing, in ms.
+	lua_State *L = GetScripting()->GetState();
+
+	SoundMixer *mixer = VideoServices::SoundServer::GetMixer();
+	if (mixer == NULL) {
+		return luabind::object();
+	}
+
+	SoundMixer::Stats stats = mixer->GetStats();
+	luabind::object retv = luabind::newtable(L);
+	retv["voices"] = stats.realVoices;
+	retv["virtual_voices"] = stats.virtualVoices;
+	retv["blocks"] = (double)stats.blocks;
+	retv["mix_time"] = stats.mixUsec / 1000.0;
+	return retv;
+}
+
+int PerfPeer::LGetBudget() const
+{
+	// function get_budget()
+	// Returns the instruction budget for each script callback (0 means
+	// unlimited).
+	return GetScripting()->GetCallBudget();
+}
+
+void PerfPeer::LSetBudget(int instructions)
+{
+	// function set_budget(instructions)
+	// Sets the instruction budget for each script callback, keeping the
+	// current over-budget action.
+	//   instructions - Maximum Lua instructions per callback (0 for unlimited).
+	Script::Core *scripting = GetScripting();
+	scripting->SetCallBudget(instructions, scripting->IsCallBudgetAbort());
+}
+
+void PerfPeer::LSetBudget_M(int instructions, const std::string &mode)
+{
+	// function set_budget(instructions, mode)
+	// Sets the instruction budget for each script callback.
+	//   instructions - Maximum Lua instructions per callback (0 for unlimited).
+	//   mode - "abort" to stop callbacks that go over budget with an error,
+	//          "log" to let them finish and print a warning.
+	Script::Core *scripting = GetScripting();
+	if (mode == "abort") {
+		scripting->SetCallBudget(instructions, true);
+	}
+	else if (mode == "log") {
+		scripting->SetCallBudget(instructions, false);
+	}
+	else {
+		luaL_error(scripting->GetState(), "Expected \"abort\" or \"log\" as second parameter.");
+	}
+}
+
+}  // namespace HoverScript
+}  // namespace Client
+}  // namespace HoverRace
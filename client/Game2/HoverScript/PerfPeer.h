@@ -0,0 +1,79 @@
+
+// PerfPeer.h
+// Scripting peer for performance counters.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <luabind/luabind.hpp>
+#include <luabind/object.hpp>
+
+#include "../../../engine/Script/Peer.h"
+
+namespace HoverRace {
+	namespace Client {
+		class ClientSession;
+	}
+	namespace Script {
+		class Core;
+	}
+}
+
+namespace HoverRace {
+namespace Client {
+namespace HoverScript {
+
+/**
+ * Scripting peer for reading the performance counters and setting the
+ * script callback budget.
+ */
+class PerfPeer : public Script::Peer {
+	typedef Script::Peer SUPER;
+	public:
+		PerfPeer(Script::Core *scripting);
+		virtual ~PerfPeer();
+
+	public:
+		static void Register(Script::Core *scripting);
+
+	public:
+		void SetSession(ClientSession *session);
+
+	public:
+		double LGetFps() const;
+		int LGetFrameTime() const;
+		luabind::object LGetSimSlices() const;
+		luabind::object LGetNetQueue() const;
+		luabind::object LGetProfiler() const;
+		luabind::object LGetScriptStats() const;
+		void LResetScriptStats();
+		luabind::object LGetSound() const;
+
+		int LGetBudget() const;
+		void LSetBudget(int instructions);
+		void LSetBudget_M(int instructions, const std::string &mode);
+
+	private:
+		ClientSession *session;
+};
+
+}  // namespace HoverScript
+}  // namespace Client
+}  // namespace HoverRace
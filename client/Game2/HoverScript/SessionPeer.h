@@ -54,6 +54,7 @@ class SessionPeer : public Script::Peer {
 		static void Register(Script::Core *scripting);
 
 	public:
+		ClientSession *GetSession() const { return session; }
 		void OnSessionEnd();
 
 	protected:
@@ -34,6 +34,7 @@
 #include "../../../engine/Util/Str.h"
 
 #include "GamePeer.h"
+#include "PerfPeer.h"
 
 #include "SysEnv.h"
 
@@ -101,6 +102,7 @@ void SysEnv::InitEnv()
 
 	object env(from_stack(L, -1));
 	env["game"] = gamePeer;
+	env["perf"] = gamePeer->GetPerfPeer();
 }
 
 void SysEnv::LogInfo(const std::string &s)
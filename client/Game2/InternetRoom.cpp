@@ -36,6 +36,7 @@
 #include "CheckUpdateServerDialog.h"
 #include "Rulebook.h"
 #include "TrackDownloadDialog.h"
+#include "TrackLoadDialog.h"
 #include "resource.h"
 
 #define MRM_DNS_ANSWER        (WM_USER + 1)
@@ -47,6 +48,7 @@
 
 #define REFRESH_DELAY        200
 #define REFRESH_TIMEOUT    11000
+#define REFRESH_LONG_POLL     25			  // Max seconds we let the server hold a refresh
 #define OP_TIMEOUT         22000
 #define FAST_OP_TIMEOUT     6000
 #define CHAT_TIMEOUT       18000
@@ -61,6 +63,8 @@
 #define LOAD_BANNER_TIMEOUT_EVENT     8
 #define ANIM_BANNER_TIMEOUT_EVENT     9
 
+#define BANNER_POLL_DELAY            15			  // Check for a decoded banner frame (ms)
+
 #define MR_IR_LIST_PORT 80
 
 // #endif
@@ -89,6 +93,7 @@ static int GetLineLen(const char *pSrc);
 static const char *GetNextLine(const char *pSrc);
 
 static int FindFocusItem(HWND pWindow);
+static void UpdateListItem(HWND pList, int pEntry, BOOL pValid, const char *pText);
 
 // InternetRequest
 
@@ -287,10 +292,12 @@ InternetRoom::InternetRoom(const std::string &pMainServer, bool mustCheckUpdates
 
 	for(lCounter = 0; lCounter < eMaxClient; lCounter++) {
 		mClientList[lCounter].mValid = FALSE;
+		mClientList[lCounter].mModified = FALSE;
 	}
 
 	for(lCounter = 0; lCounter < eMaxGame; lCounter++) {
 		mGameList[lCounter].mValid = FALSE;
+		mGameList[lCounter].mModified = FALSE;
 	}
 
 	mCurrentLocateRequest = NULL;
@@ -304,8 +311,9 @@ InternetRoom::InternetRoom(const std::string &pMainServer, bool mustCheckUpdates
 		ASSERT(FALSE);
 	}
 
+	mLastRefreshTimeStamp = 0;
+	mLongPollWait = 0;
 	mNbSuccessiveRefreshTimeOut = 0;
-	mCurrentBannerIndex = 0;
 
 }
 
@@ -333,6 +341,19 @@ int InternetRoom::ParseState(const char *pAnswer)
 		if(!strncmp(lLinePtr, "TIME_STAMP", 10)) {
 			sscanf(lLinePtr, "TIME_STAMP %d", &mLastRefreshTimeStamp);
 		}
+		else if(!strncmp(lLinePtr, "LONG_POLL", 9)) {
+			// The server will hold our next refresh until something changes
+			int lWait = 0;
+
+			sscanf(lLinePtr, "LONG_POLL %d", &lWait);
+			if(lWait < 0) {
+				lWait = 0;
+			}
+			else if(lWait > REFRESH_LONG_POLL) {
+				lWait = REFRESH_LONG_POLL;
+			}
+			mLongPollWait = lWait;
+		}
 		else if(!strncmp(lLinePtr, "USER", 4)) {
 			int lEntry;
 			char lOp[10];
@@ -342,6 +363,7 @@ int InternetRoom::ParseState(const char *pAnswer)
 					if(!strcmp(lOp, "DEL")) {
 						lReturnValue |= eUsersModified;
 						mClientList[lEntry].mValid = FALSE;
+						mClientList[lEntry].mModified = TRUE;
 					}
 					else if(!strcmp(lOp, "NEW")) {
 						lLinePtr = GetNextLine(lLinePtr);
@@ -355,6 +377,7 @@ int InternetRoom::ParseState(const char *pAnswer)
 							sscanf(GetLine(lLinePtr).c_str(), "%d-%d", &mClientList[lEntry].mMajorID, &mClientList[lEntry].mMinorID);
 
 							mClientList[lEntry].mValid = TRUE;
+							mClientList[lEntry].mModified = TRUE;
 							mClientList[lEntry].mGame = -1;
 
 							lLinePtr = GetNextLine(lLinePtr);
@@ -375,6 +398,7 @@ int InternetRoom::ParseState(const char *pAnswer)
 					if(!strcmp(lOp, "DEL")) {
 						lReturnValue |= eGamesModified;
 						mGameList[lEntry].mValid = FALSE;
+						mGameList[lEntry].mModified = TRUE;
 					}
 					else if(!strcmp(lOp, "NEW")) {
 						lLinePtr = GetNextLine(lLinePtr);
@@ -383,6 +407,7 @@ int InternetRoom::ParseState(const char *pAnswer)
 							lReturnValue |= eGamesModified;
 
 							mGameList[lEntry].mValid = TRUE;
+							mGameList[lEntry].mModified = TRUE;
 							mGameList[lEntry].mId = lId;
 							mGameList[lEntry].mNbClient = 0;
 							mGameList[lEntry].mNbLap = 1;
@@ -924,6 +949,8 @@ void InternetRoom::RefreshGameList(HWND pWindow)
 	
 			
 		//	MessageBox(0, "GL", "MessageBox caption", MB_OK);
+			mGameList[lCounter].mModified = FALSE;
+
 			if(mGameList[lCounter].mValid) {
 				LV_ITEM lItem;
 
@@ -960,14 +987,11 @@ void InternetRoom::RefreshUserList(HWND pWindow)
 		// Refill
 		int lIndex = 0;
 		for(int lCounter = 0; lCounter < eMaxClient; lCounter++) {
+			mClientList[lCounter].mModified = FALSE;
+
 			if(mClientList[lCounter].mValid) {
-				std::string &lName = mClientList[lCounter].mName;
+				std::string lName = GetUserDisplayName(lCounter);
 
-				if(mClientList[lCounter].mMajorID != -1) {
-					lName += boost::str(boost::format("[%d-%d]") %
-						mClientList[lCounter].mMajorID %
-						mClientList[lCounter].mMinorID);
-				}
 				LV_ITEM lItem;
 
 				lItem.mask = LVIF_TEXT | LVIF_PARAM;
@@ -993,6 +1017,67 @@ void InternetRoom::RefreshUserList(HWND pWindow)
 
 }
 
+/**
+ * Apply the game entries changed by the last ParseState() to the game list.
+ * Only the rows of modified entries are touched, so the selection and
+ * scroll position are kept and idle refreshes cost nothing.
+ * @param pWindow The room dialog.
+ */
+void InternetRoom::UpdateGameList(HWND pWindow)
+{
+	HWND lList = GetDlgItem(pWindow, IDC_GAME_LIST);
+
+	for(int lCounter = 0; lCounter < eMaxGame; lCounter++) {
+		if(mGameList[lCounter].mModified) {
+			mGameList[lCounter].mModified = FALSE;
+
+			if(lList != NULL) {
+				UpdateListItem(lList, lCounter, mGameList[lCounter].mValid,
+					mGameList[lCounter].mName.c_str());
+			}
+		}
+	}
+	RefreshGameSelection(pWindow);
+}
+
+/**
+ * Apply the user entries changed by the last ParseState() to the user list.
+ * @param pWindow The room dialog.
+ * @see UpdateGameList(HWND)
+ */
+void InternetRoom::UpdateUserList(HWND pWindow)
+{
+	HWND lList = GetDlgItem(pWindow, IDC_USER_LIST);
+
+	for(int lCounter = 0; lCounter < eMaxClient; lCounter++) {
+		if(mClientList[lCounter].mModified) {
+			mClientList[lCounter].mModified = FALSE;
+
+			if(lList != NULL) {
+				UpdateListItem(lList, lCounter, mClientList[lCounter].mValid,
+					GetUserDisplayName(lCounter).c_str());
+			}
+		}
+	}
+}
+
+/**
+ * Generate the name shown in the user list for a user entry.
+ * @param pEntry The user index.
+ * @return The user name, followed by the registration ID if there is one.
+ */
+std::string InternetRoom::GetUserDisplayName(int pEntry) const
+{
+	const Client &lClient = mClientList[pEntry];
+
+	if(lClient.mMajorID != -1) {
+		return lClient.mName + boost::str(boost::format("[%d-%d]") %
+			lClient.mMajorID %
+			lClient.mMinorID);
+	}
+	return lClient.mName;
+}
+
 /***
  * Refresh the chat buffer.
  * Keep in mind that mChatBuffer is internally UTF-8 (not wide), so Str::UW must be used before displaying.
@@ -1235,7 +1320,9 @@ int InternetRoom::LoadBanner(HWND pWindow, const char *pBuffer, int pBufferLen)
 		return 0;								  // no more refresh
 	}
 	else {
-		mBanner.Decode((unsigned char *) pBuffer, pBufferLen);
+		if(!mBanner.Decode((unsigned char *) pBuffer, pBufferLen)) {
+			return 0;
+		}
 
 		HDC hdc = GetDC(lWindow);
 
@@ -1251,10 +1338,9 @@ int InternetRoom::LoadBanner(HWND pWindow, const char *pBuffer, int pBufferLen)
 
 		//TRACE("Colors2 %d  %d\n", lNbColors, GetLastError());
 
-		mCurrentBannerIndex = 0;
-		SendMessage(lWindow, BM_SETIMAGE, IMAGE_BITMAP, (long) mBanner.GetImage(0));
-
-		return mBanner.GetDelay(0);
+		// The frames are decoded in the background; show the first one
+		// as soon as it is ready.
+		return RefreshBanner(pWindow);
 	}
 }
 
@@ -1264,15 +1350,20 @@ int InternetRoom::RefreshBanner(HWND pWindow)
 
 	HWND lWindow = GetDlgItem(pWindow, IDC_PUB);
 
-	if((lWindow == NULL) || (mBanner.GetImageCount() == 0)) {
+	if((lWindow == NULL) || !mBanner.HasMoreFrames()) {
 		return 0;								  // no more refresh
 	}
 	else {
-		mCurrentBannerIndex = (mCurrentBannerIndex + 1) % mBanner.GetImageCount();
+		HBITMAP lBitmap;
+		int lDelay;
 
-		SendMessage(lWindow, BM_SETIMAGE, IMAGE_BITMAP, (long) mBanner.GetImage(mCurrentBannerIndex));
+		if(!mBanner.NextFrame(lBitmap, lDelay)) {
+			return BANNER_POLL_DELAY;			  // Not decoded yet
+		}
 
-		return mBanner.GetDelay(mCurrentBannerIndex);
+		SendMessage(lWindow, BM_SETIMAGE, IMAGE_BITMAP, (long) lBitmap);
+
+		return lDelay;
 
 	}
 
@@ -1475,6 +1566,9 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 							mThis->AddChatLine(_("Warning: communication timeout"));
 							mThis->RefreshChatOut(pWindow);
 						}
+						// Fall back to short polling until the server says otherwise
+						mThis->mLongPollWait = 0;
+
 						// Initiate a new refresh
 						SetTimer(pWindow, REFRESH_EVENT, 1 /*REFRESH_DELAY */ , NULL);
 	
@@ -1485,12 +1579,16 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 					{
 						std::string lRequest;
 	
-						lRequest = boost::str(boost::format("%s?=REFRESH%%%%%d-%u%%%%%d") %
+						// Ask for the changes since our last time stamp; servers
+						// that support it may hold the request for up to
+						// REFRESH_LONG_POLL seconds until there is something new.
+						lRequest = boost::str(boost::format("%s?=REFRESH%%%%%d-%u%%%%%d%%%%%d") %
 							mThis->roomList->GetSelectedRoom()->path %
 							//(const char *) gServerList[gCurrentServerEntry].mURL,
 							mThis->mCurrentUserIndex %
 							mThis->mCurrentUserId %
-							mThis->mLastRefreshTimeStamp);
+							mThis->mLastRefreshTimeStamp %
+							REFRESH_LONG_POLL);
 						mThis->mRefreshRequest.Send(pWindow,
 							mThis->roomList->GetSelectedRoom()->addr,
 							//gServerList[gCurrentServerEntry].mAddress,
@@ -1499,7 +1597,8 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 							lRequest.c_str());
 	
 						// Activate timeout
-						SetTimer(pWindow, REFRESH_TIMEOUT_EVENT, REFRESH_TIMEOUT, NULL);
+						SetTimer(pWindow, REFRESH_TIMEOUT_EVENT,
+							REFRESH_TIMEOUT + mThis->mLongPollWait * 1000, NULL);
 					}
 					break;
 
@@ -1578,11 +1677,11 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 						int lToRefresh = mThis->ParseState(lAnswer);
 
 						if(lToRefresh & eGamesModified) {
-							mThis->RefreshGameList(pWindow);
+							mThis->UpdateGameList(pWindow);
 						}
 
 						if(lToRefresh & eUsersModified) {
-							mThis->RefreshUserList(pWindow);
+							mThis->UpdateUserList(pWindow);
 						}
 
 						if(lToRefresh & eChatModified) {
@@ -1590,8 +1689,10 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 							mThis->PlayMessageReceivedSound(pWindow);
 						}
 
-						// Schedule a new refresh
-						SetTimer(pWindow, REFRESH_EVENT, REFRESH_DELAY, NULL);
+						// Schedule a new refresh; a long-polling server already
+						// waited for us, so there is no need to wait again.
+						SetTimer(pWindow, REFRESH_EVENT,
+							(mThis->mLongPollWait > 0) ? IMMEDIATE : REFRESH_DELAY, NULL);
 					}
 					mThis->mRefreshRequest.Clear();
 				}
@@ -1796,7 +1897,7 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 
 										lSuccess = TrackDownloadDialog(lCurrentTrack).ShowModal(GetModuleHandle(NULL), pWindow);
 										if (lSuccess) {
-											Model::TrackPtr track = Config::GetInstance()->
+											track = Config::GetInstance()->
 												GetTrackBundle()->OpenTrack(lCurrentTrack.c_str());
 											if (track.get() == NULL) {
 												throw Parcel::ObjStreamExn("Track failed to download.");
@@ -1809,10 +1910,11 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 									}
 								}
 								if (lSuccess) {
-									lSuccess = mThis->mSession->LoadNew(mThis->mGameList[lFocus].mTrack.c_str(),
+									// The track loads in the background while we connect;
+									// see MRM_DLG_END_JOIN.
+									mThis->mSession->StartLoadNew(mThis->mGameList[lFocus].mTrack.c_str(),
 										track->GetRecordFile(), mThis->mGameList[lFocus].mNbLap,
-										mThis->mGameList[lFocus].mAllowWeapons,
-										mThis->mVideoBuffer);
+										mThis->mGameList[lFocus].mAllowWeapons);
 								}
 
 								if(lSuccess) {
@@ -1856,15 +1958,16 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 						}
 
 						if(lSuccess) {
-							// Load the track
+							// Start loading the track; it loads in the background
+							// while the game is registered with the server.
 							try {
 								Model::TrackPtr track = Config::GetInstance()->
 									GetTrackBundle()->OpenTrack(lCurrentTrack.c_str());
 								if (track.get() == NULL)
 									throw Parcel::ObjStreamExn("Track does not exist.");
-								lSuccess = (mThis->mSession->LoadNew(
+								mThis->mSession->StartLoadNew(
 									lCurrentTrack.c_str(), track->GetRecordFile(), lNbLap,
-									lGameOpts, mThis->mVideoBuffer) != FALSE);
+									lGameOpts);
 							}
 							catch (Parcel::ObjStreamExn &ex) {
 								TrackOpenFailMessageBox(pWindow, lCurrentTrack, ex.what());
@@ -1880,6 +1983,25 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 								lNbLap, lGameOpts,
 								Config::GetInstance()->net.tcpServPort) != FALSE);
 
+							// The track must be ready before anyone can join
+							TrackLoadDialog(mThis->mSession).ShowModal(GetModuleHandle(NULL), pWindow);
+							std::string lLoadError = _("Track load failed.");
+							BOOL lLoaded;
+							try {
+								lLoaded = mThis->mSession->FinishLoadNew(mThis->mVideoBuffer);
+							}
+							catch (Parcel::ObjStreamExn &ex) {
+								lLoadError = ex.what();
+								lLoaded = FALSE;
+							}
+							if(!lLoaded) {
+								if(lSuccess) {
+									TrackOpenFailMessageBox(pWindow, lCurrentTrack, lLoadError);
+									mThis->DelGameOp(pWindow);
+								}
+								lSuccess = false;
+							}
+
 							if(lSuccess) {
 								// Wait client registration
 								std::string lTrackName;
@@ -1938,6 +2060,24 @@ BOOL CALLBACK InternetRoom::RoomCallBack(HWND pWindow, UINT pMsgId, WPARAM pWPar
 
 			mThis->mModelessDlg = NULL;
 
+			if((pWParam == IDOK) && (pMsgId == MRM_DLG_END_JOIN)) {
+				// Wait for the track that was loading while we connected
+				TrackLoadDialog(mThis->mSession).ShowModal(GetModuleHandle(NULL), pWindow);
+				std::string lLoadError = _("Track load failed.");
+				BOOL lLoaded;
+				try {
+					lLoaded = mThis->mSession->FinishLoadNew(mThis->mVideoBuffer);
+				}
+				catch (Parcel::ObjStreamExn &ex) {
+					lLoadError = ex.what();
+					lLoaded = FALSE;
+				}
+				if(!lLoaded) {
+					TrackOpenFailMessageBox(pWindow, mThis->mSession->GetLoadTitle(), lLoadError);
+					pWParam = IDCANCEL;
+				}
+			}
+
 			if(pWParam == IDOK) {
 				// Unregister user and game
 				mThis->DelUserOp(pWindow, TRUE);
@@ -2367,5 +2507,68 @@ int FindFocusItem(HWND pWindow)
 	return lReturnValue;
 }
 
+/**
+ * Update the row of a list view for a single entry.
+ * Rows are kept ordered by entry index (stored in the item's lParam), so a
+ * new row is inserted in place instead of rebuilding the whole list.
+ * @param pList The list view.
+ * @param pEntry The entry index.
+ * @param pValid @c TRUE if the entry exists, @c FALSE to remove its row.
+ * @param pText The row text (ignored when removing).
+ */
+void UpdateListItem(HWND pList, int pEntry, BOOL pValid, const char *pText)
+{
+	LV_FINDINFO lFind;
+
+	lFind.flags = LVFI_PARAM;
+	lFind.lParam = pEntry;
+
+	int lItemIndex = ListView_FindItem(pList, -1, &lFind);
+
+	if(!pValid) {
+		if(lItemIndex != -1) {
+			ListView_DeleteItem(pList, lItemIndex);
+		}
+	}
+	else if(lItemIndex != -1) {
+		ListView_SetItemText(pList, lItemIndex, 0, const_cast<char*>(pText));
+	}
+	else {
+		// Binary search for the first row past this entry
+		int lLow = 0;
+		int lHigh = ListView_GetItemCount(pList);
+
+		while(lLow < lHigh) {
+			int lMid = (lLow + lHigh) / 2;
+			LV_ITEM lItemData;
+
+			lItemData.mask = LVIF_PARAM;
+			lItemData.iItem = lMid;
+			lItemData.iSubItem = 0;
+			lItemData.lParam = 0;
+			ListView_GetItem(pList, &lItemData);
+
+			if(lItemData.lParam < pEntry) {
+				lLow = lMid + 1;
+			}
+			else {
+				lHigh = lMid;
+			}
+		}
+
+		LV_ITEM lItem;
+
+		lItem.mask = LVIF_TEXT | LVIF_PARAM;
+		lItem.iItem = lLow;
+		lItem.iSubItem = 0;
+		lItem.pszText = const_cast<char*>(pText);
+		lItem.lParam = pEntry;
+
+		int lCode = ListView_InsertItem(pList, &lItem);
+
+		ASSERT(lCode != -1);
+	}
+}
+
 }  // namespace Client
 }  // namespace HoverRace
@@ -91,6 +91,7 @@ class InternetRoom
 		{
 			public:
 				BOOL mValid;
+				BOOL mModified;				  // Changed since the list was last updated
 				std::string mName;
 				int mGame;
 				int mMajorID;
@@ -103,6 +104,7 @@ class InternetRoom
 			public:
 
 				BOOL mValid;
+				BOOL mModified;				  // Changed since the list was last updated
 				int mId;
 				MR_TrackAvail mAvailCode;
 				std::string mName;
@@ -143,6 +145,7 @@ class InternetRoom
 		std::string mChatBuffer;
 
 		int mLastRefreshTimeStamp;
+		int mLongPollWait;				  // Seconds the server holds a refresh (0 = no long polling)
 
 		HWND mModelessDlg;
 
@@ -165,7 +168,6 @@ class InternetRoom
 
 		WNDPROC oldBannerProc;
 		GifDecoder mBanner;
-		int mCurrentBannerIndex;
 
 		bool checkUpdates;
 
@@ -197,6 +199,8 @@ class InternetRoom
 		void RefreshGameList(HWND pWindow);
 		void RefreshGameSelection(HWND pWindow);
 		void RefreshUserList(HWND pWindow);
+		void UpdateGameList(HWND pWindow);
+		void UpdateUserList(HWND pWindow);
 		void RefreshChatOut(HWND pWindow);
 
 		void PlayMessageReceivedSound(HWND wnd);
@@ -207,6 +211,7 @@ class InternetRoom
 
 		void OpenChatLog();
 		void AddChatLine(const char *pText, bool neverLog=false);
+		std::string GetUserDisplayName(int pEntry) const;
 
 		int LoadBanner(HWND pWindow, const char *pBuffer, int pBufferLen);
 		int RefreshBanner(HWND pWindow);		  // Return next refresh time
@@ -29,6 +29,9 @@
 #include "../../engine/Util/Config.h"
 #include "../../engine/Util/OS.h"
 
+#include "MatchReportSpool.h"
+
+using HoverRace::Client::MatchReportSpool;
 using HoverRace::Util::Config;
 using HoverRace::Util::OS;
 
@@ -115,6 +118,7 @@ class MatchReportRequest
 		BOOL AddVariable(const char *pVar, const char *pValue, const char *pLabel = NULL);
 		static void SetDefaultPassword(const char *pPassword);
 		BOOL Process(HWND pWindow, unsigned long pIP, unsigned int pPort, const char *pURLPath);
+		BOOL Queue(unsigned long pIP, unsigned int pPort, const char *pURLPath);
 
 		static const char *GetPassword();
 
@@ -192,6 +196,21 @@ BOOL MReport_Process(HWND pWindow, unsigned long pIP, unsigned int pPort, const
 
 }
 
+BOOL MReport_Queue(unsigned long pIP, unsigned int pPort, const char *pURLPath)
+{
+	BOOL lReturnValue = FALSE;
+
+	if(gThis == NULL) {
+		gThis = new MatchReportRequest();
+	}
+
+	if(gThis != NULL) {
+		lReturnValue = gThis->Queue(pIP, pPort, pURLPath);
+	}
+	return lReturnValue;
+
+}
+
 const char *MReport_GetPassword()
 {
 	return MatchReportRequest::GetPassword();
@@ -406,6 +425,33 @@ BOOL MatchReportRequest::Process(HWND pWindow, unsigned long pIP, unsigned int p
 	return lReturnValue;
 }
 
+/**
+ * Hand the report to the background spool instead of popping the dialog.
+ * The default password is used and no comment is sent; the server's answer
+ * is not shown to the user.
+ * @return TRUE if the report was queued.
+ */
+BOOL MatchReportRequest::Queue(unsigned long pIP, unsigned int pPort, const char *pURLPath)
+{
+	char lPaddedPasswd[20];
+
+	Pad(mPassword, lPaddedPasswd, sizeof(lPaddedPasswd));
+
+	in_addr lAddr;
+
+	lAddr.s_addr = pIP;
+
+	std::string lUrl = boost::str(boost::format("http://%s:%u%s?password=%s%s") %
+		inet_ntoa(lAddr) % pPort % pURLPath % lPaddedPasswd % mRequest);
+
+	// The spool keeps the password out of its journal.
+	MatchReportSpool *lSpool = MatchReportSpool::GetInstance();
+	lSpool->SetPassword(lPaddedPasswd);
+	lSpool->Queue(lUrl);
+
+	return TRUE;
+}
+
 BOOL MatchReportRequest::ParseAnswer()
 {
 	mNbButtons = 0;
@@ -30,5 +30,6 @@ BOOL MReport_AddResultString(const char *pString);
 BOOL MReport_AddVariable(const char *pVar, const char *pValue, const char *pLabel = NULL);
 void MReport_SetDefaultPassword(const char *pPassword);
 BOOL MReport_Process(HWND pWindow, unsigned long pIP, unsigned int pPort, const char *pURLPath);
+BOOL MReport_Queue(unsigned long pIP, unsigned int pPort, const char *pURLPath);	// Send in the background, no UI
 const char *MReport_GetPassword();				  // To be able to reuse password from one call to an other
 #endif
@@ -0,0 +1,394 @@
+
+// MatchReportSpool.cpp
+// Background ladder report queue.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <time.h>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include "../../engine/Net/Agent.h"
+#include "../../engine/Net/AsyncTransfer.h"
+#include "../../engine/Net/NetExn.h"
+#include "../../engine/Util/Config.h"
+#include "../../engine/Util/MR_Types.h"
+#include "../../engine/Util/Str.h"
+
+#include "MatchReportSpool.h"
+
+using namespace HoverRace;
+using namespace HoverRace::Client;
+using HoverRace::Util::Config;
+using HoverRace::Util::OS;
+namespace Str = HoverRace::Util::Str;
+
+namespace {
+	/// Maximum number of reports sent at once.
+	const size_t MAX_BATCH = 8;
+
+	/// Delay (seconds) after the first failed batch; doubled on each failure.
+	const int MIN_BACKOFF = 5;
+	const int MAX_BACKOFF = 10 * 60;
+
+	/// The ladder answer is a few lines of text.
+	const size_t MAX_ANSWER_SIZE = 16 * 1024;
+
+	/// Marks a well-formed answer from the ladder server.
+	const char *ANSWER_HEADER = "[LADDER_ANSWER_1]";
+
+	/// The report parameter that carries the ladder password.
+	const std::string PASSWORD_PARAM = "password=";
+
+	/**
+	 * Remove the password parameter from a report URL.
+	 * @param url The URL.
+	 * @return The URL without the password.
+	 */
+	std::string StripPassword(const std::string &url)
+	{
+		std::string::size_type query = url.find('?');
+		if (query == std::string::npos) return url;
+
+		// Only match a whole parameter name (not e.g. "oldpassword=").
+		std::string::size_type pos = url.find(PASSWORD_PARAM, query);
+		while (pos != std::string::npos && url[pos - 1] != '?' && url[pos - 1] != '&') {
+			pos = url.find(PASSWORD_PARAM, pos + 1);
+		}
+		if (pos == std::string::npos) return url;
+
+		std::string::size_type end = url.find('&', pos);
+		if (end == std::string::npos) {
+			// Last parameter; drop the separator in front of it instead.
+			return url.substr(0, (url[pos - 1] == '&') ? pos - 1 : pos);
+		}
+		return url.substr(0, pos) + url.substr(end + 1);
+	}
+}
+
+MatchReportSpool *MatchReportSpool::instance = NULL;
+boost::mutex MatchReportSpool::instanceMutex;
+
+/**
+ * Constructor.
+ * Reports left over from a previous session are loaded and sent right away.
+ * @param journalPath The journal filename.
+ */
+MatchReportSpool::MatchReportSpool(const OS::path_t &journalPath) :
+	journalPath(journalPath),
+	tmpPath(Str::UP(std::string((const char*)Str::PU(journalPath)) + ".tmp")),
+	idSeq(0), backoff(0), quit(false),
+	cancelFlag(boost::make_shared<Net::ManualCancelFlag>())
+{
+	LoadJournal();
+
+	thread = boost::thread(boost::bind(&MatchReportSpool::ThreadProc, this));
+}
+
+MatchReportSpool::~MatchReportSpool()
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		quit = true;
+	}
+	cancelFlag->Cancel();
+	workCond.notify_all();
+	thread.join();
+}
+
+/**
+ * Retrieve the shared spool, starting it if necessary.
+ * @return The spool (never @c NULL).
+ */
+MatchReportSpool *MatchReportSpool::GetInstance()
+{
+	boost::mutex::scoped_lock lock(instanceMutex);
+	if (instance == NULL) {
+		instance = new MatchReportSpool(Config::GetInstance()->GetLadderSpoolPath());
+	}
+	return instance;
+}
+
+/**
+ * Start the spool if reports were left in the journal by a previous session.
+ * Otherwise, nothing is started until the first report is queued.
+ */
+void MatchReportSpool::ResumePending()
+{
+	boost::filesystem::ifstream in(Config::GetInstance()->GetLadderSpoolPath());
+	if (in && in.peek() != EOF) {
+		in.close();
+		GetInstance();
+	}
+}
+
+/**
+ * Stop sending reports.
+ * Reports that have not been delivered stay in the journal for next time.
+ * This must be called before Net::TransferPool::Shutdown().
+ */
+void MatchReportSpool::Shutdown()
+{
+	boost::mutex::scoped_lock lock(instanceMutex);
+	delete instance;
+	instance = NULL;
+}
+
+/**
+ * Set the ladder password that is added to the reports as they are sent.
+ * @param password The password.
+ */
+void MatchReportSpool::SetPassword(const std::string &password)
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		this->password = password;
+	}
+	workCond.notify_all();
+}
+
+/**
+ * Add a report to the queue.
+ * The report is journaled before this returns; it is sent in the background.
+ * @param url The full report URL, including the query string.  A password
+ *            parameter is removed; see SetPassword().
+ * @return The match ID that was assigned to the report.
+ */
+std::string MatchReportSpool::Queue(const std::string &url)
+{
+	Report report;
+	{
+		boost::mutex::scoped_lock lock(mutex);
+
+		report.id = GenerateId(url);
+		report.url = StripPassword(url) + "&matchid=" + report.id;
+
+		AppendJournal("QUEUE " + report.id + ' ' + report.url);
+		pending.push_back(report);
+	}
+	workCond.notify_all();
+
+	return report.id;
+}
+
+/**
+ * Retrieve the number of reports that have not been delivered yet.
+ * @return The count.
+ */
+size_t MatchReportSpool::GetPendingCount()
+{
+	boost::mutex::scoped_lock lock(mutex);
+	return pending.size();
+}
+
+/**
+ * Generate a match ID that is unique for this installation.
+ * @param url The report URL (mixed in so that two players reporting the
+ *            same second get different IDs).
+ * @return The ID (hex digits only).
+ */
+std::string MatchReportSpool::GenerateId(const std::string &url)
+{
+	MR_UInt32 hash = 2166136261u;
+	for (std::string::const_iterator iter = url.begin(); iter != url.end(); ++iter) {
+		hash = (hash ^ static_cast<unsigned char>(*iter)) * 16777619u;
+	}
+	hash ^= static_cast<MR_UInt32>(OS::Time());
+
+	return boost::str(boost::format("%08x%08x%04x") %
+		static_cast<MR_UInt32>(time(NULL)) % hash % (idSeq++ & 0xffff));
+}
+
+/// Read the reports that were still pending when the journal was last used.
+void MatchReportSpool::LoadJournal()
+{
+	boost::filesystem::ifstream in(journalPath);
+	if (!in) return;
+
+	bool dirty = false;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream iss(line);
+		std::string op, id;
+		iss >> op >> id;
+
+		if (op == "QUEUE") {
+			Report report;
+			report.id = id;
+			iss >> report.url;
+			if (!report.url.empty()) {
+				// Older journals kept the password; the rewrite drops it.
+				std::string url = StripPassword(report.url);
+				if (url != report.url) {
+					report.url = url;
+					dirty = true;
+				}
+				pending.push_back(report);
+			}
+		}
+		else if (op == "DONE") {
+			Remove(id);
+			dirty = true;
+		}
+		else {
+			// Truncated write from a crash; the rewrite drops it.
+			dirty = true;
+		}
+	}
+	in.close();
+
+	if (dirty) {
+		RewriteJournal();
+	}
+}
+
+/**
+ * Append a record to the journal.
+ * The caller must hold the lock.
+ * @param line The record (without the line terminator).
+ */
+void MatchReportSpool::AppendJournal(const std::string &line)
+{
+	boost::filesystem::ofstream out(journalPath, std::ios::out | std::ios::app);
+	out << line << std::endl;
+}
+
+/**
+ * Replace the journal with just the pending reports, so that it does not
+ * grow forever.
+ * The caller must hold the lock.
+ */
+void MatchReportSpool::RewriteJournal()
+{
+	{
+		boost::filesystem::ofstream out(tmpPath, std::ios::out | std::ios::trunc);
+		for (reports_t::const_iterator iter = pending.begin(); iter != pending.end(); ++iter) {
+			out << "QUEUE " << iter->id << ' ' << iter->url << '\n';
+		}
+		out.flush();
+		if (!out) return;
+	}
+	OS::RenameReplace(tmpPath, journalPath);
+}
+
+/**
+ * Drop a report from the pending queue.
+ * The caller must hold the lock.
+ * @param id The match ID.
+ */
+void MatchReportSpool::Remove(const std::string &id)
+{
+	for (reports_t::iterator iter = pending.begin(); iter != pending.end(); ++iter) {
+		if (iter->id == id) {
+			pending.erase(iter);
+			break;
+		}
+	}
+}
+
+void MatchReportSpool::ThreadProc()
+{
+	boost::mutex::scoped_lock lock(mutex);
+	for (;;) {
+		while (!quit && (pending.empty() || password.empty())) {
+			workCond.wait(lock);
+		}
+		if (quit) break;
+
+		// Reports queued while this batch is in flight wait for the next one.
+		reports_t batch(pending.begin(),
+			pending.begin() + std::min(pending.size(), MAX_BATCH));
+		std::vector<bool> delivered(batch.size(), false);
+		std::string batchPassword = password;
+
+		lock.unlock();
+		SendBatch(batch, batchPassword, delivered);
+		lock.lock();
+
+		bool failed = false;
+		for (size_t i = 0; i < batch.size(); ++i) {
+			if (delivered[i]) {
+				Remove(batch[i].id);
+				AppendJournal("DONE " + batch[i].id);
+			}
+			else {
+				failed = true;
+			}
+		}
+		if (pending.empty()) {
+			RewriteJournal();
+		}
+
+		if (failed) {
+			backoff = (backoff == 0) ? MIN_BACKOFF : std::min(backoff * 2, MAX_BACKOFF);
+
+			boost::system_time until = boost::get_system_time() +
+				boost::posix_time::seconds(backoff);
+			while (!quit && workCond.timed_wait(lock, until)) ;
+		}
+		else {
+			backoff = 0;
+		}
+	}
+}
+
+/**
+ * Send a batch of reports.
+ * The reports are sent in parallel on the shared transfer pool.
+ * @param batch The reports.
+ * @param password The ladder password to add to each report.
+ * @param[out] delivered Set to @c true for each report the server answered.
+ */
+void MatchReportSpool::SendBatch(const reports_t &batch, const std::string &password,
+                                 std::vector<bool> &delivered)
+{
+	std::vector<std::string> answers(batch.size());
+	std::vector<Net::AsyncTransferPtr> xfers;
+	xfers.reserve(batch.size());
+
+	for (size_t i = 0; i < batch.size(); ++i) {
+		std::string url = batch[i].url;
+		std::string::size_type query = url.find('?');
+		if (query == std::string::npos) {
+			url += '?';
+			query = url.length() - 1;
+		}
+		url.insert(query + 1, PASSWORD_PARAM + password + '&');
+
+		Net::Agent agent(url);
+		agent.SetMaxSize(MAX_ANSWER_SIZE);
+		xfers.push_back(agent.GetAsync(answers[i], cancelFlag));
+	}
+
+	// Wait for all of them, since they write into the answer buffers.
+	for (size_t i = 0; i < xfers.size(); ++i) {
+		try {
+			xfers[i]->Wait();
+
+			// Any ladder answer counts, even a rejection (e.g. bad password);
+			// sending the same report again would not change it.
+			delivered[i] = answers[i].find(ANSWER_HEADER) != std::string::npos;
+		}
+		catch (Net::NetExn&) {
+			// Try again with the next batch.
+		}
+	}
+}
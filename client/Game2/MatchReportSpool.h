@@ -0,0 +1,108 @@
+
+// MatchReportSpool.h
+// Header for the background ladder report queue.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <deque>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../../engine/Net/CancelFlag.h"
+#include "../../engine/Util/OS.h"
+
+namespace HoverRace {
+namespace Client {
+
+/**
+ * Delivers match reports to the ladder server in the background.
+ *
+ * Reports are appended to a journal before anything is sent, so they
+ * survive restarts and network outages.  Pending reports are sent in
+ * batches; a batch that fails is retried later with an increasing delay.
+ * Each report carries a unique match ID (the @c matchid variable) so that
+ * the server can discard a report that is re-sent after its answer was lost.
+ *
+ * The ladder password is never written to the journal; it is only kept in
+ * memory and added to each report as it is sent, so reports wait until
+ * SetPassword() has been called in the current session.
+ *
+ * @note Nothing queues new reports yet: the post-race ladder report
+ *       (MR_SendLadderResult()) is still disabled, and the room list does not
+ *       provide a ladder server address.  The spool is only started once a
+ *       report is queued, or at startup if the journal still holds some.
+ */
+class MatchReportSpool
+{
+	private:
+		MatchReportSpool(const Util::OS::path_t &journalPath);
+	public:
+		~MatchReportSpool();
+
+		static MatchReportSpool *GetInstance();
+		static void ResumePending();
+		static void Shutdown();
+
+	public:
+		void SetPassword(const std::string &password);
+		std::string Queue(const std::string &url);
+		size_t GetPendingCount();
+
+	private:
+		struct Report
+		{
+			std::string id;
+			std::string url;
+		};
+		typedef std::deque<Report> reports_t;
+
+		std::string GenerateId(const std::string &url);
+		void LoadJournal();
+		void AppendJournal(const std::string &line);
+		void RewriteJournal();
+		void Remove(const std::string &id);
+
+		void ThreadProc();
+		void SendBatch(const reports_t &batch, const std::string &password,
+			std::vector<bool> &delivered);
+
+	private:
+		static MatchReportSpool *instance;
+		static boost::mutex instanceMutex;
+
+		Util::OS::path_t journalPath;
+		Util::OS::path_t tmpPath;
+		reports_t pending;
+		unsigned idSeq;
+		int backoff;  ///< Delay (seconds) before the next batch; 0 if the last one succeeded.
+		std::string password;  ///< Not journaled; empty until SetPassword().
+		bool quit;
+		Net::ManualCancelFlagPtr cancelFlag;
+
+		boost::mutex mutex;
+		boost::condition_variable workCond;
+		boost::thread thread;
+};
+
+}  // namespace Client
+}  // namespace HoverRace
@@ -55,6 +55,10 @@ using HoverRace::Util::Config;
 #define MRNM_READY				51
 #define MRNM_CANCEL_GAME		52
 #define MRNM_SET_PLAYER_ID		53
+#define MRNM_CAPABILITIES		54
+
+// Capability flags (MRNM_CAPABILITIES)
+#define MR_NET_CAP_RELIABLE		0x01	  // understands the reliable channel (MR_NET_RELIABLE_QUEUE)
 
 #define MR_CONNECTION_TIMEOUT   21000			  // 21 sec
 
@@ -179,6 +183,10 @@ NetworkInterface::NetworkInterface()
 
 	mUDPRecvPort = Config::GetInstance()->net.udpRecvPort;
 	mTCPRecvPort = Config::GetInstance()->net.tcpRecvPort;
+
+	for(int lCounter = 0; lCounter < eMaxClient; lCounter++) {
+		mClient[lCounter].SetReliableSocket(mUDPOutLongPort);
+	}
 }
 
 /**
@@ -336,6 +344,25 @@ int NetworkInterface::GetMinLag(int pClient) const
 	return mClient[pClient].GetMinLag();
 }
 
+/**
+ * Sum up what is waiting to go out to all connected clients.
+ *
+ * @param pOutBytes Bytes waiting in the TCP output queues.
+ * @param pReliableMsgs Reliable messages either in flight or backlogged.
+ */
+void NetworkInterface::GetQueueDepth(int &pOutBytes, int &pReliableMsgs) const
+{
+	pOutBytes = 0;
+	pReliableMsgs = 0;
+
+	for(int lCounter = 0; lCounter < eMaxClient; lCounter++) {
+		if(mClient[lCounter].IsConnected()) {
+			pOutBytes += mClient[lCounter].GetOutQueueLen();
+			pReliableMsgs += mClient[lCounter].GetReliableQueueLen();
+		}
+	}
+}
+
 /**
  * Unlike its name says, this actually does the exact same thing as GetMinLag().  It returns the minimum, not the average like its name implies.  Hooray
  * for lying!
@@ -375,9 +402,10 @@ BOOL NetworkInterface::UDPSend(int pClient, NetMessageBuffer *pMessage, BOOL pLo
  * Send a message to all clients.  Assumes long port for UDP out and that the message is not being resent.
  *
  * @param pMessage NetMessageBuffer structure containing the message to be sent
- * @param pReqLevel If set to MR_NET_DATAGRAM UDP will be used; otherwise, TCP will be used
+ * @param pReqLevel If set to MR_NET_DATAGRAM UDP will be used; otherwise, TCP (or the reliable channel) will be used
+ * @param pStream Stream for MR_NET_REQUIRED messages (MR_NET_STREAM_*)
  */
-BOOL NetworkInterface::BroadcastMessage(NetMessageBuffer *pMessage, int pReqLevel)
+BOOL NetworkInterface::BroadcastMessage(NetMessageBuffer *pMessage, int pReqLevel, int pStream)
 {
 	pMessage->mClient = mId; // must ensure this
 	
@@ -394,7 +422,7 @@ BOOL NetworkInterface::BroadcastMessage(NetMessageBuffer *pMessage, int pReqLeve
 		if(pReqLevel == MR_NET_DATAGRAM)
 			mClient[lCounter].UDPSend(mUDPOutLongPort, pMessage, 0, FALSE);
 		else
-			mClient[lCounter].Send(pMessage, pReqLevel);
+			mClient[lCounter].Send(pMessage, pReqLevel, pStream);
 	}
 	return TRUE;
 }
@@ -444,6 +472,9 @@ BOOL NetworkInterface::FetchMessage(DWORD &pTimeStamp, int &pMessageType, int &p
 	for(int lCounter = 0; !lReturnValue && (lCounter < eMaxClient); lCounter++) {
 		int lClient = (lCounter + sLastClient + 1) % eMaxClient;
 
+		// Send pending acknowledgements and resends
+		mClient[lClient].FlushReliable(mId);
+
 		//TRACE("Polling client %d\n", lClient);
 		const NetMessageBuffer *lMessage = mClient[lClient].Poll((lClient >= mId) ? lClient + 1 : lClient, TRUE);
 
@@ -1049,9 +1080,11 @@ BOOL CALLBACK NetworkInterface::WaitGameNameCallBack(HWND pWindow, UINT pMsgId,
  *
  *  -#  Dialog is initialized.  Set up the main socket for reception and wait for a new client to connect (MRM_NEW_CLIENT).
  *  -#  A new client has connected: find a place in the list for them, add them to the list, and wait for another message (MRNM_CONN_NAME_GET_SET)
- *  -#  Client has responded (MRNM_CONN_NAME_GET_SET) with player name and UDP recv port; add it to the list and respond with our name and UDP
- *      receive port (MRNM_CONN_NAME_SET) and then send the list of other client IPs and names (MRNM_CLIENT_ADDR).  Wait for client to initiate lag
- *      test (MRNM_LAG_TEST).
+ *  -#  Client has responded (MRNM_CONN_NAME_GET_SET) with player name and UDP recv port; add it to the list and respond with our capabilities
+ *      (MRNM_CAPABILITIES), name and UDP receive port (MRNM_CONN_NAME_SET) and then send the list of other client IPs and names
+ *      (MRNM_CLIENT_ADDR).  Wait for client to initiate lag test (MRNM_LAG_TEST).
+ *
+ * Older versions ignore MRNM_CAPABILITIES, so the reliable channel is only enabled with the peers that sent it; the others keep using TCP.
  *  -#  Lag test initiation received (MRNM_LAG_TEST); respond with current time (MRNM_LAG_ANSWER).  The client will repeat the lag test 5 times, then
  *      inform us of the lag info.
  *  -#  Lag info received (MRNM_LAG_INFO).  Wait for more connections (go to step 2) or user input to start the race.
@@ -1061,7 +1094,7 @@ BOOL CALLBACK NetworkInterface::WaitGameNameCallBack(HWND pWindow, UINT pMsgId,
  * Client connecting to server:
  *
  *  -#  Dialog is initialized.  Set up sockets for reception and ask the server for the game name (MRNM_CONN_NAME_GET_SET), sending the player name
- *      and UDP receive port.
+ *      and UDP receive port.  Our capabilities (MRNM_CAPABILITIES) are sent just before.
  *  -#  Server responded with their name and UDP receive port (MRNM_CONN_NAME_SET); initiate a lag test (MRNM_LAG_TEST), sending the current time.
  *      Wait for the response.
  *  -#  Server responded with lag (MRNM_LAG_ANSWER).  Do 4 more lag tests (totaling 5 tests).
@@ -1153,6 +1186,8 @@ BOOL CALLBACK NetworkInterface::ListCallBack(HWND pWindow, UINT pMsgId, WPARAM p
 					WSAAsyncSelect(mActiveInterface->mClient[0].GetSocket(), pWindow, MRM_CLIENT + 0, FD_READ);
 					WSAAsyncSelect(mActiveInterface->mClient[0].GetUDPSocket(), pWindow, MRM_CLIENT + 1, FD_READ);
 	
+					mActiveInterface->SendCapabilities(0);
+
 					// Request server name to start sequence
 					// also include UDP port number in the request
 					lAnswer.mMessageType = MRNM_CONN_NAME_GET_SET;
@@ -1243,6 +1278,11 @@ BOOL CALLBACK NetworkInterface::ListCallBack(HWND pWindow, UINT pMsgId, WPARAM p
 	
 									mActiveInterface->mClient[lCounter].Send(&lMessage, MR_NET_REQUIRED);
 								}
+
+								// From now on, required messages go over UDP (to peers that support it)
+								for(lCounter = 0; lCounter < eMaxClient; lCounter++) {
+									mActiveInterface->mClient[lCounter].EnableReliable();
+								}
 	
 								// Disable all callbacks
 								for(lCounter = 0; lCounter < eMaxClient; lCounter++) {
@@ -1471,6 +1511,8 @@ BOOL CALLBACK NetworkInterface::ListCallBack(HWND pWindow, UINT pMsgId, WPARAM p
 								SetListViewText(lListHandle, lClient + 1, 1, _("Computing lag"));
 								SetListViewText(lListHandle, lClient + 1, 2, _("Connecting"));
 	
+								mActiveInterface->SendCapabilities(lClient);
+
 								// return local name as an answer
 								// also include UDP port number in the request
 								lAnswer.mMessageType = MRNM_CONN_NAME_SET;
@@ -1711,6 +1753,11 @@ BOOL CALLBACK NetworkInterface::ListCallBack(HWND pWindow, UINT pMsgId, WPARAM p
 							// Get Client Id
 							mActiveInterface->mId = lBuffer->mData[0];
 
+							// From now on, required messages go over UDP (to peers that support it)
+							for(int lCounter = 0; lCounter < eMaxClient; lCounter++) {
+								mActiveInterface->mClient[lCounter].EnableReliable();
+							}
+
 							// Quit this dialog with success
 
 							// Remove all ports callback
@@ -1753,6 +1800,12 @@ BOOL CALLBACK NetworkInterface::ListCallBack(HWND pWindow, UINT pMsgId, WPARAM p
 							// set mId
 							mActiveInterface->mId = lBuffer->mData[0];
 							break;
+
+						case MRNM_CAPABILITIES: // peer told us what it supports (sent before its name)
+							if(lBuffer->mDataLen >= 1) {
+								mActiveInterface->mClient[lClient].SetPeerReliable((lBuffer->mData[0] & MR_NET_CAP_RELIABLE) != 0);
+							}
+							break;
 					}
 				}
 
@@ -1860,6 +1913,8 @@ BOOL CALLBACK NetworkInterface::ListCallBack(HWND pWindow, UINT pMsgId, WPARAM p
 					}
 				}
 				else {
+					mActiveInterface->SendCapabilities(lClient);
+
 					// request client name to start the connection sequence
 					// also include UDP port number in the request
 					lAnswer.mMessageType = MRNM_CONN_NAME_GET_SET;
@@ -1948,6 +2003,24 @@ BOOL CALLBACK NetworkInterface::WaitConnCallback(HWND pWindow, UINT pMsgId, WPAR
 	return FALSE;
 }
 
+/**
+ * Tell a peer which optional protocol features we support (MRNM_CAPABILITIES).
+ * This is sent over TCP before our name, so the peer knows about them before the race starts.
+ *
+ * @param pClient The connection to send to
+ */
+void NetworkInterface::SendCapabilities(int pClient)
+{
+	NetMessageBuffer lAnswer;
+
+	lAnswer.mMessageType = MRNM_CAPABILITIES;
+	lAnswer.mClient = mId;
+	lAnswer.mDataLen = 1;
+	lAnswer.mData[0] = MR_NET_CAP_RELIABLE;
+
+	mClient[pClient].Send(&lAnswer, MR_NET_REQUIRED);
+}
+
 /**
  * This function sends the MRNM_CONNECTION_DONE message to the server, if we have successfully connected to all other clients.  The message is not
  * sent if any clients are not yet finished with connecting.
@@ -1983,6 +2056,7 @@ NetworkPort::NetworkPort()
 {
 	mSocket = INVALID_SOCKET;
 	mUDPRecvSocket = INVALID_SOCKET;
+	mReliableSocket = INVALID_SOCKET;
 	mTriedBackupIP = FALSE;
 
 	Disconnect();
@@ -2090,6 +2164,14 @@ void NetworkPort::Disconnect()
 
 	mInputMessageBufferIndex = 0;
 
+	mReliable.Reset();
+	mReliableEnabled = FALSE;
+	mReliableClient = MR_ID_NOT_SET;
+	mPeerReliable = FALSE;
+	for(int lCounter = 0; lCounter < ReliableChannel::eNbStreams; lCounter++) {
+		mReliableFragLen[lCounter] = 0;
+	}
+
 	mTriedBackupIP = FALSE;
 }
 
@@ -2120,8 +2202,9 @@ SOCKET NetworkPort::GetUDPSocket() const
 /**
  * Check if any new messages have been recieved.
  * If not, @c NULL is returned.  Otherwise the first message in the queue is
- * returned.  The UDP socket is checked before the TCP socket (TCP messages
- * are not as time-critical).
+ * returned.  Messages from the reliable channel come first, then the UDP
+ * socket is checked before the TCP socket (TCP messages are not as
+ * time-critical).
  *
  * The parameter @p pClientId is a dirty hack for the one-port UDP hack.
  * Since this polls the global UDP receive port it is possible we could receive
@@ -2134,6 +2217,10 @@ SOCKET NetworkPort::GetUDPSocket() const
 const NetMessageBuffer *NetworkPort::Poll(int pClientId, BOOL pCheckClientId)
 {
 	// Socket is assumed to be non-blocking, but it damn well better be because we set it that way
+	if((mInputMessageBufferIndex == 0) && PollReliable()) {
+		return &mInputMessageBuffer;
+	}
+
 	if((mInputMessageBufferIndex == 0) && (mUDPRecvSocket != INVALID_SOCKET)) {
 		while(1) {
 			// see if there is a UDP packet addressed to us
@@ -2163,6 +2250,18 @@ const NetMessageBuffer *NetworkPort::Poll(int pClientId, BOOL pCheckClientId)
 				// We have received a datagram
 				ASSERT(lLen == mInputMessageBuffer.mDataLen + MR_NET_HEADER_LEN);
 
+				if(lQueueId == MR_NET_RELIABLE_QUEUE) {
+					// Not a message by itself; it goes through the channel
+					mWatchdog = timeGetTime();
+					mReliableClient = mInputMessageBuffer.mClient;
+					mReliable.Receive(mWatchdog, mInputMessageBuffer.mData, mInputMessageBuffer.mDataLen);
+
+					if(PollReliable()) {
+						return &mInputMessageBuffer;
+					}
+					continue;
+				}
+
 				// Eliminate duplicate and late datagrams
 				if(((MR_Int8) ((MR_Int8) (MR_UInt8) mInputMessageBuffer.mDatagramNumber - (MR_Int8) mLastReceivedDatagramNumber[lQueueId]) > 0)
 					|| (mInputMessageBuffer.mClient != mLastClient[lQueueId])) {
@@ -2278,12 +2377,56 @@ BOOL NetworkPort::UDPSend(SOCKET pSocket, NetMessageBuffer *pMessage, unsigned p
 
 /**
  * Send the given message via TCP.
+ * Once the reliable channel is enabled, MR_NET_REQUIRED messages are sent
+ * through it instead.  Messages too large for one reliable packet are split
+ * over several packets on the same stream, so a stream never mixes the two
+ * transports and stays in order.
  *
  * @param pMessage The message to be sent
  * @param pReqLevel Should be set to MR_NET_REQUIRED
+ * @param pStream Stream the message belongs to (MR_NET_STREAM_*), for the reliable channel
  */
-void NetworkPort::Send(const NetMessageBuffer *pMessage, int pReqLevel)
+void NetworkPort::Send(const NetMessageBuffer *pMessage, int pReqLevel, int pStream)
 {
+	if(mReliableEnabled && (pReqLevel == MR_NET_REQUIRED)) {
+		if(mSocket != INVALID_SOCKET) {
+			// The message type travels in the first byte of the payload;
+			// every part but the last is preceded by MR_NET_RELIABLE_FRAGMENT
+			MR_UInt8 lPayload[ReliableChannel::eMaxPayload];
+			int lOffset = 0;
+			int lLeft = pMessage->mDataLen;
+			BOOL lQueued = TRUE;
+
+			while(lQueued && (lLeft > ReliableChannel::eMaxPayload - 1)) {
+				int lPartLen = ReliableChannel::eMaxPayload - 2;
+
+				lPayload[0] = MR_NET_RELIABLE_FRAGMENT;
+				lPayload[1] = pMessage->mMessageType;
+				memcpy(lPayload + 2, pMessage->mData + lOffset, lPartLen);
+
+				lQueued = mReliable.Queue(pStream, lPayload, lPartLen + 2);
+				lOffset += lPartLen;
+				lLeft -= lPartLen;
+			}
+
+			if(lQueued) {
+				lPayload[0] = pMessage->mMessageType;
+				memcpy(lPayload + 1, pMessage->mData + lOffset, lLeft);
+
+				lQueued = mReliable.Queue(pStream, lPayload, lLeft + 1);
+			}
+
+			if(!lQueued) {
+				TRACE("Reliable queue full\n");
+				Disconnect();
+			}
+			else {
+				FlushReliable(pMessage->mClient);
+			}
+		}
+		return;
+	}
+
 	// First try to send buffered data
 	if(mSocket != INVALID_SOCKET) {
 		BOOL lEndQueueLoop = (mOutQueueLen == 0);
@@ -2367,10 +2510,10 @@ void NetworkPort::Send(const NetMessageBuffer *pMessage, int pReqLevel)
 
 					ASSERT(lFirstBlocSize > 0);
 
-					memcpy(mOutQueue + lTail, pMessage + lReturnValue, lFirstBlocSize);
+					memcpy(mOutQueue + lTail, ((const MR_UInt8 *) pMessage) + lReturnValue, lFirstBlocSize);
 
 					if(lSecondBlocSize > 0) {
-						memcpy(mOutQueue, pMessage + lFirstBlocSize + lReturnValue, lSecondBlocSize);
+						memcpy(mOutQueue, ((const MR_UInt8 *) pMessage) + lFirstBlocSize + lReturnValue, lSecondBlocSize);
 					}
 
 					mOutQueueLen += lToSend;
@@ -2380,6 +2523,107 @@ void NetworkPort::Send(const NetMessageBuffer *pMessage, int pReqLevel)
 	}
 }
 
+/**
+ * Set the UDP socket the reliable channel sends from.
+ *
+ * @param pSocket The socket (generally NetworkInterface::mUDPOutLongPort)
+ */
+void NetworkPort::SetReliableSocket(SOCKET pSocket)
+{
+	mReliableSocket = pSocket;
+}
+
+/**
+ * Record whether the peer supports the reliable channel (MRNM_CAPABILITIES).
+ *
+ * @param pReliable @c TRUE if the peer advertised MR_NET_CAP_RELIABLE
+ */
+void NetworkPort::SetPeerReliable(BOOL pReliable)
+{
+	mPeerReliable = pReliable;
+}
+
+/**
+ * Start sending MR_NET_REQUIRED messages through the reliable channel.
+ * This is done once the connection phase is over; receiving from the channel
+ * is always possible.  Peers that did not advertise support for the channel
+ * keep getting them over TCP.
+ */
+void NetworkPort::EnableReliable()
+{
+	if(IsConnected() && mPeerReliable) {
+		mReliableEnabled = TRUE;
+	}
+}
+
+/**
+ * Transmit whatever the reliable channel has to send: new messages,
+ * resends of lost ones, and acknowledgements.  This must be called regularly.
+ *
+ * @param pClientId Our own client id, to stamp on the packets
+ */
+void NetworkPort::FlushReliable(int pClientId)
+{
+	if((mUDPRecvSocket == INVALID_SOCKET) || (mReliableSocket == INVALID_SOCKET)) {
+		return;
+	}
+
+	NetMessageBuffer lPacket;
+	int lLen;
+
+	lPacket.mDatagramNumber = 0;
+	lPacket.mDatagramQueue = MR_NET_RELIABLE_QUEUE;
+	lPacket.mMessageType = 0;
+	lPacket.mClient = pClientId;
+
+	while((lLen = mReliable.GetNextPacket(timeGetTime(), lPacket.mData)) > 0) {
+		lPacket.mDataLen = lLen;
+
+		// A failed send is just another lost packet; it will be resent
+		sendto(mReliableSocket, (const char *) &lPacket, MR_NET_HEADER_LEN + lLen, 0, (LPSOCKADDR) & mUDPRemoteAddr, sizeof(mUDPRemoteAddr));
+	}
+}
+
+/**
+ * Move the next message delivered by the reliable channel, if any,
+ * into the input buffer.  Parts of a split message are collected until
+ * the last one arrives.
+ */
+BOOL NetworkPort::PollReliable()
+{
+	MR_UInt8 lPayload[ReliableChannel::eMaxPayload];
+	int lStream;
+	int lLen;
+
+	while((lLen = mReliable.Fetch(lPayload, &lStream)) > 0) {
+		BOOL lLast = (lPayload[0] != MR_NET_RELIABLE_FRAGMENT);
+		int lHeaderLen = lLast ? 1 : 2;
+		int &lFragLen = mReliableFragLen[lStream];
+
+		if((lLen < lHeaderLen) || (lFragLen + lLen - lHeaderLen > MR_MAX_NET_MESSAGE_LEN)) {
+			TRACE("Bad reliable fragment\n");
+			lFragLen = 0;
+			continue;
+		}
+
+		memcpy(mReliableFrag[lStream] + lFragLen, lPayload + lHeaderLen, lLen - lHeaderLen);
+		lFragLen += lLen - lHeaderLen;
+
+		if(lLast) {
+			mInputMessageBuffer.mDatagramNumber = 0;
+			mInputMessageBuffer.mDatagramQueue = MR_NET_RELIABLE_QUEUE;
+			mInputMessageBuffer.mMessageType = lPayload[0];
+			mInputMessageBuffer.mClient = mReliableClient;
+			mInputMessageBuffer.mDataLen = lFragLen;
+			memcpy(mInputMessageBuffer.mData, mReliableFrag[lStream], lFragLen);
+
+			lFragLen = 0;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 /**
  * Adds an observed lag sample to the lag.  Used in lag testing (if you hadn't guessed).
  *
@@ -2437,6 +2681,25 @@ void NetworkPort::SetLag(int pAvgLag, int pMinLag)
 
 }
 
+/**
+ * Returns the number of bytes waiting in the output queue.
+ */
+int NetworkPort::GetOutQueueLen() const
+{
+	return mOutQueueLen;
+}
+
+/**
+ * Returns the number of reliable messages not yet acknowledged by the peer.
+ */
+int NetworkPort::GetReliableQueueLen() const
+{
+	if(!mReliableEnabled) {
+		return 0;
+	}
+	return mReliable.GetNbUnacked() + mReliable.GetBacklogLen();
+}
+
 // Helper functions
 
 /**
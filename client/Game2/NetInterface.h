@@ -28,6 +28,8 @@
 #include "../../engine/Util/MR_Types.h"
 #include "../../engine/Util/Config.h"
 
+#include "ReliableChannel.h"
+
 #define MR_ID_NOT_SET				255
 
 #define MR_OUT_QUEUE_LEN			2048
@@ -38,6 +40,17 @@
 #define MR_NOT_REQUIRED				0
 #define MR_NET_DATAGRAM				-1
 
+// Streams for MR_NET_REQUIRED messages; each is ordered independently
+#define MR_NET_STREAM_EVENTS		0
+#define MR_NET_STREAM_STATS			1
+#define MR_NET_STREAM_CHAT			2
+
+// Datagram queue used by the reliable channel (0 and 1 are the long and short ports)
+#define MR_NET_RELIABLE_QUEUE		2
+
+// Message type of a reliable payload that is continued by the next one on its stream
+#define MR_NET_RELIABLE_FRAGMENT	255
+
 namespace HoverRace {
 namespace Client {
 
@@ -95,6 +108,19 @@ class NetworkPort
 		MR_UInt8 mOutQueue[MR_OUT_QUEUE_LEN];
 		int mOutQueueLen;
 		int mOutQueueHead;
+
+		// Reliable channel over UDP
+		// Once enabled, required messages use this instead of the TCP socket
+		// so that one lost segment does not hold up everything behind it
+		ReliableChannel mReliable;
+		BOOL mReliableEnabled;
+		SOCKET mReliableSocket;				/// the UDP socket reliable packets are sent from
+		MR_UInt8 mReliableClient;			/// client id of the peer, as seen in its packets
+		BOOL mPeerReliable;					/// the peer advertised MR_NET_CAP_RELIABLE
+		MR_UInt8 mReliableFrag[ReliableChannel::eNbStreams][MR_MAX_NET_MESSAGE_LEN];	/// partial message per stream
+		int mReliableFragLen[ReliableChannel::eNbStreams];
+
+		BOOL PollReliable();
 	public:
 		NetworkPort();
 		~NetworkPort();
@@ -108,9 +134,14 @@ class NetworkPort
 		SOCKET GetUDPSocket() const;
 
 		const NetMessageBuffer *Poll(int pClientId, BOOL pCheckClientId); // parameters are hacks
-		void Send(const NetMessageBuffer *pMessage, int pReqLevel);
+		void Send(const NetMessageBuffer *pMessage, int pReqLevel, int pStream = MR_NET_STREAM_EVENTS);
 		BOOL UDPSend(SOCKET pSocket, NetMessageBuffer *pMessage, unsigned pQueueId, BOOL pResendLast);
 
+		void SetReliableSocket(SOCKET pSocket);
+		void SetPeerReliable(BOOL pReliable);
+		void EnableReliable();
+		void FlushReliable(int pClientId);
+
 		// Time related stuff
 		BOOL AddLagSample(int pLag);
 		BOOL LagDone() const;
@@ -119,6 +150,10 @@ class NetworkPort
 		int GetMinLag() const;
 		void SetLag(int pAvgLag, int pMinLag);
 
+		// Queue depth (for the perf counters)
+		int GetOutQueueLen() const;
+		int GetReliableQueueLen() const;
+
 		BOOL mTriedBackupIP;	/// if the first connection attempt fails we must try another
 };
 
@@ -177,6 +212,7 @@ class NetworkInterface
 
 		// Helper function
 		void SendConnectionDoneIfNeeded();
+		void SendCapabilities(int pClient);
 
 	public:
 		// Creation and destruction
@@ -205,12 +241,14 @@ class NetworkInterface
 		int GetAvgLag(int pClient) const;
 		int GetMinLag(int pClient) const;
 
+		void GetQueueDepth(int &pOutBytes, int &pReliableMsgs) const;
+
 		// helper function
 		BOOL CreateUDPRecvSocket(int pPort);
 
 		// return TRUE if queue not full
 		BOOL UDPSend(int pClient, NetMessageBuffer * pMessage, BOOL pLongPort, BOOL pResendLast = FALSE);
-		BOOL BroadcastMessage(NetMessageBuffer * pMessage, int pReqLevel);
+		BOOL BroadcastMessage(NetMessageBuffer * pMessage, int pReqLevel, int pStream = MR_NET_STREAM_EVENTS);
 		// BOOL BroadcastMessage( DWORD  pTimeStamp, int  pMessageType, int pMessageLen, const MR_UInt8* pMessage );
 		BOOL FetchMessage(DWORD & pTimeStamp, int &pMessageType, int &pMessageLen, const MR_UInt8 * &pMessage, int &pClientId);
 		// pTimeStamp must be set to current time stamp before fetch
@@ -41,6 +41,14 @@
 #define MRNM_SET_PERM_ELEMENT_STATE   8
 #define MRNM_SEND_KEYID               9
 #define MRNM_HIT_MESSAGE             10
+#define MRNM_CLOCK_PING              12
+#define MRNM_CLOCK_PONG              13
+
+// Interval between clock sync pings, in ms
+#define MR_CLOCK_PING_INTERVAL       1000
+
+// Clock errors beyond this are corrected at once rather than slewed
+#define MR_CLOCK_MAX_SLEW            500
 
 using HoverRace::Parcel::RecordFile;
 
@@ -77,6 +85,7 @@ namespace HoverRace {
 				mLastSendElemStateTime[lCounter] = timeGetTime();
 			}
 			mLastSendElemStateFuncTime = timeGetTime();
+			mLastClockPingTime = timeGetTime();
 
 			mResultList = NULL;
 			mHitList = NULL;
@@ -320,6 +329,18 @@ namespace HoverRace {
 			return ResultAvaillable(); // what an ugly hack, Richard
 		}
 
+		/**
+		 * Retrieve how much outgoing traffic is waiting to be sent to the
+		 * other players.
+		 *
+		 * @param pOutBytes Bytes waiting in the stream output queues.
+		 * @param pReliableMsgs Reliable messages not yet acknowledged.
+		 */
+		void NetworkSession::GetNetQueueDepth(int& pOutBytes, int& pReliableMsgs) const
+		{
+			mNetInterface.GetQueueDepth(pOutBytes, pReliableMsgs);
+		}
+
 		/**
 		 * Returns an MainCharacter::MainCharacter object pointer pointing to the player specified in pPlayerIndex.
 		 *
@@ -371,12 +392,12 @@ namespace HoverRace {
 		}
 
 		/**
-		 * Load a new level.  This function calls MR_ClientSession::LoadNew() and then tells the level to notify call ElementCreationHook() and PermElementStateHook() when
+		 * Finish loading a new level.  This function calls MR_ClientSession::FinishLoadNew() and then tells the level to notify call ElementCreationHook() and PermElementStateHook() when
 		 * elements are created.
 		 */
-		BOOL NetworkSession::LoadNew(const char* pTitle, HoverRace::Parcel::RecordFilePtr pMazeFile, int pNbLap, char pGameOpts, VideoServices::VideoBuffer* pVideo)
+		BOOL NetworkSession::FinishLoadNew(VideoServices::VideoBuffer* pVideo)
 		{
-			BOOL lReturnValue = SUPER::LoadNew(pTitle, pMazeFile, pNbLap, pGameOpts, pVideo);
+			BOOL lReturnValue = SUPER::FinishLoadNew(pVideo);
 
 			if (lReturnValue) {
 				mSession.GetCurrentLevel()->SetBroadcastHook(ElementCreationHook, PermElementStateHook, this);
@@ -494,10 +515,19 @@ namespace HoverRace {
 							// Drop this message
 						}
 						else {
+							MR_3DCoordinate lOldPosition = mClientCharacter[lClientId]->mPosition;
 							int lOldRoom = mClientCharacter[lClientId]->mRoom;
 
 							mClientCharacter[lClientId]->SetNetState(lMessageLen, lMessage);
 
+							// The state was already old when it arrived, so dead-reckon it
+							// forward by the network delay, then glide there from where
+							// the hovercraft was being drawn
+							if (mSession.GetSimulationTime() > 0 && mClientCharacter[lClientId]->mRoom >= 0) {
+								mClientCharacter[lClientId]->Extrapolate(mNetInterface.GetMinLag(lClientId), mSession.GetCurrentLevel());
+								mClientCharacter[lClientId]->BlendFrom(lOldPosition);
+							}
+
 							// Move element if needed
 							if (mClientCharacter[lClientId]->mRoom != lOldRoom) {
 								Model::Level* lCurrentLevel = mSession.GetCurrentLevel();
@@ -599,6 +629,25 @@ namespace HoverRace {
 					AddHitEntry(lClientId, (char)lMessage[0]);
 					break;
 
+				case MRNM_CLOCK_PING: // echo the ping along with our clock
+					if (mMasterMode) {
+						NetMessageBuffer lAnswer;
+
+						lAnswer.mMessageType = MRNM_CLOCK_PONG;
+						lAnswer.mDataLen = 8;
+						*(MR_Int32*)&(lAnswer.mData[0]) = *(MR_Int32*)&(lMessage[0]);
+						*(MR_Int32*)&(lAnswer.mData[4]) = mSession.GetSimulationTime();
+
+						mNetInterface.UDPSend(lClientId, &lAnswer, TRUE, FALSE);
+					}
+					break;
+
+				case MRNM_CLOCK_PONG:
+					if (!mMasterMode && lClientId == 0) {
+						AddClockSample(*(MR_Int32*)&(lMessage[0]), *(MR_Int32*)&(lMessage[4]));
+					}
+					break;
+
 				}
 				lTimeStamp = mSession.GetSimulationTime();
 			}
@@ -608,6 +657,7 @@ namespace HoverRace {
 		 * Send all necessary data to clients.  This is called by NetworkSession::Process() as part of the game loop.
 		 *
 		 * If we are the server, we must send clock updates 12 and 8 seconds before the game starts.
+		 * Otherwise, we periodically ping the server to keep our clock in sync with it.
 		 *
 		 * If our hovercraft has been created, we must broadcast that.  Otherwise, we broadcast its state and statistics.
 		 *
@@ -635,7 +685,9 @@ namespace HoverRace {
 						}
 					}
 				}
-
+			}
+			else if (timeGetTime() - mLastClockPingTime >= MR_CLOCK_PING_INTERVAL) {
+				SendClockPing();
 			}
 
 			if (mTimeToSendCharacterCreation != 0) {
@@ -788,6 +840,7 @@ namespace HoverRace {
 		void NetworkSession::SetSimulationTime(MR_SimulationTime pTime)
 		{
 			pTime += mNetInterface.GetLagFromServer();
+			mClockSync.Clear();
 
 			if (mTimeToSendCharacterCreation != 0) {
 				mTimeToSendCharacterCreation = min(pTime + 2000, mTimeToSendCharacterCreation);
@@ -1049,6 +1102,57 @@ namespace HoverRace {
 
 		}
 
+		/**
+		 * Ask the server for its current time.  The server answers with an
+		 * MRNM_CLOCK_PONG, which is handled by AddClockSample().
+		 */
+		void NetworkSession::SendClockPing()
+		{
+			NetMessageBuffer lMessage;
+
+			mLastClockPingTime = timeGetTime();
+
+			lMessage.mMessageType = MRNM_CLOCK_PING;
+			lMessage.mDataLen = 4;
+			*(MR_Int32*)&(lMessage.mData[0]) = mLastClockPingTime;
+
+			mNetInterface.UDPSend(0, &lMessage, TRUE, FALSE);
+		}
+
+		/**
+		 * Update the clock offset estimate with the server's answer to a ping,
+		 * then steer our simulation time toward the server's.
+		 *
+		 * The offset is kept relative to the wall clock rather than to the
+		 * simulation time, since the latter is what we are correcting.
+		 *
+		 * @param pPingTime Our wall clock when the ping was sent
+		 * @param pServerTime The server's simulation time when it answered
+		 */
+		void NetworkSession::AddClockSample(DWORD pPingTime, MR_SimulationTime pServerTime)
+		{
+			DWORD lNow = timeGetTime();
+			int lRtt = lNow - pPingTime;
+
+			if (lRtt < 0 || lRtt > 10000) {
+				return; // answer to a ping from before a wrap or a reset
+			}
+
+			if (!mClockSync.AddSample(lRtt, pServerTime + lRtt / 2 - (MR_Int32)lNow, lNow)) {
+				return;
+			}
+
+			MR_SimulationTime lServerTime = (MR_Int32)lNow + mClockSync.GetOffset(lNow);
+			MR_SimulationTime lError = lServerTime - mSession.GetSimulationTime();
+
+			if (lError > MR_CLOCK_MAX_SLEW || lError < -MR_CLOCK_MAX_SLEW) {
+				mSession.SetSimulationTime(lServerTime);
+			}
+			else {
+				mSession.SlewSimulationTime(lError);
+			}
+		}
+
 		/**
 		 * Broadcast the state of our hovercraft to all other clients.  Uses the
 		 * MRNM_SET_MAIN_ELEM_STATE message.
@@ -1229,7 +1333,7 @@ namespace HoverRace {
 			lStats->mBestLap = pBestLap;
 			lStats->mCompletedLaps = pNbLaps;
 
-			mNetInterface.BroadcastMessage(&lMessage, MR_NET_REQUIRED);
+			mNetInterface.BroadcastMessage(&lMessage, MR_NET_REQUIRED, MR_NET_STREAM_STATS);
 
 			// Add local time
 			AddResultEntry(-1, pFinishTime, pBestLap, pNbLaps);
@@ -1251,7 +1355,7 @@ namespace HoverRace {
 			if (lMessage.mDataLen > 0) {
 				memcpy(lMessage.mData, pMessage, lMessage.mDataLen);
 
-				mNetInterface.BroadcastMessage(&lMessage, MR_NET_REQUIRED);
+				mNetInterface.BroadcastMessage(&lMessage, MR_NET_REQUIRED, MR_NET_STREAM_CHAT);
 
 				// Add locally
 				AddChatMessage(-1, pMessage, lMessage.mDataLen);
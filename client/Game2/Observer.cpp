@@ -1155,39 +1155,71 @@ void Observer::RenderNormalDisplay(VideoServices::VideoBuffer * pDest, const Cli
 	}
 }
 
-void Observer::PlaySounds(const Model::Level * pLevel, MainCharacter::MainCharacter * pViewingCharacter)
+/**
+ * Play the sounds of the elements within earshot of a room.
+ * @param pLevel The level.
+ * @param pRoom The room containing the elements.
+ * @param pViewingCharacter The listener.
+ * @param pDBOffset Extra attenuation (in hundredths of dB) of the sounds
+ *                  coming from the room.
+ */
+static void PlayRoomSounds(const Model::Level *pLevel, int pRoom, MainCharacter::MainCharacter *pViewingCharacter, int pDBOffset)
 {
-	// Play the sound of all moving elemnts arround
+	// Below this, the sound server would play the sound silently anyway.
+	static const int SILENT_DB = -10000;
 
-	int lCurrentRoom = pViewingCharacter->mRoom;
-	int lNeighborCount = pLevel->GetRoomVertexCount(lCurrentRoom);
+	MR_FreeElementHandle lHandle = pLevel->GetFirstFreeElement(pRoom);
 
-	for(int lCounter = -1; lCounter < lNeighborCount; lCounter++) {
-		int lRoomId;
+	while(lHandle != NULL) {
+		Model::FreeElement *lElement = Model::Level::GetFreeElement(lHandle);
 
-		if(lCounter == -1) {
-			lRoomId = lCurrentRoom;
-		}
-		else {
-			lRoomId = pLevel->GetNeighbor(lCurrentRoom, lCounter);
+		if(lElement != pViewingCharacter) {
+			double lXDist = pViewingCharacter->mPosition.mX - lElement->mPosition.mX;
+			double lYDist = pViewingCharacter->mPosition.mY - lElement->mPosition.mY;
+
+			int lDB = (int)(-sqrt(lXDist * lXDist + lYDist * lYDist) / 15.0) + pDBOffset;
+
+			if(lDB > SILENT_DB) {
+				lElement->PlayExternalSounds(lDB, 0);
+			}
 		}
 
-		if(lRoomId != -1) {
-			MR_FreeElementHandle lHandle = pLevel->GetFirstFreeElement(lRoomId);
+		lHandle = Model::Level::GetNextFreeElement(lHandle);
+	}
+}
 
-			while(lHandle != NULL) {
-				Model::FreeElement *lElement = Model::Level::GetFreeElement(lHandle);
+void Observer::PlaySounds(const Model::Level * pLevel, MainCharacter::MainCharacter * pViewingCharacter)
+{
+	// Play the sound of all moving elemnts arround
 
-				if(lElement != pViewingCharacter) {
-					double lXDist = pViewingCharacter->mPosition.mX - lElement->mPosition.mX;
-					double lYDist = pViewingCharacter->mPosition.mY - lElement->mPosition.mY;
+	int lCurrentRoom = pViewingCharacter->mRoom;
+	int lNbAudibleRoom = pLevel->GetAudibleRoomCount(lCurrentRoom);
+	int lCoefficient;
 
-					int lDB = (int)(-sqrt(lXDist * lXDist + lYDist * lYDist) / 15.0);
+	PlayRoomSounds(pLevel, lCurrentRoom, pViewingCharacter, 0);
 
-					lElement->PlayExternalSounds(lDB, 0);
-				}
+	if(lNbAudibleRoom > 0 && pLevel->GetAudibleRoom(lCurrentRoom, 0, lCoefficient) != -1) {
+		// Only the rooms the compiler found to be within earshot, attenuated
+		// by how far the sound has to travel to get here.
+		for(int lCounter = 0; lCounter < lNbAudibleRoom; lCounter++) {
+			int lRoomId = pLevel->GetAudibleRoom(lCurrentRoom, lCounter, lCoefficient);
+
+			if(lRoomId != -1 && lCoefficient > 0) {
+				int lDBOffset = (int)(2000.0 * log10(lCoefficient / 255.0));
+				PlayRoomSounds(pLevel, lRoomId, pViewingCharacter, lDBOffset);
+			}
+		}
+	}
+	else {
+		// No sound propagation information (older tracks); just listen to
+		// the neighboring rooms.
+		int lNeighborCount = pLevel->GetRoomVertexCount(lCurrentRoom);
+
+		for(int lCounter = 0; lCounter < lNeighborCount; lCounter++) {
+			int lRoomId = pLevel->GetNeighbor(lCurrentRoom, lCounter);
 
-				lHandle = Model::Level::GetNextFreeElement(lHandle);
+			if(lRoomId != -1) {
+				PlayRoomSounds(pLevel, lRoomId, pViewingCharacter, 0);
 			}
 		}
 	}
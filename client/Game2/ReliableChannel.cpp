@@ -0,0 +1,383 @@
+// ReliableChannel.cpp
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include "ReliableChannel.h"
+
+// Packet layout:
+//   0  UInt16 sequence number
+//   2  UInt16 most recent sequence number received from the peer
+//   4  UInt32 bitfield of the 32 sequence numbers before that one
+//   8  UInt8  stream number, or MR_RELIABLE_ACK_ONLY
+//   9  UInt16 sequence number within the stream
+//  11  payload
+#define MR_RELIABLE_ACK_ONLY	0xFF
+
+#define MR_RELIABLE_INITIAL_RTO	200
+#define MR_RELIABLE_MIN_RTO		30
+#define MR_RELIABLE_MAX_RTO		2000
+
+namespace HoverRace {
+namespace Client {
+
+namespace {
+	// Is sequence number a more recent than b?
+	inline bool SeqNewer(MR_UInt16 a, MR_UInt16 b)
+	{
+		return (MR_Int16) (MR_UInt16) (a - b) > 0;
+	}
+}
+
+ReliableChannel::ReliableChannel()
+{
+	Reset();
+}
+
+/**
+ * Drop all queued, in-flight and undelivered messages and start over.
+ */
+void ReliableChannel::Reset()
+{
+	mSendSeq = 0;
+	mBacklog.clear();
+
+	mRecvAny = false;
+	mRecvAck = 0;
+	mRecvAckBits = 0;
+	mAckPending = false;
+	mNextFetchStream = 0;
+
+	for(int lStream = 0; lStream < eNbStreams; lStream++) {
+		mStreamSendSeq[lStream] = 0;
+		mStreamRecvSeq[lStream] = 0;
+
+		for(int lCounter = 0; lCounter < eWindow; lCounter++) {
+			mRecvSlot[lStream][lCounter].mValid = false;
+		}
+	}
+
+	for(int lCounter = 0; lCounter < eWindow; lCounter++) {
+		mSent[lCounter].mInUse = false;
+	}
+
+	mSRtt = 0;
+	mRttVar = 0;
+	mRto = MR_RELIABLE_INITIAL_RTO;
+}
+
+/**
+ * Queue a message for reliable delivery.
+ *
+ * @param pStream The stream to deliver it on (0 to eNbStreams-1)
+ * @param pData The message
+ * @param pLen Length of the message (1 to eMaxPayload)
+ * @return @c false if too many messages are already waiting (the peer has
+ *         probably stopped answering).
+ */
+bool ReliableChannel::Queue(int pStream, const MR_UInt8 *pData, int pLen)
+{
+	ASSERT((pStream >= 0) && (pStream < eNbStreams));
+	ASSERT((pLen > 0) && (pLen <= eMaxPayload));
+
+	if(mBacklog.size() >= eMaxBacklog) {
+		return false;
+	}
+
+	mBacklog.push_back(Message());
+
+	Message &lMessage = mBacklog.back();
+	lMessage.mStream = pStream;
+	lMessage.mLen = pLen;
+	memcpy(lMessage.mData, pData, pLen);
+
+	return true;
+}
+
+/**
+ * Get the next packet to transmit, if any.
+ * This should be called repeatedly until it returns 0, and then again
+ * regularly so that lost packets get resent and acknowledgements go out.
+ *
+ * @param pTime The current time, in ms
+ * @param pBuffer Buffer for the packet (at least eHeaderLen + eMaxPayload)
+ * @return The length of the packet, or 0 if there is nothing to send.
+ */
+int ReliableChannel::GetNextPacket(MR_UInt32 pTime, MR_UInt8 *pBuffer)
+{
+	// Move waiting messages into the window while there is room
+	while(!mBacklog.empty() && !mSent[mSendSeq % eWindow].mInUse) {
+		Packet &lPacket = mSent[mSendSeq % eWindow];
+		const Message &lMessage = mBacklog.front();
+
+		lPacket.mInUse = true;
+		lPacket.mSeq = mSendSeq;
+		lPacket.mStreamSeq = mStreamSendSeq[lMessage.mStream]++;
+		lPacket.mNbSend = 0;
+		lPacket.mMessage = lMessage;
+
+		mBacklog.pop_front();
+		mSendSeq++;
+	}
+
+	// Send new packets, and resend the ones that timed out, oldest first
+	for(int lCounter = eWindow; lCounter > 0; lCounter--) {
+		MR_UInt16 lSeq = mSendSeq - lCounter;
+		Packet &lPacket = mSent[lSeq % eWindow];
+
+		if(!lPacket.mInUse || lPacket.mSeq != lSeq) {
+			continue;
+		}
+
+		if(lPacket.mNbSend > 0) {
+			// Back off exponentially on repeated losses
+			int lTimeout = min(mRto << min(lPacket.mNbSend - 1, 4), MR_RELIABLE_MAX_RTO);
+
+			if((int) (pTime - lPacket.mLastSendTime) < lTimeout) {
+				continue;
+			}
+			TRACE("Reliable resend %d (%d)\n", lSeq, lPacket.mNbSend);
+		}
+		else {
+			lPacket.mFirstSendTime = pTime;
+		}
+
+		lPacket.mLastSendTime = pTime;
+		lPacket.mNbSend++;
+
+		return WritePacket(pBuffer, lSeq, &lPacket);
+	}
+
+	if(mAckPending) {
+		return WritePacket(pBuffer, mSendSeq, NULL);
+	}
+
+	return 0;
+}
+
+/**
+ * Process a packet received from the peer.
+ *
+ * @param pTime The current time, in ms
+ * @param pPacket The packet
+ * @param pLen Length of the packet
+ */
+void ReliableChannel::Receive(MR_UInt32 pTime, const MR_UInt8 *pPacket, int pLen)
+{
+	if(pLen < eHeaderLen) {
+		return;
+	}
+
+	MR_UInt16 lSeq = *(const MR_UInt16 *) &(pPacket[0]);
+	int lStream = pPacket[8];
+	MR_UInt16 lStreamSeq = *(const MR_UInt16 *) &(pPacket[9]);
+
+	Acknowledge(pTime, *(const MR_UInt16 *) &(pPacket[2]), *(const MR_UInt32 *) &(pPacket[4]));
+
+	if(lStream == MR_RELIABLE_ACK_ONLY || lStream >= eNbStreams || pLen == eHeaderLen) {
+		return;
+	}
+
+	// Remember we got this one, so it gets acknowledged (again, if it is a
+	// duplicate: our previous acknowledgement may have been lost)
+	if(!mRecvAny) {
+		mRecvAny = true;
+		mRecvAck = lSeq;
+		mRecvAckBits = 0;
+	}
+	else if(SeqNewer(lSeq, mRecvAck)) {
+		int lShift = (MR_UInt16) (lSeq - mRecvAck);
+
+		mRecvAckBits = (lShift >= 32) ? 0 : (mRecvAckBits << lShift);
+		if(lShift <= 32) {
+			mRecvAckBits |= 1u << (lShift - 1);
+		}
+		mRecvAck = lSeq;
+	}
+	else if(lSeq != mRecvAck) {
+		int lAge = (MR_UInt16) (mRecvAck - lSeq);
+
+		if(lAge <= 32) {
+			mRecvAckBits |= 1u << (lAge - 1);
+		}
+	}
+	mAckPending = true;
+
+	// Hold the message until everything before it in its stream arrived
+	MR_Int16 lAhead = (MR_Int16) (MR_UInt16) (lStreamSeq - mStreamRecvSeq[lStream]);
+
+	if(lAhead >= 0 && lAhead < eWindow) {
+		Slot &lSlot = mRecvSlot[lStream][lStreamSeq % eWindow];
+
+		if(!lSlot.mValid) {
+			lSlot.mValid = true;
+			lSlot.mLen = pLen - eHeaderLen;
+			memcpy(lSlot.mData, pPacket + eHeaderLen, lSlot.mLen);
+		}
+	}
+}
+
+/**
+ * Retrieve the next message that is ready for delivery.
+ *
+ * @param pBuffer Buffer for the message (at least eMaxPayload)
+ * @param pStream If not @c NULL, set to the stream the message was sent on
+ * @return The length of the message, or 0 if none is ready.
+ */
+int ReliableChannel::Fetch(MR_UInt8 *pBuffer, int *pStream)
+{
+	for(int lCounter = 0; lCounter < eNbStreams; lCounter++) {
+		int lStream = (mNextFetchStream + lCounter) % eNbStreams;
+		Slot &lSlot = mRecvSlot[lStream][mStreamRecvSeq[lStream] % eWindow];
+
+		if(lSlot.mValid) {
+			lSlot.mValid = false;
+			mStreamRecvSeq[lStream]++;
+
+			// Take turns so that a busy stream does not starve the others
+			mNextFetchStream = (lStream + 1) % eNbStreams;
+
+			if(pStream != NULL) {
+				*pStream = lStream;
+			}
+			memcpy(pBuffer, lSlot.mData, lSlot.mLen);
+			return lSlot.mLen;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Number of packets sent but not yet acknowledged.
+ */
+int ReliableChannel::GetNbUnacked() const
+{
+	int lReturnValue = 0;
+
+	for(int lCounter = 0; lCounter < eWindow; lCounter++) {
+		if(mSent[lCounter].mInUse) {
+			lReturnValue++;
+		}
+	}
+	return lReturnValue;
+}
+
+/**
+ * Number of messages waiting for a free slot in the send window.
+ */
+int ReliableChannel::GetBacklogLen() const
+{
+	return (int)mBacklog.size();
+}
+
+/**
+ * Current retransmit timeout, in ms.
+ */
+int ReliableChannel::GetRetransmitTimeout() const
+{
+	return mRto;
+}
+
+/**
+ * Release the packets the peer has acknowledged.
+ *
+ * @param pTime The current time, in ms
+ * @param pAck Most recent sequence number received by the peer
+ * @param pAckBits Bitfield of the 32 before it
+ */
+void ReliableChannel::Acknowledge(MR_UInt32 pTime, MR_UInt16 pAck, MR_UInt32 pAckBits)
+{
+	for(int lCounter = 0; lCounter < eWindow; lCounter++) {
+		Packet &lPacket = mSent[lCounter];
+
+		if(!lPacket.mInUse || lPacket.mNbSend == 0) {
+			continue;
+		}
+
+		int lAge = (MR_UInt16) (pAck - lPacket.mSeq);
+
+		if((lAge == 0) || ((lAge <= 32) && (pAckBits & (1u << (lAge - 1))))) {
+			// Karn's rule: the RTT of a resent packet is ambiguous
+			if(lPacket.mNbSend == 1) {
+				AddRttSample(pTime - lPacket.mFirstSendTime);
+			}
+			lPacket.mInUse = false;
+		}
+	}
+}
+
+/**
+ * Update the retransmit timeout (Jacobson/Karels).
+ *
+ * @param pRtt Measured round-trip time, in ms
+ */
+void ReliableChannel::AddRttSample(int pRtt)
+{
+	if(mSRtt == 0) {
+		mSRtt = pRtt;
+		mRttVar = pRtt / 2;
+	}
+	else {
+		int lErr = pRtt - mSRtt;
+
+		mSRtt += lErr / 8;
+		mRttVar += (abs(lErr) - mRttVar) / 4;
+	}
+
+	mRto = max(MR_RELIABLE_MIN_RTO, min(mSRtt + 4 * mRttVar, MR_RELIABLE_MAX_RTO));
+}
+
+/**
+ * Write a packet, with the latest acknowledgement information.
+ *
+ * @param pBuffer Destination
+ * @param pSeq Sequence number of the packet
+ * @param pPacket The packet, or @c NULL for an acknowledgement only
+ * @return The length of the packet.
+ */
+int ReliableChannel::WritePacket(MR_UInt8 *pBuffer, MR_UInt16 pSeq, const Packet *pPacket)
+{
+	*(MR_UInt16 *) &(pBuffer[0]) = pSeq;
+	*(MR_UInt16 *) &(pBuffer[2]) = mRecvAck;
+	*(MR_UInt32 *) &(pBuffer[4]) = mRecvAny ? mRecvAckBits : 0;
+
+	// Until we have received anything, acknowledge a sequence number the
+	// peer cannot have in flight
+	if(!mRecvAny) {
+		*(MR_UInt16 *) &(pBuffer[2]) = 0x8000;
+	}
+
+	mAckPending = false;
+
+	if(pPacket == NULL) {
+		pBuffer[8] = MR_RELIABLE_ACK_ONLY;
+		*(MR_UInt16 *) &(pBuffer[9]) = 0;
+		return eHeaderLen;
+	}
+
+	pBuffer[8] = pPacket->mMessage.mStream;
+	*(MR_UInt16 *) &(pBuffer[9]) = pPacket->mStreamSeq;
+	memcpy(pBuffer + eHeaderLen, pPacket->mMessage.mData, pPacket->mMessage.mLen);
+
+	return eHeaderLen + pPacket->mMessage.mLen;
+}
+
+}  // namespace Client
+}  // namespace HoverRace
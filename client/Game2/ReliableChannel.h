@@ -0,0 +1,123 @@
+// ReliableChannel.h
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <deque>
+
+#include "../../engine/Util/MR_Types.h"
+
+namespace HoverRace {
+namespace Client {
+
+/**
+ * Reliable, ordered delivery of small messages over an unreliable transport.
+ *
+ * Every packet carries a sequence number plus an acknowledgement of the most
+ * recent packet received from the peer and a bitfield of the 32 before it,
+ * so a single packet getting through is enough to acknowledge everything that
+ * arrived so far.  Only packets that were not acknowledged are resent.
+ *
+ * Messages are sent on one of several streams.  Each stream is delivered in
+ * order, but independently of the others, so a lost chat message does not hold
+ * up a hit message.
+ *
+ * The channel does no I/O itself: the caller transmits what GetNextPacket()
+ * returns and feeds whatever it receives to Receive().
+ */
+class ReliableChannel
+{
+	public:
+		enum {
+			eNbStreams = 4,
+			eWindow = 32,		  /// max packets in flight; must fit the ack bitfield
+			eHeaderLen = 11,
+			eMaxPayload = 244,	  /// so a packet fits in a NetMessageBuffer
+			eMaxBacklog = 256	  /// messages waiting for room in the window
+		};
+
+	private:
+		struct Message
+		{
+			MR_UInt8 mStream;
+			MR_UInt8 mLen;
+			MR_UInt8 mData[eMaxPayload];
+		};
+
+		struct Packet
+		{
+			bool mInUse;
+			MR_UInt16 mSeq;
+			MR_UInt16 mStreamSeq;
+			MR_UInt32 mFirstSendTime;
+			MR_UInt32 mLastSendTime;
+			int mNbSend;
+			Message mMessage;
+		};
+
+		struct Slot
+		{
+			bool mValid;
+			MR_UInt8 mLen;
+			MR_UInt8 mData[eMaxPayload];
+		};
+
+		// Sending side
+		MR_UInt16 mSendSeq;						  /// sequence number of the next new packet
+		MR_UInt16 mStreamSendSeq[eNbStreams];
+		Packet mSent[eWindow];					  /// indexed by sequence number
+		std::deque<Message> mBacklog;
+
+		// Receiving side
+		bool mRecvAny;
+		MR_UInt16 mRecvAck;						  /// most recent sequence number received
+		MR_UInt32 mRecvAckBits;					  /// bit n set if mRecvAck-n-1 was received
+		bool mAckPending;
+		MR_UInt16 mStreamRecvSeq[eNbStreams];	  /// next sequence number expected per stream
+		Slot mRecvSlot[eNbStreams][eWindow];
+		int mNextFetchStream;
+
+		// Retransmit timing
+		int mSRtt;
+		int mRttVar;
+		int mRto;
+
+		void Acknowledge(MR_UInt32 pTime, MR_UInt16 pAck, MR_UInt32 pAckBits);
+		void AddRttSample(int pRtt);
+		int WritePacket(MR_UInt8 *pBuffer, MR_UInt16 pSeq, const Packet *pPacket);
+
+	public:
+		ReliableChannel();
+
+		void Reset();
+
+		bool Queue(int pStream, const MR_UInt8 *pData, int pLen);
+		int GetNextPacket(MR_UInt32 pTime, MR_UInt8 *pBuffer);
+
+		void Receive(MR_UInt32 pTime, const MR_UInt8 *pPacket, int pLen);
+		int Fetch(MR_UInt8 *pBuffer, int *pStream = NULL);
+
+		int GetNbUnacked() const;
+		int GetBacklogLen() const;
+		int GetRetransmitTimeout() const;
+};
+
+}  // namespace Client
+}  // namespace HoverRace
@@ -32,6 +32,9 @@ using namespace HoverRace;
 using namespace HoverRace::Client;
 using HoverRace::Util::OS;
 
+// The room list is a few KB; anything this big is not a room list.
+#define MAX_LIST_SIZE (256 * 1024)
+
 RoomList::RoomList() :
 	selectedRoom(NULL), curBanner(NULL), curBannerIdx(0)
 {
@@ -62,7 +65,7 @@ RoomList::~RoomList()
 void RoomList::LoadFromUrl(const std::string &url, Net::CancelFlagPtr cancelFlag)
 {
 	Net::Agent agent(url);
-	//TODO: Set max size.
+	agent.SetMaxSize(MAX_LIST_SIZE);
 
 	std::stringstream io;
 	agent.Get(io, cancelFlag);
@@ -26,8 +26,6 @@
 
 #include "resource.h"
 
-#include <curl/curl.h>
-
 #include <LiteUnzip.h>
 
 #include <boost/bind.hpp>
@@ -35,6 +33,8 @@
 
 #include <io.h>
 
+#include "../../engine/Net/ChunkedDownload.h"
+#include "../../engine/Net/NetExn.h"
 #include "../../engine/Util/Config.h"
 #include "../../engine/Util/Str.h"
 
@@ -45,11 +45,32 @@ using HoverRace::Util::Config;
 
 using namespace HoverRace::Util;
 
-#define INIT_CAPACITY (5 * 1024 * 1024)
+namespace fs = boost::filesystem;
+
 #define MAX_CAPACITY (20 * 1024 * 1024)
 
 #define TRACK_HOST "http://www.hoverrace.com/"
 
+namespace {
+	/// Escape a string for use in a URL query parameter.
+	std::string UrlEscape(const std::string &s)
+	{
+		static const char *HEX = "0123456789ABCDEF";
+		std::string retv;
+		for (std::string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+			unsigned char c = static_cast<unsigned char>(*iter);
+			if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+				retv += c;
+			} else {
+				retv += '%';
+				retv += HEX[c >> 4];
+				retv += HEX[c & 15];
+			}
+		}
+		return retv;
+	}
+}
+
 namespace HoverRace {
 namespace Client {
 
@@ -58,24 +79,45 @@ namespace Client {
  * @param name The name of the track (no ".trk" extension, may not be blank).
  */
 TrackDownloadDialog::TrackDownloadDialog(const std::string &name) :
-	name(name), trackFilename(name), dlgHwnd(NULL), state(ST_INITIALIZING),
-	bufSize(0), bufCapacity(INIT_CAPACITY)
+	name(name), dlgHwnd(NULL), state(ST_INITIALIZING)
 {
-	trackFilename += ".trk";
-	trackDl = curl_easy_init();
-
-	curlErrorBuf = new char[CURL_ERROR_SIZE];
-	curlErrorBuf[0] = 0;
+	AddDownload(name);
+}
 
-	dlBuf = (dlBuf_t *) malloc(INIT_CAPACITY * sizeof(dlBuf_t));
+/**
+ * Constructor for downloading several tracks at once.
+ * The downloads run in parallel (and share connections to the server).
+ * @param names The names of the tracks (no ".trk" extension, may not be blank).
+ */
+TrackDownloadDialog::TrackDownloadDialog(const std::vector<std::string> &names) :
+	dlgHwnd(NULL), state(ST_INITIALIZING)
+{
+	for (std::vector<std::string>::const_iterator iter = names.begin();
+		iter != names.end(); ++iter)
+	{
+		if (!name.empty()) name += ", ";
+		name += *iter;
+		AddDownload(*iter);
+	}
 }
 
 /// Destructor.
 TrackDownloadDialog::~TrackDownloadDialog()
 {
-	free(dlBuf);
-	delete[] curlErrorBuf;
-	curl_easy_cleanup(trackDl);
+}
+
+void TrackDownloadDialog::AddDownload(const std::string &name)
+{
+	const OS::path_t &trackPath = Config::GetInstance()->GetUserTrackPath();
+
+	DownloadPtr dl(new Download());
+	dl->name = name;
+	dl->trackFilename = name + ".trk";
+	dl->dlPath = trackPath / Str::UP(dl->trackFilename + ".download");
+	dl->partPath = trackPath / Str::UP(dl->trackFilename + ".download.part");
+	dl->bytesNow = 0;
+	dl->bytesTotal = 0;
+	downloads.push_back(dl);
 }
 
 /**
@@ -91,9 +133,7 @@ TrackDownloadDialog::~TrackDownloadDialog()
  */
 bool TrackDownloadDialog::ShowModal(HINSTANCE hinst, HWND parent)
 {
-	bufSize = 0;
-	bufTotal = 0;
-	cancel = false;
+	cancelFlag.reset(new Net::ManualCancelFlag());
 
 	// Ask to download the track.
 	std::string msg =
@@ -107,11 +147,11 @@ bool TrackDownloadDialog::ShowModal(HINSTANCE hinst, HWND parent)
 
 	DWORD dlgRetv = DialogBoxParamW(hinst, MAKEINTRESOURCEW(IDD_DOWNLOAD_PROGRESS),
 		parent, DlgFunc, reinterpret_cast<LPARAM>(this));
-	if (dlgRetv == IDCANCEL) cancel = true;
+	if (dlgRetv == IDCANCEL) cancelFlag->Cancel();
 
 	thread.join();
 
-	return !cancel;
+	return !cancelFlag->IsCanceled();
 }
 
 const char **TrackDownloadDialog::GetStateNames()
@@ -143,8 +183,20 @@ void TrackDownloadDialog::SetState(state_t st)
 void TrackDownloadDialog::UpdateDialogProgress(HWND hwnd)
 {
 	state_t curState = state;
-	size_t curTotal = bufTotal;
-	size_t curSize = bufSize;
+
+	// The total is only known once every download has reported its size.
+	size_t curTotal = 0;
+	size_t curSize = 0;
+	bool totalKnown = true;
+	for (downloads_t::iterator iter = downloads.begin();
+		iter != downloads.end(); ++iter)
+	{
+		const Download &dl = **iter;
+		curSize += dl.bytesNow;
+		curTotal += dl.bytesTotal;
+		if (dl.bytesTotal == 0) totalKnown = false;
+	}
+	if (!totalKnown) curTotal = 0;
 
 	// Update progress bar.
 	int pos;
@@ -195,59 +247,52 @@ void TrackDownloadDialog::UpdateDialogProgress(HWND hwnd)
 // Thread function.
 void TrackDownloadDialog::ThreadProc()
 {
-	Config *cfg = Config::GetInstance();
-
 	SetState(ST_INITIALIZING);
-
-	// Error buffer.
-	curl_easy_setopt(trackDl, CURLOPT_ERRORBUFFER, curlErrorBuf);
-
-	// Callback functions.
-	curl_easy_setopt(trackDl, CURLOPT_WRITEFUNCTION, WriteFunc);
-	curl_easy_setopt(trackDl, CURLOPT_WRITEDATA, this);
-	curl_easy_setopt(trackDl, CURLOPT_PROGRESSFUNCTION, ProgressFunc);
-	curl_easy_setopt(trackDl, CURLOPT_PROGRESSDATA, this);
-	curl_easy_setopt(trackDl, CURLOPT_NOPROGRESS, 0);
-
-	// Misc HTTP options.
-	curl_easy_setopt(trackDl, CURLOPT_FOLLOWLOCATION, 1);
-	curl_easy_setopt(trackDl, CURLOPT_FAILONERROR, 1);
-	/* Enabling content encoding makes the Content-Length not work currently.
-	curl_easy_setopt(trackDl, CURLOPT_ENCODING, "");  // Enable all encodings.
-	curl_easy_setopt(trackDl, CURLOPT_HTTP_CONTENT_DECODING, 1);
-	*/
-	curl_easy_setopt(trackDl, CURLOPT_USERAGENT, cfg->GetUserAgentId().c_str());
-
-	std::string url(TRACK_HOST "tracks/download.php?name=");
-	char *param = curl_easy_escape(trackDl, name.c_str(), name.length());
-	url += param;
-	curl_free(param);
-	curl_easy_setopt(trackDl, CURLOPT_URL, url.c_str());
-
-	if (!cancel) {
-		SetState(ST_DOWNLOADING);
-		int curlRetv = curl_easy_perform(trackDl);
-		if (curlRetv != 0 && curlRetv != CURLE_ABORTED_BY_CALLBACK) {
-			MessageBoxW(dlgHwnd, Str::UW(curlErrorBuf), PACKAGE_NAME_L, MB_ICONWARNING | MB_OK);
-			cancel = true;
+	SetState(ST_DOWNLOADING);
+
+	// Run all of the downloads at once; the transfer pool runs them in
+	// parallel over as few connections as possible.
+	boost::thread_group threads;
+	for (downloads_t::iterator iter = downloads.begin();
+		iter != downloads.end(); ++iter)
+	{
+		threads.create_thread(boost::bind(&TrackDownloadDialog::DownloadProc, this, iter->get()));
+	}
+	threads.join_all();
+
+	for (downloads_t::iterator iter = downloads.begin();
+		iter != downloads.end(); ++iter)
+	{
+		const Download &dl = **iter;
+		if (!dl.error.empty() && !cancelFlag->IsCanceled()) {
+			cancelFlag->Cancel();
+			MessageBoxW(dlgHwnd, Str::UW(dl.error.c_str()), PACKAGE_NAME_L, MB_ICONWARNING | MB_OK);
 		}
 	}
 
-	if (!cancel) {
+	if (!cancelFlag->IsCanceled()) {
 		SetState(ST_EXTRACTING);
 
-		if (bufSize <= 128) {
-			std::string message = boost::str(boost::format(
-				_("Sorry, track \"%s\" is not available from %s")) % name % TRACK_HOST);
-			MessageBoxW(dlgHwnd, Str::UW(message.c_str()), PACKAGE_NAME_L, MB_ICONINFORMATION | MB_OK);
-			cancel = true;
-		} else {
-			if (!ExtractTrackFile()) {
+		for (downloads_t::iterator iter = downloads.begin();
+			iter != downloads.end(); ++iter)
+		{
+			const Download &dl = **iter;
+
+			if (fs::file_size(dl.dlPath) <= 128) {
+				fs::remove(dl.dlPath);
 				std::string message = boost::str(boost::format(
-					_("Track download failed: The file \"%s\" was not found in the archive downloaded from %s")) %
-					trackFilename %
-					TRACK_HOST);
-				MessageBoxW(dlgHwnd, Str::UW(message.c_str()), PACKAGE_NAME_L, MB_ICONWARNING | MB_OK);
+					_("Sorry, track \"%s\" is not available from %s")) % dl.name % TRACK_HOST);
+				MessageBoxW(dlgHwnd, Str::UW(message.c_str()), PACKAGE_NAME_L, MB_ICONINFORMATION | MB_OK);
+				cancelFlag->Cancel();
+				break;
+			} else {
+				if (!ExtractTrackFile(dl)) {
+					std::string message = boost::str(boost::format(
+						_("Track download failed: The file \"%s\" was not found in the archive downloaded from %s")) %
+						dl.trackFilename %
+						TRACK_HOST);
+					MessageBoxW(dlgHwnd, Str::UW(message.c_str()), PACKAGE_NAME_L, MB_ICONWARNING | MB_OK);
+				}
 			}
 		}
 	}
@@ -282,7 +327,7 @@ BOOL TrackDownloadDialog::DlgProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM
 		case WM_COMMAND:
 			switch (LOWORD(wparam)) {
 				case IDCANCEL:
-					cancel = true;
+					cancelFlag->Cancel();
 					EndDialog(hwnd, IDCANCEL);
 					retv = TRUE;
 					break;
@@ -315,99 +360,103 @@ BOOL CALLBACK TrackDownloadDialog::DlgFunc(HWND hwnd, UINT message, WPARAM wpara
 	return (dlg == NULL) ? FALSE : dlg->DlgProc(hwnd, message, wparam, lparam);
 }
 
-/// Write callback for libcurl.
-size_t TrackDownloadDialog::WriteProc(void *ptr, size_t size, size_t nmemb)
+/**
+ * Download a single track file.
+ * Called from a worker thread for each download.
+ * @param dl The download.
+ */
+void TrackDownloadDialog::DownloadProc(Download *dl)
 {
-	// Add to buffer.
-
-	size_t bytesToAdd = size * nmemb;  // We trust that this won't overflow.
-	if (bufSize + bytesToAdd > bufCapacity) {
-		while (bufSize + bytesToAdd > bufCapacity) bufCapacity *= 2;
-
-		// If we've downloaded this much but haven't gotten a Content-Length,
-		// then chances are we're just endlessly streaming junk and wasting
-		// precious bandwidth.
-		if (bufTotal <= 0 && bufCapacity > MAX_CAPACITY) {
-			std::string message = boost::str(boost::format(
-				_("There was a problem downloading the track from %s\n"
-				  "Please visit %s and download the track manually.")) %
-				  TRACK_HOST %
-				  TRACK_HOST);
-			MessageBoxW(dlgHwnd, Str::UW(message.c_str()), PACKAGE_NAME_L, MB_OK);
-			return 0;
-		}
-
-		dlBuf = (dlBuf_t *) realloc(dlBuf, bufCapacity * sizeof(dlBuf_t));
+	std::string url = TRACK_HOST "tracks/download.php?name=" + UrlEscape(dl->name);
+	std::string manifestUrl = TRACK_HOST "tracks/manifest.php?name=" + UrlEscape(dl->name);
+
+	try {
+		Net::ChunkedDownload xfer(url, manifestUrl, dl->dlPath, dl->partPath);
+		xfer.SetMaxSize(MAX_CAPACITY);
+		xfer.Go(cancelFlag,
+			boost::bind(&TrackDownloadDialog::OnProgress, this, dl, _1, _2));
+	}
+	catch (Net::CanceledExn&) {
+		// Canceled by the user or because another download failed.
+		// The partial file is kept so the next attempt can resume.
+	}
+	catch (Net::NetExn &ex) {
+		dl->error = ex.what();
+		cancelFlag->Cancel();
 	}
-
-	memcpy(dlBuf + bufSize, ptr, bytesToAdd);
-	bufSize += bytesToAdd;
-
-	return bytesToAdd;
-}
-
-/// Global write callback dispatcher.
-size_t TrackDownloadDialog::WriteFunc(void *ptr, size_t size, size_t nmemb, void *stream)
-{
-	return reinterpret_cast<TrackDownloadDialog*>(stream)->WriteProc(ptr, size, nmemb);
 }
 
-/// Progress callback for libcurl.
-size_t TrackDownloadDialog::ProgressProc(double dlTotal, double dlNow)
+/**
+ * Progress callback for a download.
+ * Called from the download threads.
+ */
+void TrackDownloadDialog::OnProgress(Download *dl, size_t bytesNow, size_t bytesTotal)
 {
-	bufTotal = static_cast<size_t>(dlTotal);
+	dl->bytesNow = bytesNow;
+	dl->bytesTotal = bytesTotal;
 
 	// Notify dialog of progress change.
 	if (dlgHwnd != NULL) {
 		PostMessage(dlgHwnd, WM_APP, state, 0);
 	}
-
-	return cancel ? 1 : 0;
-}
-
-/// Global progress callback dispatcher.
-size_t TrackDownloadDialog::ProgressFunc(void *clientp, double dlTotal, double dlNow, double, double)
-{
-	return reinterpret_cast<TrackDownloadDialog*>(clientp)->ProgressProc(dlTotal, dlNow);
 }
 
 /**
- * Extracts the track file from the current buffer.
+ * Installs the track file from a finished download.
+ * The track is written to a temporary file first and then renamed into
+ * place, so a failed extraction never leaves a damaged track behind.
+ * @param dl The download.
  * @return @c true if the track extracted successfully, @c false otherwise.
  */
-bool TrackDownloadDialog::ExtractTrackFile()
+bool TrackDownloadDialog::ExtractTrackFile(const Download &dl)
 {
-	OS::path_t destFilename = Config::GetInstance()->GetUserTrackPath(name);
+	OS::path_t destFilename = Config::GetInstance()->GetUserTrackPath(dl.name);
 	bool retv = false;
 
-	if (dlBuf[0] == 0x50 && dlBuf[1] == 0x4b) {
+	unsigned char magic[2] = { 0, 0 };
+	FILE *in = OS::FOpen(dl.dlPath, "rb");
+	if (in != NULL) {
+		fread(magic, 1, 2, in);
+		fclose(in);
+	}
+
+	if (magic[0] == 0x50 && magic[1] == 0x4b) {
 		// Extract from ZIP archive.
+		OS::path_t tmpFilename = Config::GetInstance()->GetUserTrackPath() /
+			Str::UP(dl.trackFilename + ".tmp");
 		HUNZIP huz;
 		ZIPENTRY zent;
 
-		UnzipOpenBuffer(&huz, dlBuf, bufSize, 0);
-
-		memset(&zent, 0, sizeof(zent));
-		lstrcpy(zent.Name, trackFilename.c_str());
-		DWORD unzRetv = UnzipFindItemW(huz, &zent, 1);
+		DWORD unzRetv = UnzipOpenFileW(&huz, Str::PW(dl.dlPath), 0);
 		retv = (unzRetv == ZR_OK);
 
 		if (retv) {
-			unzRetv = UnzipItemToFileW(huz, Str::PW(destFilename), &zent);
+			memset(&zent, 0, sizeof(zent));
+			lstrcpy(zent.Name, dl.trackFilename.c_str());
+			unzRetv = UnzipFindItemW(huz, &zent, 1);
 			retv = (unzRetv == ZR_OK);
+
+			if (retv) {
+				unzRetv = UnzipItemToFileW(huz, Str::PW(tmpFilename), &zent);
+				retv = (unzRetv == ZR_OK);
+			}
+
+			UnzipClose(huz);
 		}
 
-		UnzipClose(huz);
+		if (retv) {
+			retv = OS::RenameReplace(tmpFilename, destFilename);
+		}
+		if (fs::exists(tmpFilename)) fs::remove(tmpFilename);
+		fs::remove(dl.dlPath);
 	}
 	else {
 		// Raw file.
-		FILE *outFile = _wfopen(Str::PW(destFilename), L"wb");
-		if (outFile != NULL) {
-			fwrite(dlBuf, bufSize, 1, outFile);
-			fclose(outFile);
-		}
+		retv = OS::RenameReplace(dl.dlPath, destFilename);
 	}
 
+	if (!retv) return false;
+
 #ifdef _WIN32
 	/* fix modification time and creation time */
 
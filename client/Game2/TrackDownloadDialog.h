@@ -23,8 +23,11 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
-typedef void CURL;
+#include "../../engine/Net/CancelFlag.h"
+#include "../../engine/Net/Transfer.h"
+#include "../../engine/Util/OS.h"
 
 namespace HoverRace {
 namespace Client {
@@ -39,6 +42,7 @@ class TrackDownloadDialog
 		TrackDownloadDialog() { }
 	public:
 		TrackDownloadDialog(const std::string &name);
+		TrackDownloadDialog(const std::vector<std::string> &names);
 		~TrackDownloadDialog();
 
 		bool ShowModal(HINSTANCE hinst, HWND parent);
@@ -60,27 +64,32 @@ class TrackDownloadDialog
 		BOOL DlgProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
 		static BOOL CALLBACK DlgFunc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
 
-		size_t WriteProc(void *ptr, size_t size, size_t nmemb);
-		static size_t WriteFunc(void *ptr, size_t size, size_t nmemb, void *stream);
-		size_t ProgressProc(double dlTotal, double dlNow);
-		static size_t ProgressFunc(void *clientp, double dlTotal, double dlNow, double, double);
+		struct Download
+		{
+			std::string name;
+			std::string trackFilename;
+			Util::OS::path_t dlPath;
+			Util::OS::path_t partPath;
+			std::string error;
+			volatile size_t bytesNow;
+			volatile size_t bytesTotal;
+		};
+		typedef boost::shared_ptr<Download> DownloadPtr;
+
+		void AddDownload(const std::string &name);
+		void DownloadProc(Download *dl);
+		void OnProgress(Download *dl, size_t bytesNow, size_t bytesTotal);
 
-		bool ExtractTrackFile();
+		bool ExtractTrackFile(const Download &dl);
 
 	private:
-		std::string name;
-		std::string trackFilename;
+		std::string name;  ///< Names of all of the tracks (for display).
 		HWND dlgHwnd;
-		CURL *trackDl;
-		char *curlErrorBuf;
 		volatile state_t state;
-		volatile bool cancel;
+		Net::ManualCancelFlagPtr cancelFlag;
 
-		typedef unsigned char dlBuf_t;
-		dlBuf_t *dlBuf;
-		volatile size_t bufSize;
-		size_t bufCapacity;
-		volatile size_t bufTotal;
+		typedef std::vector<DownloadPtr> downloads_t;
+		downloads_t downloads;
 };
 
 }  // namespace Client
@@ -0,0 +1,150 @@
+
+// TrackLoadDialog.cpp
+// Track loading progress dialog.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include "ClientSession.h"
+#include "TrackLoadDialog.h"
+
+#include "resource.h"
+
+#include "../../engine/Util/Str.h"
+
+using namespace HoverRace::Util;
+
+// How often the progress is polled, in ms
+#define POLL_INTERVAL 50
+
+// Loads that finish within this time (ms) don't show the dialog at all
+#define SHOW_DELAY 250
+
+namespace HoverRace {
+namespace Client {
+
+/**
+ * Constructor.
+ * @param session The session that is loading the track
+ *                (ClientSession::StartLoadNew() must have been called).
+ */
+TrackLoadDialog::TrackLoadDialog(ClientSession *session) :
+	session(session)
+{
+}
+
+/// Destructor.
+TrackLoadDialog::~TrackLoadDialog()
+{
+}
+
+/**
+ * Display the modal dialog until the track has finished loading.
+ *
+ * The loader cannot be interrupted, so the dialog cannot be canceled.
+ * ClientSession::FinishLoadNew() returns immediately afterwards.
+ *
+ * @param hinst The app instance handle.
+ * @param parent The parent window handle.
+ */
+void TrackLoadDialog::ShowModal(HINSTANCE hinst, HWND parent)
+{
+	// Don't flash a dialog for small tracks.
+	DWORD start = timeGetTime();
+	while (!session->IsLoadDone() && timeGetTime() - start < SHOW_DELAY) {
+		Sleep(POLL_INTERVAL / 5);
+	}
+
+	if (!session->IsLoadDone()) {
+		DialogBoxParamW(hinst, MAKEINTRESOURCEW(IDD_DOWNLOAD_PROGRESS),
+			parent, DlgFunc, reinterpret_cast<LPARAM>(this));
+	}
+}
+
+/// Update the dialog with the current status.
+void TrackLoadDialog::UpdateDialogProgress(HWND hwnd)
+{
+	int pos = static_cast<int>(session->GetLoadProgress() * 100);
+	SendDlgItemMessage(hwnd, IDC_DLPROGRESS, PBM_SETPOS, (WPARAM)pos, 0);
+}
+
+// Dialog callback.
+BOOL TrackLoadDialog::DlgProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam)
+{
+	BOOL retv = FALSE;
+
+	switch (message) {
+
+		case WM_INITDIALOG:
+			SetWindowTextW(hwnd, Str::UW(_("Loading")));
+			SetDlgItemTextW(hwnd, IDC_DLITEM, Str::UW(_("Loading Track:")));
+			SetDlgItemTextW(hwnd, IDC_ITEM_NAME, Str::UW(session->GetLoadTitle().c_str()));
+			SetDlgItemTextW(hwnd, IDC_STATE, Str::UW(_("Processing...")));
+			EnableWindow(GetDlgItem(hwnd, IDCANCEL), FALSE);
+			UpdateDialogProgress(hwnd);
+			SetTimer(hwnd, 1, POLL_INTERVAL, NULL);
+			retv = TRUE;
+			break;
+
+		case WM_DESTROY:
+			KillTimer(hwnd, 1);
+			break;
+
+		case WM_COMMAND:
+			switch (LOWORD(wparam)) {
+				case IDCANCEL:
+					// Can't be canceled; see ShowModal().
+					retv = TRUE;
+					break;
+			}
+			break;
+
+		case WM_TIMER:
+			UpdateDialogProgress(hwnd);
+			if (session->IsLoadDone()) {
+				EndDialog(hwnd, IDOK);
+			}
+			retv = TRUE;
+			break;
+	}
+
+	return retv;
+}
+
+/// Global dialog callback dispatcher.
+BOOL CALLBACK TrackLoadDialog::DlgFunc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam)
+{
+	// Determine which instance to route the message to.
+	TrackLoadDialog *dlg;
+	if (message == WM_INITDIALOG) {
+		dlg = reinterpret_cast<TrackLoadDialog*>(lparam);
+		SetWindowLong(hwnd, GWL_USERDATA, lparam);
+	} else {
+		dlg = reinterpret_cast<TrackLoadDialog*>(GetWindowLong(hwnd, GWL_USERDATA));
+		if (message == WM_DESTROY) {
+			SetWindowLong(hwnd, GWL_USERDATA, 0);
+		}
+	}
+
+	return (dlg == NULL) ? FALSE : dlg->DlgProc(hwnd, message, wparam, lparam);
+}
+
+}  // namespace Client
+}  // namespace HoverRace
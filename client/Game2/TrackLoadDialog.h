@@ -0,0 +1,59 @@
+
+// TrackLoadDialog.h
+// Header for the track loading progress dialog.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+namespace HoverRace {
+	namespace Client {
+		class ClientSession;
+	}
+}
+
+namespace HoverRace {
+namespace Client {
+
+/**
+ * Shows the progress of a track being loaded in the background by
+ * ClientSession::StartLoadNew().
+ */
+class TrackLoadDialog
+{
+	private:
+		TrackLoadDialog() { }
+	public:
+		TrackLoadDialog(ClientSession *session);
+		~TrackLoadDialog();
+
+		void ShowModal(HINSTANCE hinst, HWND parent);
+
+	private:
+		void UpdateDialogProgress(HWND hwnd);
+
+		BOOL DlgProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
+		static BOOL CALLBACK DlgFunc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
+
+	private:
+		ClientSession *session;
+};
+
+}  // namespace Client
+}  // namespace HoverRace
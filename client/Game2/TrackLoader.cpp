@@ -0,0 +1,358 @@
+// TrackLoader.cpp
+// Loads a track in the background.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <boost/thread/locks.hpp>
+
+#include "../../engine/Model/TrackFileCommon.h"
+#include "../../engine/Parcel/MmapRecordFile.h"
+#include "../../engine/Parcel/ObjStream.h"
+#include "../../engine/Util/DllObjectFactory.h"
+#include "../../engine/VideoServices/Viewport3D.h"
+
+#include "TrackLoader.h"
+
+using namespace HoverRace::Parcel;
+
+namespace HoverRace {
+namespace Client {
+
+namespace {
+	// Share of the progress bar given to building the level; the rest is
+	// for the background and map.
+	const double LEVEL_PROGRESS_SHARE = 0.8;
+}
+
+/**
+ * Constructor.
+ * Loading starts immediately.
+ * @param mazeFile The track file (may not be @c NULL).
+ * @param allowRendering Passed on to the level; must match the session
+ *                       the level will be attached to.
+ * @param gameOpts The game options.
+ */
+TrackLoader::TrackLoader(RecordFilePtr mazeFile, BOOL allowRendering, char gameOpts) :
+	mazeFile(mazeFile), allowRendering(allowRendering), gameOpts(gameOpts),
+	level(NULL), backPalette(NULL), backImage(NULL), map(NULL),
+	mapX0(0), mapY0(0), mapX1(0), mapY1(0),
+	levelProgress(0.0), attribsDone(false), done(false), failed(false)
+{
+	thread = boost::thread(boost::bind(&TrackLoader::Run, this));
+}
+
+TrackLoader::~TrackLoader()
+{
+	// There's no way to interrupt a level in the middle of being built.
+	thread.join();
+
+	delete level;
+	delete[] backPalette;
+	delete[] backImage;
+	delete map;
+}
+
+/**
+ * Retrieve how much of the track has been loaded so far.
+ * @return The progress, from 0.0 to 1.0.
+ */
+double TrackLoader::GetProgress() const
+{
+	boost::lock_guard<boost::mutex> lock(mutex);
+	return levelProgress * LEVEL_PROGRESS_SHARE +
+		(attribsDone ? (1.0 - LEVEL_PROGRESS_SHARE) : 0.0);
+}
+
+/**
+ * Check if loading has finished (successfully or not).
+ * @return @c true if Wait() will return immediately.
+ */
+bool TrackLoader::IsDone() const
+{
+	boost::lock_guard<boost::mutex> lock(mutex);
+	return done;
+}
+
+/**
+ * Wait for loading to finish.
+ * @throws ObjStreamExn The level could not be loaded.
+ */
+void TrackLoader::Wait()
+{
+	thread.join();
+	if (failed) {
+		throw ObjStreamExn(error);
+	}
+}
+
+/**
+ * Take ownership of the loaded level.
+ * Only valid after Wait() has returned successfully.
+ * @return The level.
+ */
+Model::Level *TrackLoader::ReleaseLevel()
+{
+	Model::Level *retv = level;
+	level = NULL;
+	return retv;
+}
+
+/**
+ * Take ownership of the background palette.
+ * @return The palette (@c MR_BACK_COLORS RGB triples),
+ *         or @c NULL if the track has no background.
+ */
+MR_UInt8 *TrackLoader::ReleaseBackPalette()
+{
+	MR_UInt8 *retv = backPalette;
+	backPalette = NULL;
+	return retv;
+}
+
+/**
+ * Take ownership of the background image.
+ * @return The image (@c MR_BACK_X_RES by @c MR_BACK_Y_RES),
+ *         or @c NULL if the track has no background.
+ */
+MR_UInt8 *TrackLoader::ReleaseBackImage()
+{
+	MR_UInt8 *retv = backImage;
+	backImage = NULL;
+	return retv;
+}
+
+/**
+ * Take ownership of the map sprite.
+ * @param[out] x0 The left edge of the area covered by the map.
+ * @param[out] y0 The bottom edge of the area covered by the map.
+ * @param[out] x1 The right edge of the area covered by the map.
+ * @param[out] y1 The top edge of the area covered by the map.
+ * @return The map, or @c NULL if the track has no map
+ *         (the coordinates are not set).
+ */
+VideoServices::Sprite *TrackLoader::ReleaseMap(int &x0, int &y0, int &x1, int &y1)
+{
+	VideoServices::Sprite *retv = map;
+	if (retv != NULL) {
+		x0 = mapX0;
+		y0 = mapY0;
+		x1 = mapX1;
+		y1 = mapY1;
+	}
+	map = NULL;
+	return retv;
+}
+
+void TrackLoader::OnLoadProgress(int done, int total)
+{
+	boost::lock_guard<boost::mutex> lock(mutex);
+	levelProgress = (total > 0) ? (static_cast<double>(done) / total) : 1.0;
+}
+
+void TrackLoader::Run()
+{
+	// Mapped records each get their own independent stream, so the
+	// background and map can be decoded while the level is being built.
+	// Other record files share a single file position, so everything has to
+	// be read in order.
+	bool concurrent = (dynamic_cast<MmapRecordFile*>(mazeFile.get()) != NULL);
+	int numRecords = mazeFile->GetNbRecords();
+	bool success = false;
+
+	try {
+		if (numRecords < 2) {
+			throw ObjStreamExn(_("Track has no level"));
+		}
+
+		if (concurrent) {
+			ObjStreamPtr imageOs;
+			if (numRecords > MR_LEVEL_IMAGE_RECORD) {
+				mazeFile->SelectRecord(MR_LEVEL_IMAGE_RECORD);
+				imageOs = mazeFile->StreamIn();
+			}
+
+			mazeFile->SelectRecord(1);
+			ObjStreamPtr levelOs(mazeFile->StreamIn());
+
+			ObjStreamPtr backOs, mapOs;
+			if (numRecords >= 3) {
+				mazeFile->SelectRecord(2);
+				backOs = mazeFile->StreamIn();
+			}
+			if (numRecords >= 4) {
+				mazeFile->SelectRecord(3);
+				mapOs = mazeFile->StreamIn();
+			}
+
+			boost::thread attribsThread(boost::bind(
+				&TrackLoader::LoadAttribs, this, backOs, mapOs));
+			try {
+				if (imageOs.get() == NULL || !LoadLevelImage(*imageOs)) {
+					LoadLevel(*levelOs);
+				}
+			}
+			catch (...) {
+				attribsThread.join();
+				throw;
+			}
+			attribsThread.join();
+		}
+		else {
+			bool imageLoaded = false;
+			if (numRecords > MR_LEVEL_IMAGE_RECORD) {
+				mazeFile->SelectRecord(MR_LEVEL_IMAGE_RECORD);
+				imageLoaded = LoadLevelImage(*mazeFile->StreamIn());
+			}
+			if (!imageLoaded) {
+				mazeFile->SelectRecord(1);
+				LoadLevel(*mazeFile->StreamIn());
+			}
+
+			try {
+				if (numRecords >= 3) {
+					mazeFile->SelectRecord(2);
+					LoadBackground(*mazeFile->StreamIn());
+				}
+				if (numRecords >= 4) {
+					mazeFile->SelectRecord(3);
+					LoadMap(*mazeFile->StreamIn());
+				}
+			}
+			catch (std::exception&) {
+				DiscardAttribs();
+			}
+
+			boost::lock_guard<boost::mutex> lock(mutex);
+			attribsDone = true;
+		}
+
+		// The craft, weapons and power-ups are only created once the race
+		// starts; decode their resources now instead of on the first frame.
+		Util::DllObjectFactory::PrefetchRaceResources(1);
+
+		success = true;
+	}
+	catch (Exception &ex) {
+		//TODO: Proper logging.
+#		ifdef _WIN32
+			OutputDebugString(ex.what());
+			OutputDebugString("\n");
+#		endif
+		error = ex.what();
+	}
+	catch (std::exception &ex) {
+		// Malformed track.
+		error = ex.what();
+	}
+
+	boost::lock_guard<boost::mutex> lock(mutex);
+	failed = !success;
+	done = true;
+}
+
+void TrackLoader::LoadLevel(ObjStream &os)
+{
+	level = new Model::Level(allowRendering, gameOpts);
+	level->Serialize(os, this);
+}
+
+/**
+ * Load the level from the precompiled level image.
+ * @param os The level image record.
+ * @return @c false if the image format is not supported or the image is
+ *         damaged (the regular level record must be used instead).
+ */
+bool TrackLoader::LoadLevelImage(ObjStream &os)
+{
+	level = new Model::Level(allowRendering, gameOpts);
+	try {
+		if (level->SerializeImage(os, this)) {
+			return true;
+		}
+	}
+	catch (std::exception&) {
+		// The level record is still there to fall back on.
+	}
+	delete level;
+	level = NULL;
+	return false;
+}
+
+void TrackLoader::LoadBackground(ObjStream &os)
+{
+	int imageType;
+	os >> imageType;
+
+	if (imageType == MR_RAWBITMAP) {
+		backPalette = new MR_UInt8[MR_BACK_COLORS * 3];
+		backImage = new MR_UInt8[MR_BACK_X_RES * MR_BACK_Y_RES];
+
+		os.Read(backPalette, MR_BACK_COLORS * 3);
+		os.Read(backImage, MR_BACK_X_RES * MR_BACK_Y_RES);
+	}
+}
+
+void TrackLoader::LoadMap(ObjStream &os)
+{
+	os >> mapX0;
+	os >> mapX1;
+	os >> mapY0;
+	os >> mapY1;
+
+	map = new VideoServices::Sprite;
+	map->Serialize(os);
+}
+
+/**
+ * Decode the background and map (on a separate thread).
+ * A bad background or map doesn't prevent the track from being raced, so
+ * errors only discard the background and map.
+ */
+void TrackLoader::LoadAttribs(ObjStreamPtr backOs, ObjStreamPtr mapOs)
+{
+	try {
+		if (backOs.get() != NULL) {
+			LoadBackground(*backOs);
+		}
+		if (mapOs.get() != NULL) {
+			LoadMap(*mapOs);
+		}
+	}
+	catch (std::exception&) {
+		DiscardAttribs();
+	}
+
+	boost::lock_guard<boost::mutex> lock(mutex);
+	attribsDone = true;
+}
+
+void TrackLoader::DiscardAttribs()
+{
+	delete[] backPalette;
+	backPalette = NULL;
+	delete[] backImage;
+	backImage = NULL;
+	delete map;
+	map = NULL;
+}
+
+}  // namespace Client
+}  // namespace HoverRace
@@ -0,0 +1,97 @@
+// TrackLoader.h
+// Loads a track in the background.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include "../../engine/Model/Level.h"
+#include "../../engine/Parcel/RecordFile.h"
+#include "../../engine/VideoServices/Sprite.h"
+
+namespace HoverRace {
+	namespace Parcel {
+		class ObjStream;
+	}
+}
+
+namespace HoverRace {
+namespace Client {
+
+/**
+ * Loads the level, background and map of a track on a worker thread.
+ *
+ * When the track file is memory-mapped, the background and map are decoded
+ * on a second thread while the level itself is being built.
+ *
+ * Loading starts as soon as the loader is created; the results are
+ * collected with Wait() and the Release*() methods, on the main thread.
+ */
+class TrackLoader : private Model::Level::LoadProgress
+{
+	public:
+		TrackLoader(Parcel::RecordFilePtr mazeFile, BOOL allowRendering, char gameOpts);
+		virtual ~TrackLoader();
+
+	public:
+		double GetProgress() const;
+		bool IsDone() const;
+		void Wait();
+
+		Parcel::RecordFilePtr GetMazeFile() const { return mazeFile; }
+
+		Model::Level *ReleaseLevel();
+		MR_UInt8 *ReleaseBackPalette();
+		MR_UInt8 *ReleaseBackImage();
+		VideoServices::Sprite *ReleaseMap(int &x0, int &y0, int &x1, int &y1);
+
+	private:
+		virtual void OnLoadProgress(int done, int total);
+
+		void Run();
+		void LoadLevel(Parcel::ObjStream &os);
+		bool LoadLevelImage(Parcel::ObjStream &os);
+		void LoadBackground(Parcel::ObjStream &os);
+		void LoadMap(Parcel::ObjStream &os);
+		void LoadAttribs(Parcel::ObjStreamPtr backOs, Parcel::ObjStreamPtr mapOs);
+		void DiscardAttribs();
+
+	private:
+		Parcel::RecordFilePtr mazeFile;
+		BOOL allowRendering;
+		char gameOpts;
+
+		Model::Level *level;
+		MR_UInt8 *backPalette;
+		MR_UInt8 *backImage;
+		VideoServices::Sprite *map;
+		int mapX0, mapY0, mapX1, mapY1;
+
+		mutable boost::mutex mutex;
+		double levelProgress;
+		bool attribsDone;
+		bool done;
+		bool failed;
+		std::string error;  ///< Why loading failed.
+
+		boost::thread thread;
+};
+
+}  // namespace Client
+}  // namespace HoverRace
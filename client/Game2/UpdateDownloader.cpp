@@ -34,6 +34,9 @@ using namespace HoverRace;
 using namespace HoverRace::Client;
 using namespace HoverRace::Util;
 
+// The version list is only a few lines long.
+#define MAX_LIST_SIZE (64 * 1024)
+
 UpdateDownloader::UpdateDownloader()
 {
 	// nothing to do
@@ -64,7 +67,7 @@ bool UpdateDownloader::CheckUrl(const std::string &url, Net::CancelFlagPtr cance
 	Config *cfg = Config::GetInstance();
 
 	Net::Agent agent(url);
-	//TODO: Set max size.
+	agent.SetMaxSize(MAX_LIST_SIZE);
 
 	stringstream io;
 	agent.Get(io, cancelFlag);
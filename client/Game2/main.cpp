@@ -24,6 +24,7 @@
 #	include "ClientApp.h"
 #else
 #	include "GameApp.h"
+#	include "MatchReportSpool.h"
 #endif
 
 #ifdef _WIN32
@@ -35,6 +36,7 @@
 #include <curl/curl.h>
 
 #include "../../engine/Exception.h"
+#include "../../engine/Net/TransferPool.h"
 #include "../../engine/Util/Config.h"
 #include "../../engine/Util/OS.h"
 #include "../../engine/Util/Str.h"
@@ -50,7 +52,9 @@ using boost::str;
 using HoverRace::Client::ClientApp;
 #else
 using HoverRace::Client::GameApp;
+using HoverRace::Client::MatchReportSpool;
 #endif
+using HoverRace::Net::TransferPool;
 using HoverRace::Util::Config;
 using HoverRace::Util::OS;
 namespace Str = HoverRace::Util::Str;
@@ -66,6 +70,7 @@ static bool safeMode = false;
 static bool allowMultipleInstances = false;
 static bool showVersion = false;
 static bool silentMode = false;
+static std::string soundSink;
 static bool experimentalMode =
 #	ifdef _WIN32
 		false;
@@ -157,6 +162,15 @@ static bool ProcessCmdLine(int argc, char **argv)
 		else if (strcmp("--silent", arg) == 0) {
 			silentMode = true;
 		}
+		else if (strcmp("--sound-sink", arg) == 0) {
+			if (i < argc) {
+				soundSink = argv[i++];
+			}
+			else {
+				ShowMessage("Expected: --sound-sink (null, wav:filename, or device)");
+				return false;
+			}
+		}
 		else if (strcmp("-V", arg) == 0 || strcmp("--version", arg) == 0) {
 			showVersion = true;
 		}
@@ -324,6 +338,7 @@ int main(int argc, char** argv)
 #endif
 		);
 	cfg->runtime.silent = silentMode;
+	cfg->runtime.soundSink = soundSink;
 	cfg->runtime.aieeee = experimentalMode;
 	cfg->runtime.showFramerate = showFramerate;
 	cfg->runtime.initScript = initScript;
@@ -349,6 +364,12 @@ int main(int argc, char** argv)
 
 	OS::TimeInit();
 
+#ifndef WITH_SDL
+	// Resume sending the ladder reports left over from the last session.
+	// The spool is not started at all if there are none.
+	MatchReportSpool::ResumePending();
+#endif
+
 	try {
 		lErrorCode = RunClient();
 	}
@@ -373,6 +394,10 @@ int main(int argc, char** argv)
 	OS::TimeShutdown();
 
 	// Library cleanup.
+#ifndef WITH_SDL
+	MatchReportSpool::Shutdown();
+#endif
+	TransferPool::Shutdown();
 	curl_global_cleanup();
 
 	Config::Shutdown();
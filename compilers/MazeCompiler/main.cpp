@@ -23,6 +23,10 @@
 #include "StdAfx.h"
 
 #include <iostream>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
 
 #include "../../engine/Util/Config.h"
 #include "../../engine/Util/DllObjectFactory.h"
@@ -75,7 +79,10 @@ namespace {
 static void PrintUsage()
 {
 	// this should be redone, it's horrible
-	puts(_("Usage: MazeCompiler <outputfile> <inputfile>"));
+	puts(_("Usage: MazeCompiler [--jobs N] [--compress MODE] <outputfile> <inputfile>"));
+	puts(_("  -j, --jobs N         Number of threads to use (default: one per core)"));
+	puts(_("  -z, --compress MODE  Compress the track: \"fast\" or \"small\"\n"
+		"                       (older versions cannot read compressed tracks)"));
 }
 
 int main(int pArgCount, char *pArgStrings[])
@@ -83,8 +90,6 @@ int main(int pArgCount, char *pArgStrings[])
 	bool lPrintUsage = false;
 	bool lError = false;
 
-	//TODO: Process command-line options.
-
 	Config *cfg = Config::Init(0, 0, 0, 0, true, OS::path_t());
 	cfg->runtime.silent = true;
 
@@ -108,19 +113,69 @@ int main(int pArgCount, char *pArgStrings[])
 
 	OS::path_t outputFilename;
 	OS::path_t inputFilename;
+	int lJobs = 0;
+	Parcel::ClassicRecordFile::Compression lCompression = Parcel::ClassicRecordFile::COMPRESS_NONE;
+	const char *lCompressArg = NULL;
 
 	// Analyse the input parameters
-	if(pArgCount != 3) {
+	std::vector<int> lFileArgs;
+	for (int i = 1; i < pArgCount; ++i) {
+		const char *arg = pArgStrings[i];
+		if (strcmp(arg, "-j") == 0 || strcmp(arg, "--jobs") == 0) {
+			if (++i >= pArgCount) {
+				lPrintUsage = true;
+				lError = true;
+				break;
+			}
+			lJobs = atoi(pArgStrings[i]);
+		}
+		else if (strncmp(arg, "--jobs=", 7) == 0) {
+			lJobs = atoi(arg + 7);
+		}
+		else if (strcmp(arg, "-z") == 0 || strcmp(arg, "--compress") == 0) {
+			if (++i >= pArgCount) {
+				lPrintUsage = true;
+				lError = true;
+				break;
+			}
+			lCompressArg = pArgStrings[i];
+		}
+		else if (strncmp(arg, "--compress=", 11) == 0) {
+			lCompressArg = arg + 11;
+		}
+		else {
+			lFileArgs.push_back(i);
+		}
+	}
+
+	if (lCompressArg != NULL) {
+		if (strcmp(lCompressArg, "fast") == 0) {
+			lCompression = Parcel::ClassicRecordFile::COMPRESS_FAST;
+		}
+		else if (strcmp(lCompressArg, "small") == 0) {
+			lCompression = Parcel::ClassicRecordFile::COMPRESS_SMALL;
+		}
+		else {
+			lPrintUsage = true;
+			lError = true;
+		}
+	}
+
+	if (lJobs < 0) {
+		lPrintUsage = true;
+		lError = true;
+	}
+	else if (!lPrintUsage && lFileArgs.size() != 2) {
 		lPrintUsage = true;
 		puts(_("Wrong argument count"));
 	}
-	else {
+	else if (!lPrintUsage) {
 #		ifdef _WIN32
-			outputFilename = wargv[1];
-			inputFilename = wargv[2];
+			outputFilename = wargv[lFileArgs[0]];
+			inputFilename = wargv[lFileArgs[1]];
 #		else
-			outputFilename = pArgStrings[1];
-			inputFilename = pArgStrings[2];
+			outputFilename = pArgStrings[lFileArgs[0]];
+			inputFilename = pArgStrings[lFileArgs[1]];
 #		endif
 	}
 
@@ -128,7 +183,9 @@ int main(int pArgCount, char *pArgStrings[])
 
 	if (!lError && !lPrintUsage) {
 		try {
-			TrackCompiler(compileLog, outputFilename).Compile(inputFilename);
+			TrackCompiler compiler(compileLog, outputFilename, lJobs);
+			compiler.SetCompression(lCompression);
+			compiler.Compile(inputFilename);
 		}
 		catch (TrackCompileExn &ex) {
 			lError = true;
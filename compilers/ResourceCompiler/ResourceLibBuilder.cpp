@@ -32,14 +32,23 @@ using namespace HoverRace::Parcel;
 
 namespace {
 	template<class T>
-	void WriteRes(ObjStream &os, T &res)
+	void WriteIndex(ObjStream &os, T &res, MR_UInt32 &recordNo)
 	{
 		MR_UInt32 num = res.size();
 		os << num;
 		BOOST_FOREACH(const typename T::value_type &ent, res) {
 			MR_Int32 key = ent.first;
-			os << key;
-			ent.second->Serialize(os);
+			os << key << recordNo++;
+		}
+	}
+
+	template<class T>
+	void WriteRes(RecordFile &file, T &res)
+	{
+		BOOST_FOREACH(const typename T::value_type &ent, res) {
+			file.BeginANewRecord();
+			ObjStreamPtr archivePtr(file.StreamOut());
+			ent.second->Serialize(*archivePtr);
 		}
 	}
 }
@@ -84,11 +93,13 @@ void ResourceLibBuilder::AddSound(ObjFacTools::ResContinuousSound *pSound)
 
 /**
  * This is the function that is called when the file is being written.
- * It creates the output file, then writes (in this order):
+ * It creates the output file, then writes an index of every resource into
+ * the first record, followed by one record per resource (in this order):
  * - bitmaps
  * - actors (meshes)
  * - sprites
  * - sounds
+ * so that ResourceLib can load each resource on demand.
  *
  * @param filename Filename of output file
  * @return BOOL indicating the success of the operation
@@ -99,7 +110,10 @@ bool ResourceLibBuilder::Export(const HoverRace::Util::OS::path_t &filename)
 
 	ClassicRecordFile lFile;
 
-	lReturnValue = lFile.CreateForWrite(filename, 1, "\x8\rFireball object factory resource file, (c)GrokkSoft 1996\n\x1a");
+	MR_UInt32 lNbRecords = 1 + bitmaps.size() + actors.size() + sprites.size() +
+		shortSounds.size() + continuousSounds.size();
+
+	lReturnValue = lFile.CreateForWrite(filename, lNbRecords, "\x8\rFireball object factory resource file, (c)GrokkSoft 1996\n\x1a");
 
 	if(!lReturnValue) {
 		fprintf(stderr, "%s: %s.\n", _("ERROR"), _("unable to create output file"));
@@ -108,20 +122,27 @@ bool ResourceLibBuilder::Export(const HoverRace::Util::OS::path_t &filename)
 		lFile.BeginANewRecord();
 
 		{
-			// Write the magic number
-			int lMagicNumber = FILE_MAGIC;
+			// Write the magic number and the index
+			int lMagicNumber = INDEXED_FILE_MAGIC;
+			MR_UInt32 lRecordNo = 1;
 
 			ObjStreamPtr archivePtr(lFile.StreamOut());
 			ObjStream &lArchive = *archivePtr;
 
 			lArchive << lMagicNumber;
 
-			WriteRes(lArchive, bitmaps);
-			WriteRes(lArchive, actors);
-			WriteRes(lArchive, sprites);
-			WriteRes(lArchive, shortSounds);
-			WriteRes(lArchive, continuousSounds);
+			WriteIndex(lArchive, bitmaps, lRecordNo);
+			WriteIndex(lArchive, actors, lRecordNo);
+			WriteIndex(lArchive, sprites, lRecordNo);
+			WriteIndex(lArchive, shortSounds, lRecordNo);
+			WriteIndex(lArchive, continuousSounds, lRecordNo);
 		}
+
+		WriteRes(lFile, bitmaps);
+		WriteRes(lFile, actors);
+		WriteRes(lFile, sprites);
+		WriteRes(lFile, shortSounds);
+		WriteRes(lFile, continuousSounds);
 	}
 
 	return lReturnValue;
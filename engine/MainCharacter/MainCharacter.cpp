@@ -70,6 +70,9 @@ const int eCharacterWeight[MR_NB_HOVER_MODEL] = { 300, 250, 450, 300, 300, 300,
 const int eMissileRefillTime = 10000;
 const int ePwrUpDuration = 5000;
 
+const int eMaxBlendError = 8000;				  // Larger corrections are applied at once
+const int eErrorBlendTime = 200;				  // Time to blend out a correction (ms)
+
 const double eSteadySpeed[MR_NB_HOVER_MODEL] =
 {
 	8.7 * 2222.0 / 1000.0,
@@ -199,6 +202,9 @@ MainCharacter::MainCharacter(const Util::ObjectFromFactoryId & pId) :
 	mCheckPoint1 = FALSE;
 	mCheckPoint2 = FALSE;
 
+	mRenderOffsetX = 0;
+	mRenderOffsetY = 0;
+	mRenderOffsetZ = 0;
 }
 
 MainCharacter::~MainCharacter()
@@ -253,7 +259,7 @@ void MainCharacter::AddRenderer()
 void MainCharacter::Render(VideoServices::Viewport3D * pDest, MR_SimulationTime /*pTime */ )
 {
 	if(mRenderer != NULL)
-		mRenderer->Render(pDest, mPosition, mCabinOrientation, mMotorDisplay > 0, mHoverId, mHoverModel);
+		mRenderer->Render(pDest, GetRenderPosition(), mCabinOrientation, mMotorDisplay > 0, mHoverId, mHoverModel);
 }
 
 Util::ObjectFromFactory *MainCharacter::FactoryFunc(MR_UInt16)
@@ -395,6 +401,67 @@ void MainCharacter::SetNbLapForRace(int pNbLap)
 	mNbLapForRace = pNbLap;
 }
 
+/**
+ * Dead-reckon the character forward from its last known state.
+ * Used on remote characters, whose state is already old when it arrives:
+ * the movement is simulated with the last known controls, without any of
+ * the side effects of a normal simulation step.
+ * @param pDuration How far to move the character forward in time.
+ * @param pLevel The current level.
+ * @return The room the character ends up in.
+ */
+int MainCharacter::Extrapolate(MR_SimulationTime pDuration, Model::Level *pLevel)
+{
+	MainCharacterRenderer *lRenderer = mRenderer;
+	mRenderer = NULL;							  // No sounds while extrapolating
+
+	int lRoom = mRoom;
+
+	while((pDuration > 0) && (lRoom >= 0)) {
+		lRoom = InternalSimulate(min<MR_SimulationTime>(pDuration, TIME_SLICE), pLevel, lRoom);
+		pDuration -= TIME_SLICE;
+	}
+
+	mRenderer = lRenderer;
+	return mRoom;
+}
+
+/**
+ * Start blending from a previous position to the current one.
+ * Used after the position has been corrected by the network so that the
+ * craft glides to its new position instead of jumping.
+ * @param pOldPosition The position before the correction.
+ */
+void MainCharacter::BlendFrom(const MR_3DCoordinate &pOldPosition)
+{
+	mRenderOffsetX += pOldPosition.mX - mPosition.mX;
+	mRenderOffsetY += pOldPosition.mY - mPosition.mY;
+	mRenderOffsetZ += pOldPosition.mZ - mPosition.mZ;
+
+	if((fabs(mRenderOffsetX) > eMaxBlendError) ||
+		(fabs(mRenderOffsetY) > eMaxBlendError) ||
+		(fabs(mRenderOffsetZ) > eMaxBlendError))
+	{
+		// Too far to look like anything but a warp anyway
+		mRenderOffsetX = 0;
+		mRenderOffsetY = 0;
+		mRenderOffsetZ = 0;
+	}
+}
+
+/**
+ * Get the position the character should be drawn at.
+ * This is the simulated position plus whatever correction error has not
+ * been blended out yet.
+ */
+MR_3DCoordinate MainCharacter::GetRenderPosition() const
+{
+	return MR_3DCoordinate(
+		mPosition.mX + static_cast<MR_Int32>(mRenderOffsetX),
+		mPosition.mY + static_cast<MR_Int32>(mRenderOffsetY),
+		mPosition.mZ + static_cast<MR_Int32>(mRenderOffsetZ));
+}
+
 void MainCharacter::SetSimulationTime(MR_SimulationTime pTime)
 {
 	mCurrentTime = pTime;
@@ -513,6 +580,15 @@ int MainCharacter::Simulate(MR_SimulationTime pDuration, Model::Level *pLevel, i
 	if(mMotorDisplay < 0)
 		mMotorDisplay = 0;
 
+	// Blend out the remaining correction error
+	if(pDuration > 0) {
+		double lBlend = (pDuration >= eErrorBlendTime) ? 0.0 : 1.0 - static_cast<double>(pDuration) / eErrorBlendTime;
+
+		mRenderOffsetX *= lBlend;
+		mRenderOffsetY *= lBlend;
+		mRenderOffsetZ *= lBlend;
+	}
+
 
 	/*Some twonk messed around with the brake function
 	//This messed  with king of the hill on Steeplechase, which is not cool
@@ -153,6 +153,10 @@ class MainCharacter : public Model::FreeElement
 
 		MR_FixedFastFifo < int, 6 > mLastHits;
 
+		double mRenderOffsetX;					  // Remaining correction error, blended out
+		double mRenderOffsetY;					  // over a few frames so that corrections
+		double mRenderOffsetZ;					  // do not make the hovercraft warp
+
 		// Sound events list
 		MR_FixedFastFifo < HoverRace::VideoServices::ShortSound *, 6 > mInternalSoundList;
 		MR_FixedFastFifo < HoverRace::VideoServices::ShortSound *, 6 > mExternalSoundList;
@@ -188,6 +192,11 @@ class MainCharacter : public Model::FreeElement
 		MR_DllDeclare void SetNetState(int pDataLen, const MR_UInt8 * pData);
 		MR_DllDeclare void SetNbLapForRace(int pNbLap);
 
+		// Prediction and smoothing
+		MR_DllDeclare int Extrapolate(MR_SimulationTime pDuration, Model::Level * pLevel);
+		MR_DllDeclare void BlendFrom(const MR_3DCoordinate & pOldPosition);
+		MR_DllDeclare MR_3DCoordinate GetRenderPosition() const;
+
 		// Movement inputs
 		MR_DllDeclare void SetSimulationTime(MR_SimulationTime pTime);
 		MR_DllDeclare void SetEngineState(bool engineState); // TODO: analog
@@ -23,7 +23,13 @@
 
 #include <math.h>
 
+#include <queue>
+
+#include <boost/bind.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "TrackCompileExn.h"
 #include "TrackSpecParser.h"
@@ -51,15 +57,87 @@ struct MR_Connection
 	int mWall1;
 };
 
-// Helper variables
-static LevelBuilder *gsCurrentLevelBuilder = NULL;
+// Path length (in mm) beyond which a sound can no longer be heard.
+// This matches the distance at which the client's distance attenuation
+// reaches silence.
+static const double MR_AUDIBLE_RANGE = 150000.0;
+
+// A room reached while propagating sound from a connection
+struct MR_AudiblePath
+{
+	double mDist;
+	int mRoom;
+
+	// Reversed, so that the priority queue yields the nearest room first
+	bool operator<(const MR_AudiblePath &pPath) const { return mDist > pPath.mDist; }
+};
+
+namespace {
+	/// Shared state for the threads running ForEachRoom.
+	struct RoomQueue
+	{
+		boost::function<void(int)> func;
+		boost::mutex mutex;
+		int nbRoom;
+		int next;
+
+		// The error from the lowest-numbered room that failed, so that the
+		// result does not depend on the thread scheduling.
+		int errRoom;
+		std::string errMsg;
+		bool errCompile;
+
+		void Fail(int pRoom, const std::string &pMsg, bool pCompile)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			if(errRoom < 0 || pRoom < errRoom) {
+				errRoom = pRoom;
+				errMsg = pMsg;
+				errCompile = pCompile;
+			}
+		}
+	};
+
+	void RoomWorker(RoomQueue *queue)
+	{
+		for(;;) {
+			int lRoom;
+			{
+				boost::mutex::scoped_lock lock(queue->mutex);
+				if(queue->next >= queue->nbRoom) {
+					return;
+				}
+				lRoom = queue->next++;
+			}
+
+			try {
+				queue->func(lRoom);
+			}
+			catch(TrackCompileExn &ex) {
+				queue->Fail(lRoom, ex.what(), true);
+			}
+			catch(std::exception &ex) {
+				queue->Fail(lRoom, ex.what(), false);
+			}
+		}
+	}
+}
 
 // Local helper functions
 static Model::SurfaceElement *sLoadTexture(TrackSpecParser * pParser);
 
-LevelBuilder::LevelBuilder(const TrackCompilationLogPtr &log) :
-	SUPER(), log(log)
+/**
+ * Constructor.
+ * @param log The compilation log.
+ * @param jobs The number of threads to use for the per-room passes
+ *             (zero to use one per core).
+ */
+LevelBuilder::LevelBuilder(const TrackCompilationLogPtr &log, int jobs) :
+	SUPER(), log(log), jobs(jobs)
 {
+	if(this->jobs <= 0) {
+		this->jobs = std::max<int>(1, boost::thread::hardware_concurrency());
+	}
 }
 
 bool LevelBuilder::InitFromFile(const OS::path_t &filename)
@@ -70,10 +148,74 @@ bool LevelBuilder::InitFromFile(const OS::path_t &filename)
 
 bool LevelBuilder::InitFromStream(std::istream &in)
 {
-	return Parse(in) &&
-		ComputeVisibleZones() &&
-		ComputeAudibleZones() &&
-		(OrderVisibleSurfaces(), true);
+	OS::timestamp_t lStart = OS::Time();
+	if(!Parse(in)) {
+		return false;
+	}
+	LogPhaseTime(_("Parsing"), lStart);
+
+	lStart = OS::Time();
+	if(!ComputeVisibleZones()) {
+		return false;
+	}
+	LogPhaseTime(_("Visible zones"), lStart);
+
+	lStart = OS::Time();
+	if(!ComputeAudibleZones()) {
+		return false;
+	}
+	LogPhaseTime(_("Audible zones"), lStart);
+
+	lStart = OS::Time();
+	OrderVisibleSurfaces();
+	LogPhaseTime(_("Surface ordering"), lStart);
+
+	return true;
+}
+
+void LevelBuilder::LogPhaseTime(const char *pPhase, OS::timestamp_t pStart) const
+{
+	log->Info(str(format(_("%s: %d ms")) %
+		pPhase % OS::TimeDiff(OS::Time(), pStart)));
+}
+
+/**
+ * Run a per-room pass over every room of the level.
+ * The rooms are shared out between the worker threads; since each call
+ * only writes to its own room, the result is the same as running the rooms
+ * in order, whatever the number of threads.
+ * @param pFunc The pass to run.
+ * @throw TrackCompileExn If the pass failed for any room.
+ */
+void LevelBuilder::ForEachRoom(roomFunc_t pFunc)
+{
+	RoomQueue lQueue;
+	lQueue.func = boost::bind(pFunc, this, _1);
+	lQueue.nbRoom = mNbRoom;
+	lQueue.next = 0;
+	lQueue.errRoom = -1;
+	lQueue.errCompile = false;
+
+	int lNbThreads = std::min(jobs, mNbRoom);
+	if(lNbThreads <= 1) {
+		RoomWorker(&lQueue);
+	}
+	else {
+		boost::thread_group lThreads;
+		for(int i = 0; i < lNbThreads; i++) {
+			lThreads.create_thread(boost::bind(&RoomWorker, &lQueue));
+		}
+		lThreads.join_all();
+	}
+
+	if(lQueue.errRoom >= 0) {
+		if(lQueue.errCompile) {
+			throw TrackCompileExn(lQueue.errMsg);
+		}
+		else {
+			throw Exception(lQueue.errMsg);
+		}
+	}
 }
 
 bool LevelBuilder::Parse(std::istream &in)
@@ -619,117 +761,232 @@ bool LevelBuilder::Parse(std::istream &in)
 
 bool LevelBuilder::ComputeAudibleZones()
 {
-	// Not implemented.
+	log->Info(_("Computing audible zones"));
+
+	ForEachRoom(&LevelBuilder::ComputeRoomAudibleZones);
+
 	return true;
 }
 
-void LevelBuilder::OrderVisibleSurfaces()
+/**
+ * Compute the rooms that can be heard from a room.
+ * Sound is propagated from each connection of the room through the
+ * connections of the neighboring rooms, following the shortest path from
+ * connection center to connection center.  Each source room records, for
+ * each connection of the listening room that it can be heard through, an
+ * attenuation coefficient from 255 (as loud as in the next room) down to 1.
+ * @param pRoom The listening room.
+ */
+void LevelBuilder::ComputeRoomAudibleZones(int pRoom)
 {
-	int lCounter;
+	Room &lRoom = mRoomList[pRoom];
 
-	// For each room, compute the list of the visible surfaces
-	for(int lRoomId = 0; lRoomId < mNbRoom; lRoomId++) {
-		mRoomList[lRoomId].mNbVisibleSurface = 0;
+	// Connections and coefficients for each source room, ordered by room
+	typedef std::vector<std::pair<int, BYTE> > sources_t;
+	std::map<int, sources_t> lSources;
 
-		// Compute the number of visible surfaces
+	std::vector<double> lDist(mNbRoom);
+	std::vector<bool> lDone(mNbRoom);
+	std::vector<double> lEntryX(mNbRoom);
+	std::vector<double> lEntryY(mNbRoom);
 
-		mRoomList[lRoomId].mNbVisibleSurface = mRoomList[lRoomId].mNbChild + 1;
+	for(int lWall = 0; lWall < lRoom.mNbVertex; lWall++) {
+		int lNeighbor = lRoom.mNeighborList[lWall];
 
-		for(lCounter = 0; lCounter < mRoomList[lRoomId].mNbVisibleRoom; lCounter++) {
-			mRoomList[lRoomId].mNbVisibleSurface += mRoomList[mRoomList[lRoomId].mVisibleRoomList[lCounter]].mNbChild + 1;
+		if(lNeighbor == -1) {
+			continue;
 		}
 
-		// Create the arrays containing the list of visible floor and ceiling
-		int lCurrentIndex = 0;
+		std::fill(lDist.begin(), lDist.end(), -1.0);
+		std::fill(lDone.begin(), lDone.end(), false);
+
+		// The listening room itself is never crossed
+		lDone[pRoom] = true;
 
-		mRoomList[lRoomId].mVisibleFloorList = new Model::SectionId[mRoomList[lRoomId].mNbVisibleSurface];
-		mRoomList[lRoomId].mVisibleCeilingList = new Model::SectionId[mRoomList[lRoomId].mNbVisibleSurface];
+		const MR_2DCoordinate &lWallStart = lRoom.mVertexList[lWall];
+		const MR_2DCoordinate &lWallEnd = lRoom.mVertexList[(lWall + 1) % lRoom.mNbVertex];
 
-		for(lCounter = -1; lCounter < mRoomList[lRoomId].mNbVisibleRoom; lCounter++) {
-			int lVisibleRoom;
+		lDist[lNeighbor] = 0.0;
+		lEntryX[lNeighbor] = (lWallStart.mX + lWallEnd.mX) / 2.0;
+		lEntryY[lNeighbor] = (lWallStart.mY + lWallEnd.mY) / 2.0;
 
-			if(lCounter == -1) {
-				lVisibleRoom = lRoomId;
+		std::priority_queue<MR_AudiblePath> lQueue;
+		MR_AudiblePath lStart = { 0.0, lNeighbor };
+		lQueue.push(lStart);
+
+		while(!lQueue.empty()) {
+			MR_AudiblePath lPath = lQueue.top();
+			lQueue.pop();
+
+			if(lDone[lPath.mRoom]) {
+				continue;
 			}
-			else {
-				lVisibleRoom = mRoomList[lRoomId].mVisibleRoomList[lCounter];
+			lDone[lPath.mRoom] = true;
+
+			int lCoefficient = (int) (255.0 * (1.0 - lPath.mDist / MR_AUDIBLE_RANGE));
+			if(lCoefficient <= 0) {
+				continue;
 			}
+			lSources[lPath.mRoom].push_back(std::make_pair(lWall, (BYTE) lCoefficient));
+
+			const Room &lSource = mRoomList[lPath.mRoom];
+
+			for(int lCounter = 0; lCounter < lSource.mNbVertex; lCounter++) {
+				int lNext = lSource.mNeighborList[lCounter];
+
+				if(lNext == -1 || lDone[lNext]) {
+					continue;
+				}
+
+				const MR_2DCoordinate &lStartPos = lSource.mVertexList[lCounter];
+				const MR_2DCoordinate &lEndPos = lSource.mVertexList[(lCounter + 1) % lSource.mNbVertex];
 
-			mRoomList[lRoomId].mVisibleFloorList[lCurrentIndex].mType = Model::SectionId::eRoom;
-			mRoomList[lRoomId].mVisibleFloorList[lCurrentIndex].mId = lVisibleRoom;
-			mRoomList[lRoomId].mVisibleCeilingList[lCurrentIndex].mType = Model::SectionId::eRoom;
-			mRoomList[lRoomId].mVisibleCeilingList[lCurrentIndex++].mId = lVisibleRoom;
+				double lX = (lStartPos.mX + lEndPos.mX) / 2.0;
+				double lY = (lStartPos.mY + lEndPos.mY) / 2.0;
+				double lDX = lX - lEntryX[lPath.mRoom];
+				double lDY = lY - lEntryY[lPath.mRoom];
+				double lNextDist = lPath.mDist + sqrt(lDX * lDX + lDY * lDY);
 
-			for(int lChildIndex = 0; lChildIndex < mRoomList[lVisibleRoom].mNbChild; lChildIndex++) {
-				mRoomList[lRoomId].mVisibleFloorList[lCurrentIndex].mType = Model::SectionId::eFeature;
-				mRoomList[lRoomId].mVisibleFloorList[lCurrentIndex].mId = mRoomList[lVisibleRoom].mChildList[lChildIndex];
-				mRoomList[lRoomId].mVisibleCeilingList[lCurrentIndex].mType = Model::SectionId::eFeature;
-				mRoomList[lRoomId].mVisibleCeilingList[lCurrentIndex++].mId = mRoomList[lVisibleRoom].mChildList[lChildIndex];
+				if(lNextDist < MR_AUDIBLE_RANGE && (lDist[lNext] < 0.0 || lNextDist < lDist[lNext])) {
+					lDist[lNext] = lNextDist;
+					lEntryX[lNext] = lX;
+					lEntryY[lNext] = lY;
+
+					MR_AudiblePath lNextPath = { lNextDist, lNext };
+					lQueue.push(lNextPath);
+				}
 			}
+		}
+	}
+
+	lRoom.mNbAudibleRoom = static_cast<int>(lSources.size());
+	lRoom.mAudibleRoomList = (lSources.empty()) ? NULL : new Room::AudibleRoom[lSources.size()];
+
+	int lIndex = 0;
+	for(std::map<int, sources_t>::const_iterator iter = lSources.begin(); iter != lSources.end(); ++iter, ++lIndex) {
+		Room::AudibleRoom &lAudible = lRoom.mAudibleRoomList[lIndex];
+		const sources_t &lConnections = iter->second;
 
-			ASSERT(lCurrentIndex <= mRoomList[lRoomId].mNbVisibleSurface);
+		lAudible.mSectionSource = iter->first;
+		lAudible.mNbVertexSources = static_cast<int>(lConnections.size());
+		lAudible.mVertexList = new int[lConnections.size()];
+		lAudible.mSoundCoefficient = new BYTE[lConnections.size()];
+
+		for(size_t lCounter = 0; lCounter < lConnections.size(); lCounter++) {
+			lAudible.mVertexList[lCounter] = lConnections[lCounter].first;
+			lAudible.mSoundCoefficient[lCounter] = lConnections[lCounter].second;
 		}
+	}
+}
+
+void LevelBuilder::OrderVisibleSurfaces()
+{
+	// For each room, compute the list of the visible surfaces
+	ForEachRoom(&LevelBuilder::OrderRoomVisibleSurfaces);
+}
 
-		ASSERT(lCurrentIndex == mRoomList[lRoomId].mNbVisibleSurface);
+void LevelBuilder::OrderRoomVisibleSurfaces(int pRoom)
+{
+	int lCounter;
 
-		// Order the surfaces list
-		gsCurrentLevelBuilder = this;
+	mRoomList[pRoom].mNbVisibleSurface = 0;
 
-		qsort(mRoomList[lRoomId].mVisibleFloorList, mRoomList[lRoomId].mNbVisibleSurface, sizeof(Model::SectionId), OrderFloor);
+	// Compute the number of visible surfaces
 
-		qsort(mRoomList[lRoomId].mVisibleCeilingList, mRoomList[lRoomId].mNbVisibleSurface, sizeof(Model::SectionId), OrderCeiling);
+	mRoomList[pRoom].mNbVisibleSurface = mRoomList[pRoom].mNbChild + 1;
 
+	for(lCounter = 0; lCounter < mRoomList[pRoom].mNbVisibleRoom; lCounter++) {
+		mRoomList[pRoom].mNbVisibleSurface += mRoomList[mRoomList[pRoom].mVisibleRoomList[lCounter]].mNbChild + 1;
 	}
+
+	// Create the arrays containing the list of visible floor and ceiling
+	int lCurrentIndex = 0;
+
+	mRoomList[pRoom].mVisibleFloorList = new Model::SectionId[mRoomList[pRoom].mNbVisibleSurface];
+	mRoomList[pRoom].mVisibleCeilingList = new Model::SectionId[mRoomList[pRoom].mNbVisibleSurface];
+
+	for(lCounter = -1; lCounter < mRoomList[pRoom].mNbVisibleRoom; lCounter++) {
+		int lVisibleRoom;
+
+		if(lCounter == -1) {
+			lVisibleRoom = pRoom;
+		}
+		else {
+			lVisibleRoom = mRoomList[pRoom].mVisibleRoomList[lCounter];
+		}
+
+		mRoomList[pRoom].mVisibleFloorList[lCurrentIndex].mType = Model::SectionId::eRoom;
+		mRoomList[pRoom].mVisibleFloorList[lCurrentIndex].mId = lVisibleRoom;
+		mRoomList[pRoom].mVisibleCeilingList[lCurrentIndex].mType = Model::SectionId::eRoom;
+		mRoomList[pRoom].mVisibleCeilingList[lCurrentIndex++].mId = lVisibleRoom;
+
+		for(int lChildIndex = 0; lChildIndex < mRoomList[lVisibleRoom].mNbChild; lChildIndex++) {
+			mRoomList[pRoom].mVisibleFloorList[lCurrentIndex].mType = Model::SectionId::eFeature;
+			mRoomList[pRoom].mVisibleFloorList[lCurrentIndex].mId = mRoomList[lVisibleRoom].mChildList[lChildIndex];
+			mRoomList[pRoom].mVisibleCeilingList[lCurrentIndex].mType = Model::SectionId::eFeature;
+			mRoomList[pRoom].mVisibleCeilingList[lCurrentIndex++].mId = mRoomList[lVisibleRoom].mChildList[lChildIndex];
+		}
+
+		ASSERT(lCurrentIndex <= mRoomList[pRoom].mNbVisibleSurface);
+	}
+
+	ASSERT(lCurrentIndex == mRoomList[pRoom].mNbVisibleSurface);
+
+	// Order the surfaces list
+	// (stable, so that surfaces at the same level keep the same order
+	// from one compilation to the next)
+	std::stable_sort(mRoomList[pRoom].mVisibleFloorList,
+		mRoomList[pRoom].mVisibleFloorList + mRoomList[pRoom].mNbVisibleSurface,
+		boost::bind(&LevelBuilder::OrderFloor, this, _1, _2));
+
+	std::stable_sort(mRoomList[pRoom].mVisibleCeilingList,
+		mRoomList[pRoom].mVisibleCeilingList + mRoomList[pRoom].mNbVisibleSurface,
+		boost::bind(&LevelBuilder::OrderCeiling, this, _1, _2));
+
 }
 
-int LevelBuilder::OrderFloor(const void *pSurface0, const void *pSurface1)
+bool LevelBuilder::OrderFloor(const Model::SectionId &pSurface0, const Model::SectionId &pSurface1) const
 {
 	int lLevel0;
 	int lLevel1;
 
-	Model::SectionId lSurface0 = *(Model::SectionId *) pSurface0;
-	Model::SectionId lSurface1 = *(Model::SectionId *) pSurface1;
-
-	if(lSurface0.mType == Model::SectionId::eRoom) {
-		lLevel0 = gsCurrentLevelBuilder->mRoomList[lSurface0.mId].mFloorLevel;
+	if(pSurface0.mType == Model::SectionId::eRoom) {
+		lLevel0 = mRoomList[pSurface0.mId].mFloorLevel;
 	}
 	else {
-		lLevel0 = gsCurrentLevelBuilder->mFeatureList[lSurface0.mId].mCeilingLevel;
+		lLevel0 = mFeatureList[pSurface0.mId].mCeilingLevel;
 	}
 
-	if(lSurface1.mType == Model::SectionId::eRoom) {
-		lLevel1 = gsCurrentLevelBuilder->mRoomList[lSurface1.mId].mFloorLevel;
+	if(pSurface1.mType == Model::SectionId::eRoom) {
+		lLevel1 = mRoomList[pSurface1.mId].mFloorLevel;
 	}
 	else {
-		lLevel1 = gsCurrentLevelBuilder->mFeatureList[lSurface1.mId].mCeilingLevel;
+		lLevel1 = mFeatureList[pSurface1.mId].mCeilingLevel;
 	}
 
-	return (lLevel0 - lLevel1);
+	return lLevel0 < lLevel1;
 }
 
-int LevelBuilder::OrderCeiling(const void *pSurface0, const void *pSurface1)
+bool LevelBuilder::OrderCeiling(const Model::SectionId &pSurface0, const Model::SectionId &pSurface1) const
 {
 	int lLevel0;
 	int lLevel1;
 
-	Model::SectionId lSurface0 = *(Model::SectionId *) pSurface0;
-	Model::SectionId lSurface1 = *(Model::SectionId *) pSurface1;
-
-	if(lSurface0.mType == Model::SectionId::eFeature) {
-		lLevel0 = gsCurrentLevelBuilder->mFeatureList[lSurface0.mId].mFloorLevel;
+	if(pSurface0.mType == Model::SectionId::eFeature) {
+		lLevel0 = mFeatureList[pSurface0.mId].mFloorLevel;
 	}
 	else {
-		lLevel0 = gsCurrentLevelBuilder->mRoomList[lSurface0.mId].mCeilingLevel;
+		lLevel0 = mRoomList[pSurface0.mId].mCeilingLevel;
 	}
 
-	if(lSurface1.mType == Model::SectionId::eFeature) {
-		lLevel1 = gsCurrentLevelBuilder->mFeatureList[lSurface1.mId].mFloorLevel;
+	if(pSurface1.mType == Model::SectionId::eFeature) {
+		lLevel1 = mFeatureList[pSurface1.mId].mFloorLevel;
 	}
 	else {
-		lLevel1 = gsCurrentLevelBuilder->mRoomList[lSurface1.mId].mCeilingLevel;
+		lLevel1 = mRoomList[pSurface1.mId].mCeilingLevel;
 	}
 
-	return (lLevel1 - lLevel0);
+	return lLevel1 < lLevel0;
 }
 
 double LevelBuilder::ComputeShapeConst(Section * pSection)
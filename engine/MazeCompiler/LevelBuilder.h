@@ -44,7 +44,7 @@ class MR_DllDeclare LevelBuilder : public Model::Level
 {
 	typedef Model::Level SUPER;
 	public:
-		LevelBuilder(const TrackCompilationLogPtr &log);
+		LevelBuilder(const TrackCompilationLogPtr &log, int jobs=0);
 		virtual ~LevelBuilder() {}
 
 	protected:
@@ -59,11 +59,20 @@ class MR_DllDeclare LevelBuilder : public Model::Level
 
 		void OrderVisibleSurfaces();
 
+		typedef void (LevelBuilder::*roomFunc_t)(int pRoom);
+		void ForEachRoom(roomFunc_t pFunc);
+
 	private:
+		void ComputeRoomVisibleZones(int pRoom);
 		void TestForVisibility(VisibleStep *pPreviousStep, int *pDestArray, int &pDestIndex, int pNewLeftNodeIndex);
 
-		static int OrderFloor(const void *pSurface0, const void *pSurface1);
-		static int OrderCeiling(const void *pSurface0, const void *pSurface1);
+		void ComputeRoomAudibleZones(int pRoom);
+
+		void OrderRoomVisibleSurfaces(int pRoom);
+		bool OrderFloor(const Model::SectionId &pSurface0, const Model::SectionId &pSurface1) const;
+		bool OrderCeiling(const Model::SectionId &pSurface0, const Model::SectionId &pSurface1) const;
+
+		void LogPhaseTime(const char *pPhase, Util::OS::timestamp_t pStart) const;
 
 	public:
 		bool InitFromFile(const Util::OS::path_t &filename);
@@ -71,6 +80,7 @@ class MR_DllDeclare LevelBuilder : public Model::Level
 
 	private:
 		TrackCompilationLogPtr log;
+		int jobs;
 };
 
 }  // namespace MazeCompiler
@@ -75,53 +75,53 @@ static double GetAngle(const MR_2DFloatPos & pPoint0, const MR_2DFloatPos & pPoi
 // Functions implementation
 bool LevelBuilder::ComputeVisibleZones()
 {
-	bool lReturnValue = true;
-
-	int lDestIndex;
-	int lDestArray[MR_MAX_VISIBLE_ZONES];
-
 	log->Info(_("Computing visible zones... be patient"));
 
-	VisibleStep lStep;
+	// The rooms are independent of each other, so they are computed in
+	// parallel.
+	ForEachRoom(&LevelBuilder::ComputeRoomVisibleZones);
 
-	for(int lCounter = 0; lCounter < mNbRoom; lCounter++) {
-		lDestIndex = 0;							  // Index in destination array
+	return true;
+}
+
+void LevelBuilder::ComputeRoomVisibleZones(int pRoom)
+{
+	int lDestIndex = 0;							  // Index in destination array
+	int lDestArray[MR_MAX_VISIBLE_ZONES];
 
-		lStep.mZone = lCounter;
+	VisibleStep lStep;
 
-		for(int lCounter2 = 0; lCounter2 < mRoomList[lCounter].mNbVertex; lCounter2++) {
-			lStep.mLeftNode = mRoomList[lCounter].mVertexList[lCounter2];
-			lStep.mRightNode = mRoomList[lCounter].mVertexList[(lCounter2 + 1) % mRoomList[lCounter].mNbVertex];
+	lStep.mZone = pRoom;
 
-			lStep.mLeftLimit = lStep.mLeftNode;
-			lStep.mLeftLimitLightSource = lStep.mRightNode;
+	for(int lCounter2 = 0; lCounter2 < mRoomList[pRoom].mNbVertex; lCounter2++) {
+		lStep.mLeftNode = mRoomList[pRoom].mVertexList[lCounter2];
+		lStep.mRightNode = mRoomList[pRoom].mVertexList[(lCounter2 + 1) % mRoomList[pRoom].mNbVertex];
 
-			lStep.mRightLimit = lStep.mRightNode;
-			lStep.mRightLimitLightSource = lStep.mLeftNode;
+		lStep.mLeftLimit = lStep.mLeftNode;
+		lStep.mLeftLimitLightSource = lStep.mRightNode;
 
-			// PrintStep( &lStep );
-			// gMargin += 3;
+		lStep.mRightLimit = lStep.mRightNode;
+		lStep.mRightLimitLightSource = lStep.mLeftNode;
 
-			TestForVisibility(&lStep, lDestArray, lDestIndex, lCounter2);
+		// PrintStep( &lStep );
+		// gMargin += 3;
 
-			// gMargin -= 3;
-		}
-		// printf( "%d visibles zones for zone %d\n", lDestIndex, lCounter );
+		TestForVisibility(&lStep, lDestArray, lDestIndex, lCounter2);
 
-		if(lDestIndex > 0) {
-			mRoomList[lCounter].mNbVisibleRoom = lDestIndex;
+		// gMargin -= 3;
+	}
+	// printf( "%d visibles zones for zone %d\n", lDestIndex, pRoom );
 
-			mRoomList[lCounter].mVisibleRoomList = new int[lDestIndex];
+	if(lDestIndex > 0) {
+		mRoomList[pRoom].mNbVisibleRoom = lDestIndex;
 
-			for(int lCounter3 = 0; lCounter3 < lDestIndex; lCounter3++) {
-				mRoomList[lCounter].mVisibleRoomList[lCounter3] = lDestArray[lCounter3];
-			}
+		mRoomList[pRoom].mVisibleRoomList = new int[lDestIndex];
 
+		for(int lCounter3 = 0; lCounter3 < lDestIndex; lCounter3++) {
+			mRoomList[pRoom].mVisibleRoomList[lCounter3] = lDestArray[lCounter3];
 		}
 
 	}
-
-	return lReturnValue;
 }
 
 void LevelBuilder::TestForVisibility(VisibleStep *pPreviousStep, int *pDestArray, int &pDestIndex, int pNewLeftNodeIndex)
@@ -40,8 +40,15 @@ using namespace HoverRace::Util;
 namespace HoverRace {
 namespace MazeCompiler {
 
-TrackCompiler::TrackCompiler(const TrackCompilationLogPtr &log, const Util::OS::path_t &outputFilename) :
-	log(log), outputFilename(outputFilename)
+/**
+ * Constructor.
+ * @param log The compilation log.
+ * @param outputFilename The full path to the track file to create.
+ * @param jobs The number of threads to compile with (zero for one per core).
+ */
+TrackCompiler::TrackCompiler(const TrackCompilationLogPtr &log, const Util::OS::path_t &outputFilename, int jobs) :
+	log(log), outputFilename(outputFilename), jobs(jobs),
+	compression(Parcel::ClassicRecordFile::COMPRESS_NONE)
 {
 }
 
@@ -70,9 +77,10 @@ void TrackCompiler::Compile(const Util::OS::path_t &inputFilename) const
 void TrackCompiler::Compile(std::istream &in) const
 {
 	Parcel::ClassicRecordFile outFile;
+	outFile.SetCompression(compression);
 
 	// Try to create the output file
-	if (!outFile.CreateForWrite(outputFilename, 4, "\x8\rHoverRace track file\n\x1a")) {
+	if (!outFile.CreateForWrite(outputFilename, 5, "\x8\rHoverRace track file\n\x1a")) {
 		throw TrackCompileExn(boost::str(
 			boost::format(_("Unable to create the output file: %s")) %
 				Str::PU(outputFilename)));
@@ -94,7 +102,7 @@ void TrackCompiler::Compile(std::istream &in) const
 	in.seekg(0, std::ios::beg);
 
 	// The track itself.
-	LevelBuilder builder(log);
+	LevelBuilder builder(log, jobs);
 	if (!outFile.BeginANewRecord()) {
 		throw TrackCompileExn(_("Unable to add the track to the output file"));
 	}
@@ -143,6 +151,18 @@ void TrackCompiler::Compile(std::istream &in) const
 		mapSprite.Serialize(archive);
 	}
 
+	// The precompiled level image.
+	// This duplicates the track record in a form that loads much faster;
+	// older versions ignore it.
+	if (!outFile.BeginANewRecord()) {
+		throw TrackCompileExn(_("Unable to add a level image record"));
+	}
+	else {
+		Parcel::ObjStreamPtr archivePtr(outFile.StreamOut());
+		Parcel::ObjStream &archive = *archivePtr;
+		builder.SerializeImage(archive);
+	}
+
 	log->Info(_("Compiled track successfully!"));
 }
 
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "../Parcel/ClassicRecordFile.h"
 #include "../Util/MR_Types.h"
 #include "../Util/OS.h"
 #include "TrackCompilationLog.h"
@@ -51,10 +52,12 @@ namespace MazeCompiler {
 class MR_DllDeclare TrackCompiler
 {
 	public:
-		TrackCompiler(const TrackCompilationLogPtr &log, const Util::OS::path_t &outputFilename);
+		TrackCompiler(const TrackCompilationLogPtr &log, const Util::OS::path_t &outputFilename, int jobs=0);
 		~TrackCompiler() {}
 
 	public:
+		void SetCompression(Parcel::ClassicRecordFile::Compression compression) { this->compression = compression; }
+
 		void Compile(const Util::OS::path_t &inputFilename) const;
 		void Compile(std::istream &in) const;
 
@@ -71,6 +74,8 @@ class MR_DllDeclare TrackCompiler
 	private:
 		Util::OS::path_t outputFilename;
 		TrackCompilationLogPtr log;
+		int jobs;
+		Parcel::ClassicRecordFile::Compression compression;
 };
 
 }  // namespace MazeCompiler
@@ -23,10 +23,14 @@
 
 #include "GameSession.h"
 #include "ObstacleCollisionReport.h"
+#include "TrackFileCommon.h"
 
 #define MR_SIMULATION_SLICE             15
 #define MR_MINIMUM_SIMULATION_SLICE     10
 
+// A slewed clock runs at most this much (1/n) faster or slower than real time
+#define MR_MAX_SLEW_RATE                10
+
 using namespace HoverRace::Parcel;
 
 namespace HoverRace {
@@ -36,7 +40,9 @@ GameSession::GameSession(BOOL pAllowRendering) :
 	mAllowRendering(pAllowRendering),
 	mCurrentLevelNumber(-1),
 	mCurrentLevel(NULL),
-	mSimulationTime(-3000)  // 3 sec countdown
+	mSimulationTime(-3000),  // 3 sec countdown
+	mSlewRemaining(0), mLastSliceCount(0), mPendingSliceCount(0),
+	mTotalSliceCount(0)
 {
 }
 
@@ -58,12 +64,24 @@ BOOL GameSession::LoadLevel(int pLevel, char pGameOpts)
 	// Load the new level
 	if(pLevel < mCurrentMazeFile->GetNbRecords()) {
 		mCurrentLevel = new Level(mAllowRendering, pGameOpts);
-		mCurrentMazeFile->SelectRecord(pLevel);
 
-		ObjStreamPtr archivePtr(mCurrentMazeFile->StreamIn());
-		ObjStream &lArchive = *archivePtr;
+		// Use the precompiled image of the level if the track has one
+		BOOL lLoaded = FALSE;
+		if(pLevel == 1 && mCurrentMazeFile->GetNbRecords() > MR_LEVEL_IMAGE_RECORD) {
+			mCurrentMazeFile->SelectRecord(MR_LEVEL_IMAGE_RECORD);
+
+			ObjStreamPtr archivePtr(mCurrentMazeFile->StreamIn());
+			lLoaded = mCurrentLevel->SerializeImage(*archivePtr);
+		}
+
+		if(!lLoaded) {
+			mCurrentMazeFile->SelectRecord(pLevel);
+
+			ObjStreamPtr archivePtr(mCurrentMazeFile->StreamIn());
+			ObjStream &lArchive = *archivePtr;
 
-		mCurrentLevel->Serialize(lArchive);
+			mCurrentLevel->Serialize(lArchive);
+		}
 
 		mCurrentLevelNumber = pLevel;
 	} else
@@ -99,10 +117,55 @@ BOOL GameSession::LoadNew(const char *pTitle, RecordFilePtr pMazeFile, char pGam
 	return lReturnValue;
 }
 
+/**
+ * Start a new session with a level that has already been loaded
+ * (e.g. in the background).
+ * @param pTitle The track title.
+ * @param pMazeFile The track file the level was loaded from.
+ * @param pLevel The level (record 1 of the track), created with the same
+ *               rendering mode as this session (see IsRenderingAllowed()).
+ *               The session takes ownership of it.
+ * @return @c TRUE if successful.
+ */
+BOOL GameSession::LoadNew(const char *pTitle, RecordFilePtr pMazeFile, Level *pLevel)
+{
+	Clean();
+	if((pMazeFile == NULL) || (pLevel == NULL)) {
+		delete pLevel;
+		return FALSE;
+	}
+
+	mTitle = pTitle;
+	mCurrentMazeFile = pMazeFile;
+	mCurrentLevel = pLevel;
+	mCurrentLevelNumber = 1;
+
+	return TRUE;
+}
+
+BOOL GameSession::IsRenderingAllowed() const
+{
+	return mAllowRendering;
+}
+
 void GameSession::SetSimulationTime(MR_SimulationTime pTime)
 {
 	mSimulationTime = pTime;
 	mLastSimulateCallTime = Util::OS::Time();
+	mSlewRemaining = 0;
+}
+
+/**
+ * Gradually correct the simulation time.
+ * Unlike SetSimulationTime(), the correction is spread over the following
+ * Simulate() calls by running the clock slightly fast or slow, so the
+ * simulation never jumps.  A new correction replaces any that is still
+ * pending, since it is measured against the current (partly corrected) time.
+ * @param pCorrection The amount of time to add (may be negative).
+ */
+void GameSession::SlewSimulationTime(MR_SimulationTime pCorrection)
+{
+	mSlewRemaining = pCorrection;
 }
 
 MR_SimulationTime GameSession::GetSimulationTime() const
@@ -110,18 +173,69 @@ MR_SimulationTime GameSession::GetSimulationTime() const
 	return mSimulationTime;
 }
 
+/**
+ * Retrieve the number of simulation slices run by the last Simulate() call
+ * (including any SimulateUntil() calls before it).
+ * @return The number of slices.
+ */
+int GameSession::GetLastSliceCount() const
+{
+	return mLastSliceCount;
+}
+
+/**
+ * Retrieve the number of simulation slices run since the session started.
+ * @return The number of slices.
+ */
+MR_UInt32 GameSession::GetTotalSliceCount() const
+{
+	return mTotalSliceCount;
+}
+
 void GameSession::Simulate()
+{
+	SimulateTo(Util::OS::Time(), TRUE);
+}
+
+/**
+ * Run the simulation up to a moment that is already past, in the middle of
+ * a frame.
+ * This lets events (such as player input) take effect at the time they
+ * actually happened instead of at the start of the next frame.  Time too
+ * short to be simulated is carried over to the next call, and clock
+ * corrections are only applied by Simulate().
+ * @param pTime The time to simulate up to (from Util::OS::Time()).
+ *              Times that have already been simulated are ignored.
+ */
+void GameSession::SimulateUntil(Util::OS::timestamp_t pTime)
+{
+	SimulateTo(pTime, FALSE);
+}
+
+void GameSession::SimulateTo(Util::OS::timestamp_t pTime, BOOL pEndOfFrame)
 {
 	ASSERT(mCurrentLevel != NULL);
 
-	Util::OS::timestamp_t lSimulateCallTime = Util::OS::Time();
+	Util::OS::timestamp_t lSimulateCallTime = pTime;
 	MR_SimulationTime lTimeToSimulate;
 
 	// Determine the duration of the simulation step
 	lTimeToSimulate = lSimulateCallTime - mLastSimulateCallTime;
 
-	if(lTimeToSimulate < 0)
+	if(lTimeToSimulate < 0) {
+		if(!pEndOfFrame)
+			return;
 		lTimeToSimulate = 0;
+	}
+
+	// Apply part of any pending clock correction
+	if(pEndOfFrame && mSlewRemaining != 0 && lTimeToSimulate > 0) {
+		MR_SimulationTime lMaxSlew = max<MR_SimulationTime>(1, lTimeToSimulate / MR_MAX_SLEW_RATE);
+		MR_SimulationTime lSlew = max(-lMaxSlew, min(lMaxSlew, mSlewRemaining));
+
+		lTimeToSimulate += lSlew;
+		mSlewRemaining -= lSlew;
+	}
 
 	/*
 	   if( (lTimeToSimulate < 0 )||(lTimeToSimulate>500) )
@@ -135,16 +249,27 @@ void GameSession::Simulate()
 	   }
 	 */
 
+	int lSliceCount = 0;
+
 	while(lTimeToSimulate >= MR_SIMULATION_SLICE) {
 		SimulateFreeElems(mSimulationTime < 0 ? 0 : MR_SIMULATION_SLICE);
 		lTimeToSimulate -= MR_SIMULATION_SLICE;
 		mSimulationTime += MR_SIMULATION_SLICE;
+		lSliceCount++;
 	}
 
 	if(lTimeToSimulate >= MR_MINIMUM_SIMULATION_SLICE) {
 		SimulateFreeElems(mSimulationTime < 0 ? 0 : lTimeToSimulate);
 		mSimulationTime += lTimeToSimulate;
 		lTimeToSimulate = 0;
+		lSliceCount++;
+	}
+
+	mPendingSliceCount += lSliceCount;
+	mTotalSliceCount += lSliceCount;
+	if(pEndOfFrame) {
+		mLastSliceCount = mPendingSliceCount;
+		mPendingSliceCount = 0;
 	}
 
 	SimulateSurfaceElems(lSimulateCallTime - lTimeToSimulate - mLastSimulateCallTime);
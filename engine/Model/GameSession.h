@@ -50,9 +50,14 @@ class GameSession
 
 		MR_SimulationTime mSimulationTime;		  // Time simulated since the session start
 		Util::OS::timestamp_t mLastSimulateCallTime;			  // Time in ms obtainend by timeGetTime
+		MR_SimulationTime mSlewRemaining;		  // Clock correction not yet applied
+		int mLastSliceCount;					  // Slices run by the last Simulate()
+		int mPendingSliceCount;					  // Slices run by SimulateUntil() since then
+		MR_UInt32 mTotalSliceCount;
 
 		BOOL LoadLevel(int pLevelIndex, char pGameOpts);
 		void Clean();							  // Clean up before destruction or clean-up
+		void SimulateTo(Util::OS::timestamp_t pTime, BOOL pEndOfFrame);
 
 		void SimulateFreeElems(MR_SimulationTime pDuration);
 		int SimulateOneFreeElem(MR_SimulationTime pTimeToSimulate, MR_FreeElementHandle pElementHandle, int pRoom);
@@ -66,10 +71,16 @@ class GameSession
 		MR_DllDeclare ~GameSession();
 
 		MR_DllDeclare BOOL LoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile, char pGameOpts);
+		MR_DllDeclare BOOL LoadNew(const char *pTitle, Parcel::RecordFilePtr pMazeFile, Level *pLevel);
+		MR_DllDeclare BOOL IsRenderingAllowed() const;
 
 		MR_DllDeclare void SetSimulationTime(MR_SimulationTime);
 		MR_DllDeclare MR_SimulationTime GetSimulationTime() const;
+		MR_DllDeclare void SlewSimulationTime(MR_SimulationTime pCorrection);
 		MR_DllDeclare void Simulate();
+		MR_DllDeclare void SimulateUntil(Util::OS::timestamp_t pTime);
+		MR_DllDeclare int GetLastSliceCount() const;
+		MR_DllDeclare MR_UInt32 GetTotalSliceCount() const;
 		MR_DllDeclare void SimulateLateElement(MR_FreeElementHandle pElement, MR_SimulationTime pDuration, int pRoom);
 
 		MR_DllDeclare Level *GetCurrentLevel() const;
@@ -21,15 +21,70 @@
 
 #include "StdAfx.h"
 
+#include <vector>
+
+#include <boost/static_assert.hpp>
+
 #include "../Parcel/ObjStream.h"
 
 #include "Level.h"
 
 using HoverRace::Parcel::ObjStream;
+using HoverRace::Parcel::ObjStreamExn;
 
 namespace HoverRace {
 namespace Model {
 
+namespace {
+	// Layout of the entries of the level image (see Level::SerializeImage).
+	// Offsets in an entry are word indexes into the image.
+	enum {
+		eImgNbVertex,
+		eImgFloorLevel,
+		eImgCeilingLevel,
+		eImgMinX, eImgMinY,
+		eImgMaxX, eImgMaxY,
+		eImgVertexList,
+		eImgWallLen,
+		eImgSectionWords
+	};
+	enum {
+		eImgParentSection = eImgSectionWords,
+		eImgFeatureWords
+	};
+	enum {
+		eImgNeighborList = eImgSectionWords,
+		eImgNbChild, eImgChildList,
+		eImgNbVisibleRoom, eImgVisibleRoomList,
+		eImgNbVisibleSurface, eImgVisibleFloorList, eImgVisibleCeilingList,
+		eImgNbAudibleRoom, eImgAudibleRoomList,
+		eImgRoomWords
+	};
+	enum {
+		eImgAudSectionSource,
+		eImgAudNbVertexSources,
+		eImgAudVertexList,
+		eImgAudSoundCoefficient,				  // Offset into the byte arena
+		eImgAudibleRoomWords
+	};
+
+	// Arrays are used in place, so they must match the image layout
+	BOOST_STATIC_ASSERT(sizeof(MR_2DCoordinate) == 2 * sizeof(MR_Int32));
+	BOOST_STATIC_ASSERT(sizeof(SectionId) == 2 * sizeof(MR_Int32));
+	BOOST_STATIC_ASSERT(sizeof(int) == sizeof(MR_Int32));
+
+	// Largest image that will be loaded (in 32-bit words)
+	const MR_UInt32 MAX_IMAGE_WORDS = 64 * 1024 * 1024;
+
+	MR_Int32 AppendImage(std::vector<MR_Int32> &pImage, const void *pData, int pWords)
+	{
+		MR_Int32 lOffset = static_cast<MR_Int32>(pImage.size());
+		const MR_Int32 *lData = static_cast<const MR_Int32*>(pData);
+		pImage.insert(pImage.end(), lData, lData + pWords);
+		return lOffset;
+	}
+}
+
 // Level implementation
 Level::Level(BOOL pAllowRendering, char pGameOpts)
 {
@@ -53,17 +108,24 @@ Level::Level(BOOL pAllowRendering, char pGameOpts)
 	mNbPermNetActor = 0;
 	mPermActorCacheCount = 0;
 
+	mImage = NULL;
+	mImageWords = 0;
+	mImageBytes = 0;
+	mImageWallTextures = NULL;
+	mImageAudibleRooms = NULL;
+
 }
 
 Level::~Level()
 {
+	int lCounter;
 
 	// Delete free elements
 	while(mFreeElementNonClassifiedList != NULL) {
 		delete mFreeElementNonClassifiedList;
 	}
 
-	for(int lCounter = 0; lCounter < mNbRoom; lCounter++) {
+	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
 		while(mFreeElementClassifiedByRoomList[lCounter] != NULL) {
 			delete mFreeElementClassifiedByRoomList[lCounter];
 		}
@@ -71,10 +133,26 @@ Level::~Level()
 
 	delete[]mFreeElementClassifiedByRoomList;
 
+	// The audible rooms of the image point into the image too
+	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
+		Room &lRoom = mRoomList[lCounter];
+
+		if(lRoom.mInImage) {
+			for(int lAudible = 0; lAudible < lRoom.mNbAudibleRoom; lAudible++) {
+				lRoom.mAudibleRoomList[lAudible].mVertexList = NULL;
+				lRoom.mAudibleRoomList[lAudible].mSoundCoefficient = NULL;
+			}
+		}
+	}
+
 	// Delete structure
 	delete[]mRoomList;
 	delete[]mFeatureList;
 
+	delete[]mImageAudibleRooms;
+	delete[]mImageWallTextures;
+	delete[]mImage;
+
 }
 
 void Level::SetBroadcastHook(void (*pCreationHook) (FreeElement *, int, void *), void (*pStateHook) (FreeElement *, int, int, void *), void *pHookData)
@@ -85,34 +163,14 @@ void Level::SetBroadcastHook(void (*pCreationHook) (FreeElement *, int, void *),
 }
 
 // Serialization
-void Level::Serialize(ObjStream &pArchive)
+void Level::Serialize(ObjStream &pArchive, LoadProgress *pProgress)
 {
 	int lCounter;
-	int lPlayerNo;
+	int lProgress = 0;
+	int lProgressTotal;
 
 	// Serialize the starting position
-	if(pArchive.IsWriting()) {
-		pArchive << mNbPlayer;
-
-		for(lPlayerNo = 0; lPlayerNo < mNbPlayer; lPlayerNo++) {
-			pArchive << mPlayerTeam[lPlayerNo];
-			pArchive << mStartingRoom[lPlayerNo];
-			mStartingPosition[lPlayerNo].Serialize(pArchive);
-			pArchive << mStartingOrientation[lPlayerNo];
-		}
-	}
-	else {
-		mNbPermNetActor = 0;
-
-		pArchive >> mNbPlayer;
-
-		for(lPlayerNo = 0; lPlayerNo < mNbPlayer; lPlayerNo++) {
-			pArchive >> mPlayerTeam[lPlayerNo];
-			pArchive >> mStartingRoom[lPlayerNo];
-			mStartingPosition[lPlayerNo].Serialize(pArchive);
-			pArchive >> mStartingOrientation[lPlayerNo];
-		}
-	}
+	SerializePlayers(pArchive);
 
 	// Serialize the structure
 	if(pArchive.IsWriting()) {
@@ -135,14 +193,157 @@ void Level::Serialize(ObjStream &pArchive)
 		}
 	}
 
+	// Each room and feature is visited once for the structure and once for
+	// the logic state; rooms are visited once more for the elements
+	lProgressTotal = 3 * mNbRoom + 2 * mNbFeature;
+
 	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
 		mRoomList[lCounter].SerializeStructure(pArchive);
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++lProgress, lProgressTotal);
+		}
 	}
 
 	for(lCounter = 0; lCounter < mNbFeature; lCounter++) {
 		mFeatureList[lCounter].SerializeStructure(pArchive);
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++lProgress, lProgressTotal);
+		}
 	}
 
+	SerializeElements(pArchive, pProgress, lProgress, lProgressTotal);
+}
+
+/**
+ * Serialize the level using the precompiled level image.
+ *
+ * This is an alternative to Serialize() that is much faster to load: all of
+ * the structural arrays (vertices, connectivity, visibility and sound lists)
+ * are stored as a single flat arena with offsets instead of pointers, which
+ * is read in one block and then used in place by every section.  Only the
+ * surfaces and elements (which come from object factories) are still
+ * deserialized one by one.
+ *
+ * The image starts with the room and feature count, followed by one entry
+ * per room and per feature, then the arrays they refer to.  A separate byte
+ * arena holds the sound coefficients.
+ *
+ * @param pArchive The stream.
+ * @param pProgress Optional progress listener.
+ * @return @c FALSE if the image is not in a supported format (nothing is
+ *         loaded; use Serialize() with the regular level record instead).
+ * @throws ObjStreamExn The image is corrupt.
+ */
+BOOL Level::SerializeImage(ObjStream &pArchive, LoadProgress *pProgress)
+{
+	int lCounter;
+	int lProgress = 0;
+	int lProgressTotal;
+
+	if(pArchive.IsWriting()) {
+		std::vector<MR_Int32> lWords;
+		std::vector<MR_UInt8> lBytes;
+
+		BuildImage(lWords, lBytes);
+
+		pArchive << IMAGE_MAGIC << IMAGE_VERSION;
+		SerializePlayers(pArchive);
+
+		pArchive << (MR_UInt32) lWords.size() << (MR_UInt32) lBytes.size();
+		pArchive.WriteArray(&lWords[0], lWords.size());
+		if(!lBytes.empty()) {
+			pArchive.WriteArray(&lBytes[0], lBytes.size());
+		}
+	}
+	else {
+		ASSERT(mRoomList == NULL);
+		ASSERT(mImage == NULL);
+
+		MR_UInt32 lMagic;
+		MR_UInt32 lVersion;
+
+		pArchive >> lMagic >> lVersion;
+		if(lMagic != IMAGE_MAGIC || lVersion != IMAGE_VERSION) {
+			return FALSE;
+		}
+
+		SerializePlayers(pArchive);
+
+		pArchive >> mImageWords >> mImageBytes;
+		if(mImageWords < 2 || mImageWords > MAX_IMAGE_WORDS || mImageBytes > MAX_IMAGE_WORDS) {
+			throw ObjStreamExn(pArchive.GetName(), _("Corrupt level image"));
+		}
+
+		// One allocation and one read for the whole structure
+		mImage = new MR_Int32[mImageWords + (mImageBytes + 3) / 4];
+		pArchive.ReadArray(mImage, mImageWords);
+		pArchive.ReadArray(reinterpret_cast<MR_UInt8*>(mImage + mImageWords), mImageBytes);
+
+		AttachImage();
+	}
+
+	// Same progress steps as Serialize(), with the surfaces standing in for
+	// the structure
+	lProgressTotal = 3 * mNbRoom + 2 * mNbFeature;
+
+	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
+		mRoomList[lCounter].SerializeSurfaces(pArchive);
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++lProgress, lProgressTotal);
+		}
+	}
+
+	for(lCounter = 0; lCounter < mNbFeature; lCounter++) {
+		mFeatureList[lCounter].SerializeSurfaces(pArchive);
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++lProgress, lProgressTotal);
+		}
+	}
+
+	SerializeElements(pArchive, pProgress, lProgress, lProgressTotal);
+
+	return TRUE;
+}
+
+void Level::SerializePlayers(ObjStream &pArchive)
+{
+	int lPlayerNo;
+
+	if(pArchive.IsWriting()) {
+		pArchive << mNbPlayer;
+
+		for(lPlayerNo = 0; lPlayerNo < mNbPlayer; lPlayerNo++) {
+			pArchive << mPlayerTeam[lPlayerNo];
+			pArchive << mStartingRoom[lPlayerNo];
+			mStartingPosition[lPlayerNo].Serialize(pArchive);
+			pArchive << mStartingOrientation[lPlayerNo];
+		}
+	}
+	else {
+		mNbPermNetActor = 0;
+
+		pArchive >> mNbPlayer;
+		if(mNbPlayer < 0 || mNbPlayer > MR_NB_MAX_PLAYER) {
+			throw ObjStreamExn(pArchive.GetName(), _("Invalid player count"));
+		}
+
+		for(lPlayerNo = 0; lPlayerNo < mNbPlayer; lPlayerNo++) {
+			pArchive >> mPlayerTeam[lPlayerNo];
+			pArchive >> mStartingRoom[lPlayerNo];
+			mStartingPosition[lPlayerNo].Serialize(pArchive);
+			pArchive >> mStartingOrientation[lPlayerNo];
+		}
+	}
+}
+
+/**
+ * Serialize the free elements and the logic state of every surface.
+ * This is the part of the level that follows the structure.
+ */
+void Level::SerializeElements(ObjStream &pArchive, LoadProgress *pProgress, int &pProgressDone, int pProgressTotal)
+{
+	int lCounter;
+
 	// Serialise the actors
 
 	FreeElementList::SerializeList(pArchive, &mFreeElementNonClassifiedList);
@@ -167,6 +368,10 @@ void Level::Serialize(ObjStream &pArchive)
 				lCurrentElem = lCurrentElem->mNext;
 			}
 		}
+
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++pProgressDone, pProgressTotal);
+		}
 	}
 
 	// remove unwanted elements
@@ -196,12 +401,250 @@ void Level::Serialize(ObjStream &pArchive)
 	// elements have a link between them
 	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
 		mRoomList[lCounter].SerializeSurfacesLogicState(pArchive);
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++pProgressDone, pProgressTotal);
+		}
 	}
 
 	for(lCounter = 0; lCounter < mNbFeature; lCounter++) {
 		mFeatureList[lCounter].SerializeSurfacesLogicState(pArchive);
+		if(pProgress != NULL) {
+			pProgress->OnLoadProgress(++pProgressDone, pProgressTotal);
+		}
+	}
+
+}
+
+/**
+ * Lay out the level structure as a level image.
+ * @param pWords Receives the word arena.
+ * @param pBytes Receives the byte arena.
+ */
+void Level::BuildImage(std::vector<MR_Int32> &pWords, std::vector<MR_UInt8> &pBytes) const
+{
+	int lCounter;
+
+	pWords.push_back(mNbRoom);
+	pWords.push_back(mNbFeature);
+
+	size_t lRoomTable = pWords.size();
+	size_t lFeatureTable = lRoomTable + mNbRoom * eImgRoomWords;
+	pWords.resize(lFeatureTable + mNbFeature * eImgFeatureWords, 0);
+
+	// Entries are addressed by index since the arrays are appended to the
+	// same vector
+	for(lCounter = 0; lCounter < mNbRoom + mNbFeature; lCounter++) {
+		const Section &lSection = (lCounter < mNbRoom) ?
+			static_cast<const Section&>(mRoomList[lCounter]) :
+			static_cast<const Section&>(mFeatureList[lCounter - mNbRoom]);
+		size_t lEntry = (lCounter < mNbRoom) ?
+			lRoomTable + lCounter * eImgRoomWords :
+			lFeatureTable + (lCounter - mNbRoom) * eImgFeatureWords;
+
+		pWords[lEntry + eImgNbVertex] = lSection.mNbVertex;
+		pWords[lEntry + eImgFloorLevel] = lSection.mFloorLevel;
+		pWords[lEntry + eImgCeilingLevel] = lSection.mCeilingLevel;
+		pWords[lEntry + eImgMinX] = lSection.mMin.mX;
+		pWords[lEntry + eImgMinY] = lSection.mMin.mY;
+		pWords[lEntry + eImgMaxX] = lSection.mMax.mX;
+		pWords[lEntry + eImgMaxY] = lSection.mMax.mY;
+		pWords[lEntry + eImgVertexList] = AppendImage(pWords, lSection.mVertexList, lSection.mNbVertex * 2);
+		pWords[lEntry + eImgWallLen] = AppendImage(pWords, lSection.mWallLen, lSection.mNbVertex);
+	}
+
+	for(lCounter = 0; lCounter < mNbFeature; lCounter++) {
+		size_t lEntry = lFeatureTable + lCounter * eImgFeatureWords;
+
+		pWords[lEntry + eImgParentSection] = mFeatureList[lCounter].mParentSectionIndex;
+	}
+
+	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
+		const Room &lRoom = mRoomList[lCounter];
+		size_t lEntry = lRoomTable + lCounter * eImgRoomWords;
+
+		pWords[lEntry + eImgNeighborList] = AppendImage(pWords, lRoom.mNeighborList, lRoom.mNbVertex);
+		pWords[lEntry + eImgNbChild] = lRoom.mNbChild;
+		pWords[lEntry + eImgChildList] = AppendImage(pWords, lRoom.mChildList, lRoom.mNbChild);
+		pWords[lEntry + eImgNbVisibleRoom] = lRoom.mNbVisibleRoom;
+		pWords[lEntry + eImgVisibleRoomList] = AppendImage(pWords, lRoom.mVisibleRoomList, lRoom.mNbVisibleRoom);
+		pWords[lEntry + eImgNbVisibleSurface] = lRoom.mNbVisibleSurface;
+		pWords[lEntry + eImgVisibleFloorList] = AppendImage(pWords, lRoom.mVisibleFloorList, lRoom.mNbVisibleSurface * 2);
+		pWords[lEntry + eImgVisibleCeilingList] = AppendImage(pWords, lRoom.mVisibleCeilingList, lRoom.mNbVisibleSurface * 2);
+		pWords[lEntry + eImgNbAudibleRoom] = lRoom.mNbAudibleRoom;
+
+		size_t lAudibleTable = pWords.size();
+		pWords[lEntry + eImgAudibleRoomList] = static_cast<MR_Int32>(lAudibleTable);
+		pWords.resize(lAudibleTable + lRoom.mNbAudibleRoom * eImgAudibleRoomWords, 0);
+
+		for(int lAudible = 0; lAudible < lRoom.mNbAudibleRoom; lAudible++) {
+			const Room::AudibleRoom &lAudibleRoom = lRoom.mAudibleRoomList[lAudible];
+			size_t lAudibleEntry = lAudibleTable + lAudible * eImgAudibleRoomWords;
+
+			pWords[lAudibleEntry + eImgAudSectionSource] = lAudibleRoom.mSectionSource;
+			pWords[lAudibleEntry + eImgAudNbVertexSources] = lAudibleRoom.mNbVertexSources;
+			pWords[lAudibleEntry + eImgAudVertexList] = AppendImage(pWords, lAudibleRoom.mVertexList, lAudibleRoom.mNbVertexSources);
+			pWords[lAudibleEntry + eImgAudSoundCoefficient] = static_cast<MR_Int32>(pBytes.size());
+			pBytes.insert(pBytes.end(), lAudibleRoom.mSoundCoefficient,
+				lAudibleRoom.mSoundCoefficient + lAudibleRoom.mNbVertexSources);
+		}
+	}
+}
+
+/**
+ * Get a pointer to an array in the level image.
+ * @param pOffset The word offset of the array.
+ * @param pCount The number of items.
+ * @param pItemWords The size of each item, in words.
+ * @return The array (may be @c NULL if the array is empty).
+ * @throws ObjStreamExn The array is not entirely inside the image.
+ */
+MR_Int32 *Level::GetImageSlice(MR_Int32 pOffset, MR_Int32 pCount, int pItemWords) const
+{
+	if(pCount == 0) {
+		return NULL;
+	}
+	if(pOffset < 0 || pCount < 0 || (MR_UInt32) pOffset > mImageWords ||
+		(MR_UInt32) pCount > (mImageWords - (MR_UInt32) pOffset) / pItemWords)
+	{
+		throw ObjStreamExn(_("Corrupt level image"));
+	}
+	return mImage + pOffset;
+}
+
+/**
+ * Point the rooms and features at the arrays of the level image.
+ * Every offset is checked before it is used.
+ * @throws ObjStreamExn The image is corrupt.
+ */
+void Level::AttachImage()
+{
+	int lCounter;
+	int lNbVertex = 0;
+	int lNbAudibleRoom = 0;
+
+	MR_Int32 lNbRoom = mImage[0];
+	MR_Int32 lNbFeature = mImage[1];
+	const MR_Int32 *lRoomTable = GetImageSlice(2, lNbRoom, eImgRoomWords);
+	const MR_Int32 *lFeatureTable = GetImageSlice(2 + lNbRoom * eImgRoomWords, lNbFeature, eImgFeatureWords);
+
+	// Count the shared arrays first so that they can be allocated at once
+	// (every vertex and audible room takes up at least one word of its own,
+	// so neither can outnumber the words in the image)
+	for(lCounter = 0; lCounter < lNbRoom + lNbFeature; lCounter++) {
+		const MR_Int32 *lEntry = (lCounter < lNbRoom) ?
+			lRoomTable + lCounter * eImgRoomWords :
+			lFeatureTable + (lCounter - lNbRoom) * eImgFeatureWords;
+
+		if(lEntry[eImgNbVertex] < 0 || lEntry[eImgNbVertex] > (MR_Int32) mImageWords - lNbVertex) {
+			throw ObjStreamExn(_("Corrupt level image"));
+		}
+		lNbVertex += lEntry[eImgNbVertex];
+
+		if(lCounter < lNbRoom) {
+			if(lEntry[eImgNbAudibleRoom] < 0 ||
+				lEntry[eImgNbAudibleRoom] > (MR_Int32) mImageWords - lNbAudibleRoom)
+			{
+				throw ObjStreamExn(_("Corrupt level image"));
+			}
+			lNbAudibleRoom += lEntry[eImgNbAudibleRoom];
+		}
+	}
+
+	mNbRoom = lNbRoom;
+	mNbFeature = lNbFeature;
+	mRoomList = new Room[mNbRoom];
+	mFeatureList = new Feature[mNbFeature];
+	mFreeElementClassifiedByRoomList = new FreeElementList *[mNbRoom];
+
+	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
+		mFreeElementClassifiedByRoomList[lCounter] = NULL;
+	}
+
+	mImageWallTextures = new SurfaceElement *[lNbVertex];
+	for(lCounter = 0; lCounter < lNbVertex; lCounter++) {
+		mImageWallTextures[lCounter] = NULL;
+	}
+	mImageAudibleRooms = (lNbAudibleRoom == 0) ? NULL : new Room::AudibleRoom[lNbAudibleRoom];
+
+	SurfaceElement **lWallTextures = mImageWallTextures;
+	Room::AudibleRoom *lAudibleRooms = mImageAudibleRooms;
+	const MR_UInt8 *lBytes = reinterpret_cast<const MR_UInt8*>(mImage + mImageWords);
+
+	for(lCounter = 0; lCounter < mNbRoom; lCounter++) {
+		Room &lRoom = mRoomList[lCounter];
+		const MR_Int32 *lEntry = lRoomTable + lCounter * eImgRoomWords;
+
+		AttachSectionImage(lRoom, lEntry, lWallTextures);
+		lWallTextures += lRoom.mNbVertex;
+
+		lRoom.mNeighborList = GetImageSlice(lEntry[eImgNeighborList], lRoom.mNbVertex, 1);
+		lRoom.mChildList = GetImageSlice(lEntry[eImgChildList], lEntry[eImgNbChild], 1);
+		lRoom.mNbChild = lEntry[eImgNbChild];
+		lRoom.mVisibleRoomList = GetImageSlice(lEntry[eImgVisibleRoomList], lEntry[eImgNbVisibleRoom], 1);
+		lRoom.mNbVisibleRoom = lEntry[eImgNbVisibleRoom];
+		lRoom.mVisibleFloorList = reinterpret_cast<SectionId*>(
+			GetImageSlice(lEntry[eImgVisibleFloorList], lEntry[eImgNbVisibleSurface], 2));
+		lRoom.mVisibleCeilingList = reinterpret_cast<SectionId*>(
+			GetImageSlice(lEntry[eImgVisibleCeilingList], lEntry[eImgNbVisibleSurface], 2));
+		lRoom.mNbVisibleSurface = lEntry[eImgNbVisibleSurface];
+
+		const MR_Int32 *lAudibleTable = GetImageSlice(lEntry[eImgAudibleRoomList],
+			lEntry[eImgNbAudibleRoom], eImgAudibleRoomWords);
+
+		lRoom.mAudibleRoomList = (lEntry[eImgNbAudibleRoom] == 0) ? NULL : lAudibleRooms;
+		lRoom.mNbAudibleRoom = lEntry[eImgNbAudibleRoom];
+		lAudibleRooms += lRoom.mNbAudibleRoom;
+
+		for(int lAudible = 0; lAudible < lRoom.mNbAudibleRoom; lAudible++) {
+			Room::AudibleRoom &lAudibleRoom = lRoom.mAudibleRoomList[lAudible];
+			const MR_Int32 *lAudibleEntry = lAudibleTable + lAudible * eImgAudibleRoomWords;
+			MR_Int32 lNbSources = lAudibleEntry[eImgAudNbVertexSources];
+			MR_Int32 lCoefficients = lAudibleEntry[eImgAudSoundCoefficient];
+
+			if(lNbSources < 0 || lCoefficients < 0 ||
+				(MR_UInt32) lCoefficients > mImageBytes ||
+				(MR_UInt32) lNbSources > mImageBytes - (MR_UInt32) lCoefficients)
+			{
+				throw ObjStreamExn(_("Corrupt level image"));
+			}
+
+			lAudibleRoom.mSectionSource = lAudibleEntry[eImgAudSectionSource];
+			lAudibleRoom.mVertexList = GetImageSlice(lAudibleEntry[eImgAudVertexList], lNbSources, 1);
+			lAudibleRoom.mSoundCoefficient = const_cast<BYTE*>(lBytes + lCoefficients);
+			lAudibleRoom.mNbVertexSources = lNbSources;
+		}
+	}
+
+	for(lCounter = 0; lCounter < mNbFeature; lCounter++) {
+		Feature &lFeature = mFeatureList[lCounter];
+		const MR_Int32 *lEntry = lFeatureTable + lCounter * eImgFeatureWords;
+
+		AttachSectionImage(lFeature, lEntry, lWallTextures);
+		lWallTextures += lFeature.mNbVertex;
+
+		if(lEntry[eImgParentSection] < 0 || lEntry[eImgParentSection] >= lNbRoom) {
+			throw ObjStreamExn(_("Corrupt level image"));
+		}
+		lFeature.mParentSectionIndex = lEntry[eImgParentSection];
 	}
+}
+
+void Level::AttachSectionImage(Section &pSection, const MR_Int32 *pEntry, SurfaceElement **pWallTextures)
+{
+	pSection.mInImage = TRUE;
+
+	pSection.mVertexList = reinterpret_cast<MR_2DCoordinate*>(
+		GetImageSlice(pEntry[eImgVertexList], pEntry[eImgNbVertex], 2));
+	pSection.mWallLen = GetImageSlice(pEntry[eImgWallLen], pEntry[eImgNbVertex], 1);
+	pSection.mWallTexture = pWallTextures;
+	pSection.mNbVertex = pEntry[eImgNbVertex];
 
+	pSection.mFloorLevel = pEntry[eImgFloorLevel];
+	pSection.mCeilingLevel = pEntry[eImgCeilingLevel];
+	pSection.mMin.mX = pEntry[eImgMinX];
+	pSection.mMin.mY = pEntry[eImgMinY];
+	pSection.mMax.mX = pEntry[eImgMaxX];
+	pSection.mMax.mY = pEntry[eImgMaxY];
 }
 
 // Internal helper functions
@@ -324,6 +767,35 @@ int Level::GetNeighbor(int pRoomId, int pVertex) const
 	return mRoomList[pRoomId].mNeighborList[pVertex];
 }
 
+int Level::GetAudibleRoomCount(int pRoomId) const
+{
+	return mRoomList[pRoomId].mNbAudibleRoom;
+}
+
+/**
+ * Retrieve a room that can be heard from a room.
+ * @param pRoomId The listening room.
+ * @param pIndex The index of the audible room (less than GetAudibleRoomCount()).
+ * @param[out] pCoefficient The attenuation factor of the loudest connection
+ *                          the sound comes through, from 255 (no attenuation)
+ *                          down to 0 (silent).
+ * @return The source room, or @c -1 if it is not known (the level was not
+ *         loaded from a level image).
+ */
+int Level::GetAudibleRoom(int pRoomId, int pIndex, int &pCoefficient) const
+{
+	const Room::AudibleRoom &lAudible = mRoomList[pRoomId].mAudibleRoomList[pIndex];
+
+	pCoefficient = 0;
+	for(int lCounter = 0; lCounter < lAudible.mNbVertexSources; lCounter++) {
+		if(lAudible.mSoundCoefficient[lCounter] > pCoefficient) {
+			pCoefficient = lAudible.mSoundCoefficient[lCounter];
+		}
+	}
+
+	return lAudible.mSectionSource;
+}
+
 int Level::GetParent(int pFeatureId) const
 {
 	return mFeatureList[pFeatureId].mParentSectionIndex;
@@ -596,9 +1068,18 @@ void Level::Room::AudibleRoom::Serialize(ObjStream & pArchive)
 		mVertexList = new int[mNbVertexSources];
 		mSoundCoefficient = new BYTE[mNbVertexSources];
 
-		for(lCounter = 0; lCounter < mNbVertexSources; lCounter++) {
-			pArchive >> mVertexList[lCounter]
-				>> mSoundCoefficient[lCounter];
+		// Each source is a 32-bit vertex index followed by a one-byte
+		// coefficient; read them all at once and unpack
+		if(mNbVertexSources > 0) {
+			std::vector<MR_UInt8> lBuf(mNbVertexSources * 5);
+			pArchive.ReadArray(&lBuf[0], lBuf.size());
+
+			const MR_UInt8 *lPtr = &lBuf[0];
+			for(lCounter = 0; lCounter < mNbVertexSources; lCounter++, lPtr += 5) {
+				mVertexList[lCounter] = static_cast<MR_Int32>(
+					lPtr[0] | (lPtr[1] << 8) | (lPtr[2] << 16) | (lPtr[3] << 24));
+				mSoundCoefficient[lCounter] = lPtr[4];
+			}
 		}
 	}
 
@@ -663,12 +1144,16 @@ Level::Section::Section()
 	mFloorTexture = NULL;
 	mCeilingTexture = NULL;
 
+	mInImage = FALSE;
+
 }
 
 Level::Section::~Section()
 {
-	delete[]mVertexList;
-	delete[]mWallLen;
+	if(!mInImage) {
+		delete[]mVertexList;
+		delete[]mWallLen;
+	}
 
 	delete mFloorTexture;
 	delete mCeilingTexture;
@@ -676,7 +1161,9 @@ Level::Section::~Section()
 	for(int lCounter = 0; lCounter < mNbVertex; lCounter++) {
 		delete mWallTexture[lCounter];
 	}
-	delete[]mWallTexture;
+	if(!mInImage) {
+		delete[]mWallTexture;
+	}
 
 }
 
@@ -692,10 +1179,15 @@ void Level::Section::SerializeStructure(ObjStream & pArchive)
 		mMin.Serialize(pArchive);
 		mMax.Serialize(pArchive);
 
-		// Arrays
-		for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
-			mVertexList[lCounter].Serialize(pArchive);
-			pArchive << mWallLen[lCounter];
+		// Arrays (x, y and wall length of each vertex)
+		if(mNbVertex > 0) {
+			std::vector<MR_Int32> lBuf(mNbVertex * 3);
+			for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
+				lBuf[lCounter * 3] = mVertexList[lCounter].mX;
+				lBuf[lCounter * 3 + 1] = mVertexList[lCounter].mY;
+				lBuf[lCounter * 3 + 2] = mWallLen[lCounter];
+			}
+			pArchive.WriteArray(&lBuf[0], lBuf.size());
 		}
 
 	}
@@ -713,21 +1205,31 @@ void Level::Section::SerializeStructure(ObjStream & pArchive)
 		mVertexList = new MR_2DCoordinate[mNbVertex];
 		mWallLen = new MR_Int32[mNbVertex];
 
-		for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
-			mVertexList[lCounter].Serialize(pArchive);
-			pArchive >> mWallLen[lCounter];
+		if(mNbVertex > 0) {
+			std::vector<MR_Int32> lBuf(mNbVertex * 3);
+			pArchive.ReadArray(&lBuf[0], lBuf.size());
+			for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
+				mVertexList[lCounter].mX = lBuf[lCounter * 3];
+				mVertexList[lCounter].mY = lBuf[lCounter * 3 + 1];
+				mWallLen[lCounter] = lBuf[lCounter * 3 + 2];
+			}
 		}
 	}
 
 	// Serialize the textures
-	Util::ObjectFromFactory::SerializePtr(pArchive, (Util::ObjectFromFactory * &)mFloorTexture);
-	Util::ObjectFromFactory::SerializePtr(pArchive, (Util::ObjectFromFactory * &)mCeilingTexture);
-
 	if(!pArchive.IsWriting()) {
 		mWallTexture = new SurfaceElement *[mNbVertex];
 	}
 
-	for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
+	SerializeSurfaces(pArchive);
+}
+
+void Level::Section::SerializeSurfaces(ObjStream & pArchive)
+{
+	Util::ObjectFromFactory::SerializePtr(pArchive, (Util::ObjectFromFactory * &)mFloorTexture);
+	Util::ObjectFromFactory::SerializePtr(pArchive, (Util::ObjectFromFactory * &)mCeilingTexture);
+
+	for(int lCounter = 0; lCounter < mNbVertex; lCounter++) {
 		Util::ObjectFromFactory::SerializePtr(pArchive, (Util::ObjectFromFactory * &)mWallTexture[lCounter]);
 	}
 }
@@ -770,12 +1272,14 @@ Level::Room::Room()
 
 Level::Room::~Room()
 {
-	delete[]mChildList;
-	delete[]mNeighborList;
-	delete[]mVisibleRoomList;
-	delete[]mAudibleRoomList;
-	delete[]mVisibleFloorList;
-	delete[]mVisibleCeilingList;
+	if(!mInImage) {
+		delete[]mChildList;
+		delete[]mNeighborList;
+		delete[]mVisibleRoomList;
+		delete[]mAudibleRoomList;
+		delete[]mVisibleFloorList;
+		delete[]mVisibleCeilingList;
+	}
 }
 
 void Level::Room::SerializeStructure(ObjStream & pArchive)
@@ -789,22 +1293,22 @@ void Level::Room::SerializeStructure(ObjStream & pArchive)
 		pArchive << mNbVisibleSurface;
 		pArchive << mNbAudibleRoom;
 
-		for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
-			pArchive << mNeighborList[lCounter];
-		}
-
-		for(lCounter = 0; lCounter < mNbChild; lCounter++) {
-			pArchive << mChildList[lCounter];
-		}
-
-		for(lCounter = 0; lCounter < mNbVisibleRoom; lCounter++) {
+		pArchive.WriteArray(mNeighborList, mNbVertex);
+		pArchive.WriteArray(mChildList, mNbChild);
 												  // List of the room that are visible from the current room
-			pArchive << mVisibleRoomList[lCounter];
-		}
-
-		for(lCounter = 0; lCounter < mNbVisibleSurface; lCounter++) {
-			mVisibleFloorList[lCounter].Serialize(pArchive);
-			mVisibleCeilingList[lCounter].Serialize(pArchive);
+		pArchive.WriteArray(mVisibleRoomList, mNbVisibleRoom);
+
+		// Floor and ceiling (type and id of each) of every visible surface
+		if(mNbVisibleSurface > 0) {
+			std::vector<MR_Int32> lBuf(mNbVisibleSurface * 4);
+			for(lCounter = 0; lCounter < mNbVisibleSurface; lCounter++) {
+				MR_Int32 *lPtr = &lBuf[lCounter * 4];
+				lPtr[0] = (int) mVisibleFloorList[lCounter].mType;
+				lPtr[1] = mVisibleFloorList[lCounter].mId;
+				lPtr[2] = (int) mVisibleCeilingList[lCounter].mType;
+				lPtr[3] = mVisibleCeilingList[lCounter].mId;
+			}
+			pArchive.WriteArray(&lBuf[0], lBuf.size());
 		}
 
 		for(lCounter = 0; lCounter < mNbAudibleRoom; lCounter++) {
@@ -838,22 +1342,22 @@ void Level::Room::SerializeStructure(ObjStream & pArchive)
 			mAudibleRoomList = new AudibleRoom[mNbAudibleRoom];
 		}
 
-		for(lCounter = 0; lCounter < mNbVertex; lCounter++) {
-			pArchive >> mNeighborList[lCounter];
-		}
-
-		for(lCounter = 0; lCounter < mNbChild; lCounter++) {
-			pArchive >> mChildList[lCounter];
-		}
-
-		for(lCounter = 0; lCounter < mNbVisibleRoom; lCounter++) {
+		pArchive.ReadArray(mNeighborList, mNbVertex);
+		pArchive.ReadArray(mChildList, mNbChild);
 												  // List of the room that are visible from the current room
-			pArchive >> mVisibleRoomList[lCounter];
-		}
-
-		for(lCounter = 0; lCounter < mNbVisibleSurface; lCounter++) {
-			mVisibleFloorList[lCounter].Serialize(pArchive);
-			mVisibleCeilingList[lCounter].Serialize(pArchive);
+		pArchive.ReadArray(mVisibleRoomList, mNbVisibleRoom);
+
+		// Floor and ceiling (type and id of each) of every visible surface
+		if(mNbVisibleSurface > 0) {
+			std::vector<MR_Int32> lBuf(mNbVisibleSurface * 4);
+			pArchive.ReadArray(&lBuf[0], lBuf.size());
+			for(lCounter = 0; lCounter < mNbVisibleSurface; lCounter++) {
+				const MR_Int32 *lPtr = &lBuf[lCounter * 4];
+				mVisibleFloorList[lCounter].mType = (SectionId::eSectionType) lPtr[0];
+				mVisibleFloorList[lCounter].mId = lPtr[1];
+				mVisibleCeilingList[lCounter].mType = (SectionId::eSectionType) lPtr[2];
+				mVisibleCeilingList[lCounter].mId = lPtr[3];
+			}
 		}
 
 		for(lCounter = 0; lCounter < mNbAudibleRoom; lCounter++) {
@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "MazeElement.h"
 #include "ShapeCollisions.h"
 #include "../Util/FastArray.h"
@@ -84,6 +86,15 @@ class MR_DllDeclare Level
 	public:
 		enum { eNonClassified = -1, eMustBeDeleted = -2 };
 
+		// Receives progress updates while a level is being loaded
+		// (possibly from a loader thread)
+		class LoadProgress
+		{
+			public:
+				virtual ~LoadProgress() { }
+				virtual void OnLoadProgress(int pDone, int pTotal) = 0;
+		};
+
 	protected:
 
 		// Class pre-declaration
@@ -138,11 +149,14 @@ class MR_DllDeclare Level
 				SurfaceElement *mFloorTexture;
 				SurfaceElement *mCeilingTexture;
 
+				BOOL mInImage;					  // Arrays point into the level image (not owned)
+
 				// Methods
 				Section();
 				~Section();
 
 				void SerializeStructure(Parcel::ObjStream &pArchive);
+				void SerializeSurfaces(Parcel::ObjStream &pArchive);
 				void SerializeSurfacesLogicState(Parcel::ObjStream &pArchive);
 
 		};
@@ -196,8 +210,9 @@ class MR_DllDeclare Level
 				SectionId *mVisibleFloorList;  // Ordered floor list
 				SectionId *mVisibleCeilingList;// Ordered ceiling list
 
-				int mNbAudibleRoom;				  // Theses members are only used by the server
+				int mNbAudibleRoom;				  // Size of mAudibleRoomList
 				AudibleRoom *mAudibleRoomList;	  // List of the room from where a sound can be heard from the current room
+				// The source rooms are only known when loaded from the level image
 
 				// Methods
 				Room();
@@ -262,6 +277,25 @@ class MR_DllDeclare Level
 		// Helper functions
 		int GetRealRoomRecursive(const MR_2DCoordinate & pPosition, int pOriginalSection, int = -1) const;
 
+	private:
+		// Precompiled level image (see SerializeImage)
+		MR_Int32 *mImage;						  // Word arena followed by the byte arena
+		MR_UInt32 mImageWords;
+		MR_UInt32 mImageBytes;
+		SurfaceElement **mImageWallTextures;	  // Wall textures of all sections
+		Room::AudibleRoom *mImageAudibleRooms;	  // Audible rooms of all rooms
+
+		void SerializePlayers(Parcel::ObjStream &pArchive);
+		void SerializeElements(Parcel::ObjStream &pArchive, LoadProgress *pProgress, int &pProgressDone, int pProgressTotal);
+
+		void BuildImage(std::vector<MR_Int32> &pWords, std::vector<MR_UInt8> &pBytes) const;
+		void AttachImage();
+		MR_Int32 *GetImageSlice(MR_Int32 pOffset, MR_Int32 pCount, int pItemWords) const;
+		void AttachSectionImage(Section &pSection, const MR_Int32 *pEntry, SurfaceElement **pWallTextures);
+
+		static const MR_UInt32 IMAGE_MAGIC = 0x474d494c;  // "LIMG"
+		static const MR_UInt32 IMAGE_VERSION = 1;
+
 	public:
 		Level(BOOL pAllowRendering = FALSE, char pGameOpts = 1);
 		~Level();
@@ -270,7 +304,8 @@ class MR_DllDeclare Level
 		void SetBroadcastHook(void (*pCreationHook) (FreeElement *, int, void *), void (*pStateHook) (FreeElement *, int, int, void *), void *pHookData);
 
 		// Serialisation functions
-		void Serialize(Parcel::ObjStream &pArchive);
+		void Serialize(Parcel::ObjStream &pArchive, LoadProgress *pProgress = NULL);
+		BOOL SerializeImage(Parcel::ObjStream &pArchive, LoadProgress *pProgress = NULL);
 
 		// Strucre Interrocation functions
 		int GetRoomCount() const;
@@ -302,6 +337,8 @@ class MR_DllDeclare Level
 		const SectionId *GetVisibleFloorList(int pRoomId) const;
 		const SectionId *GetVisibleCeilingList(int pRoomId) const;
 		int GetNeighbor(int pRoomId, int pVertex) const;
+		int GetAudibleRoomCount(int pRoomId) const;
+		int GetAudibleRoom(int pRoomId, int pIndex, int &pCoefficient) const;
 		int GetParent(int pFeatureId) const;
 		int GetFeatureCount(int pRoomId) const;
 		int GetFeature(int pRoomId, int pChildIndex) const;
@@ -28,3 +28,6 @@
 
 #define MR_NOBITMAP  0
 #define MR_RAWBITMAP 1
+
+// Optional record holding the precompiled level image (see Level::SerializeImage)
+#define MR_LEVEL_IMAGE_RECORD 4
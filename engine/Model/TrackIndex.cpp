@@ -0,0 +1,224 @@
+// TrackIndex.cpp
+// On-disk cache of track headers.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <boost/make_shared.hpp>
+
+#include "../Parcel/ClassicObjStream.h"
+#include "../Util/Str.h"
+
+#include "TrackIndex.h"
+
+namespace fs = boost::filesystem;
+
+using namespace HoverRace::Parcel;
+using HoverRace::Util::OS;
+namespace Str = HoverRace::Util::Str;
+
+namespace HoverRace {
+namespace Model {
+
+namespace {
+	inline std::string PathKey(const OS::path_t &path)
+	{
+		return (const char*)Str::PU(path);
+	}
+}
+
+/**
+ * Constructor.
+ * The existing index, if any, is loaded immediately.
+ * @param filename The index file (does not need to exist).
+ */
+TrackIndex::TrackIndex(const OS::path_t &filename) :
+	filename(filename), dirty(false)
+{
+	Load();
+}
+
+void TrackIndex::Load()
+{
+	FILE *in = OS::FOpen(filename, "rb");
+	if (in == NULL) {
+		dirty = true;
+		return;
+	}
+
+	try {
+		ClassicObjStream is(in, filename, false);
+
+		MR_UInt32 magic, version, num;
+		is >> magic >> version;
+		if (magic != FILE_MAGIC || version != FILE_VERSION) {
+			throw ObjStreamExn(filename, _("Stale track index"));
+		}
+
+		is >> num;
+		for (MR_UInt32 i = 0; i < num; ++i) {
+			std::string key;
+			Record rec;
+			MR_UInt8 valid;
+			is >> key >> rec.size >> rec.mtime >> valid;
+			if (valid) {
+				TrackEntryPtr ent = boost::make_shared<TrackEntry>();
+				is >> ent->name >> ent->description >>
+					ent->regMinor >> ent->regMajor >>
+					ent->registrationMode >> ent->sortingIndex;
+				rec.entry = ent;
+			}
+			records.insert(records_t::value_type(key, rec));
+		}
+	}
+	catch (ObjStreamExn&) {
+		// Start over; everything will be re-read and the index rewritten.
+		records.clear();
+		dirty = true;
+	}
+
+	fclose(in);
+}
+
+/**
+ * Look up the header of a track file.
+ * @param path The track file.
+ * @param size The current size of the file.
+ * @param mtime The current modification time of the file.
+ * @param[out] entry The cached header (@c NULL if the track is known to be
+ *                   unreadable).  Only set if the lookup succeeds.
+ * @return @c true if the cached header is still current,
+ *         @c false if the track needs to be (re-)read.
+ */
+bool TrackIndex::Find(const OS::path_t &path, MR_UInt32 size, MR_UInt32 mtime,
+                      TrackEntryPtr &entry)
+{
+	records_t::iterator iter = records.find(PathKey(path));
+	if (iter == records.end()) {
+		return false;
+	}
+
+	Record &rec = iter->second;
+	if (rec.size != size || rec.mtime != mtime) {
+		return false;
+	}
+
+	rec.used = true;
+	entry = rec.entry;
+	return true;
+}
+
+/**
+ * Add or replace the header of a track file.
+ * @param path The track file.
+ * @param size The current size of the file.
+ * @param mtime The current modification time of the file.
+ * @param entry The header (may be @c NULL if the track could not be read).
+ */
+void TrackIndex::Put(const OS::path_t &path, MR_UInt32 size, MR_UInt32 mtime,
+                     TrackEntryPtr entry)
+{
+	Record &rec = records[PathKey(path)];
+	rec.size = size;
+	rec.mtime = mtime;
+	rec.entry = entry;
+	rec.used = true;
+	dirty = true;
+}
+
+/**
+ * Write the index back to disk, if anything changed.
+ * Tracks which were neither looked up nor added since the index was loaded
+ * (e.g. because they were deleted) are dropped.
+ * @return @c true if successful (or nothing needed to be written).
+ */
+bool TrackIndex::Save()
+{
+	MR_UInt32 num = 0;
+	for (records_t::iterator iter = records.begin(); iter != records.end(); ) {
+		if (iter->second.used) {
+			++num;
+			++iter;
+		}
+		else {
+			records.erase(iter++);
+			dirty = true;
+		}
+	}
+
+	if (!dirty) return true;
+
+	// Write to a temporary file first so that a crash never leaves a
+	// half-written index behind.
+	OS::path_t tmpFilename(filename);
+	tmpFilename.replace_extension(".tmp");
+
+	try {
+		OS::path_t dir = filename.parent_path();
+		if (!dir.empty() && !fs::exists(dir)) {
+			fs::create_directories(dir);
+		}
+	}
+	catch (OS::fs_error_t&) {
+		return false;
+	}
+
+	FILE *out = OS::FOpen(tmpFilename, "wb");
+	if (out == NULL) return false;
+
+	try {
+		ClassicObjStream os(out, tmpFilename, true);
+
+		os << FILE_MAGIC << FILE_VERSION << num;
+		BOOST_FOREACH(const records_t::value_type &ent, records) {
+			const Record &rec = ent.second;
+			os << ent.first << rec.size << rec.mtime <<
+				static_cast<MR_UInt8>(rec.entry.get() == NULL ? 0 : 1);
+			if (rec.entry.get() != NULL) {
+				os << rec.entry->name << rec.entry->description <<
+					rec.entry->regMinor << rec.entry->regMajor <<
+					rec.entry->registrationMode << rec.entry->sortingIndex;
+			}
+		}
+		os.Flush();
+	}
+	catch (ObjStreamExn&) {
+		fclose(out);
+		return false;
+	}
+
+	if (fclose(out) != 0) return false;
+
+	try {
+		if (fs::exists(filename)) {
+			fs::remove(filename);
+		}
+		fs::rename(tmpFilename, filename);
+	}
+	catch (OS::fs_error_t&) {
+		return false;
+	}
+
+	dirty = false;
+	return true;
+}
+
+}  // namespace Model
+}  // namespace HoverRace
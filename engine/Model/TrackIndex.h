@@ -0,0 +1,89 @@
+// TrackIndex.h
+// On-disk cache of track headers.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <map>
+
+#include "../Util/MR_Types.h"
+#include "../Util/OS.h"
+#include "TrackEntry.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Model {
+
+/**
+ * On-disk cache of track headers, keyed by the path, size and modification
+ * time of each track file.
+ *
+ * An index that is missing, corrupt or from an older version is silently
+ * discarded, so the worst case is that every track is re-read.
+ */
+class MR_DllDeclare TrackIndex
+{
+	public:
+		TrackIndex(const Util::OS::path_t &filename);
+
+	public:
+		bool Find(const Util::OS::path_t &path, MR_UInt32 size, MR_UInt32 mtime,
+			TrackEntryPtr &entry);
+		void Put(const Util::OS::path_t &path, MR_UInt32 size, MR_UInt32 mtime,
+			TrackEntryPtr entry);
+
+		bool Save();
+
+	private:
+		void Load();
+
+	private:
+		struct Record
+		{
+			Record() : size(0), mtime(0), used(false) { }
+
+			MR_UInt32 size;
+			MR_UInt32 mtime;
+			TrackEntryPtr entry;  ///< @c NULL if the track could not be read.
+			bool used;
+		};
+		typedef std::map<std::string, Record> records_t;
+
+		Util::OS::path_t filename;
+		records_t records;
+		bool dirty;
+
+		static const MR_UInt32 FILE_MAGIC = 0x58444954;  // "TIDX"
+		static const MR_UInt32 FILE_VERSION = 1;
+};
+
+}  // namespace Model
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
@@ -22,17 +22,24 @@
 
 #include "StdAfx.h"
 
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "../Parcel/ObjStream.h"
 #include "../Parcel/TrackBundle.h"
+#include "../Util/Config.h"
 #include "../Util/Str.h"
 #include "../Util/OS.h"
+#include "TrackIndex.h"
 
 #include "TrackList.h"
 
+namespace fs = boost::filesystem;
+
 using namespace HoverRace::Parcel;
+using HoverRace::Util::Config;
 using HoverRace::Util::OS;
 namespace Str = HoverRace::Util::Str;
 
@@ -52,6 +59,43 @@ namespace {
 	{
 		return *ent1 < *ent2;
 	}
+
+	struct TrackFile
+	{
+		OS::dirEnt_t ent;
+		MR_UInt32 size;
+		MR_UInt32 mtime;
+		TrackEntryPtr entry;
+		bool changed;
+	};
+	typedef std::vector<TrackFile> trackFiles_t;
+
+	/**
+	 * Read the headers of every @p step-th pending track file.
+	 * Each worker thread writes only to its own files, so no locking is needed.
+	 */
+	void ReadTrackEntries(const TrackBundle *trackBundle,
+	                      std::vector<TrackFile*> *pending,
+	                      size_t first, size_t step)
+	{
+		for (size_t i = first; i < pending->size(); i += step) {
+			TrackFile *file = (*pending)[i];
+			try {
+				file->entry = trackBundle->OpenTrackEntry(file->ent);
+			}
+			catch (Parcel::ObjStreamExn &ex) {
+				//TODO: Proper logging.
+#				ifdef _WIN32
+					OutputDebugString(ex.what());
+					OutputDebugString("\n");
+#				endif
+				// Ignore this bad track and continue.
+			}
+			catch (std::exception&) {
+				// Bad header; ignore this track too.
+			}
+		}
+	}
 }
 
 TrackList::TrackList()
@@ -75,30 +119,65 @@ void TrackList::Clear()
 /**
  * Load the list of available tracks from the track bundle.
  * Any previously-loaded list is cleared.
+ * Track headers are cached in the track index (see Config::GetTrackIndexPath),
+ * so only new or modified tracks are actually opened.
  * @param trackBundle The track bundle (may not be @c NULL).
  */
 void TrackList::Reload(Parcel::TrackBundlePtr trackBundle)
 {
 	Clear();
 
+	// Headers of tracks that haven't changed since the last time are read
+	// from the index instead of opening every track.
+	TrackIndex index(Config::GetInstance()->GetTrackIndexPath());
+
+	trackFiles_t files;
 	BOOST_FOREACH(const OS::dirEnt_t &ent, *trackBundle) {
-		std::string name((const char*)Str::PU(ent.path().filename().c_str()));
+		TrackFile file;
+		file.ent = ent;
 		try {
-			Model::TrackEntryPtr trackEnt = trackBundle->OpenTrackEntry(name);
-			if (trackEnt.get() != NULL) {
-				tracks.push_back(*trackEnt);
-#				ifdef _DEBUG
-					tracks.back().path = ent.path();
-#				endif
-			}
+			if (!fs::is_regular_file(ent.status())) continue;
+			file.size = static_cast<MR_UInt32>(fs::file_size(ent.path()));
+			file.mtime = static_cast<MR_UInt32>(fs::last_write_time(ent.path()));
+		}
+		catch (OS::fs_error_t&) {
+			continue;
+		}
+		file.changed = !index.Find(ent.path(), file.size, file.mtime, file.entry);
+		files.push_back(file);
+	}
+
+	std::vector<TrackFile*> pending;
+	BOOST_FOREACH(TrackFile &file, files) {
+		if (file.changed) pending.push_back(&file);
+	}
+
+	// Read new and changed tracks in parallel.
+	size_t numThreads = std::min<size_t>(pending.size(),
+		std::max<size_t>(1, boost::thread::hardware_concurrency()));
+	if (numThreads <= 1) {
+		ReadTrackEntries(trackBundle.get(), &pending, 0, 1);
+	}
+	else {
+		boost::thread_group threads;
+		for (size_t i = 0; i < numThreads; ++i) {
+			threads.create_thread(boost::bind(&ReadTrackEntries,
+				trackBundle.get(), &pending, i, numThreads));
 		}
-		catch (Parcel::ObjStreamExn &ex) {
-			//TODO: Proper logging.
-#			ifdef _WIN32
-				OutputDebugString(ex.what());
-				OutputDebugString("\n");
+		threads.join_all();
+	}
+
+	BOOST_FOREACH(TrackFile *file, pending) {
+		index.Put(file->ent.path(), file->size, file->mtime, file->entry);
+	}
+	index.Save();
+
+	BOOST_FOREACH(const TrackFile &file, files) {
+		if (file.entry.get() != NULL) {
+			tracks.push_back(*file.entry);
+#			ifdef _DEBUG
+				tracks.back().path = file.ent.path();
 #			endif
-			// Ignore this bad track and continue.
 		}
 	}
 
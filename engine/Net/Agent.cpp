@@ -26,7 +26,8 @@
 
 #include "../Util/Config.h"
 
-#include "BlockingTransfer.h"
+#include "AsyncTransfer.h"
+#include "TransferPool.h"
 
 #include "Agent.h"
 
@@ -39,7 +40,7 @@ using HoverRace::Util::Config;
  * @param The URL to retrieve.
  */
 Agent::Agent(const std::string &url) :
-	url(url)
+	url(url), maxSize(0), rangeOffset(0), rangeLen(0)
 {
 }
 
@@ -52,15 +53,30 @@ void Agent::SetUrl(const std::string &url)
 	this->url = url;
 }
 
+/**
+ * Only request part of the resource (an HTTP range request).
+ * @param offset The offset of the first byte.
+ * @param len The number of bytes (0 for the whole resource).
+ */
+void Agent::SetRange(size_t offset, size_t len)
+{
+	rangeOffset = offset;
+	rangeLen = len;
+}
+
 /**
  * Easy URL retrieval to a string.
  * This method blocks until the transfer is complete.
+ * The transfer still goes through the shared TransferPool, so it can reuse
+ * a connection left open by an earlier request to the same server.
  * @param buf The string to store to.
  * @param cancelFlag Optional control to check for cancellation (may be @c NULL).
+ * @throw NetExn If an error occurs during the transfer.
+ * @throw CanceledExn If the transfer was canceled.
  */
 void Agent::Get(std::string &buf, CancelFlagPtr cancelFlag)
 {
-	BlockingTransfer(*this, buf, cancelFlag).Go();
+	GetAsync(buf, cancelFlag)->Wait();
 }
 
 /**
@@ -68,8 +84,44 @@ void Agent::Get(std::string &buf, CancelFlagPtr cancelFlag)
  * This method blocks until the transfer is complete.
  * @param buf The stream to write to.
  * @param cancelFlag Optional control to check for cancellation (may be @c NULL).
+ * @throw NetExn If an error occurs during the transfer.
+ * @throw CanceledExn If the transfer was canceled.
  */
 void Agent::Get(std::ostream &buf, CancelFlagPtr cancelFlag)
 {
-	BlockingTransfer(*this, buf, cancelFlag).Go();
+	GetAsync(buf, cancelFlag)->Wait();
+}
+
+/**
+ * Start retrieving a URL to a string in the background.
+ * Any number of transfers may be running at once; they share the
+ * connections of the TransferPool.
+ * @param buf The string to store to.  It must not be touched until the
+ *            transfer is complete.
+ * @param cancelFlag Optional control to check for cancellation (may be @c NULL).
+ * @param progressFn Optional progress callback (called from the transfer thread).
+ * @return The transfer (use AsyncTransfer::Wait to wait for the result).
+ */
+AsyncTransferPtr Agent::GetAsync(std::string &buf, CancelFlagPtr cancelFlag,
+                                 ProgressFn progressFn)
+{
+	AsyncTransferPtr retv(new AsyncTransfer(*this, buf, cancelFlag, progressFn));
+	TransferPool::GetInstance()->Add(retv);
+	return retv;
+}
+
+/**
+ * Start retrieving a URL to a stream in the background.
+ * @param buf The stream to write to.  It must not be touched until the
+ *            transfer is complete.
+ * @param cancelFlag Optional control to check for cancellation (may be @c NULL).
+ * @param progressFn Optional progress callback (called from the transfer thread).
+ * @return The transfer (use AsyncTransfer::Wait to wait for the result).
+ */
+AsyncTransferPtr Agent::GetAsync(std::ostream &buf, CancelFlagPtr cancelFlag,
+                                 ProgressFn progressFn)
+{
+	AsyncTransferPtr retv(new AsyncTransfer(*this, buf, cancelFlag, progressFn));
+	TransferPool::GetInstance()->Add(retv);
+	return retv;
 }
@@ -37,6 +37,13 @@
 #	define MR_DllDeclare
 #endif
 
+namespace HoverRace {
+namespace Net {
+	class AsyncTransfer;
+	typedef boost::shared_ptr<AsyncTransfer> AsyncTransferPtr;
+}
+}
+
 namespace HoverRace {
 namespace Net {
 
@@ -54,12 +61,30 @@ class MR_DllDeclare Agent
 		void SetUrl(const std::string &url);
 		const std::string &GetUrl() const { return url; };
 
+		/// Set the maximum size of the response, in bytes (0 for no limit).
+		void SetMaxSize(size_t maxSize) { this->maxSize = maxSize; }
+		size_t GetMaxSize() const { return maxSize; }
+
+		void SetRange(size_t offset, size_t len);
+		size_t GetRangeOffset() const { return rangeOffset; }
+		size_t GetRangeLen() const { return rangeLen; }
+
 	public:
 		void Get(std::string &buf, CancelFlagPtr cancelFlag=CancelFlagPtr());
 		void Get(std::ostream &buf, CancelFlagPtr cancelFlag=CancelFlagPtr());
 
+		AsyncTransferPtr GetAsync(std::string &buf,
+			CancelFlagPtr cancelFlag=CancelFlagPtr(),
+			ProgressFn progressFn=ProgressFn());
+		AsyncTransferPtr GetAsync(std::ostream &buf,
+			CancelFlagPtr cancelFlag=CancelFlagPtr(),
+			ProgressFn progressFn=ProgressFn());
+
 	private:
 		std::string url;
+		size_t maxSize;
+		size_t rangeOffset;
+		size_t rangeLen;
 };
 
 }  // namespace Net
@@ -0,0 +1,155 @@
+
+// AsyncTransfer.cpp
+// Background transfers run by the TransferPool.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include "AsyncTransfer.h"
+
+using namespace HoverRace::Net;
+
+/**
+ * Constructor (for storing to a string).
+ * @param agent The transfer agent (request parameters).
+ * @param buf The string to store to.
+ * @param cancelFlag Control object to check for cancellation (may be @c NULL).
+ * @param progressFn Progress callback (may be empty).
+ */
+AsyncTransfer::AsyncTransfer(const Agent &agent, std::string &buf,
+                             CancelFlagPtr cancelFlag, ProgressFn progressFn) :
+	SUPER(agent), cancelFlag(cancelFlag), progressFn(progressFn),
+	strBuf(&buf), streamBuf(NULL)
+{
+	Init(agent);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StringWriteFunc);
+}
+
+/**
+ * Constructor (for storing to a stream).
+ * @param agent The transfer agent (request parameters).
+ * @param buf The stream to write to.
+ * @param cancelFlag Control object to check for cancellation (may be @c NULL).
+ * @param progressFn Progress callback (may be empty).
+ */
+AsyncTransfer::AsyncTransfer(const Agent &agent, std::ostream &buf,
+                             CancelFlagPtr cancelFlag, ProgressFn progressFn) :
+	SUPER(agent), cancelFlag(cancelFlag), progressFn(progressFn),
+	strBuf(NULL), streamBuf(&buf)
+{
+	Init(agent);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamWriteFunc);
+}
+
+void AsyncTransfer::Init(const Agent &agent)
+{
+	maxSize = agent.GetMaxSize();
+	canceled = false;
+	tooLarge = false;
+	bytesReceived = 0;
+	bytesTotal = 0;
+	complete = false;
+	result = CURLE_OK;
+
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+	curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
+	curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, ProgressFunc);
+	curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, this);
+}
+
+/**
+ * Wait for the transfer to finish.
+ * @throw NetExn If an error occurred during the transfer.
+ * @throw CanceledExn If the transfer was canceled.
+ */
+void AsyncTransfer::Wait()
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		while (!complete) {
+			completeCond.wait(lock);
+		}
+	}
+
+	if (tooLarge) {
+		throw NetExn("Transfer exceeded maximum size");
+	}
+	AssertCurlSuccess(result, cancelFlag);
+}
+
+/// Check if the transfer should be aborted.
+bool AsyncTransfer::IsCanceled()
+{
+	return canceled || (cancelFlag != NULL && cancelFlag->IsCanceled());
+}
+
+/**
+ * Mark the transfer as finished and wake up anyone waiting on it.
+ * Called by the TransferPool once the handle has been removed.
+ * @param result The result of the transfer.
+ */
+void AsyncTransfer::Finish(CURLcode result)
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		this->result = result;
+		complete = true;
+	}
+	completeCond.notify_all();
+}
+
+size_t AsyncTransfer::StringWriteFunc(void *ptr, size_t size, size_t nmemb, void *stream)
+{
+	AsyncTransfer *self = (AsyncTransfer*)stream;
+	size_t sz = size * nmemb;
+	if (self->maxSize > 0 && self->bytesReceived + sz > self->maxSize) {
+		self->tooLarge = true;
+		return 0;
+	}
+	if (sz > 0) self->strBuf->append((const char*)ptr, sz);
+	self->bytesReceived += sz;
+	return sz;
+}
+
+size_t AsyncTransfer::StreamWriteFunc(void *ptr, size_t size, size_t nmemb, void *stream)
+{
+	AsyncTransfer *self = (AsyncTransfer*)stream;
+	size_t sz = size * nmemb;
+	if (self->maxSize > 0 && self->bytesReceived + sz > self->maxSize) {
+		self->tooLarge = true;
+		return 0;
+	}
+	if (sz > 0) self->streamBuf->write((const char*)ptr, sz);
+	self->bytesReceived += sz;
+	return sz;
+}
+
+size_t AsyncTransfer::ProgressFunc(void *xfer, double dlTotal, double dlNow, double, double)
+{
+	AsyncTransfer *self = (AsyncTransfer*)xfer;
+
+	self->bytesTotal = static_cast<size_t>(dlTotal);
+	if (self->progressFn) {
+		self->progressFn(static_cast<size_t>(dlNow), self->bytesTotal);
+	}
+
+	// Abort transfer if cancel flag is set.
+	return self->IsCanceled() ? 1 : 0;
+}
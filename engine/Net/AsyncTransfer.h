@@ -0,0 +1,100 @@
+
+// AsyncTransfer.h
+// Header for background transfers run by the TransferPool.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "BaseTransfer.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Net {
+
+/**
+ * A transfer that runs in the background on the TransferPool thread.
+ * Use Agent::GetAsync to start one.
+ */
+class MR_DllDeclare AsyncTransfer : public BaseTransfer
+{
+	typedef BaseTransfer SUPER;
+	friend class TransferPool;
+	public:
+		AsyncTransfer(const Agent &agent, std::string &buf,
+			CancelFlagPtr cancelFlag, ProgressFn progressFn);
+		AsyncTransfer(const Agent &agent, std::ostream &buf,
+			CancelFlagPtr cancelFlag, ProgressFn progressFn);
+		virtual ~AsyncTransfer() { }
+	private:
+		void Init(const Agent &agent);
+
+	public:
+		virtual bool IsComplete() const { return complete; }
+
+		void Cancel() { canceled = true; }
+		void Wait();
+
+		size_t GetBytesReceived() const { return bytesReceived; }
+		size_t GetBytesTotal() const { return bytesTotal; }
+
+	private:
+		CURL *GetHandle() const { return curl; }
+		bool IsCanceled();
+		void Finish(CURLcode result);
+
+		static size_t StringWriteFunc(void *ptr, size_t size, size_t nmemb, void *stream);
+		static size_t StreamWriteFunc(void *ptr, size_t size, size_t nmemb, void *stream);
+		static size_t ProgressFunc(void *xfer, double dlTotal, double dlNow, double, double);
+
+	private:
+		CancelFlagPtr cancelFlag;
+		ProgressFn progressFn;
+		std::string *strBuf;
+		std::ostream *streamBuf;
+		size_t maxSize;
+
+		volatile bool canceled;
+		volatile bool tooLarge;
+		volatile size_t bytesReceived;
+		volatile size_t bytesTotal;
+
+		boost::mutex mutex;
+		boost::condition_variable completeCond;
+		volatile bool complete;
+		CURLcode result;
+};
+typedef boost::shared_ptr<AsyncTransfer> AsyncTransferPtr;
+
+}  // namespace Net
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
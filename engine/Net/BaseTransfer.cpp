@@ -48,6 +48,19 @@ BaseTransfer::BaseTransfer(const Agent &agent) :
 	curl_easy_setopt(curl, CURLOPT_USERAGENT, cfg->GetUserAgentId().c_str());
 
 	curl_easy_setopt(curl, CURLOPT_URL, agent.GetUrl().c_str());
+
+	if (agent.GetRangeLen() > 0) {
+		std::ostringstream oss;
+		oss << agent.GetRangeOffset() << '-' <<
+			(agent.GetRangeOffset() + agent.GetRangeLen() - 1);
+		curl_easy_setopt(curl, CURLOPT_RANGE, oss.str().c_str());
+	}
+
+	// Only effective if the server sends a Content-Length; otherwise the
+	// transfer has to enforce the limit itself.
+	if (agent.GetMaxSize() > 0) {
+		curl_easy_setopt(curl, CURLOPT_MAXFILESIZE, (long)agent.GetMaxSize());
+	}
 }
 
 BaseTransfer::~BaseTransfer()
@@ -64,6 +77,7 @@ void BaseTransfer::AssertCurlSuccess(CURLcode code, CancelFlagPtr cancelFlag)
 	switch (code) {
 		case 0: break;
 		case CURLE_ABORTED_BY_CALLBACK: throw CanceledExn();
+		case CURLE_FILESIZE_EXCEEDED: throw NetExn("Transfer exceeded maximum size");
 		default: throw NetExn(errorBuf);
 	}
 }
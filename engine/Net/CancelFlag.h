@@ -48,6 +48,25 @@ class MR_DllDeclare MR_PureVirtual CancelFlag
 };
 typedef boost::shared_ptr<CancelFlag> CancelFlagPtr;
 
+/**
+ * Cancel flag that is set explicitly, e.g. by a "Cancel" button.
+ * One flag can be shared by several transfers to cancel them all at once.
+ */
+class MR_DllDeclare ManualCancelFlag : public CancelFlag
+{
+	public:
+		ManualCancelFlag() : canceled(false) { }
+		virtual ~ManualCancelFlag() { }
+
+	public:
+		void Cancel() { canceled = true; }
+		virtual bool IsCanceled() { return canceled; }
+
+	private:
+		volatile bool canceled;
+};
+typedef boost::shared_ptr<ManualCancelFlag> ManualCancelFlagPtr;
+
 }  // namespace Net
 }  // namespace HoverRace
 
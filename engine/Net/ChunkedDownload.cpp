@@ -0,0 +1,313 @@
+
+// ChunkedDownload.cpp
+// Resumable, chunk-verified downloads.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <deque>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../Util/Crc32c.h"
+#include "../Util/Str.h"
+#include "Agent.h"
+#include "AsyncTransfer.h"
+#include "NetExn.h"
+
+#include "ChunkedDownload.h"
+
+using namespace HoverRace::Net;
+using namespace HoverRace::Util;
+
+namespace {
+	/// Number of chunks requested at once.
+	const size_t MAX_IN_FLIGHT = 4;
+
+	/// Number of times a chunk is attempted before giving up.
+	const int MAX_TRIES = 5;
+
+	const size_t MAX_MANIFEST_SIZE = 256 * 1024;
+	const size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+	/// A chunk being downloaded.
+	struct Chunk
+	{
+		size_t idx;
+		std::string buf;
+		AsyncTransferPtr xfer;
+	};
+	typedef boost::shared_ptr<Chunk> ChunkPtr;
+	typedef std::deque<ChunkPtr> chunks_t;
+
+	/// Cancel the transfers and wait for them to let go of their buffers.
+	void AbortChunks(chunks_t &chunks)
+	{
+		for (chunks_t::iterator iter = chunks.begin(); iter != chunks.end(); ++iter) {
+			(*iter)->xfer->Cancel();
+		}
+		for (chunks_t::iterator iter = chunks.begin(); iter != chunks.end(); ++iter) {
+			try {
+				(*iter)->xfer->Wait();
+			}
+			catch (NetExn&) { }
+		}
+		chunks.clear();
+	}
+}
+
+/**
+ * Constructor.
+ * @param url The URL of the file.
+ * @param manifestUrl The URL of the chunk manifest.
+ * @param dest The destination filename.
+ * @param partPath The filename for the partial download.  It is kept if
+ *                 the download fails so that the next attempt can resume.
+ */
+ChunkedDownload::ChunkedDownload(const std::string &url,
+                                 const std::string &manifestUrl,
+                                 const OS::path_t &dest,
+                                 const OS::path_t &partPath) :
+	url(url), manifestUrl(manifestUrl), dest(dest), partPath(partPath),
+	maxSize(0), fileSize(0), chunkSize(0)
+{
+}
+
+ChunkedDownload::~ChunkedDownload()
+{
+}
+
+/**
+ * Download the file.
+ * This method blocks until the download is complete.
+ * @param cancelFlag Optional control to check for cancellation (may be @c NULL).
+ * @param progressFn Optional progress callback.
+ * @throw NetExn If the download failed.
+ * @throw CanceledExn If the download was canceled.
+ */
+void ChunkedDownload::Go(CancelFlagPtr cancelFlag, ProgressFn progressFn)
+{
+	if (LoadManifest(cancelFlag)) {
+		GoChunked(cancelFlag, progressFn);
+	}
+	else {
+		GoWhole(cancelFlag, progressFn);
+	}
+	Install();
+}
+
+/**
+ * Retrieve and parse the manifest.
+ * @param cancelFlag Optional control to check for cancellation (may be @c NULL).
+ * @return @c true if the manifest was loaded, @c false if there is none
+ *         (or it is unusable).
+ * @throw CanceledExn If the download was canceled.
+ */
+bool ChunkedDownload::LoadManifest(CancelFlagPtr cancelFlag)
+{
+	chunkHashes.clear();
+
+	std::stringstream io;
+	try {
+		Agent agent(manifestUrl);
+		agent.SetMaxSize(MAX_MANIFEST_SIZE);
+		agent.Get(io, cancelFlag);
+	}
+	catch (CanceledExn&) {
+		throw;
+	}
+	catch (NetExn&) {
+		return false;
+	}
+
+	std::string preamble;
+	std::getline(io, preamble);
+	if (preamble != "CHUNK MANIFEST") return false;
+
+	io >> fileSize >> chunkSize;
+	if (!io || chunkSize == 0 || chunkSize > MAX_CHUNK_SIZE) return false;
+	if (maxSize > 0 && fileSize > maxSize) {
+		throw NetExn("Transfer exceeded maximum size");
+	}
+
+	size_t numChunks = (fileSize + chunkSize - 1) / chunkSize;
+	io >> std::hex;
+	for (size_t i = 0; i < numChunks; ++i) {
+		MR_UInt32 hash;
+		io >> hash;
+		if (!io) {
+			chunkHashes.clear();
+			return false;
+		}
+		chunkHashes.push_back(hash);
+	}
+
+	return true;
+}
+
+/// Stream the whole file to the partial file in one request.
+void ChunkedDownload::GoWhole(CancelFlagPtr cancelFlag, ProgressFn progressFn)
+{
+	boost::filesystem::ofstream out(partPath,
+		std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if (!out) {
+		throw NetExn("Unable to write to: " + std::string((const char*)Str::PU(partPath)));
+	}
+
+	Agent agent(url);
+	agent.SetMaxSize(maxSize);
+	agent.GetAsync(out, cancelFlag, progressFn)->Wait();
+
+	out.close();
+	if (!out) {
+		throw NetExn("Unable to write to: " + std::string((const char*)Str::PU(partPath)));
+	}
+}
+
+/// Fetch the chunks that are missing from the partial file.
+void ChunkedDownload::GoChunked(CancelFlagPtr cancelFlag, ProgressFn progressFn)
+{
+	const size_t numChunks = chunkHashes.size();
+
+	FILE *out = OS::FOpen(partPath, "r+b");
+	size_t existing = 0;
+	if (out != NULL) {
+		fseek(out, 0, SEEK_END);
+		existing = static_cast<size_t>(ftell(out));
+		if (existing > fileSize) {
+			// Not the file we're looking for.
+			fclose(out);
+			out = NULL;
+			existing = 0;
+		}
+	}
+	if (out == NULL) {
+		out = OS::FOpen(partPath, "w+b");
+		if (out == NULL) {
+			throw NetExn("Unable to write to: " + std::string((const char*)Str::PU(partPath)));
+		}
+	}
+
+	// Keep whatever is left from a previous attempt, as long as it
+	// still matches the manifest.
+	std::deque<size_t> todo;
+	size_t bytesDone = 0;
+	{
+		std::vector<char> buf(chunkSize);
+		for (size_t i = 0; i < numChunks; ++i) {
+			size_t offset = i * chunkSize;
+			size_t len = GetChunkLen(i);
+			if (offset + len <= existing &&
+				fseek(out, static_cast<long>(offset), SEEK_SET) == 0 &&
+				fread(&buf[0], 1, len, out) == len &&
+				Crc32c::Compute(&buf[0], len) == chunkHashes[i])
+			{
+				bytesDone += len;
+			}
+			else {
+				todo.push_back(i);
+			}
+		}
+	}
+	if (progressFn) progressFn(bytesDone, fileSize);
+
+	std::vector<int> tries(numChunks, 0);
+	chunks_t inFlight;
+	while (!todo.empty() || !inFlight.empty()) {
+		while (inFlight.size() < MAX_IN_FLIGHT && !todo.empty()) {
+			ChunkPtr chunk(new Chunk());
+			chunk->idx = todo.front();
+			todo.pop_front();
+
+			Agent agent(url);
+			agent.SetRange(chunk->idx * chunkSize, GetChunkLen(chunk->idx));
+			agent.SetMaxSize(GetChunkLen(chunk->idx));
+			chunk->xfer = agent.GetAsync(chunk->buf, cancelFlag);
+			inFlight.push_back(chunk);
+		}
+
+		ChunkPtr chunk = inFlight.front();
+		inFlight.pop_front();
+		size_t len = GetChunkLen(chunk->idx);
+
+		std::string error;
+		try {
+			chunk->xfer->Wait();
+			if (chunk->buf.length() != len ||
+				Crc32c::Compute(chunk->buf.data(), len) != chunkHashes[chunk->idx])
+			{
+				error = "Downloaded data failed verification";
+			}
+		}
+		catch (CanceledExn&) {
+			AbortChunks(inFlight);
+			fclose(out);
+			throw;
+		}
+		catch (NetExn &ex) {
+			error = ex.what();
+		}
+
+		if (!error.empty()) {
+			// Try again later, unless this chunk is hopeless.
+			if (++tries[chunk->idx] >= MAX_TRIES) {
+				AbortChunks(inFlight);
+				fclose(out);
+				throw NetExn(error);
+			}
+			todo.push_back(chunk->idx);
+			boost::this_thread::sleep(boost::posix_time::milliseconds(
+				100 * tries[chunk->idx]));
+			continue;
+		}
+
+		if (fseek(out, static_cast<long>(chunk->idx * chunkSize), SEEK_SET) != 0 ||
+			fwrite(chunk->buf.data(), 1, len, out) != len ||
+			fflush(out) != 0)
+		{
+			AbortChunks(inFlight);
+			fclose(out);
+			throw NetExn("Unable to write to: " + std::string((const char*)Str::PU(partPath)));
+		}
+
+		bytesDone += len;
+		if (progressFn) progressFn(bytesDone, fileSize);
+	}
+
+	if (fclose(out) != 0) {
+		throw NetExn("Unable to write to: " + std::string((const char*)Str::PU(partPath)));
+	}
+}
+
+/// Move the completed partial file into place.
+void ChunkedDownload::Install()
+{
+	if (!OS::RenameReplace(partPath, dest)) {
+		throw NetExn("Unable to write to: " + std::string((const char*)Str::PU(dest)));
+	}
+}
+
+/// Retrieve the length of a chunk (the last one may be short).
+size_t ChunkedDownload::GetChunkLen(size_t idx) const
+{
+	size_t offset = idx * chunkSize;
+	return std::min(chunkSize, fileSize - offset);
+}
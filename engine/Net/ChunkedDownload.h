@@ -0,0 +1,104 @@
+
+// ChunkedDownload.h
+// Header for resumable, chunk-verified downloads.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../Util/MR_Types.h"
+#include "../Util/OS.h"
+#include "CancelFlag.h"
+#include "Transfer.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Net {
+
+/**
+ * Downloads a file to disk in chunks, verifying each one.
+ *
+ * The chunk hashes come from a manifest on the server:
+ * <pre>
+ * CHUNK MANIFEST
+ * (file size) (chunk size)
+ * (CRC-32C of chunk 0, in hex)
+ * (CRC-32C of chunk 1, in hex)
+ * ...
+ * </pre>
+ *
+ * Chunks are fetched with range requests (a few at a time) and written
+ * to a partial file as soon as they have been verified.  If the download
+ * is interrupted, the next attempt keeps every chunk of the partial file
+ * that still matches the manifest and only fetches the rest.  Once every
+ * chunk is in place, the partial file is renamed to the destination.
+ *
+ * If the server has no manifest, the whole file is streamed to the partial
+ * file instead (without verification or resuming).
+ */
+class MR_DllDeclare ChunkedDownload
+{
+	public:
+		ChunkedDownload(const std::string &url, const std::string &manifestUrl,
+			const Util::OS::path_t &dest, const Util::OS::path_t &partPath);
+		virtual ~ChunkedDownload();
+
+	public:
+		/// Set the maximum size of the file, in bytes (0 for no limit).
+		void SetMaxSize(size_t maxSize) { this->maxSize = maxSize; }
+
+		void Go(CancelFlagPtr cancelFlag=CancelFlagPtr(),
+			ProgressFn progressFn=ProgressFn());
+
+	private:
+		bool LoadManifest(CancelFlagPtr cancelFlag);
+		void GoWhole(CancelFlagPtr cancelFlag, ProgressFn progressFn);
+		void GoChunked(CancelFlagPtr cancelFlag, ProgressFn progressFn);
+		void Install();
+
+		size_t GetChunkLen(size_t idx) const;
+
+	private:
+		std::string url;
+		std::string manifestUrl;
+		Util::OS::path_t dest;
+		Util::OS::path_t partPath;
+		size_t maxSize;
+
+		size_t fileSize;
+		size_t chunkSize;
+		std::vector<MR_UInt32> chunkHashes;
+};
+
+}  // namespace Net
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <boost/function.hpp>
+
 #ifdef _WIN32
 #	ifdef MR_ENGINE
 #		define MR_DllDeclare   __declspec( dllexport )
@@ -47,6 +49,13 @@ class MR_DllDeclare MR_PureVirtual Transfer
 		virtual bool IsComplete() const = 0;
 };
 
+/**
+ * Progress callback for transfers.
+ * The parameters are the number of bytes received so far and the total
+ * number of bytes expected (zero if unknown).
+ */
+typedef boost::function<void(size_t, size_t)> ProgressFn;
+
 }  // namespace Net
 }  // namespace HoverRace
 
@@ -0,0 +1,222 @@
+
+// TransferPool.cpp
+// Shared curl-multi transfer thread.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#ifndef _WIN32
+#	include <sys/select.h>
+#endif
+
+#include <boost/bind.hpp>
+
+#include "TransferPool.h"
+
+using namespace HoverRace::Net;
+
+namespace {
+	/// Maximum number of idle connections kept open for reuse.
+	const long MAX_CONNECTIONS = 8;
+
+	/// Longest time (ms) to wait for socket activity before checking for
+	/// new or canceled transfers.
+	const long MAX_WAIT = 50;
+}
+
+TransferPool *TransferPool::instance = NULL;
+boost::mutex TransferPool::instanceMutex;
+
+TransferPool::TransferPool() :
+	multi(curl_multi_init()), quit(false)
+{
+	curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, MAX_CONNECTIONS);
+
+	thread = boost::thread(boost::bind(&TransferPool::ThreadProc, this));
+}
+
+TransferPool::~TransferPool()
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		quit = true;
+	}
+	workCond.notify_all();
+	thread.join();
+
+	curl_multi_cleanup(multi);
+}
+
+/**
+ * Retrieve the shared pool, starting it if necessary.
+ * @return The pool (never @c NULL).
+ */
+TransferPool *TransferPool::GetInstance()
+{
+	boost::mutex::scoped_lock lock(instanceMutex);
+	if (instance == NULL) {
+		instance = new TransferPool();
+	}
+	return instance;
+}
+
+/**
+ * Stop the pool, aborting any transfers still running.
+ * This must be called before curl_global_cleanup().
+ */
+void TransferPool::Shutdown()
+{
+	boost::mutex::scoped_lock lock(instanceMutex);
+	delete instance;
+	instance = NULL;
+}
+
+/**
+ * Start a transfer.
+ * @param xfer The transfer (must not already be started).
+ */
+void TransferPool::Add(AsyncTransferPtr xfer)
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		pending.push_back(xfer);
+	}
+	workCond.notify_all();
+}
+
+void TransferPool::ThreadProc()
+{
+	for (;;) {
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			while (!quit && pending.empty() && active.empty()) {
+				workCond.wait(lock);
+			}
+			if (quit) break;
+		}
+
+		AddPending();
+
+		int running;
+		while (curl_multi_perform(multi, &running) == CURLM_CALL_MULTI_PERFORM) ;
+
+		ReadCompleted();
+		CheckCanceled();
+
+		if (!active.empty()) {
+			WaitForActivity();
+		}
+	}
+
+	// Abort whatever is left.
+	AddPending();
+	for (active_t::iterator iter = active.begin(); iter != active.end(); ++iter) {
+		curl_multi_remove_handle(multi, iter->first);
+		iter->second->Finish(CURLE_ABORTED_BY_CALLBACK);
+	}
+	active.clear();
+}
+
+/// Move the newly-added transfers to the multi handle.
+void TransferPool::AddPending()
+{
+	std::vector<AsyncTransferPtr> added;
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		added.swap(pending);
+	}
+
+	for (std::vector<AsyncTransferPtr>::iterator iter = added.begin();
+		iter != added.end(); ++iter)
+	{
+		CURL *handle = (*iter)->GetHandle();
+		active[handle] = *iter;
+		curl_multi_add_handle(multi, handle);
+	}
+}
+
+/// Finish the transfers that libcurl reports as done.
+void TransferPool::ReadCompleted()
+{
+	CURLMsg *msg;
+	int msgsLeft;
+	while ((msg = curl_multi_info_read(multi, &msgsLeft)) != NULL) {
+		if (msg->msg != CURLMSG_DONE) continue;
+
+		active_t::iterator iter = active.find(msg->easy_handle);
+		if (iter == active.end()) continue;
+
+		CURLcode result = msg->data.result;
+		AsyncTransferPtr xfer = iter->second;
+		active.erase(iter);
+
+		// The message is invalid once the handle is removed.
+		curl_multi_remove_handle(multi, xfer->GetHandle());
+		xfer->Finish(result);
+	}
+}
+
+/**
+ * Abort the transfers that have been canceled.
+ * The progress callback already does this while data is flowing; this
+ * catches transfers that are stuck waiting on a connection.
+ */
+void TransferPool::CheckCanceled()
+{
+	for (active_t::iterator iter = active.begin(); iter != active.end(); ) {
+		if (iter->second->IsCanceled()) {
+			AsyncTransferPtr xfer = iter->second;
+			active.erase(iter++);
+			curl_multi_remove_handle(multi, xfer->GetHandle());
+			xfer->Finish(CURLE_ABORTED_BY_CALLBACK);
+		}
+		else {
+			++iter;
+		}
+	}
+}
+
+/// Block until there is socket activity (or a short timeout).
+void TransferPool::WaitForActivity()
+{
+	long timeout;
+	curl_multi_timeout(multi, &timeout);
+	if (timeout < 0 || timeout > MAX_WAIT) timeout = MAX_WAIT;
+	if (timeout == 0) return;
+
+	fd_set readFds, writeFds, errFds;
+	FD_ZERO(&readFds);
+	FD_ZERO(&writeFds);
+	FD_ZERO(&errFds);
+	int maxFd = -1;
+	curl_multi_fdset(multi, &readFds, &writeFds, &errFds, &maxFd);
+
+	if (maxFd < 0) {
+		// No sockets yet (e.g. still resolving the host name).
+		// Note that select() can't be used as a sleep on Win32.
+		boost::this_thread::sleep(boost::posix_time::milliseconds(timeout));
+	}
+	else {
+		struct timeval tv;
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		select(maxFd + 1, &readFds, &writeFds, &errFds, &tv);
+	}
+}
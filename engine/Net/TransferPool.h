@@ -0,0 +1,94 @@
+
+// TransferPool.h
+// Header for the shared curl-multi transfer thread.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <curl/curl.h>
+
+#include "AsyncTransfer.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Net {
+
+/**
+ * Runs all AsyncTransfers on a single background thread.
+ *
+ * The transfers share one libcurl multi handle, so they run in parallel
+ * and connections to a server are kept alive and reused by later
+ * transfers (e.g. a batch of track downloads from the same host only
+ * connects once).
+ */
+class MR_DllDeclare TransferPool
+{
+	private:
+		TransferPool();
+	public:
+		~TransferPool();
+
+		static TransferPool *GetInstance();
+		static void Shutdown();
+
+	public:
+		void Add(AsyncTransferPtr xfer);
+
+	private:
+		void ThreadProc();
+		void AddPending();
+		void ReadCompleted();
+		void CheckCanceled();
+		void WaitForActivity();
+
+	private:
+		static TransferPool *instance;
+		static boost::mutex instanceMutex;
+
+		CURLM *multi;
+
+		boost::mutex mutex;
+		boost::condition_variable workCond;
+		bool quit;
+		std::vector<AsyncTransferPtr> pending;  ///< Guarded by mutex.
+
+		typedef std::map<CURL*, AsyncTransferPtr> active_t;
+		active_t active;  ///< Only used by the transfer thread.
+
+		boost::thread thread;
+};
+
+}  // namespace Net
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
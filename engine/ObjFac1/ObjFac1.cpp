@@ -57,6 +57,35 @@ ObjFac1::~ObjFac1()
 	delete resourceLib;
 }
 
+/**
+ * Load the resources of the objects that are only created once the race
+ * has started (craft, weapons and power-ups), so that the first frame that
+ * needs them doesn't have to decode them.
+ * The objects stored in the track already load theirs as the track is read.
+ */
+void ObjFac1::PrefetchRaceResources()
+{
+	static const int raceIds[] = {
+		// HoverRender
+		MR_ELECTRO_CAR, MR_HITECH_CAR, MR_BITURBO_CAR, MR_EON_CRAFT,
+		MR_SND_LINE_CROSSING, MR_SND_START, MR_SND_FINISH, MR_SND_BUMP,
+		MR_SND_JUMP, MR_SND_FIRE, MR_SND_MIS_JUMP, MR_SND_MIS_FIRE,
+		MR_SND_OUT_OF_CTRL, MR_SND_PICKUP, MR_SND_MOTOR, MR_SND_FRICTION,
+		// Missile, Mine, PowerUp
+		MR_MISSILE, MR_SND_MISSILE_BOUNCE, MR_SND_MISSILE_MOTOR,
+		MR_MINE, MR_PWRUP,
+	};
+
+	std::vector<int> ids(raceIds, raceIds + sizeof(raceIds) / sizeof(raceIds[0]));
+	for (int i = 0; i < 10; i++) {
+		ids.push_back(MR_CAR_COCKPIT1 + i);
+		ids.push_back(MR_CAR_COCKPIT21 + i);
+		ids.push_back(MR_CAR_COCKPIT31 + i);
+	}
+
+	resourceLib->Prefetch(ids);
+}
+
 HoverRace::Util::ObjectFromFactory *ObjFac1::GetObject(int pClassId)
 {
 	Util::ObjectFromFactory *lReturnValue = NULL;
@@ -24,6 +24,7 @@ namespace HoverRace
 				~ObjFac1();
 
 				HoverRace::Util::ObjectFromFactory *GetObject(int pClassId);
+				void PrefetchRaceResources();
 
 			private:
 				HoverRace::ObjFacTools::ResourceLib* resourceLib;
@@ -21,6 +21,8 @@
 
 #include "StdAfx.h"
 
+#include <vector>
+
 #include "../Parcel/ObjStream.h"
 #include "ResourceLib.h"
 
@@ -237,8 +239,15 @@ void ResActor::Patch::Serialize(ObjStream &pArchive, ResourceLib *pLib)
 		pArchive << mVRes;
 		pArchive << mBitmap->GetResourceId();	  //bitmaptype is serialize using the Id of the bitmap
 
-		for(lCounter = 0; lCounter < mURes * mVRes; lCounter++) {
-			mVertexList[lCounter].Serialize(pArchive);
+		int lNbVertex = mURes * mVRes;
+		if(lNbVertex > 0) {
+			std::vector<MR_Int32> lBuf(lNbVertex * 3);
+			for(lCounter = 0; lCounter < lNbVertex; lCounter++) {
+				lBuf[lCounter * 3] = mVertexList[lCounter].mX;
+				lBuf[lCounter * 3 + 1] = mVertexList[lCounter].mY;
+				lBuf[lCounter * 3 + 2] = mVertexList[lCounter].mZ;
+			}
+			pArchive.WriteArray(&lBuf[0], lBuf.size());
 		}
 	}
 	else {
@@ -252,10 +261,17 @@ void ResActor::Patch::Serialize(ObjStream &pArchive, ResourceLib *pLib)
 
 		mBitmap = pLib->GetBitmap(lBitmapId);
 
-		mVertexList = new MR_3DCoordinate[mURes * mVRes];
+		int lNbVertex = mURes * mVRes;
+		mVertexList = new MR_3DCoordinate[lNbVertex];
 
-		for(lCounter = 0; lCounter < mURes * mVRes; lCounter++) {
-			mVertexList[lCounter].Serialize(pArchive);
+		if(lNbVertex > 0) {
+			std::vector<MR_Int32> lBuf(lNbVertex * 3);
+			pArchive.ReadArray(&lBuf[0], lBuf.size());
+			for(lCounter = 0; lCounter < lNbVertex; lCounter++) {
+				mVertexList[lCounter].mX = lBuf[lCounter * 3];
+				mVertexList[lCounter].mY = lBuf[lCounter * 3 + 1];
+				mVertexList[lCounter].mZ = lBuf[lCounter * 3 + 2];
+			}
 		}
 	}
 }
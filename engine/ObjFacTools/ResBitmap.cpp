@@ -62,11 +62,8 @@ void ResBitmap::Serialize(Parcel::ObjStream &pArchive)
 	int lCounter;
 
 	if(pArchive.IsWriting()) {
-		pArchive << mWidth;
-		pArchive << mHeight;
-		pArchive << mXRes;
-		pArchive << mYRes;
-		pArchive << mSubBitmapCount;
+		MR_Int32 lHeader[5] = { mWidth, mHeight, mXRes, mYRes, mSubBitmapCount };
+		pArchive.WriteArray(lHeader, 5);
 		pArchive << mPlainColor;
 
 	}
@@ -74,11 +71,13 @@ void ResBitmap::Serialize(Parcel::ObjStream &pArchive)
 		delete[]mSubBitmapList;
 		mSubBitmapList = NULL;
 
-		pArchive >> mWidth;
-		pArchive >> mHeight;
-		pArchive >> mXRes;
-		pArchive >> mYRes;
-		pArchive >> mSubBitmapCount;
+		MR_Int32 lHeader[5];
+		pArchive.ReadArray(lHeader, 5);
+		mWidth = lHeader[0];
+		mHeight = lHeader[1];
+		mXRes = lHeader[2];
+		mYRes = lHeader[3];
+		mSubBitmapCount = lHeader[4];
 		pArchive >> mPlainColor;
 
 		if(mSubBitmapCount > 0) {
@@ -169,37 +168,46 @@ ResBitmap::SubBitmap::SubBitmap()
 {
 	mBuffer = NULL;
 	mColumnPtr = NULL;
+	mOwnBuffer = true;
 }
 
 ResBitmap::SubBitmap::~SubBitmap()
 {
-	delete[] mBuffer;
+	if(mOwnBuffer) {
+		delete[] mBuffer;
+	}
 	delete[] mColumnPtr;
 }
 
 void ResBitmap::SubBitmap::Serialize(Parcel::ObjStream &pArchive)
 {
 	if(pArchive.IsWriting()) {
-
-		pArchive << mXRes;
-		pArchive << mYRes;
-		pArchive << mXResShiftFactor;
-		pArchive << mYResShiftFactor;
-		pArchive << mHaveTransparent;
+		MR_Int32 lHeader[5] = {
+			mXRes, mYRes, mXResShiftFactor, mYResShiftFactor, mHaveTransparent };
+		pArchive.WriteArray(lHeader, 5);
 
 		pArchive.Write(mBuffer, mXRes * mYRes);
 	}
 	else {
-		delete[] mBuffer;
+		if(mOwnBuffer) {
+			delete[] mBuffer;
+		}
 		delete[] mColumnPtr;
 
-		pArchive >> mXRes;
-		pArchive >> mYRes;
-		pArchive >> mXResShiftFactor;
-		pArchive >> mYResShiftFactor;
-		pArchive >> mHaveTransparent;
+		MR_Int32 lHeader[5];
+		pArchive.ReadArray(lHeader, 5);
+		mXRes = lHeader[0];
+		mYRes = lHeader[1];
+		mXResShiftFactor = lHeader[2];
+		mYResShiftFactor = lHeader[3];
+		mHaveTransparent = lHeader[4];
+
+		// Use the pixels in place if the stream allows it
+		// (the mapping is copy-on-write, so it is safe to hand out non-const)
+		const MR_UInt8 *lView = pArchive.ReadView(mXRes * mYRes);
 
-		mBuffer = new MR_UInt8[mXRes * mYRes];
+		mOwnBuffer = (lView == NULL);
+		mBuffer = mOwnBuffer ? new MR_UInt8[mXRes * mYRes] : const_cast<MR_UInt8 *>(lView);
 		mColumnPtr = new MR_UInt8 *[mXRes];
 
 		MR_UInt8 *lPtr = mBuffer;
@@ -208,7 +216,10 @@ void ResBitmap::SubBitmap::Serialize(Parcel::ObjStream &pArchive)
 			mColumnPtr[lCounter] = lPtr;
 			lPtr += mYRes;
 		}
-		pArchive.Read(mBuffer, mXRes * mYRes);
+
+		if(mOwnBuffer) {
+			pArchive.Read(mBuffer, mXRes * mYRes);
+		}
 	}
 }
 
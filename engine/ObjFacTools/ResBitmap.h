@@ -58,6 +58,7 @@ class ResBitmap : public VideoServices::Bitmap
 
 				MR_UInt8 *mBuffer;
 				MR_UInt8 **mColumnPtr;
+				bool mOwnBuffer;			  // false if mBuffer points into the record file
 
 				MR_DllDeclare SubBitmap();
 				MR_DllDeclare ~ SubBitmap();
@@ -36,6 +36,7 @@ ResShortSound::ResShortSound(int pResourceId)
 	mNbCopy = 0;
 	mDataLen = 0;
 	mData = NULL;
+	mOwnData = true;
 	mSound = NULL;
 
 }
@@ -45,7 +46,9 @@ ResShortSound::~ResShortSound()
 	SoundServer::DeleteShortSound(mSound);
 	mSound = NULL;
 
-	delete[]mData;
+	if(mOwnData) {
+		delete[]mData;
+	}
 	mData = NULL;
 }
 
@@ -66,15 +69,25 @@ void ResShortSound::Serialize(Parcel::ObjStream &pArchive)
 		SoundServer::DeleteShortSound(mSound);
 		mSound = NULL;
 
-		delete[]mData;
+		if(mOwnData) {
+			delete[]mData;
+		}
 		mData = NULL;
 
 		pArchive >> mNbCopy;
 		pArchive >> mDataLen;
 
-		mData = new char[mDataLen];
+		// Use the samples in place if the stream allows it
+		const MR_UInt8 *lView = pArchive.ReadView(mDataLen);
 
-		pArchive.Read(mData, mDataLen);
+		mOwnData = (lView == NULL);
+		if(mOwnData) {
+			mData = new char[mDataLen];
+			pArchive.Read(mData, mDataLen);
+		}
+		else {
+			mData = const_cast<char *>(reinterpret_cast<const char *>(lView));
+		}
 
 		mSound = SoundServer::CreateShortSound(mData, mNbCopy);
 
@@ -92,6 +105,7 @@ ResContinuousSound::ResContinuousSound(int pResourceId)
 	mNbCopy = 0;
 	mDataLen = 0;
 	mData = NULL;
+	mOwnData = true;
 	mSound = NULL;
 }
 
@@ -100,7 +114,9 @@ ResContinuousSound::~ResContinuousSound()
 	SoundServer::DeleteContinuousSound(mSound);
 	mSound = NULL;
 
-	delete[]mData;
+	if(mOwnData) {
+		delete[]mData;
+	}
 	mData = NULL;
 }
 
@@ -121,15 +137,25 @@ void ResContinuousSound::Serialize(Parcel::ObjStream &pArchive)
 		SoundServer::DeleteContinuousSound(mSound);
 		mSound = NULL;
 
-		delete[]mData;
+		if(mOwnData) {
+			delete[]mData;
+		}
 		mData = NULL;
 
 		pArchive >> mNbCopy;
 		pArchive >> mDataLen;
 
-		mData = new char[mDataLen];
-
-		pArchive.Read(mData, mDataLen);
+		// Use the samples in place if the stream allows it
+		const MR_UInt8 *lView = pArchive.ReadView(mDataLen);
+
+		mOwnData = (lView == NULL);
+		if(mOwnData) {
+			mData = new char[mDataLen];
+			pArchive.Read(mData, mDataLen);
+		}
+		else {
+			mData = const_cast<char *>(reinterpret_cast<const char *>(lView));
+		}
 
 		mSound = SoundServer::CreateContinuousSound(mData, mNbCopy);
 
@@ -52,6 +52,7 @@ class ResShortSound
 		int mNbCopy;
 		int mDataLen;
 		char *mData;
+		bool mOwnData;							  // false if mData points into the record file
 
 	public:
 												  // Only availlable for resourceLib and construction
@@ -74,6 +75,7 @@ class ResContinuousSound
 		int mNbCopy;
 		int mDataLen;
 		char *mData;
+		bool mOwnData;							  // false if mData points into the record file
 
 	public:
 												  // Only availlable for resourceLib and construction
@@ -22,7 +22,7 @@
 
 #include "StdAfx.h"
 
-#include "../Parcel/ClassicRecordFile.h"
+#include "../Parcel/MmapRecordFile.h"
 #if defined(_WIN32) && !defined(WITH_OBJSTREAM)
 #	include "../Parcel/MfcRecordFile.h"
 #endif
@@ -63,6 +63,53 @@ namespace {
 			res.insert(typename std::map<int, T*>::value_type(key, val));
 		}
 	}
+
+	void LoadIndex(ObjStream &os, std::map<int, int> &index)
+	{
+		MR_UInt32 num;
+		os >> num;
+		for (MR_UInt32 i = 0; i < num; ++i) {
+			MR_Int32 key;
+			MR_UInt32 recordNo;
+			os >> key >> recordNo;
+
+			index.insert(std::map<int, int>::value_type(key, recordNo));
+		}
+	}
+
+	/**
+	 * Retrieve a resource, decoding it from its own record if it hasn't been
+	 * loaded yet.
+	 * Loading an actor loads the bitmaps it refers to, so this may be
+	 * re-entered while the outer stream is still open; each record gets an
+	 * independent stream so that is safe.  The caller holds the (recursive)
+	 * lock.
+	 */
+	template<class T>
+	T *FindRes(int id, std::map<int, T*> &res, const std::map<int, int> &index,
+		RecordFile *recordFile, ResourceLib *self)
+	{
+		typename std::map<int, T*>::const_iterator iter = res.find(id);
+		if (iter != res.end()) return iter->second;
+
+		std::map<int, int>::const_iterator idx = index.find(id);
+		if (idx == index.end()) return NULL;
+
+		recordFile->SelectRecord(idx->second);
+		ObjStreamPtr osPtr(recordFile->StreamIn());
+
+		T *val = new T(id);
+		try {
+			NewRes(val, *osPtr, self);
+		}
+		catch (...) {
+			delete val;
+			throw;
+		}
+
+		res.insert(typename std::map<int, T*>::value_type(id, val));
+		return val;
+	}
 }
 
 /**
@@ -74,7 +121,8 @@ ResourceLib::ResourceLib(const Util::OS::path_t &filename)
 #	if defined(_WIN32) && !defined(WITH_OBJSTREAM)
 		recordFile = MfcRecordFile::New();
 #	else
-		recordFile = new ClassicRecordFile();
+		// Mapped so that bitmaps and sounds can use their data in place.
+		recordFile = new MmapRecordFile();
 #	endif
 
 	if (!recordFile->OpenForRead(filename)) {
@@ -86,21 +134,30 @@ ResourceLib::ResourceLib(const Util::OS::path_t &filename)
 	ObjStreamPtr osPtr(recordFile->StreamIn());
 	ObjStream &os = *osPtr;
 
-	const MR_UInt32 expectedMagic = FILE_MAGIC;
 	MR_UInt32 magic;
 	os >> magic;
-	if (magic != expectedMagic) {
+	if (magic == INDEXED_FILE_MAGIC) {
+		// Only the index is read here; resources are loaded on demand.
+		LoadIndex(os, bitmapIndex);
+		LoadIndex(os, actorIndex);
+		LoadIndex(os, spriteIndex);
+		LoadIndex(os, shortSoundIndex);
+		LoadIndex(os, continuousSoundIndex);
+	}
+	else if (magic == FILE_MAGIC) {
+		LoadRes(os, bitmaps, this);
+		LoadRes(os, actors, this);
+		LoadRes(os, sprites, this);
+		LoadRes(os, shortSounds, this);
+		LoadRes(os, continuousSounds, this);
+	}
+	else {
+		const MR_UInt32 expectedMagic = INDEXED_FILE_MAGIC;
 		throw ObjStreamExn(filename,
 			boost::str(boost::format("%s: %s %08x, %s %08x") %
             _("Invalid magic number") % _("Expected") %
 				expectedMagic % _("got") % magic));
 	}
-
-	LoadRes(os, bitmaps, this);
-	LoadRes(os, actors, this);
-	LoadRes(os, sprites, this);
-	LoadRes(os, shortSounds, this);
-	LoadRes(os, continuousSounds, this);
 }
 
 ResourceLib::~ResourceLib()
@@ -116,32 +173,51 @@ ResourceLib::~ResourceLib()
 
 ResBitmap *ResourceLib::GetBitmap(int id)
 {
-	bitmaps_t::const_iterator iter = bitmaps.find(id);
-	return (iter == bitmaps.end()) ? NULL : iter->second;
+	boost::recursive_mutex::scoped_lock lock(mutex);
+	return FindRes(id, bitmaps, bitmapIndex, recordFile, this);
 }
 
 const ResActor *ResourceLib::GetActor(int id)
 {
-	actors_t::const_iterator iter = actors.find(id);
-	return (iter == actors.end()) ? NULL : iter->second;
+	boost::recursive_mutex::scoped_lock lock(mutex);
+	return FindRes(id, actors, actorIndex, recordFile, this);
 }
 
 const ResSprite *ResourceLib::GetSprite(int id)
 {
-	sprites_t::const_iterator iter = sprites.find(id);
-	return (iter == sprites.end()) ? NULL : iter->second;
+	boost::recursive_mutex::scoped_lock lock(mutex);
+	return FindRes(id, sprites, spriteIndex, recordFile, this);
 }
 
 const ResShortSound *ResourceLib::GetShortSound(int id)
 {
-	shortSounds_t::const_iterator iter = shortSounds.find(id);
-	return (iter == shortSounds.end()) ? NULL : iter->second;
+	boost::recursive_mutex::scoped_lock lock(mutex);
+	return FindRes(id, shortSounds, shortSoundIndex, recordFile, this);
 }
 
 const ResContinuousSound *ResourceLib::GetContinuousSound(int id)
 {
-	continuousSounds_t::const_iterator iter = continuousSounds.find(id);
-	return (iter == continuousSounds.end()) ? NULL : iter->second;
+	boost::recursive_mutex::scoped_lock lock(mutex);
+	return FindRes(id, continuousSounds, continuousSoundIndex, recordFile, this);
+}
+
+/**
+ * Load a set of resources ahead of time, so that the first frame that uses
+ * them doesn't have to.
+ * Resource IDs are not unique across resource types, so every type of
+ * resource with a matching ID is loaded.  Unknown IDs are ignored.
+ * @param ids The resource IDs.
+ */
+void ResourceLib::Prefetch(const std::vector<int> &ids)
+{
+	boost::recursive_mutex::scoped_lock lock(mutex);
+	BOOST_FOREACH(int id, ids) {
+		GetBitmap(id);
+		GetActor(id);
+		GetSprite(id);
+		GetShortSound(id);
+		GetContinuousSound(id);
+	}
 }
 
 }  // namespace HoverRace
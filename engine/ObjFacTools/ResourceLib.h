@@ -23,6 +23,9 @@
 #pragma once
 
 #include <map>
+#include <vector>
+
+#include <boost/thread/recursive_mutex.hpp>
 
 #include "../Util/OS.h"
 #include "ResActor.h"
@@ -49,10 +52,21 @@ namespace HoverRace {
 namespace HoverRace {
 namespace ObjFacTools {
 
+/**
+ * Loadable resource manager.
+ *
+ * Indexed resource files keep each resource in its own record, with an
+ * id-to-record index in record 0; resources are only decoded the first time
+ * they are requested (or when they are prefetched).  Legacy files, which
+ * keep everything in record 0, are still loaded in full up front.
+ *
+ * Resources may be requested from any thread (e.g. while a track is being
+ * loaded in the background).
+ */
 class MR_DllDeclare ResourceLib
 {
 	protected:
-		ResourceLib() { }
+		ResourceLib() : recordFile(NULL) { }
 	public:
 		ResourceLib(const Util::OS::path_t &filename);
 		~ResourceLib();
@@ -64,8 +78,19 @@ class MR_DllDeclare ResourceLib
 		const ResShortSound *GetShortSound(int id);
 		const ResContinuousSound *GetContinuousSound(int id);
 
+		void Prefetch(const std::vector<int> &ids);
+
 	protected:
 		Parcel::RecordFile *recordFile;
+		boost::recursive_mutex mutex;  ///< Guards on-demand loading.
+
+		/// Resource ID to record number, for resources not yet loaded.
+		typedef std::map<int, int> index_t;
+		index_t bitmapIndex;
+		index_t actorIndex;
+		index_t spriteIndex;
+		index_t shortSoundIndex;
+		index_t continuousSoundIndex;
 
 		typedef std::map<int, ResBitmap*> bitmaps_t;
 		bitmaps_t bitmaps;
@@ -80,6 +105,7 @@ class MR_DllDeclare ResourceLib
 
 	protected:
 		static const MR_UInt32 FILE_MAGIC = 12345;
+		static const MR_UInt32 INDEXED_FILE_MAGIC = 12346;
 };
 
 }  // namespace HoverRace
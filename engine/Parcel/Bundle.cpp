@@ -24,6 +24,7 @@
 
 #include "../Util/Str.h"
 #include "ClassicRecordFile.h"
+#include "MmapRecordFile.h"
 #if defined(_WIN32) && !defined(WITH_OBJSTREAM)
 #	include "MfcRecordFile.h"
 #endif
@@ -54,37 +55,64 @@ Bundle::Bundle(const OS::path_t &dir, BundlePtr subBundle) :
  * All parcels, including sub-bundles, will be searched.
  * @param name The name of the parcel.
  * @param writing @c true if the parcel will be written to, @c false if read-only.
+ * @param validate @c true to check the content hash (read-only parcels only).
  * @return The parcel (may be @c NULL if parcel does not exist).
+ * @throws ObjStreamExn The parcel failed validation.
  */
-RecordFilePtr Bundle::OpenParcel(const std::string &name, bool writing) const
+RecordFilePtr Bundle::OpenParcel(const std::string &name, bool writing, bool validate) const
 {
 	OS::path_t pt = dir / Str::UP(name.c_str());
 
 	if (fs::exists(pt)) {
-#		if defined(_WIN32) && !defined(WITH_OBJSTREAM)
-			MfcRecordFile::FixFileAttrs(pt);
-			RecordFile *rec = MfcRecordFile::New();
-#		else
-			RecordFile *rec = new ClassicRecordFile();
-#		endif
-		if (writing) {
-			rec->OpenForWrite(pt);
-		}
-		else {
-			rec->OpenForRead(pt);
-		}
-		return RecordFilePtr(rec);
+		return OpenParcelFile(pt, writing, validate);
 	}
 	else {
 		if (subBundle.get() == NULL) {
 			return RecordFilePtr();
 		}
 		else {
-			return subBundle->OpenParcel(name, writing);
+			return subBundle->OpenParcel(name, writing, validate);
 		}
 	}
 }
 
+/**
+ * Open an existing parcel file directly.
+ * @param path The path to the parcel (must exist).
+ * @param writing @c true if the parcel will be written to, @c false if read-only.
+ * @param validate @c true to check the content hash (read-only parcels only).
+ * @return The parcel (never @c NULL).
+ * @throws ObjStreamExn The parcel failed validation.
+ */
+RecordFilePtr Bundle::OpenParcelFile(const OS::path_t &path, bool writing, bool validate)
+{
+	RecordFilePtr rec;
+#	if defined(_WIN32) && !defined(WITH_OBJSTREAM)
+		MfcRecordFile::FixFileAttrs(path);
+		rec.reset(MfcRecordFile::New());
+		if (writing) {
+			rec->OpenForWrite(path);
+		}
+		else {
+			rec->OpenForRead(path, validate);
+		}
+#	else
+		if (writing) {
+			rec.reset(new ClassicRecordFile());
+			rec->OpenForWrite(path);
+		}
+		else {
+			rec.reset(new MmapRecordFile());
+			if (!rec->OpenForRead(path, validate)) {
+				// Fall back to plain file I/O (e.g. mapping not possible).
+				rec.reset(new ClassicRecordFile());
+				rec->OpenForRead(path, validate);
+			}
+		}
+#	endif
+	return rec;
+}
+
 Bundle::iterator Bundle::begin()
 {
 	return iterator(this);
@@ -52,7 +52,12 @@ class MR_DllDeclare Bundle
 		Bundle(const Util::OS::path_t &dir, BundlePtr subBundle=BundlePtr());
 		virtual ~Bundle() { }
 
-		virtual RecordFilePtr OpenParcel(const std::string &name, bool writing=false) const;
+		virtual RecordFilePtr OpenParcel(const std::string &name, bool writing=false,
+			bool validate=false) const;
+
+	protected:
+		static RecordFilePtr OpenParcelFile(const Util::OS::path_t &path, bool writing=false,
+			bool validate=false);
 
 	private:
 		class MR_DllDeclare Iterator :
@@ -31,11 +31,86 @@ namespace Parcel {
 
 ClassicObjStream::ClassicObjStream(FILE *stream, const Util::OS::path_t &name, bool writing) :
 	SUPER(name, 1, writing),
-	stream(stream)
+	stream(stream), buffer(new MR_UInt8[BUFFER_SIZE]), bufPos(0), bufLen(0)
 {
 	// Version for classic record file is currently always 1.
 }
 
+ClassicObjStream::~ClassicObjStream()
+{
+	if (IsWriting()) {
+		try {
+			Flush();
+		}
+		catch (ObjStreamExn&) {
+			// Nowhere to report it from here.
+		}
+	}
+	else if (bufPos < bufLen) {
+		// Give back what was read ahead so the next reader of the file
+		// starts where this one left off.
+		fseek(stream, -static_cast<long>(bufLen - bufPos), SEEK_CUR);
+	}
+
+	delete[] buffer;
+}
+
+/**
+ * Write out any buffered data.
+ * @throws ObjStreamExn The write failed.
+ */
+void ClassicObjStream::Flush()
+{
+	if (bufLen > 0) {
+		size_t len = bufLen;
+		bufLen = 0;
+		if (fwrite(buffer, len, 1, stream) == 0) {
+			throw ObjStreamExn(GetName(), _("Write failed"));
+		}
+	}
+}
+
+void ClassicObjStream::WriteBufSlow(const void *buf, size_t ct)
+{
+	Flush();
+	if (ct >= BUFFER_SIZE) {
+		if (fwrite(buf, ct, 1, stream) == 0) {
+			throw ObjStreamExn(GetName(), _("Write failed"));
+		}
+	}
+	else {
+		memcpy(buffer, buf, ct);
+		bufLen = ct;
+	}
+}
+
+void ClassicObjStream::ReadBufSlow(void *buf, size_t ct)
+{
+	MR_UInt8 *dest = static_cast<MR_UInt8*>(buf);
+
+	// Drain what's left in the buffer.
+	size_t avail = bufLen - bufPos;
+	memcpy(dest, buffer + bufPos, avail);
+	dest += avail;
+	ct -= avail;
+	bufPos = bufLen = 0;
+
+	if (ct >= BUFFER_SIZE) {
+		// Large blocks go straight to the destination.
+		if (fread(dest, ct, 1, stream) == 0) {
+			throw ObjStreamExn(GetName(), _("Read failed"));
+		}
+	}
+	else {
+		bufLen = fread(buffer, 1, BUFFER_SIZE, stream);
+		if (bufLen < ct) {
+			throw ObjStreamExn(GetName(), _("Read failed"));
+		}
+		memcpy(dest, buffer, ct);
+		bufPos = ct;
+	}
+}
+
 void ClassicObjStream::WriteUInt8(MR_UInt8 i)
 {
 	WriteBuf(&i, 1);
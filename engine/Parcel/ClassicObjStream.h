@@ -39,6 +39,11 @@ namespace Parcel {
 
 /**
  * Standard HoverRace 1.x parcel data stream.
+ *
+ * Reads and writes go through a block buffer instead of one stdio call per
+ * field.  When a reading stream is destroyed, the file position is moved
+ * back to just after the last byte actually consumed; a writing stream is
+ * flushed when it is destroyed (call Flush() first to catch write errors).
  * @author Michael Imamura
  * @todo Handle big-endian platforms.
  */
@@ -48,14 +53,23 @@ class MR_DllDeclare ClassicObjStream : public ObjStream
 	public:
 	public:
 		ClassicObjStream(FILE *stream, const Util::OS::path_t &name, bool writing);
-		virtual ~ClassicObjStream() { }
+		virtual ~ClassicObjStream();
+
+	public:
+		void Flush();
 
 	private:
 		void WriteBuf(const void *buf, size_t ct)
 		{
-			size_t ret = fwrite(buf, ct, 1, stream);
-			if (ret == 0) throw ObjStreamExn(GetName(), _("Write failed"));
+			if (ct <= BUFFER_SIZE - bufLen) {
+				memcpy(buffer + bufLen, buf, ct);
+				bufLen += ct;
+			}
+			else {
+				WriteBufSlow(buf, ct);
+			}
 		}
+		void WriteBufSlow(const void *buf, size_t ct);
 
 	public:
 		virtual void Write(const void *buf, size_t ct) { WriteBuf(buf, ct); }
@@ -75,9 +89,15 @@ class MR_DllDeclare ClassicObjStream : public ObjStream
 
 		void ReadBuf(void *buf, size_t ct)
 		{
-			size_t ret = fread(buf, ct, 1, stream);
-			if (ret == 0) throw ObjStreamExn(GetName(), _("Read failed"));
+			if (ct <= bufLen - bufPos) {
+				memcpy(buf, buffer + bufPos, ct);
+				bufPos += ct;
+			}
+			else {
+				ReadBufSlow(buf, ct);
+			}
 		}
+		void ReadBufSlow(void *buf, size_t ct);
 
 	public:
 		virtual void Read(void *buf, size_t ct) { ReadBuf(buf, ct); }
@@ -97,6 +117,11 @@ class MR_DllDeclare ClassicObjStream : public ObjStream
 
 	private:
 		FILE *stream;
+
+		static const size_t BUFFER_SIZE = 64 * 1024;
+		MR_UInt8 *buffer;
+		size_t bufPos;  ///< Read position in the buffer.
+		size_t bufLen;  ///< Number of bytes in the buffer.
 };
 
 }  // namespace Parcel
@@ -22,9 +22,12 @@
 
 #include "StdAfx.h"
 
+#include "../Util/Crc32c.h"
 #include "../Util/InspectMapNode.h"
 #include "../Util/Str.h"
 #include "ClassicObjStream.h"
+#include "DeflateObjStream.h"
+#include "MmapObjStream.h"
 
 #include "ClassicRecordFile.h"
 
@@ -55,18 +58,23 @@ class ClassicRecordFileHeader : public Util::Inspectable
 		MR_UInt32 checksum;
 		MR_UInt32 recordsUsed;
 		MR_UInt32 recordsMax;
+		MR_UInt32 recordFormat;
+		MR_UInt32 hashType;
+		MR_UInt32 contentHash;
 		MR_UInt32 *recordList;
 };
 
 ClassicRecordFileHeader::ClassicRecordFileHeader() :
 	SUPER(), sumValid(false), checksum(0),
-	recordsUsed(0), recordsMax(0), recordList(NULL)
+	recordsUsed(0), recordsMax(0), recordFormat(0), hashType(0), contentHash(0),
+	recordList(NULL)
 {
 }
 
 ClassicRecordFileHeader::ClassicRecordFileHeader(MR_UInt32 numRecords) :
 	SUPER(), sumValid(false), checksum(0),
-	recordsUsed(0), recordsMax(numRecords), recordList(new MR_UInt32[numRecords])
+	recordsUsed(0), recordsMax(numRecords), recordFormat(0), hashType(0), contentHash(0),
+	recordList(new MR_UInt32[numRecords])
 {
 	ASSERT(numRecords > 0);
 
@@ -86,9 +94,9 @@ void ClassicRecordFileHeader::Serialize(ObjStream &os)
 		BOOL sumValidLoad = FALSE;  //TODO
 
 		os << title <<
-			(MR_Int32) 0 << (MR_Int32) 0 <<
+			recordFormat << (MR_Int32) 0 <<
 			sumValidLoad << checksum << recordsUsed << recordsMax <<
-			(MR_Int32) 0 << (MR_Int32) 0;
+			hashType << contentHash;
 
 		if (recordsMax > 0) {
 			for (unsigned int i = 0; i < recordsMax; ++i) {
@@ -104,9 +112,9 @@ void ClassicRecordFileHeader::Serialize(ObjStream &os)
 		BOOL sumValidLoad;
 
 		os >> title >>
-			dummy >> dummy >>
+			recordFormat >> dummy >>
 			sumValidLoad >> checksum >> recordsUsed >> recordsMax >>
-			dummy >> dummy;
+			hashType >> contentHash;
 		sumValid = sumValidLoad != FALSE;
 
 		// Check title for validity.
@@ -135,13 +143,18 @@ void ClassicRecordFileHeader::Inspect(Util::InspectMapNode &node) const
 		AddField("checksum", checksum).
 		AddField("recordsUsed", recordsUsed).
 		AddField("recordsMax", recordsMax).
+		AddField("recordFormat", recordFormat).
+		AddField("hashType", hashType).
+		AddField("contentHash", contentHash).
 		AddArray("recordList", recordList, 0, recordsMax);
 }
 
 // ClassicRecordFile
 
 ClassicRecordFile::ClassicRecordFile() :
-	SUPER(), constructionMode(false), curRecord(-1), header(NULL)
+	SUPER(), constructionMode(false), compression(COMPRESS_NONE),
+	curRecord(-1), header(NULL),
+	fileStream(NULL), headerEnd(0)
 {
 }
 
@@ -151,8 +164,12 @@ ClassicRecordFile::~ClassicRecordFile()
 		// Re-write header for construction mode.
 		if (constructionMode) {
 			fseek(fileStream, 0, SEEK_SET);
-			ClassicObjStream objStream(fileStream, filename, true);
-			header->Serialize(objStream);
+			{
+				ClassicObjStream objStream(fileStream, filename, true);
+				header->Serialize(objStream);
+			}
+			headerEnd = ftell(fileStream);
+			WriteContentHash();
 		}
 
 		fclose(fileStream);
@@ -169,10 +186,16 @@ bool ClassicRecordFile::CreateForWrite(const Util::OS::path_t &filename, int num
 	fileStream = OS::FOpen(filename, "w+b");
 	if (fileStream == NULL) return false;
 
-	ClassicObjStream objStream(fileStream, filename, true);
 	header = new ClassicRecordFileHeader(numRecords);
 	header->title = title;
-	header->Serialize(objStream);
+	if (compression != COMPRESS_NONE) {
+		header->recordFormat = RECORD_FORMAT_FRAMED;
+	}
+	{
+		ClassicObjStream objStream(fileStream, filename, true);
+		header->Serialize(objStream);
+	}
+	headerEnd = ftell(fileStream);
 
 	constructionMode = true;
 
@@ -188,9 +211,12 @@ bool ClassicRecordFile::OpenForWrite(const Util::OS::path_t &filename)
 	fileStream = OS::FOpen(filename, "r+b");
 	if (fileStream == NULL) return false;
 
-	ClassicObjStream objStream(fileStream, filename, false);
 	header = new ClassicRecordFileHeader();
-	header->Serialize(objStream);
+	{
+		ClassicObjStream objStream(fileStream, filename, false);
+		header->Serialize(objStream);
+	}
+	headerEnd = ftell(fileStream);
 
 	if (header->recordList == NULL) { fclose(fileStream); return false; }
 
@@ -201,18 +227,146 @@ bool ClassicRecordFile::OpenForWrite(const Util::OS::path_t &filename)
 	return true;
 }
 
+/**
+ * Open an existing parcel for reading.
+ * @param filename The parcel file.
+ * @param validateChecksum @c true to check the content hash, if the parcel
+ *                         has one (see HasContentHash()).
+ * @return @c true if successful, @c false if the file could not be opened.
+ * @throws ObjStreamExn The content hash does not match.
+ */
 bool ClassicRecordFile::OpenForRead(const Util::OS::path_t &filename, bool validateChecksum)
 {
 	if (OpenForWrite(filename)) {
 		constructionMode = false;
 
-		//TODO: Validate checksum;
+		if (validateChecksum && HasContentHash()) {
+			LoadVerified();
+		}
 		return true;
 	}
 
 	return false;
 }
 
+/**
+ * Set the compression for records written from now on.
+ * Anything other than COMPRESS_NONE must be set before CreateForWrite(),
+ * and only one output stream may be opened for each record.
+ * Records appended to an existing unframed parcel are never compressed.
+ * @param compression The compression.
+ */
+void ClassicRecordFile::SetCompression(Compression compression)
+{
+	this->compression = compression;
+}
+
+/**
+ * Calculate the position of the content hash fields in the header.
+ * @return The file offset.
+ */
+long ClassicRecordFile::GetContentHashPos() const
+{
+	return headerEnd - (long)(header->recordsMax * sizeof(MR_UInt32)) -
+		(long)CONTENT_HASH_SIZE;
+}
+
+/**
+ * Read the whole file into memory, checking the content hash along the way.
+ * @throws ObjStreamExn The file could not be read or the hash does not match.
+ */
+void ClassicRecordFile::LoadVerified()
+{
+	static const size_t CHUNK_SIZE = 64 * 1024;
+
+	fseek(fileStream, 0, SEEK_END);
+	long len = ftell(fileStream);
+	long hashPos = GetContentHashPos();
+	if (len < 0 || hashPos < 0) {
+		throw ObjStreamExn(filename, _("Read failed"));
+	}
+	fseek(fileStream, 0, SEEK_SET);
+
+	std::vector<MR_UInt8> buf((size_t)len);
+	Crc32c crc;
+	for (size_t pos = 0; pos < buf.size(); ) {
+		size_t ct = fread(&buf[pos], 1, std::min(CHUNK_SIZE, buf.size() - pos), fileStream);
+		if (ct == 0) throw ObjStreamExn(filename, _("Read failed"));
+		HashContent(crc, &buf[pos], pos, ct, (size_t)hashPos);
+		pos += ct;
+	}
+
+	if (crc.Get() != header->contentHash) {
+		throw ObjStreamExn(filename, _("Checksum mismatch (the file is corrupt)"));
+	}
+
+	contents.swap(buf);
+}
+
+/**
+ * Recalculate the content hash and update it in the header.
+ * The rest of the header must already have been written.
+ */
+void ClassicRecordFile::WriteContentHash()
+{
+	long hashPos = GetContentHashPos();
+	if (hashPos < 0) return;
+
+	fflush(fileStream);
+	fseek(fileStream, 0, SEEK_SET);
+
+	std::vector<MR_UInt8> buf(64 * 1024);
+	Crc32c crc;
+	size_t pos = 0;
+	size_t ct;
+	while ((ct = fread(&buf[0], 1, buf.size(), fileStream)) > 0) {
+		HashContent(crc, &buf[0], pos, ct, (size_t)hashPos);
+		pos += ct;
+	}
+
+	header->hashType = CONTENT_HASH_CRC32C;
+	header->contentHash = crc.Get();
+
+	fseek(fileStream, hashPos, SEEK_SET);
+	ClassicObjStream objStream(fileStream, filename, true);
+	objStream << header->hashType << header->contentHash;
+}
+
+/**
+ * Check if the parcel has a content hash (parcels written by older versions
+ * only have the legacy checksum from ApplyChecksum()).
+ */
+bool ClassicRecordFile::HasContentHash() const
+{
+	return header != NULL && header->recordList != NULL &&
+		header->hashType == CONTENT_HASH_CRC32C;
+}
+
+/**
+ * Add a block of a parcel file to its content hash.
+ * The hash covers the whole file except the hash fields themselves.
+ * Blocks must be passed in order.
+ * @param crc The hash.
+ * @param buf The block.
+ * @param pos The offset of the block in the file.
+ * @param len The length of the block.
+ * @param hashPos The offset of the hash fields in the file.
+ */
+void ClassicRecordFile::HashContent(Crc32c &crc, const MR_UInt8 *buf,
+                                    size_t pos, size_t len, size_t hashPos)
+{
+	size_t end = pos + len;
+	size_t skipEnd = hashPos + CONTENT_HASH_SIZE;
+
+	if (pos < hashPos) {
+		crc.Update(buf, std::min(end, hashPos) - pos);
+	}
+	if (end > skipEnd) {
+		size_t from = std::max(pos, skipEnd);
+		crc.Update(buf + (from - pos), end - from);
+	}
+}
+
 DWORD ClassicRecordFile::ComputeSum(const OS::path_t &filename)
 {
 	DWORD lReturnValue = 0;
@@ -298,6 +452,11 @@ bool ClassicRecordFile::BeginANewRecord()
 	curRecord = header->recordsUsed++;
 	header->recordList[curRecord] = ftell(fileStream);
 
+	if (header->recordFormat == RECORD_FORMAT_FRAMED) {
+		ClassicObjStream objStream(fileStream, filename, true);
+		objStream << ((compression == COMPRESS_NONE) ? RECORD_STORED : RECORD_DEFLATE);
+	}
+
 	return true;
 }
 
@@ -308,13 +467,74 @@ void ClassicRecordFile::Inspect(Util::InspectMapNode &node) const
 		AddSubobject("header", header);
 }
 
+/**
+ * Open a stream on a record held in memory.
+ * @param begin The start of the record.
+ * @param end The end of the available data.
+ * @param name The name of the parcel (for error messages).
+ * @param recordFormat The record format from the parcel header.
+ * @return The stream (never @c NULL).
+ * @throws ObjStreamExn The record uses an unknown compression method.
+ */
+ObjStreamPtr ClassicRecordFile::StreamInRecord(const MR_UInt8 *begin,
+                                               const MR_UInt8 *end,
+                                               const OS::path_t &name,
+                                               MR_UInt32 recordFormat)
+{
+	if (recordFormat == RECORD_FORMAT_FRAMED) {
+		MmapObjStream frame(begin, end, name);
+		MR_UInt32 method;
+		frame >> method;
+		begin = frame.GetPos();
+
+		if (method == RECORD_DEFLATE) {
+			return ObjStreamPtr(new DeflateObjStream(begin, end, name));
+		}
+		else if (method != RECORD_STORED) {
+			throw ObjStreamExn(name, _("Unsupported record compression"));
+		}
+	}
+	return ObjStreamPtr(new MmapObjStream(begin, end, name));
+}
+
 ObjStreamPtr ClassicRecordFile::StreamIn()
 {
+	if (!contents.empty() && curRecord >= 0) {
+		size_t offset = header->recordList[curRecord];
+		if (offset > contents.size()) {
+			throw ObjStreamExn(filename, _("Read failed"));
+		}
+		const MR_UInt8 *data = &contents[0];
+		return StreamInRecord(data + offset, data + contents.size(), filename,
+			header->recordFormat);
+	}
+
+	if (header != NULL && header->recordFormat == RECORD_FORMAT_FRAMED) {
+		MR_UInt32 method;
+		{
+			ClassicObjStream frame(fileStream, filename, false);
+			frame >> method;
+		}
+
+		if (method == RECORD_DEFLATE) {
+			return ObjStreamPtr(new DeflateObjStream(fileStream, filename));
+		}
+		else if (method != RECORD_STORED) {
+			throw ObjStreamExn(filename, _("Unsupported record compression"));
+		}
+	}
 	return ObjStreamPtr(new ClassicObjStream(fileStream, filename, false));
 }
 
 ObjStreamPtr ClassicRecordFile::StreamOut()
 {
+	if (header != NULL && header->recordFormat == RECORD_FORMAT_FRAMED &&
+		compression != COMPRESS_NONE)
+	{
+		return ObjStreamPtr(new DeflateObjStream(fileStream, filename,
+			(compression == COMPRESS_FAST) ?
+				DeflateObjStream::LEVEL_FAST : DeflateObjStream::LEVEL_SMALL));
+	}
 	return ObjStreamPtr(new ClassicObjStream(fileStream, filename, true));
 }
 
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <fstream>
+#include <vector>
 
 #include "RecordFile.h"
 
@@ -36,6 +37,12 @@
 #	define MR_DllDeclare
 #endif
 
+namespace HoverRace {
+	namespace Util {
+		class Crc32c;
+	}
+}
+
 namespace HoverRace {
 namespace Parcel {
 
@@ -43,6 +50,17 @@ class ClassicRecordFileHeader;
 
 /**
  * Standard HoverRace 1.x parcel format.
+ *
+ * Parcels written by this class also carry a CRC-32C of the whole file in
+ * the (formerly reserved) last two words of the header; older readers
+ * ignore it.  When opened with @c validateChecksum, the file is read into
+ * memory in a single pass, hashing as it goes, and the records are then
+ * served from that copy.
+ *
+ * Records may also be compressed (see SetCompression()).  Such parcels are
+ * marked as "framed" in the header and each record starts with a word
+ * giving its compression method; these parcels cannot be read by older
+ * versions.
  * @author Michael Imamura
  */
 class MR_DllDeclare ClassicRecordFile : public RecordFile
@@ -56,10 +74,38 @@ class MR_DllDeclare ClassicRecordFile : public RecordFile
 		virtual bool OpenForWrite(const Util::OS::path_t &filename);
 		virtual bool OpenForRead(const Util::OS::path_t &filename, bool validateChecksum=false);
 
+		/// Compression for new records.
+		enum Compression {
+			COMPRESS_NONE,   ///< Unframed, readable by older versions.
+			COMPRESS_FAST,   ///< Deflate, favoring speed.
+			COMPRESS_SMALL,  ///< Deflate, favoring size.
+		};
+		void SetCompression(Compression compression);
+
 	protected:
 		static DWORD ComputeSum(const Util::OS::path_t &filename);
 	public:
 		virtual bool ApplyChecksum(const Util::OS::path_t &filename);
+		virtual bool HasContentHash() const;
+
+		static void HashContent(Util::Crc32c &crc, const MR_UInt8 *buf,
+			size_t pos, size_t len, size_t hashPos);
+
+		/// Header tag for a CRC-32C content hash ("C32C").
+		static const MR_UInt32 CONTENT_HASH_CRC32C = 0x43323343;
+		/// Size of the content hash fields (tag and hash) in the header.
+		static const size_t CONTENT_HASH_SIZE = 8;
+
+		/// Header tag for parcels whose records are framed ("ZRC1").
+		static const MR_UInt32 RECORD_FORMAT_FRAMED = 0x3143525a;
+		/// Record frame method: raw data.
+		static const MR_UInt32 RECORD_STORED = 0;
+		/// Record frame method: zlib-wrapped deflate (see DeflateObjStream).
+		static const MR_UInt32 RECORD_DEFLATE = 1;
+
+		static ObjStreamPtr StreamInRecord(const MR_UInt8 *begin,
+			const MR_UInt8 *end, const Util::OS::path_t &name,
+			MR_UInt32 recordFormat);
 
 		virtual DWORD GetAlignMode();
 
@@ -72,12 +118,20 @@ class MR_DllDeclare ClassicRecordFile : public RecordFile
 		virtual ObjStreamPtr StreamIn();
 		virtual ObjStreamPtr StreamOut();
 
+	private:
+		long GetContentHashPos() const;
+		void LoadVerified();
+		void WriteContentHash();
+
 	private:
 		bool constructionMode;
+		Compression compression;
 		int curRecord;
 		ClassicRecordFileHeader *header;
 		FILE *fileStream;
+		long headerEnd;
 		Util::OS::path_t filename;
+		std::vector<MR_UInt8> contents;  ///< Whole file, if verified on open.
 };
 
 }  // namespace Parcel
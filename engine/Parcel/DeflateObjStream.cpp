@@ -0,0 +1,316 @@
+// DeflateObjStream.cpp
+// Compressed parcel data stream.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <limits.h>
+
+#include <zlib.h>
+
+#include "../Exception.h"
+
+#include "DeflateObjStream.h"
+
+namespace HoverRace {
+namespace Parcel {
+
+/**
+ * Constructor for a writing stream.
+ * @param stream The file to write the compressed data to.
+ * @param name The name of the parcel (for error messages).
+ * @param level The zlib compression level (1 = fastest, 9 = smallest).
+ */
+DeflateObjStream::DeflateObjStream(FILE *stream, const Util::OS::path_t &name, int level) :
+	SUPER(name, 1, true),
+	stream(stream), src(NULL), srcEnd(NULL), level(level)
+{
+	Init();
+}
+
+/**
+ * Constructor for a stream reading from a file.
+ * @param stream The file, positioned at the start of the compressed data.
+ * @param name The name of the parcel (for error messages).
+ */
+DeflateObjStream::DeflateObjStream(FILE *stream, const Util::OS::path_t &name) :
+	SUPER(name, 1, false),
+	stream(stream), src(NULL), srcEnd(NULL), level(0)
+{
+	Init();
+}
+
+/**
+ * Constructor for a stream reading from memory.
+ * The memory must outlive the stream.
+ * @param begin The start of the compressed data.
+ * @param end The end of the available data (the compressed data may end
+ *            before this).
+ * @param name The name of the parcel (for error messages).
+ */
+DeflateObjStream::DeflateObjStream(const MR_UInt8 *begin, const MR_UInt8 *end,
+                                   const Util::OS::path_t &name) :
+	SUPER(name, 1, false),
+	stream(NULL), src(begin), srcEnd(end), level(0)
+{
+	Init();
+}
+
+void DeflateObjStream::Init()
+{
+	zs = new z_stream;
+	memset(zs, 0, sizeof(z_stream));
+
+	int ret = IsWriting() ? deflateInit(zs, level) : inflateInit(zs);
+	if (ret != Z_OK) {
+		delete zs;
+		throw ObjStreamExn(GetName(), _("Unable to initialize compression"));
+	}
+
+	finished = false;
+	buffer = new MR_UInt8[BUFFER_SIZE];
+	bufPos = 0;
+	bufLen = 0;
+	zbuffer = (src == NULL) ? new MR_UInt8[BUFFER_SIZE] : NULL;
+}
+
+DeflateObjStream::~DeflateObjStream()
+{
+	if (IsWriting()) {
+		try {
+			Finish();
+		}
+		catch (ObjStreamExn&) {
+			// Nowhere to report it from here.
+		}
+		deflateEnd(zs);
+	}
+	else {
+		inflateEnd(zs);
+	}
+
+	delete zs;
+	delete[] zbuffer;
+	delete[] buffer;
+}
+
+/**
+ * Compress and write out any buffered data and end the compressed stream.
+ * Nothing more may be written afterwards.
+ * @throws ObjStreamExn The write failed.
+ */
+void DeflateObjStream::Finish()
+{
+	if (!finished) {
+		finished = true;
+		size_t len = bufLen;
+		bufLen = 0;
+		Deflate(buffer, len, Z_FINISH);
+	}
+}
+
+/**
+ * Compress a block of data to the file.
+ * @param buf The data.
+ * @param ct The number of bytes.
+ * @param flush The zlib flush mode.
+ * @throws ObjStreamExn The write failed.
+ */
+void DeflateObjStream::Deflate(const MR_UInt8 *buf, size_t ct, int flush)
+{
+	do {
+		uInt chunk = (uInt)std::min<size_t>(ct, UINT_MAX);
+		zs->next_in = const_cast<Bytef*>(buf);
+		zs->avail_in = chunk;
+		buf += chunk;
+		ct -= chunk;
+
+		int chunkFlush = (ct > 0) ? Z_NO_FLUSH : flush;
+		do {
+			zs->next_out = zbuffer;
+			zs->avail_out = BUFFER_SIZE;
+			if (deflate(zs, chunkFlush) == Z_STREAM_ERROR) {
+				throw ObjStreamExn(GetName(), _("Write failed"));
+			}
+			size_t have = BUFFER_SIZE - zs->avail_out;
+			if (have > 0 && fwrite(zbuffer, have, 1, stream) == 0) {
+				throw ObjStreamExn(GetName(), _("Write failed"));
+			}
+		} while (zs->avail_out == 0);
+	} while (ct > 0);
+}
+
+void DeflateObjStream::WriteBufSlow(const void *buf, size_t ct)
+{
+	if (finished) {
+		throw ObjStreamExn(GetName(), _("Write failed"));
+	}
+
+	size_t len = bufLen;
+	bufLen = 0;
+	Deflate(buffer, len, Z_NO_FLUSH);
+
+	if (ct >= BUFFER_SIZE) {
+		Deflate(static_cast<const MR_UInt8*>(buf), ct, Z_NO_FLUSH);
+	}
+	else {
+		memcpy(buffer, buf, ct);
+		bufLen = ct;
+	}
+}
+
+void DeflateObjStream::WriteString(const std::string &s)
+{
+	MR_UInt32 len = s.length();
+	WriteStringLength(len);
+	WriteBuf(s.c_str(), len);
+}
+
+void DeflateObjStream::WriteStringLength(MR_UInt32 len)
+{
+	if (len < 0xff) {
+		WriteUInt8(len);
+		return;
+	}
+
+	WriteUInt8(0xff);
+	// 0xfffe is the marker for Unicode strings.
+	if (len < 0xfffe) {
+		WriteUInt16(len);
+		return;
+	}
+
+	WriteUInt16(0xffff);
+	WriteUInt32(len);
+}
+
+/**
+ * Decompress data.
+ * @param buf The destination.
+ * @param ct The number of bytes wanted.
+ * @return The number of bytes decompressed; this is less than @p ct only
+ *         if the end of the compressed data was reached.
+ * @throws ObjStreamExn The compressed data could not be read or is corrupt.
+ */
+size_t DeflateObjStream::Inflate(MR_UInt8 *buf, size_t ct)
+{
+	size_t done = 0;
+
+	while (done < ct && !finished) {
+		if (zs->avail_in == 0) {
+			if (src != NULL) {
+				if (src == srcEnd) {
+					throw ObjStreamExn(GetName(), _("Read failed"));
+				}
+				uInt chunk = (uInt)std::min<size_t>(srcEnd - src, UINT_MAX);
+				zs->next_in = const_cast<Bytef*>(src);
+				zs->avail_in = chunk;
+				src += chunk;
+			}
+			else {
+				size_t len = fread(zbuffer, 1, BUFFER_SIZE, stream);
+				if (len == 0) {
+					throw ObjStreamExn(GetName(), _("Read failed"));
+				}
+				zs->next_in = zbuffer;
+				zs->avail_in = (uInt)len;
+			}
+		}
+
+		uInt chunk = (uInt)std::min<size_t>(ct - done, UINT_MAX);
+		zs->next_out = buf + done;
+		zs->avail_out = chunk;
+
+		int ret = inflate(zs, Z_NO_FLUSH);
+		done += chunk - zs->avail_out;
+
+		if (ret == Z_STREAM_END) {
+			finished = true;
+		}
+		else if (ret != Z_OK) {
+			throw ObjStreamExn(GetName(), _("Corrupt compressed record"));
+		}
+	}
+
+	return done;
+}
+
+void DeflateObjStream::ReadBufSlow(void *buf, size_t ct)
+{
+	MR_UInt8 *dest = static_cast<MR_UInt8*>(buf);
+
+	// Drain what's left in the buffer.
+	size_t avail = bufLen - bufPos;
+	memcpy(dest, buffer + bufPos, avail);
+	dest += avail;
+	ct -= avail;
+	bufPos = bufLen = 0;
+
+	if (ct >= BUFFER_SIZE) {
+		// Large blocks are decompressed straight to the destination.
+		if (Inflate(dest, ct) < ct) {
+			throw ObjStreamExn(GetName(), _("Read failed"));
+		}
+	}
+	else {
+		bufLen = Inflate(buffer, BUFFER_SIZE);
+		if (bufLen < ct) {
+			throw ObjStreamExn(GetName(), _("Read failed"));
+		}
+		memcpy(dest, buffer, ct);
+		bufPos = ct;
+	}
+}
+
+void DeflateObjStream::ReadString(std::string &s)
+{
+	MR_UInt32 len = ReadStringLength();
+
+	s.resize(len);
+	if (len > 0) {
+		ReadBuf(&s[0], len);
+	}
+}
+
+MR_UInt32 DeflateObjStream::ReadStringLength()
+{
+	MR_UInt8 b;
+	ReadUInt8(b);
+	if (b < 0xff) return b;
+
+	MR_UInt16 w;
+	ReadUInt16(w);
+	if (w == 0xfffe) {
+		// Unicode (length follows).
+		ASSERT(FALSE);
+		throw UnimplementedExn("DeflateObjStream::ReadStringLength for unicode strings");
+	}
+	else if (w == 0xffff) {
+		MR_UInt32 dw;
+		ReadUInt32(dw);
+		return dw;
+	}
+	else {
+		return w;
+	}
+}
+
+}  // namespace Parcel
+}  // namespace HoverRace
@@ -0,0 +1,149 @@
+// DeflateObjStream.h
+// Compressed parcel data stream.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include "ObjStream.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+struct z_stream_s;
+
+namespace HoverRace {
+namespace Parcel {
+
+/**
+ * Parcel data stream for a deflate-compressed record, in the same format as
+ * ClassicObjStream once decompressed.
+ *
+ * Data is compressed and decompressed incrementally through a pair of
+ * fixed-size buffers, so a record is never held in memory in full, and large
+ * reads are decompressed straight into the destination.  The compressed data
+ * is read from either a file or a block of memory; it is always written to a
+ * file.  A writing stream is finished when it is destroyed (call Finish()
+ * first to catch write errors).
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare DeflateObjStream : public ObjStream
+{
+	typedef ObjStream SUPER;
+	public:
+		DeflateObjStream(FILE *stream, const Util::OS::path_t &name, int level);
+		DeflateObjStream(FILE *stream, const Util::OS::path_t &name);
+		DeflateObjStream(const MR_UInt8 *begin, const MR_UInt8 *end,
+			const Util::OS::path_t &name);
+		virtual ~DeflateObjStream();
+
+		static const int LEVEL_FAST = 1;   ///< Fastest compression level.
+		static const int LEVEL_SMALL = 9;  ///< Smallest compression level.
+
+	private:
+		void Init();
+
+	public:
+		void Finish();
+
+	private:
+		void WriteBuf(const void *buf, size_t ct)
+		{
+			if (ct <= BUFFER_SIZE - bufLen) {
+				memcpy(buffer + bufLen, buf, ct);
+				bufLen += ct;
+			}
+			else {
+				WriteBufSlow(buf, ct);
+			}
+		}
+		void WriteBufSlow(const void *buf, size_t ct);
+		void Deflate(const MR_UInt8 *buf, size_t ct, int flush);
+
+	public:
+		virtual void Write(const void *buf, size_t ct) { WriteBuf(buf, ct); }
+
+		virtual void WriteUInt8(MR_UInt8 i) { WriteBuf(&i, 1); }
+		virtual void WriteInt16(MR_Int16 i) { WriteBuf(&i, 2); }
+		virtual void WriteUInt16(MR_UInt16 i) { WriteBuf(&i, 2); }
+		virtual void WriteInt32(MR_Int32 i) { WriteBuf(&i, 4); }
+		virtual void WriteUInt32(MR_UInt32 i) { WriteBuf(&i, 4); }
+		virtual void WriteString(const std::string &s);
+#		if defined(_WIN32) && !defined(WITH_OBJSTREAM)
+			virtual void WriteCString(const CString &s) { WriteString((const char *)s); }
+#		endif
+
+	private:
+		void WriteStringLength(MR_UInt32 len);
+
+		void ReadBuf(void *buf, size_t ct)
+		{
+			if (ct <= bufLen - bufPos) {
+				memcpy(buf, buffer + bufPos, ct);
+				bufPos += ct;
+			}
+			else {
+				ReadBufSlow(buf, ct);
+			}
+		}
+		void ReadBufSlow(void *buf, size_t ct);
+		size_t Inflate(MR_UInt8 *buf, size_t ct);
+
+	public:
+		virtual void Read(void *buf, size_t ct) { ReadBuf(buf, ct); }
+
+		virtual void ReadUInt8(MR_UInt8 &i) { ReadBuf(&i, 1); }
+		virtual void ReadInt16(MR_Int16 &i) { ReadBuf(&i, 2); }
+		virtual void ReadUInt16(MR_UInt16 &i) { ReadBuf(&i, 2); }
+		virtual void ReadInt32(MR_Int32 &i) { ReadBuf(&i, 4); }
+		virtual void ReadUInt32(MR_UInt32 &i) { ReadBuf(&i, 4); }
+		virtual void ReadString(std::string &s);
+#		if defined(_WIN32) && !defined(WITH_OBJSTREAM)
+			virtual void ReadCString(CString &s) { std::string ss; ReadString(ss); s = ss.c_str(); }
+#		endif
+
+	private:
+		MR_UInt32 ReadStringLength();
+
+	private:
+		FILE *stream;
+		const MR_UInt8 *src;     ///< Compressed data, if reading from memory.
+		const MR_UInt8 *srcEnd;
+		int level;
+		z_stream_s *zs;
+		bool finished;           ///< End of the compressed data reached.
+
+		static const size_t BUFFER_SIZE = 64 * 1024;
+		MR_UInt8 *buffer;        ///< Uncompressed data.
+		size_t bufPos;           ///< Read position in the buffer.
+		size_t bufLen;           ///< Number of bytes in the buffer.
+		MR_UInt8 *zbuffer;       ///< Compressed data, to or from the file.
+};
+
+}  // namespace Parcel
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
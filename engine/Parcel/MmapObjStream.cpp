@@ -0,0 +1,88 @@
+// MmapObjStream.cpp
+// Parcel data stream over a block of memory.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include "../Exception.h"
+
+#include "MmapObjStream.h"
+
+namespace HoverRace {
+namespace Parcel {
+
+/**
+ * Constructor.
+ * @param begin Start of the data.
+ * @param end End of the data (one past the last byte).
+ * @param name Name of the stream, for error messages.
+ */
+MmapObjStream::MmapObjStream(const MR_UInt8 *begin, const MR_UInt8 *end,
+                             const Util::OS::path_t &name) :
+	SUPER(name, 1, false),
+	cur(begin), end(end)
+{
+}
+
+/**
+ * Read a block of data in place.
+ * @param ct The number of bytes.
+ * @return A pointer to the data, valid for as long as the backing memory is.
+ */
+const MR_UInt8 *MmapObjStream::ReadView(size_t ct)
+{
+	if (ct > (size_t)(end - cur)) throw ObjStreamExn(GetName(), _("Read failed"));
+	const MR_UInt8 *retv = cur;
+	cur += ct;
+	return retv;
+}
+
+void MmapObjStream::ReadString(std::string &s)
+{
+	MR_UInt32 len = ReadStringLength();
+	s.assign(reinterpret_cast<const char*>(ReadView(len)), len);
+}
+
+MR_UInt32 MmapObjStream::ReadStringLength()
+{
+	// Same encoding as ClassicObjStream.
+	MR_UInt8 b;
+	ReadUInt8(b);
+	if (b < 0xff) return b;
+
+	MR_UInt16 w;
+	ReadUInt16(w);
+	if (w == 0xfffe) {
+		// Unicode (length follows).
+		ASSERT(FALSE);
+		throw UnimplementedExn("MmapObjStream::ReadStringLength for unicode strings");
+	}
+	else if (w == 0xffff) {
+		MR_UInt32 dw;
+		ReadUInt32(dw);
+		return dw;
+	}
+	else {
+		return w;
+	}
+}
+
+}  // namespace Parcel
+}  // namespace HoverRace
@@ -0,0 +1,109 @@
+// MmapObjStream.h
+// Parcel data stream over a block of memory.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include "ObjStream.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Parcel {
+
+/**
+ * Read-only parcel data stream over a block of memory, in the same format
+ * as ClassicObjStream.
+ *
+ * Since the memory outlives the stream, bulk payloads can be handed out
+ * in place with ReadView() instead of being copied.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare MmapObjStream : public ObjStream
+{
+	typedef ObjStream SUPER;
+	public:
+		MmapObjStream(const MR_UInt8 *begin, const MR_UInt8 *end,
+			const Util::OS::path_t &name);
+		virtual ~MmapObjStream() { }
+
+	public:
+		virtual void Write(const void *buf, size_t ct) { WriteBuf(buf, ct); }
+
+		virtual void WriteUInt8(MR_UInt8 i) { WriteBuf(&i, 1); }
+		virtual void WriteInt16(MR_Int16 i) { WriteBuf(&i, 2); }
+		virtual void WriteUInt16(MR_UInt16 i) { WriteBuf(&i, 2); }
+		virtual void WriteInt32(MR_Int32 i) { WriteBuf(&i, 4); }
+		virtual void WriteUInt32(MR_UInt32 i) { WriteBuf(&i, 4); }
+		virtual void WriteString(const std::string &s) { WriteBuf(s.c_str(), s.length()); }
+#		if defined(_WIN32) && !defined(WITH_OBJSTREAM)
+			virtual void WriteCString(const CString &s) { WriteString((const char *)s); }
+#		endif
+
+	private:
+		void WriteBuf(const void*, size_t)
+		{
+			throw ObjStreamExn(GetName(), _("Write failed"));
+		}
+
+		void ReadBuf(void *buf, size_t ct)
+		{
+			if (ct > (size_t)(end - cur)) throw ObjStreamExn(GetName(), _("Read failed"));
+			memcpy(buf, cur, ct);
+			cur += ct;
+		}
+
+	public:
+		virtual void Read(void *buf, size_t ct) { ReadBuf(buf, ct); }
+		virtual const MR_UInt8 *ReadView(size_t ct);
+
+		virtual void ReadUInt8(MR_UInt8 &i) { ReadBuf(&i, 1); }
+		virtual void ReadInt16(MR_Int16 &i) { ReadBuf(&i, 2); }
+		virtual void ReadUInt16(MR_UInt16 &i) { ReadBuf(&i, 2); }
+		virtual void ReadInt32(MR_Int32 &i) { ReadBuf(&i, 4); }
+		virtual void ReadUInt32(MR_UInt32 &i) { ReadBuf(&i, 4); }
+		virtual void ReadString(std::string &s);
+#		if defined(_WIN32) && !defined(WITH_OBJSTREAM)
+			virtual void ReadCString(CString &s) { std::string ss; ReadString(ss); s = ss.c_str(); }
+#		endif
+
+		/// The current read position.
+		const MR_UInt8 *GetPos() const { return cur; }
+
+	private:
+		MR_UInt32 ReadStringLength();
+
+	private:
+		const MR_UInt8 *cur;
+		const MR_UInt8 *end;
+};
+
+}  // namespace Parcel
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
@@ -0,0 +1,294 @@
+// MmapRecordFile.cpp
+// Memory-mapped reader for the standard parcel format.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#include "../Util/Crc32c.h"
+#include "../Util/InspectMapNode.h"
+#include "../Util/Str.h"
+#include "ClassicRecordFile.h"
+#include "MmapObjStream.h"
+
+#include "MmapRecordFile.h"
+
+using namespace HoverRace::Util;
+
+namespace HoverRace {
+namespace Parcel {
+
+MmapRecordFile::MmapRecordFile() :
+	SUPER(), data(NULL), size(0),
+#	ifdef _WIN32
+		fileHandle(INVALID_HANDLE_VALUE), mapHandle(NULL),
+#	endif
+	curRecord(-1), checksum(0), recordFormat(0), hashType(0), contentHash(0),
+	hashPos(0)
+{
+}
+
+MmapRecordFile::~MmapRecordFile()
+{
+	Unmap();
+}
+
+bool MmapRecordFile::CreateForWrite(const Util::OS::path_t&, int, const char*)
+{
+	return false;
+}
+
+bool MmapRecordFile::OpenForWrite(const Util::OS::path_t&)
+{
+	return false;
+}
+
+/**
+ * Open an existing parcel for reading.
+ * Checking the content hash walks the whole mapping once, which also pulls
+ * the file into memory ahead of the records being read.
+ * @param filename The parcel file.
+ * @param validateChecksum @c true to check the content hash, if the parcel
+ *                         has one (see HasContentHash()).
+ * @return @c true if successful, @c false if the file could not be opened.
+ * @throws ObjStreamExn The content hash does not match.
+ */
+bool MmapRecordFile::OpenForRead(const Util::OS::path_t &filename, bool validateChecksum)
+{
+	if (data != NULL) return false;
+
+	this->filename = filename;
+
+	if (!Map(filename)) return false;
+
+	if (!ReadHeader()) {
+		Unmap();
+		return false;
+	}
+
+	if (validateChecksum && HasContentHash()) {
+		Crc32c crc;
+		ClassicRecordFile::HashContent(crc, data, 0, size, hashPos);
+		if (crc.Get() != contentHash) {
+			Unmap();
+			throw ObjStreamExn(filename, _("Checksum mismatch (the file is corrupt)"));
+		}
+	}
+
+	curRecord = 0;
+	return true;
+}
+
+bool MmapRecordFile::ApplyChecksum(const Util::OS::path_t&)
+{
+	return false;
+}
+
+bool MmapRecordFile::HasContentHash() const
+{
+	return data != NULL && hashType == ClassicRecordFile::CONTENT_HASH_CRC32C;
+}
+
+/**
+ * Map the whole file into memory.
+ * @param filename The file.
+ * @return @c true if successful.
+ */
+bool MmapRecordFile::Map(const Util::OS::path_t &filename)
+{
+#	ifdef _WIN32
+		fileHandle = CreateFileW((const wchar_t*)Str::PW(filename), GENERIC_READ,
+			FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+			Unmap();
+			return false;
+		}
+		size = static_cast<size_t>(fileSize.QuadPart);
+
+		mapHandle = CreateFileMappingW(fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (mapHandle == NULL) {
+			Unmap();
+			return false;
+		}
+
+		data = static_cast<const MR_UInt8*>(MapViewOfFile(mapHandle, FILE_MAP_COPY, 0, 0, 0));
+#	else
+		int fd = open((const char*)Str::PU(filename), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			close(fd);
+			return false;
+		}
+		size = static_cast<size_t>(st.st_size);
+
+		// Private and writable so that a stray write to a resource only
+		// copies the page instead of faulting; nothing is written back.
+		void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (addr != MAP_FAILED) {
+			data = static_cast<const MR_UInt8*>(addr);
+		}
+#	endif
+
+	if (data == NULL) {
+		Unmap();
+		return false;
+	}
+	return true;
+}
+
+void MmapRecordFile::Unmap()
+{
+#	ifdef _WIN32
+		if (data != NULL) UnmapViewOfFile(data);
+		if (mapHandle != NULL) CloseHandle(mapHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		mapHandle = NULL;
+		fileHandle = INVALID_HANDLE_VALUE;
+#	else
+		if (data != NULL) munmap(const_cast<MR_UInt8*>(data), size);
+#	endif
+
+	data = NULL;
+	size = 0;
+	recordList.clear();
+	curRecord = -1;
+}
+
+/**
+ * Read the parcel header (same layout as ClassicRecordFileHeader).
+ * @return @c true if the header is valid.
+ */
+bool MmapRecordFile::ReadHeader()
+{
+	MmapObjStream os(data, data + size, filename);
+
+	std::string title;
+	MR_UInt32 dummy;
+	BOOL sumValid;
+	MR_UInt32 recordsUsed;
+	MR_UInt32 recordsMax;
+
+	try {
+		os >> title >>
+			recordFormat >> dummy >>
+			sumValid >> checksum >> recordsUsed >> recordsMax;
+		hashPos = os.GetPos() - data;
+		os >> hashType >> contentHash;
+
+		if (title.find("HoverRace track file") == std::string::npos &&
+			title.find("Fireball object factory resource file") == std::string::npos)
+		{
+			return false;
+		}
+
+		if (recordsUsed > recordsMax || recordsMax > size / sizeof(MR_UInt32)) {
+			return false;
+		}
+
+		recordList.resize(recordsUsed);
+		for (MR_UInt32 i = 0; i < recordsMax; ++i) {
+			MR_UInt32 offset;
+			os >> offset;
+			if (i < recordsUsed) {
+				if (offset > size) return false;
+				recordList[i] = offset;
+			}
+		}
+	}
+	catch (ObjStreamExn&) {
+		return false;
+	}
+
+	return true;
+}
+
+DWORD MmapRecordFile::GetAlignMode()
+{
+	return checksum;
+}
+
+int MmapRecordFile::GetNbRecords() const
+{
+	return static_cast<int>(recordList.size());
+}
+
+void MmapRecordFile::SelectRecord(int i)
+{
+	if ((unsigned)i < recordList.size()) {
+		curRecord = i;
+	}
+	else {
+		ASSERT(FALSE);
+	}
+}
+
+bool MmapRecordFile::BeginANewRecord()
+{
+	ASSERT(FALSE);
+	return false;
+}
+
+void MmapRecordFile::Inspect(Util::InspectMapNode &node) const
+{
+	node.
+		AddField("curRecord", curRecord).
+		AddField("checksum", checksum).
+		AddField("recordFormat", recordFormat).
+		AddField("hashType", hashType).
+		AddField("contentHash", contentHash).
+		AddField("size", (MR_UInt32)size).
+		AddField("recordsUsed", (MR_UInt32)recordList.size());
+}
+
+/**
+ * Open a stream on the current record.
+ * The stream runs to the end of the file, like ClassicObjStream does.
+ * Compressed records are decompressed as they are read, so data from them
+ * cannot be used in place.
+ */
+ObjStreamPtr MmapRecordFile::StreamIn()
+{
+	if (data == NULL || curRecord < 0) {
+		throw ObjStreamExn(filename, _("No record selected"));
+	}
+	return ClassicRecordFile::StreamInRecord(data + recordList[curRecord], data + size,
+		filename, recordFormat);
+}
+
+ObjStreamPtr MmapRecordFile::StreamOut()
+{
+	throw ObjStreamExn(filename, _("Memory-mapped parcels are read-only"));
+}
+
+}  // namespace Parcel
+}  // namespace HoverRace
@@ -0,0 +1,102 @@
+// MmapRecordFile.h
+// Memory-mapped reader for the standard parcel format.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "RecordFile.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Parcel {
+
+/**
+ * Memory-mapped reader for the standard HoverRace 1.x parcel format.
+ *
+ * The whole file is mapped copy-on-write, so streams read straight out of
+ * the page cache, and bulk data (textures, sounds) can be used in place via
+ * ObjStream::ReadView() and shared between processes.
+ *
+ * This is read-only; use ClassicRecordFile to create or modify parcels.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare MmapRecordFile : public RecordFile
+{
+	typedef RecordFile SUPER;
+	public:
+		MmapRecordFile();
+		virtual ~MmapRecordFile();
+
+		virtual bool CreateForWrite(const Util::OS::path_t &filename, int numRecords, const char *title=NULL);
+		virtual bool OpenForWrite(const Util::OS::path_t &filename);
+		virtual bool OpenForRead(const Util::OS::path_t &filename, bool validateChecksum=false);
+
+		virtual bool ApplyChecksum(const Util::OS::path_t &filename);
+		virtual bool HasContentHash() const;
+
+		virtual DWORD GetAlignMode();
+
+		virtual int GetNbRecords() const;
+		virtual void SelectRecord(int i);
+		virtual bool BeginANewRecord();
+
+		virtual void Inspect(Util::InspectMapNode &node) const;
+
+		virtual ObjStreamPtr StreamIn();
+		virtual ObjStreamPtr StreamOut();
+
+	private:
+		bool Map(const Util::OS::path_t &filename);
+		void Unmap();
+		bool ReadHeader();
+
+	private:
+		Util::OS::path_t filename;
+		const MR_UInt8 *data;
+		size_t size;
+#		ifdef _WIN32
+			HANDLE fileHandle;
+			HANDLE mapHandle;
+#		endif
+
+		int curRecord;
+		MR_UInt32 checksum;
+		MR_UInt32 recordFormat;
+		MR_UInt32 hashType;
+		MR_UInt32 contentHash;
+		size_t hashPos;
+		std::vector<MR_UInt32> recordList;
+};
+
+}  // namespace Parcel
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
@@ -22,7 +22,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <vector>
+
+#include <boost/static_assert.hpp>
 
 #include "../Exception.h"
 #include "../Util/MR_Types.h"
@@ -73,6 +77,26 @@ class MR_DllDeclare ObjStream
 	public:
 		virtual void Write(const void *buf, size_t ct) = 0;
 
+		/**
+		 * Write an array of integers in a single block.
+		 * The encoding is the same as writing each element individually.
+		 * @param buf The elements.
+		 * @param ct The number of elements.
+		 */
+		template<class T>
+		void WriteArray(const T *buf, size_t ct)
+		{
+			BOOST_STATIC_ASSERT(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+			if (ct == 0) return;
+#			ifdef WORDS_BIGENDIAN
+				std::vector<T> tmp(buf, buf + ct);
+				SwapArray(&tmp[0], ct);
+				Write(&tmp[0], ct * sizeof(T));
+#			else
+				Write(buf, ct * sizeof(T));
+#			endif
+		}
+
 		virtual void WriteUInt8(MR_UInt8 i) = 0;
 		friend ObjStream &operator<<(ObjStream &os, MR_UInt8 i) { os.WriteUInt8(i); return os; }
 
@@ -98,6 +122,33 @@ class MR_DllDeclare ObjStream
 
 		virtual void Read(void *buf, size_t ct) = 0;
 
+		/**
+		 * Read an array of integers in a single block.
+		 * The encoding is the same as reading each element individually.
+		 * @param buf The destination.
+		 * @param ct The number of elements.
+		 */
+		template<class T>
+		void ReadArray(T *buf, size_t ct)
+		{
+			BOOST_STATIC_ASSERT(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+			if (ct == 0) return;
+			Read(buf, ct * sizeof(T));
+#			ifdef WORDS_BIGENDIAN
+				SwapArray(buf, ct);
+#			endif
+		}
+
+		/**
+		 * Read a block of data in place, if the stream supports it.
+		 * The data stays valid for as long as the RecordFile that the stream
+		 * came from stays open.
+		 * @param ct The number of bytes.
+		 * @return The data, or @c NULL if the stream cannot read in place
+		 *         (nothing is consumed; use Read() instead).
+		 */
+		virtual const MR_UInt8 *ReadView(size_t ct) { return NULL; }
+
 		virtual void ReadUInt8(MR_UInt8 &i) = 0;
 		friend ObjStream &operator>>(ObjStream &os, MR_UInt8 &i) { os.ReadUInt8(i); return os; }
 
@@ -121,6 +172,19 @@ class MR_DllDeclare ObjStream
 			friend ObjStream &operator>>(ObjStream &os, CString &s) { os.ReadCString(s); return os; }
 #		endif
 
+	private:
+#		ifdef WORDS_BIGENDIAN
+			/// Convert between the (little-endian) file encoding and native.
+			template<class T>
+			static void SwapArray(T *buf, size_t ct)
+			{
+				MR_UInt8 *p = reinterpret_cast<MR_UInt8*>(buf);
+				for (size_t i = 0; i < ct; ++i, p += sizeof(T)) {
+					std::reverse(p, p + sizeof(T));
+				}
+			}
+#		endif
+
 	private:
 		Util::OS::path_t name;
 		int version;
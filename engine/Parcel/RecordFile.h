@@ -57,6 +57,12 @@ class MR_DllDeclare RecordFile : public Util::Inspectable {
 		// Checksum stuff
 		virtual bool ApplyChecksum(const Util::OS::path_t &filename) = 0;
 
+		/**
+		 * Check if the parcel carries a hash of its full contents, which is
+		 * checked when opened with @c validateChecksum.
+		 */
+		virtual bool HasContentHash() const { return false; }
+
 		virtual DWORD GetAlignMode() = 0;
 
 		virtual int GetNbRecords() const = 0;
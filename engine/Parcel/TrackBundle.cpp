@@ -23,18 +23,25 @@
 #include "StdAfx.h"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "../Model/Track.h"
 #include "../Model/TrackEntry.h"
 #include "../Parcel/RecordFile.h"
 #include "../Util/Config.h"
 #include "../Util/InspectMapNode.h"
+#include "../Util/Str.h"
 #include "ObjStream.h"
 
 #include "TrackBundle.h"
 
+namespace fs = boost::filesystem;
+
 using HoverRace::Util::Config;
 using HoverRace::Util::OS;
+namespace Str = HoverRace::Util::Str;
 
 namespace HoverRace {
 namespace Parcel {
@@ -48,22 +55,25 @@ TrackBundle::~TrackBundle()
 {
 }
 
-RecordFilePtr TrackBundle::OpenParcel(const std::string &name, bool writing) const
+RecordFilePtr TrackBundle::OpenParcel(const std::string &name, bool writing,
+                                      bool validate) const
 {
 	return SUPER::OpenParcel(
 		boost::ends_with(name, Config::TRACK_EXT) ? name : name + Config::TRACK_EXT,
-		writing);
+		writing, validate);
 }
 
 /**
  * Load a track.
+ * The content hash of the track file is checked, so a corrupt or truncated
+ * download is caught here instead of partway through loading the level.
  * @param name The name of the track.  The ".trk" suffix may be omitted.
  * @return The track or @c NULL if the track does not exist.
- * @throws ObjStreamExn The track failed to load.
+ * @throws ObjStreamExn The track failed to load or is corrupt.
  */
 Model::TrackPtr TrackBundle::OpenTrack(const std::string &name) const
 {
-	RecordFilePtr recFile(OpenParcel(name));
+	RecordFilePtr recFile(OpenParcel(name, false, true));
 	return (recFile.get() == NULL) ?
 		Model::TrackPtr() :
 		boost::make_shared<Model::Track>(recFile);
@@ -77,7 +87,26 @@ Model::TrackPtr TrackBundle::OpenTrack(const std::string &name) const
  */
 Model::TrackEntryPtr TrackBundle::OpenTrackEntry(const std::string &name) const
 {
-	RecordFilePtr recFile(OpenParcel(name));
+	return ReadTrackEntry(OpenParcel(name), name);
+}
+
+/**
+ * Load a track header from a specific file in the bundle.
+ * Unlike looking up the track by name, this never picks up a
+ * higher-priority track of the same name from another bundle directory.
+ * @param ent The directory entry, as returned when iterating the bundle.
+ * @return The track (never @c NULL).
+ * @throws ObjStreamExn The track failed to load.
+ */
+Model::TrackEntryPtr TrackBundle::OpenTrackEntry(const OS::dirEnt_t &ent) const
+{
+	return ReadTrackEntry(OpenParcelFile(ent.path()),
+		(const char*)Str::PU(ent.path().filename().c_str()));
+}
+
+Model::TrackEntryPtr TrackBundle::ReadTrackEntry(RecordFilePtr recFile,
+                                                 const std::string &name)
+{
 	if (recFile.get() == NULL) {
 		return Model::TrackEntryPtr();
 	}
@@ -111,5 +140,66 @@ MR_TrackAvail TrackBundle::CheckAvail(const std::string &name) const
 	}
 }
 
+/**
+ * Check the content hash of every track file in the bundle.
+ * Files are checked in parallel, one thread per core.
+ * @return The status of each track file, in bundle order.
+ */
+TrackBundle::verifyResults_t TrackBundle::VerifyAll() const
+{
+	verifyResults_t results;
+	BOOST_FOREACH(const OS::dirEnt_t &ent, *this) {
+		const OS::path_t &path = ent.path();
+		try {
+			if (!fs::is_regular_file(ent.status())) continue;
+		}
+		catch (OS::fs_error_t&) {
+			continue;
+		}
+		if (boost::ends_with((const char*)Str::PU(path.filename().c_str()), Config::TRACK_EXT)) {
+			results.push_back(std::make_pair(path, VERIFY_UNREADABLE));
+		}
+	}
+
+	size_t numThreads = std::min<size_t>(results.size(),
+		std::max<size_t>(1, boost::thread::hardware_concurrency()));
+	if (numThreads <= 1) {
+		VerifyFiles(&results, 0, 1);
+	}
+	else {
+		boost::thread_group threads;
+		for (size_t i = 0; i < numThreads; ++i) {
+			threads.create_thread(boost::bind(&TrackBundle::VerifyFiles,
+				&results, i, numThreads));
+		}
+		threads.join_all();
+	}
+
+	return results;
+}
+
+/**
+ * Verify every @p step-th file in a list.
+ * Each worker thread writes only to its own entries, so no locking is needed.
+ */
+void TrackBundle::VerifyFiles(verifyResults_t *results, size_t first, size_t step)
+{
+	for (size_t i = first; i < results->size(); i += step) {
+		VerifyStatus &status = (*results)[i].second;
+		try {
+			RecordFilePtr recFile(OpenParcelFile((*results)[i].first, false, true));
+			if (recFile->GetNbRecords() == 0) {
+				status = VERIFY_UNREADABLE;
+			}
+			else {
+				status = recFile->HasContentHash() ? VERIFY_OK : VERIFY_NO_HASH;
+			}
+		}
+		catch (ObjStreamExn&) {
+			status = VERIFY_CORRUPT;
+		}
+	}
+}
+
 }  // namespace Parcel
 }  // namespace HoverRace
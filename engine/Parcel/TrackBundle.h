@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Bundle.h"
 
 #ifdef _WIN32
@@ -63,12 +65,28 @@ class MR_DllDeclare TrackBundle : public Bundle
 		TrackBundle(const Util::OS::path_t &dir, BundlePtr subBundle=BundlePtr());
 		virtual ~TrackBundle();
 
-		virtual RecordFilePtr OpenParcel(const std::string &name, bool writing=false) const;
+		virtual RecordFilePtr OpenParcel(const std::string &name, bool writing=false,
+			bool validate=false) const;
 
 		Model::TrackPtr OpenTrack(const std::string &name) const;
 		Model::TrackEntryPtr OpenTrackEntry(const std::string &name) const;
+		Model::TrackEntryPtr OpenTrackEntry(const Util::OS::dirEnt_t &ent) const;
 
 		MR_TrackAvail CheckAvail(const std::string &name) const;
+
+		enum VerifyStatus {
+			VERIFY_OK,         ///< Content hash matches.
+			VERIFY_NO_HASH,    ///< Readable, but written without a content hash.
+			VERIFY_CORRUPT,    ///< Content hash does not match.
+			VERIFY_UNREADABLE  ///< Not a valid track file.
+		};
+		typedef std::vector<std::pair<Util::OS::path_t, VerifyStatus> > verifyResults_t;
+		verifyResults_t VerifyAll() const;
+
+	private:
+		static Model::TrackEntryPtr ReadTrackEntry(RecordFilePtr recFile,
+			const std::string &name);
+		static void VerifyFiles(verifyResults_t *results, size_t first, size_t step);
 };
 typedef boost::shared_ptr<TrackBundle> TrackBundlePtr;
 
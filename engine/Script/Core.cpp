@@ -72,11 +72,24 @@ namespace Script {
 
 const std::string Core::DEFAULT_CHUNK_NAME("=lua");
 
+/// Registry key for finding the Core from inside the budget hook.
+static const char BUDGET_HOOK_KEY = 0;
+
 Core::Core() :
-	curHelpHandler(NULL)
+	curHelpHandler(NULL), callBudget(0), callBudgetAbort(false),
+	budgetHit(false), callDepth(0)
 {
 	state = luaL_newstate();
 
+	lua_pushlightuserdata(state, (void*)&BUDGET_HOOK_KEY);
+	lua_pushlightuserdata(state, this);
+	lua_rawset(state, LUA_REGISTRYINDEX);
+
+	Util::Config *cfg = Util::Config::GetInstance();
+	if (cfg != NULL) {
+		SetCallBudget(cfg->misc.scriptBudget, cfg->misc.scriptBudgetAbort);
+	}
+
 	//TODO: Set panic handler.
 
 	//TODO: Load class help on demand.
@@ -219,6 +232,77 @@ int Core::ErrorFunc(lua_State *L)
 	return 1;
 }
 
+/**
+ * Instruction-count hook, installed while a callback is running.
+ * It only fires once the budget is used up.
+ */
+void Core::BudgetHook(lua_State *L, lua_Debug*)
+{
+	lua_pushlightuserdata(L, (void*)&BUDGET_HOOK_KEY);
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	Core *self = static_cast<Core*>(lua_touserdata(L, -1));
+	lua_pop(L, 1);
+
+	self->budgetHit = true;
+	if (self->callBudgetAbort) {
+		luaL_error(L, "%s (%d)", _("Script exceeded its instruction budget"), self->callBudget);
+	}
+	else {
+		// We only need to know that it happened; let it run in peace.
+		lua_sethook(L, NULL, 0, 0);
+	}
+}
+
+/**
+ * Set the limit for each script callback.
+ * Every top-level call (event handlers, console commands, scripts) gets a
+ * fresh budget; calls nested inside of it share the outer call's budget.
+ * @param instructions The maximum number of Lua VM instructions
+ *                     (0 for unlimited).
+ * @param abort @c true to raise an error in callbacks that go over budget,
+ *              @c false to only print a warning after they finish.
+ */
+void Core::SetCallBudget(int instructions, bool abort)
+{
+	callBudget = (instructions < 0) ? 0 : instructions;
+	callBudgetAbort = abort;
+}
+
+/**
+ * Clear the timing stats for all callbacks.
+ */
+void Core::ResetCallStats()
+{
+	callStats.clear();
+}
+
+void Core::RecordCall(const std::string &label, OS::timestamp_t duration)
+{
+	// Drop the chunk name decoration.
+	std::string name = label;
+	if (!name.empty() && (name[0] == '=' || name[0] == '@')) {
+		name.erase(0, 1);
+	}
+
+	callStats_t::iterator iter = callStats.find(name);
+	if (iter == callStats.end()) {
+		CallStats stats = { 0, 0, 0, 0 };
+		iter = callStats.insert(callStats_t::value_type(name, stats)).first;
+	}
+	CallStats &stats = iter->second;
+	stats.calls++;
+	stats.totalTime += duration;
+	if (duration > stats.maxTime) stats.maxTime = duration;
+
+	if (budgetHit) {
+		stats.overBudget++;
+		if (!callBudgetAbort) {
+			Print(boost::str(boost::format("%s: %s (%d ms)") %
+				name % _("Script exceeded its instruction budget") % duration));
+		}
+	}
+}
+
 /**
  * Redirect output to a stream.
  * @param out The output stream (wrapped in a shared pointer).
@@ -287,11 +371,14 @@ void Core::Compile(const std::string &chunk, const std::string &name)
 
 /**
  * Pop a function off the stack and execute it, printing any return values.
+ * The call is timed and held to the callback budget (see SetCallBudget()).
  * @param numParams The number of params being passed to the function.
  * @param helpHandler Optional callback for when a script requests API help.
+ * @param label The name the call is recorded under in the call stats.
  * @throw ScriptExn The code signaled an error while executing.
  */
-void Core::CallAndPrint(int numParams, Help::HelpHandler *helpHandler)
+void Core::CallAndPrint(int numParams, Help::HelpHandler *helpHandler,
+                        const std::string &label)
 {
 	int initStack = lua_gettop(state);
 	if (initStack == 0) {
@@ -299,10 +386,29 @@ void Core::CallAndPrint(int numParams, Help::HelpHandler *helpHandler)
 	}
 	initStack -= (1 + numParams);
 
+	// Only the outermost call is timed and budgeted.
+	bool outermost = (callDepth++ == 0);
+	OS::timestamp_t startTime = 0;
+	if (outermost) {
+		budgetHit = false;
+		startTime = OS::Time();
+		if (callBudget > 0) {
+			lua_sethook(state, Core::BudgetHook, LUA_MASKCOUNT, callBudget);
+		}
+	}
+
 	// Execute the chunk.
+	Help::HelpHandler *oldHelpHandler = curHelpHandler;
 	curHelpHandler = helpHandler;
 	int status = lua_pcall(state, numParams, LUA_MULTRET, 0);
-	curHelpHandler = NULL;
+	curHelpHandler = oldHelpHandler;
+
+	--callDepth;
+	if (outermost) {
+		lua_sethook(state, NULL, 0, 0);
+		RecordCall(label, OS::TimeDiff(OS::Time(), startTime));
+	}
+
 	if (status != 0) {
 		throw ScriptExn(PopError());
 	}
@@ -23,9 +23,11 @@
 #pragma once
 
 #include <list>
+#include <map>
 
 #include <lua.hpp>
 
+#include "../Util/OS.h"
 #include "ScriptExn.h"
 
 #ifdef _WIN32
@@ -76,6 +78,28 @@ class MR_DllDeclare Core
 
 	private:
 		static int ErrorFunc(lua_State *L);
+		static void BudgetHook(lua_State *L, lua_Debug *ar);
+
+	public:
+		/// Timing for one kind of script callback.
+		struct CallStats
+		{
+			int calls;
+			int overBudget;  ///< Number of calls that exceeded the instruction budget.
+			Util::OS::timestamp_t totalTime;  ///< Milliseconds.
+			Util::OS::timestamp_t maxTime;  ///< Milliseconds.
+		};
+		typedef std::map<std::string, CallStats> callStats_t;
+
+		void SetCallBudget(int instructions, bool abort);
+		int GetCallBudget() const { return callBudget; }
+		bool IsCallBudgetAbort() const { return callBudgetAbort; }
+
+		const callStats_t &GetCallStats() const { return callStats; }
+		void ResetCallStats();
+
+	private:
+		void RecordCall(const std::string &label, Util::OS::timestamp_t duration);
 
 	private:
 		typedef std::list<boost::shared_ptr<std::ostream> > outs_t;
@@ -91,7 +115,8 @@ class MR_DllDeclare Core
 
 		static const std::string DEFAULT_CHUNK_NAME;
 		void Compile(const std::string &chunk, const std::string &name=DEFAULT_CHUNK_NAME);
-		void CallAndPrint(int numParams=0, Help::HelpHandler *helpHandler=NULL);
+		void CallAndPrint(int numParams=0, Help::HelpHandler *helpHandler=NULL,
+			const std::string &label=DEFAULT_CHUNK_NAME);
 
 		void Execute(const std::string &chunk, Help::HelpHandler *helpHandler=NULL);
 
@@ -113,6 +138,11 @@ class MR_DllDeclare Core
 		Help::HelpHandler *curHelpHandler;
 		typedef std::map<const std::string,Help::ClassPtr> helpClasses_t;
 		helpClasses_t helpClasses;
+		int callBudget;
+		bool callBudgetAbort;
+		bool budgetHit;
+		int callDepth;
+		callStats_t callStats;
 };
 
 }  // namespace Script
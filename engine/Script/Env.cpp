@@ -115,7 +115,7 @@ void Env::Execute(const std::string &chunk, const std::string &name)
 	lua_setfenv(state, -2);
 
 	// May throw ScriptExn, but the function on the stack will be consumed anyway.
-	scripting->CallAndPrint(0, helpHandler);
+	scripting->CallAndPrint(0, helpHandler, name);
 }
 
 }  // namespace Script
@@ -36,9 +36,10 @@ namespace Script {
 /**
  * Constructor.
  * @param scripting The scripting core (may not be @c NULL).
+ * @param name The event name, used to label the handlers in the call stats.
  */
-Handlers::Handlers(Core *scripting) :
-	scripting(scripting), seq(1)
+Handlers::Handlers(Core *scripting, const std::string &name) :
+	scripting(scripting), name(name), seq(1)
 {
 	lua_State *L = scripting->GetState();
 	lua_newtable(L);
@@ -83,7 +84,7 @@ void Handlers::Call(int numParams) const
 				lua_pushvalue(L, paramsStart + j);
 			}
 			// (params...) (fns...) (params...)
-			scripting->CallAndPrint(numParams);
+			scripting->CallAndPrint(numParams, NULL, name);
 		}
 		catch (Script::ScriptExn &ex) {
 			scripting->Print(ex.what());
@@ -50,7 +50,7 @@ class MR_DllDeclare Handlers
 	private:
 		Handlers() { }
 	public:
-		Handlers(Core *scripting);
+		Handlers(Core *scripting, const std::string &name);
 		virtual ~Handlers();
 
 	protected:
@@ -64,6 +64,7 @@ class MR_DllDeclare Handlers
 
 	private:
 		Core *scripting;
+		std::string name;
 		int seq;
 		int ref;
 };
@@ -0,0 +1,151 @@
+// ClockSync.cpp
+// Continuous clock offset estimation against a remote peer.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include "ClockSync.h"
+
+using namespace HoverRace::Util;
+
+namespace {
+	// Samples with an RTT this many deviations above normal are rejected.
+	const double OUTLIER_DEVIATIONS = 4.0;
+
+	// After this many rejections in a row, assume the path itself changed.
+	const unsigned int MAX_CONSECUTIVE_REJECTS = 4;
+
+	// Drift beyond this is not plausible for a PC clock (1%).
+	const double MAX_DRIFT = 0.01;
+}
+
+ClockSync::ClockSync()
+{
+	Clear();
+}
+
+/**
+ * Forget all samples.
+ */
+void ClockSync::Clear()
+{
+	numSamples = 0;
+	nextSample = 0;
+	srtt = 0;
+	rttVar = 0;
+	drift = 0;
+	numRejected = 0;
+	numConsecutiveRejected = 0;
+}
+
+/**
+ * Add the result of one exchange with the peer.
+ * @param rtt The measured round-trip time (ms).
+ * @param offset The peer's clock minus ours, assuming a symmetric path (ms).
+ * @param now Local time at which the sample was taken (ms).
+ * @return @c true if the sample was accepted, @c false if it was rejected
+ *         as an outlier.
+ */
+bool ClockSync::AddSample(int rtt, int offset, unsigned int now)
+{
+	if (rtt < 0) return false;
+
+	if (numSamples == 0) {
+		srtt = rtt;
+		rttVar = rtt / 2.0;
+	}
+	else {
+		// Jacobson/Karels, same as TCP's retransmit timer.
+		double err = rtt - srtt;
+		bool outlier = err > OUTLIER_DEVIATIONS * std::max(rttVar, 1.0);
+
+		srtt += err / 8.0;
+		rttVar += (fabs(err) - rttVar) / 4.0;
+
+		if (outlier && ++numConsecutiveRejected < MAX_CONSECUTIVE_REJECTS) {
+			++numRejected;
+			return false;
+		}
+	}
+	numConsecutiveRejected = 0;
+
+	Sample &sample = samples[nextSample];
+	sample.rtt = rtt;
+	sample.offset = offset;
+	sample.time = now;
+
+	nextSample = (nextSample + 1) % WINDOW;
+	if (numSamples < WINDOW) ++numSamples;
+
+	UpdateDrift();
+
+	return true;
+}
+
+/**
+ * Estimate the current offset to the peer's clock.
+ * @param now The current local time (ms).
+ * @return The peer's clock minus ours (ms), or 0 if there are no samples.
+ */
+int ClockSync::GetOffset(unsigned int now) const
+{
+	if (numSamples == 0) return 0;
+
+	// The fastest exchange had the least queueing, so its offset is the
+	// most trustworthy.
+	const Sample *best = &samples[0];
+	for (int i = 1; i < numSamples; ++i) {
+		if (samples[i].rtt < best->rtt) best = &samples[i];
+	}
+
+	int age = static_cast<int>(now - best->time);
+	return best->offset + static_cast<int>(drift * age);
+}
+
+/**
+ * Fit a line through the offsets in the window.
+ */
+void ClockSync::UpdateDrift()
+{
+	if (numSamples < 3) {
+		drift = 0;
+		return;
+	}
+
+	// Times relative to the oldest sample to keep the sums small.
+	unsigned int base = samples[(nextSample - numSamples + WINDOW) % WINDOW].time;
+
+	double sumT = 0, sumO = 0, sumTT = 0, sumTO = 0;
+	for (int i = 0; i < numSamples; ++i) {
+		double t = static_cast<int>(samples[i].time - base);
+		double o = samples[i].offset;
+		sumT += t;
+		sumO += o;
+		sumTT += t * t;
+		sumTO += t * o;
+	}
+
+	double denom = numSamples * sumTT - sumT * sumT;
+	if (denom <= 0) return;
+
+	drift = (numSamples * sumTO - sumT * sumO) / denom;
+	if (drift > MAX_DRIFT) drift = MAX_DRIFT;
+	else if (drift < -MAX_DRIFT) drift = -MAX_DRIFT;
+}
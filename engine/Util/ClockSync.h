@@ -0,0 +1,93 @@
+// ClockSync.h
+// Continuous clock offset estimation against a remote peer.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace Util {
+
+/**
+ * Estimates the offset between our clock and a peer's, NTP-style.
+ *
+ * Each sample is one request/response exchange: the round-trip time
+ * measured locally, and the offset computed by assuming the reply took half
+ * of it.  Samples far slower than usual are rejected (their offset is
+ * mostly queueing noise); of the samples kept, the one with the lowest RTT
+ * in the recent window gives the offset, as in NTP's clock filter.  The
+ * trend of the offsets over time gives the drift.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare ClockSync
+{
+	public:
+		ClockSync();
+
+	public:
+		void Clear();
+		bool AddSample(int rtt, int offset, unsigned int now);
+
+		bool HasEstimate() const { return numSamples > 0; }
+		int GetOffset(unsigned int now) const;
+		int GetRtt() const { return static_cast<int>(srtt); }
+		int GetRttVariance() const { return static_cast<int>(rttVar); }
+		double GetDrift() const { return drift; }
+
+		unsigned int GetNumRejected() const { return numRejected; }
+
+	private:
+		void UpdateDrift();
+
+	private:
+		static const int WINDOW = 8;
+
+		struct Sample
+		{
+			int rtt;
+			int offset;
+			unsigned int time;
+		};
+
+		Sample samples[WINDOW];
+		int numSamples;
+		int nextSample;
+
+		double srtt;    ///< Smoothed RTT.
+		double rttVar;  ///< Smoothed mean deviation of the RTT.
+		double drift;   ///< Offset change, in ms per ms.
+
+		unsigned int numRejected;
+		unsigned int numConsecutiveRejected;
+};
+
+}  // namespace Util
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
@@ -488,6 +488,24 @@ Parcel::TrackBundlePtr Config::GetTrackBundle() const
 	return trackBundle;
 }
 
+/**
+ * Retrieve the path to the cached index of track headers.
+ * @return The file path (may be relative).
+ */
+OS::path_t Config::GetTrackIndexPath() const
+{
+	return dataPath / Str::UP("TrackIndex.dat");
+}
+
+/**
+ * Retrieve the path to the journal of ladder reports waiting to be sent.
+ * @return The file path (may be relative).
+ */
+OS::path_t Config::GetLadderSpoolPath() const
+{
+	return dataPath / Str::UP("LadderReports.log");
+}
+
 /**
  * Retrieve the path to the help file for a class in the scripting API.
  * @param className The name of the class.
@@ -595,6 +613,9 @@ void Config::ResetToDefaults()
 	misc.displayFirstScreen = true;
 	misc.introMovie = true;
 	misc.aloneWarning = true;
+	misc.scriptBudget = 10000000;
+	misc.scriptBudgetAbort = false;
+	misc.inputPollRate = 250;
 
 	// Get current user name as default nickname.
 #ifdef _WIN32
@@ -887,6 +908,9 @@ void Config::cfg_misc_t::Load(yaml::MapNode *root)
 	READ_BOOL(root, displayFirstScreen);
 	READ_BOOL(root, introMovie);
 	READ_BOOL(root, aloneWarning);
+	READ_INT(root, scriptBudget, 0, INT_MAX);
+	READ_BOOL(root, scriptBudgetAbort);
+	READ_INT(root, inputPollRate, 0, 1000);
 }
 
 void Config::cfg_misc_t::Save(yaml::Emitter *emitter)
@@ -897,6 +921,9 @@ void Config::cfg_misc_t::Save(yaml::Emitter *emitter)
 	EMIT_VAR(emitter, displayFirstScreen);
 	EMIT_VAR(emitter, introMovie);
 	EMIT_VAR(emitter, aloneWarning);
+	EMIT_VAR(emitter, scriptBudget);
+	EMIT_VAR(emitter, scriptBudgetAbort);
+	EMIT_VAR(emitter, inputPollRate);
 
 	emitter->EndMap();
 }
@@ -137,6 +137,8 @@ class MR_DllDeclare Config
 		const OS::path_t &GetUserTrackPath() const;
 		OS::path_t GetUserTrackPath(const std::string &name) const;
 		Parcel::TrackBundlePtr GetTrackBundle() const;
+		OS::path_t GetTrackIndexPath() const;
+		OS::path_t GetLadderSpoolPath() const;
 
 		OS::path_t GetScriptHelpPath(const std::string &className) const;
 
@@ -190,6 +192,9 @@ class MR_DllDeclare Config
 			bool displayFirstScreen;
 			bool introMovie;
 			bool aloneWarning; /// warn a player if he launches a game alone
+			int scriptBudget; /// max Lua instructions per script callback (0 = unlimited)
+			bool scriptBudgetAbort; /// abort callbacks that go over budget instead of just warning
+			int inputPollRate; /// input captures per second on the input thread (0 = capture once per frame)
 
 			void Load(yaml::MapNode*);
 			void Save(yaml::Emitter*);
@@ -268,6 +273,7 @@ class MR_DllDeclare Config
 			bool showFramerate;
 			bool enableConsole;
 			OS::path_t initScript;
+			std::string soundSink;  ///< Mixer output, or empty for the classic backend.
 		} runtime;
 };
 
@@ -0,0 +1,171 @@
+// Crc32c.cpp
+// CRC-32C (Castagnoli) checksum.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <string.h>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#	include <intrin.h>
+#	include <nmmintrin.h>
+#	define HR_CRC32C_SSE42
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#	include <cpuid.h>
+#	include <nmmintrin.h>
+#	define HR_CRC32C_SSE42
+#endif
+
+#include "Crc32c.h"
+
+namespace HoverRace {
+namespace Util {
+
+namespace {
+	const MR_UInt32 POLY = 0x82f63b78;  // Reflected Castagnoli polynomial.
+
+	/// Lookup tables for slicing-by-8, built once at startup.
+	class SoftTable
+	{
+		public:
+			SoftTable()
+			{
+				for (MR_UInt32 i = 0; i < 256; ++i) {
+					MR_UInt32 crc = i;
+					for (int j = 0; j < 8; ++j) {
+						crc = (crc >> 1) ^ ((crc & 1) ? POLY : 0);
+					}
+					t[0][i] = crc;
+				}
+				for (MR_UInt32 i = 0; i < 256; ++i) {
+					for (int k = 1; k < 8; ++k) {
+						t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+					}
+				}
+			}
+
+		public:
+			MR_UInt32 t[8][256];
+	} softTable;
+
+	MR_UInt32 UpdateSoft(MR_UInt32 crc, const MR_UInt8 *p, size_t len)
+	{
+		const MR_UInt32 (*t)[256] = softTable.t;
+
+		while (len >= 8) {
+			MR_UInt32 lo, hi;
+			memcpy(&lo, p, 4);
+			memcpy(&hi, p + 4, 4);
+#			ifdef WORDS_BIGENDIAN
+				lo = (lo >> 24) | ((lo >> 8) & 0xff00) | ((lo << 8) & 0xff0000) | (lo << 24);
+				hi = (hi >> 24) | ((hi >> 8) & 0xff00) | ((hi << 8) & 0xff0000) | (hi << 24);
+#			endif
+			lo ^= crc;
+			crc =
+				t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+				t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+				t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+				t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+			p += 8;
+			len -= 8;
+		}
+		while (len-- > 0) {
+			crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+		}
+		return crc;
+	}
+
+#	ifdef HR_CRC32C_SSE42
+		bool HasSse42()
+		{
+#			ifdef _MSC_VER
+				int regs[4];
+				__cpuid(regs, 1);
+				return (regs[2] & (1 << 20)) != 0;
+#			else
+				unsigned int eax, ebx, ecx, edx;
+				return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0;
+#			endif
+		}
+		const bool hasSse42 = HasSse42();
+
+#		ifdef __GNUC__
+			__attribute__((target("sse4.2")))
+#		endif
+		MR_UInt32 UpdateSse42(MR_UInt32 crc, const MR_UInt8 *p, size_t len)
+		{
+#			if defined(_M_X64) || defined(__x86_64__)
+				MR_UInt64 crc64 = crc;
+				while (len >= 8) {
+					MR_UInt64 v;
+					memcpy(&v, p, 8);
+					crc64 = _mm_crc32_u64(crc64, v);
+					p += 8;
+					len -= 8;
+				}
+				crc = static_cast<MR_UInt32>(crc64);
+#			endif
+			while (len >= 4) {
+				MR_UInt32 v;
+				memcpy(&v, p, 4);
+				crc = _mm_crc32_u32(crc, v);
+				p += 4;
+				len -= 4;
+			}
+			while (len-- > 0) {
+				crc = _mm_crc32_u8(crc, *p++);
+			}
+			return crc;
+		}
+#	endif
+}
+
+/**
+ * Add a block of data to the checksum.
+ * @param buf The data.
+ * @param len The length of the data, in bytes.
+ */
+void Crc32c::Update(const void *buf, size_t len)
+{
+	const MR_UInt8 *p = static_cast<const MR_UInt8*>(buf);
+#	ifdef HR_CRC32C_SSE42
+		if (hasSse42) {
+			crc = UpdateSse42(crc, p, len);
+			return;
+		}
+#	endif
+	crc = UpdateSoft(crc, p, len);
+}
+
+/**
+ * Calculate the checksum of a single block of data.
+ * @param buf The data.
+ * @param len The length of the data, in bytes.
+ * @return The checksum.
+ */
+MR_UInt32 Crc32c::Compute(const void *buf, size_t len)
+{
+	Crc32c crc;
+	crc.Update(buf, len);
+	return crc.Get();
+}
+
+}  // namespace Util
+}  // namespace HoverRace
@@ -1,8 +1,7 @@
-
-// BlockingTransfer.h
-// Header for the simple blocking transfer.
+// Crc32c.h
+// CRC-32C (Castagnoli) checksum.
 //
-// Copyright (c) 2009 Michael Imamura.
+// Copyright (c) 2026 HoverRace contributors.
 //
 // Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
 // you may not use this file except in compliance with the License.
@@ -22,7 +21,9 @@
 
 #pragma once
 
-#include "BaseTransfer.h"
+#include <stddef.h>
+
+#include "MR_Types.h"
 
 #ifdef _WIN32
 #	ifdef MR_ENGINE
@@ -35,40 +36,32 @@
 #endif
 
 namespace HoverRace {
-namespace Net {
+namespace Util {
 
 /**
- * This is used for the simple forms of transfer, only used in Agent::Get.
- * @author Michael Imamura
+ * Incremental CRC-32C (Castagnoli polynomial) checksum.
+ *
+ * Uses the SSE 4.2 CRC32 instruction when the CPU has it, and a
+ * slicing-by-8 table otherwise; both give the same result.
  */
-class MR_DllDeclare BlockingTransfer : public BaseTransfer
+class MR_DllDeclare Crc32c
 {
-	typedef BaseTransfer SUPER;
 	public:
-		BlockingTransfer(const Agent &agent, std::string &buf,
-			CancelFlagPtr cancelFlag);
-		BlockingTransfer(const Agent &agent, std::ostream &buf,
-			CancelFlagPtr cancelFlag);
-		virtual ~BlockingTransfer() { }
-	private:
-		void Init();
+		Crc32c() : crc(0xffffffff) { }
 
 	public:
-		virtual bool IsComplete() const { return true; }
+		void Update(const void *buf, size_t len);
 
-	public:
-		void Go();
+		/// The checksum of everything passed to Update() so far.
+		MR_UInt32 Get() const { return ~crc; }
 
-	private:
-		static size_t StringWriteFunc(void *ptr, size_t size, size_t nmemb, void *stream);
-		static size_t StreamWriteFunc(void *ptr, size_t size, size_t nmemb, void *stream);
-		static size_t ProgressFunc(void *cancelFlag, double, double, double, double);
+		static MR_UInt32 Compute(const void *buf, size_t len);
 
 	private:
-		CancelFlagPtr cancelFlag;
+		MR_UInt32 crc;
 };
 
-}  // namespace Net
+}  // namespace Util
 }  // namespace HoverRace
 
 #undef MR_DllDeclare
@@ -23,6 +23,9 @@
 
 #include <map>
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "../ObjFac1/ObjFac1.h"
 #include "../Parcel/ObjStream.h"
 
@@ -43,6 +46,7 @@ class FactoryDll
 		int mRefCount;
 
 		virtual ObjectFromFactory* GetObject(int classId) const = 0;
+		virtual void PrefetchRaceResources() const { }
 
 		// Initialisation
 		FactoryDll();
@@ -60,6 +64,7 @@ class PackageFactoryDll : public FactoryDll
 		virtual ~PackageFactoryDll();
 
 		virtual ObjectFromFactory* GetObject(int classId) const;
+		virtual void PrefetchRaceResources() const;
 
 	private:
 		ObjFac1::ObjFac1 *package;
@@ -89,6 +94,8 @@ static FactoryDll *GetDll(MR_UInt16 pDllId, BOOL pTrowOnError);
 //TODO: Use a std::map instead.
 typedef std::map<int,FactoryDll*> gsDllList_t;
 static gsDllList_t gsDllList;
+// Objects may be created while a track is loading in the background.
+static boost::mutex gsDllMutex;
 
 // Module functions
 void DllObjectFactory::Init()
@@ -98,6 +105,8 @@ void DllObjectFactory::Init()
 
 void DllObjectFactory::Clean(BOOL pOnlyDynamic)
 {
+	boost::lock_guard<boost::mutex> lock(gsDllMutex);
+
 	for (gsDllList_t::iterator iter = gsDllList.begin(); iter != gsDllList.end(); ) {
 		int dllId = iter->first;
 		FactoryDll* dllPtr = iter->second;
@@ -130,12 +139,14 @@ void DllObjectFactory::RegisterLocalDll(int pDllId, getObject_t pFunc)
 
 	lDllPtr = new LocalFactoryDll(pFunc);
 
+	boost::lock_guard<boost::mutex> lock(gsDllMutex);
 	bool inserted = gsDllList.insert(gsDllList_t::value_type(pDllId, lDllPtr)).second;
 	ASSERT(inserted);
 }
 
 void DllObjectFactory::IncrementReferenceCount(int pDllId)
 {
+	boost::lock_guard<boost::mutex> lock(gsDllMutex);
 	gsDllList_t::iterator iter = gsDllList.find(pDllId);
 	if (iter != gsDllList.end()) {
 		iter->second->mRefCount++;
@@ -147,6 +158,7 @@ void DllObjectFactory::IncrementReferenceCount(int pDllId)
 
 void DllObjectFactory::DecrementReferenceCount(int pDllId)
 {
+	boost::lock_guard<boost::mutex> lock(gsDllMutex);
 	gsDllList_t::iterator iter = gsDllList.find(pDllId);
 	if (iter != gsDllList.end()) {
 		iter->second->mRefCount--;
@@ -167,6 +179,16 @@ ObjectFromFactory *DllObjectFactory::CreateObject(const ObjectFromFactoryId &pId
 	return lReturnValue;
 }
 
+/**
+ * Load the resources of the objects that a factory creates during a race
+ * (e.g. while the track is loading in the background).
+ * @param pDllId The factory.
+ */
+void DllObjectFactory::PrefetchRaceResources(MR_UInt16 pDllId)
+{
+	GetDll(pDllId, TRUE)->PrefetchRaceResources();
+}
+
 /**
  * Get a handle to the factory DLL.  The option of choosing which DLL has been deprecated.
  */
@@ -176,6 +198,8 @@ FactoryDll *GetDll(MR_UInt16 pDllId, BOOL pThrowOnError)
 
 	ASSERT(pDllId != 0);						  // Number 0 is reserved for NULL entry
 
+	boost::lock_guard<boost::mutex> lock(gsDllMutex);
+
 	// Create the factory DLL if it doesn't exist already.
 	gsDllList_t::iterator iter = gsDllList.find(pDllId);
 	if (iter == gsDllList.end()) {
@@ -298,6 +322,11 @@ ObjectFromFactory* PackageFactoryDll::GetObject(int classId) const
 	return package->GetObject(classId);
 }
 
+void PackageFactoryDll::PrefetchRaceResources() const
+{
+	package->PrefetchRaceResources();
+}
+
 LocalFactoryDll::LocalFactoryDll(DllObjectFactory::getObject_t getObject) :
 	SUPER(), getObject(getObject)
 {
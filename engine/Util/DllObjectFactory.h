@@ -107,6 +107,9 @@ namespace DllObjectFactory
 	// Fast Object Creation function
 	MR_DllDeclare ObjectFromFactory *CreateObject(const ObjectFromFactoryId & pId);
 
+	// Load the resources needed once a race has started
+	MR_DllDeclare void PrefetchRaceResources(MR_UInt16 pDllId);
+
 	// Local Dll
 	MR_DllDeclare void RegisterLocalDll(int pDLLId, getObject_t pFunc);
 
@@ -625,5 +625,23 @@ FILE *OS::FOpen(const path_t &path, const char *mode)
 #	endif
 }
 
+/**
+ * Rename a file, replacing the destination if it already exists.
+ * The replacement is atomic: anything opening the destination sees either
+ * the old file or the new one, never a partially-written file.
+ * @param from The file to rename.
+ * @param to The new name.
+ * @return @c true if successful, @c false otherwise.
+ */
+bool OS::RenameReplace(const path_t &from, const path_t &to)
+{
+#	ifdef _WIN32
+		return MoveFileExW((const wchar_t*)Str::PW(from), (const wchar_t*)Str::PW(to),
+			MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+#	else
+		return rename((const char*)Str::PU(from), (const char*)Str::PU(to)) == 0;
+#	endif
+}
+
 }  // namespace Util
 }  // namespace HoverRace
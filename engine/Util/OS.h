@@ -116,6 +116,7 @@ class MR_DllDeclare OS {
 		static bool OpenPath(const path_t &path);
 
 		static FILE *FOpen(const path_t &path, const char *mode);
+		static bool RenameReplace(const path_t &from, const path_t &to);
 
 		static void Free(void *buf);
 };
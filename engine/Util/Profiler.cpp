@@ -58,6 +58,21 @@ void OutputProfilerStats()
 	gProfilerMaster.PrintStats();
 }
 
+void GetProfilerSamples(std::vector<ProfilerSample> &pSamples)
+{
+	pSamples.clear();
+
+	for(ProfilerSampler *lCurrent = gProfilerSamplerList; lCurrent != NULL; lCurrent = lCurrent->mNext) {
+		ProfilerSample lSample;
+		lSample.name = lCurrent->mName;
+		lSample.calls = lCurrent->mNbCall;
+		lSample.totalTime = lCurrent->mTotalTime;
+		lSample.minTime = (lCurrent->mNbCall > 0) ? lCurrent->mMinPeriod : 0;
+		lSample.maxTime = lCurrent->mMaxPeriod;
+		pSamples.push_back(lSample);
+	}
+}
+
 // ProfilerSampler
 ProfilerSampler::ProfilerSampler(const char *pName)
 {
@@ -190,4 +205,17 @@ void ProfilerMaster::PrintStats()
 }  // namespace Util
 }  // namespace HoverRace
 
+#else
+
+namespace HoverRace {
+namespace Util {
+
+void GetProfilerSamples(std::vector<ProfilerSample> &pSamples)
+{
+	pSamples.clear();
+}
+
+}  // namespace Util
+}  // namespace HoverRace
+
 #endif
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <vector>
+
 #ifdef _WIN32
 #	ifdef MR_ENGINE
 #		define MR_DllDeclare   __declspec( dllexport )
@@ -32,6 +34,25 @@
 #	define MR_DllDeclare
 #endif
 
+namespace HoverRace {
+namespace Util {
+
+/// Snapshot of a profiler sampler, for reporting.
+struct ProfilerSample
+{
+	const char *name;
+	int calls;
+	int totalTime;
+	int minTime;
+	int maxTime;
+};
+
+// Always available; the list is empty in non-debug builds.
+void MR_DllDeclare GetProfilerSamples(std::vector<ProfilerSample> &pSamples);
+
+}  // namespace Util
+}  // namespace HoverRace
+
 #ifdef _DEBUG
 
 namespace HoverRace {
@@ -42,6 +63,7 @@ class MR_DllDeclare ProfilerSampler
 {
 	// Theses objects must always be declared staticly
 	friend class ProfilerMaster;
+	friend void GetProfilerSamples(std::vector<ProfilerSample> &pSamples);
 
 	private:
 		ProfilerSampler *mNext;
@@ -0,0 +1,594 @@
+// SoundMixer.cpp
+// Software mixer for sound effects.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <algorithm>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define HR_MIXER_SSE2
+#	include <emmintrin.h>
+#endif
+
+#include "SoundMixer.h"
+
+namespace pt = boost::posix_time;
+
+namespace HoverRace {
+namespace VideoServices {
+
+namespace {
+	/// Number of frames mixed at a time by the audio thread.
+	const size_t BLOCK_FRAMES = 512;
+
+	/// Limit on one-shot sounds; more than this and new ones are dropped.
+	const size_t MAX_ONE_SHOTS = 128;
+
+	/// Voices quieter than this (about -60 dB) are always virtual.
+	const float SILENT_GAIN = 0.001f;
+
+	const double FIXED_ONE = 4294967296.0;
+
+	/// Convert millibels (as used by DirectSound) to linear.
+	float MillibelsToLinear(int value)
+	{
+		return (value <= -10000) ? 0.0f :
+			powf(10.0f, static_cast<float>(value) / 2000.0f);
+	}
+
+	struct LouderThan
+	{
+		template<class T>
+		bool operator()(const T *a, const T *b) const
+		{
+			return std::max(a->gainL, a->gainR) > std::max(b->gainL, b->gainR);
+		}
+	};
+}
+
+/**
+ * Constructor.
+ * The mixer is idle until Start() is called.
+ * @param sink The output device.
+ * @param maxVoices The maximum number of voices to mix at once.
+ */
+SoundMixer::SoundMixer(SoundSinkPtr sink, int maxVoices) :
+	sink(sink), rate(sink->GetRate()), maxVoices(maxVoices), nextId(0),
+	thread(NULL)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+SoundMixer::~SoundMixer()
+{
+	Stop();
+}
+
+/**
+ * Convert sound effect data to the mixer's format.
+ * @param pData Data buffer, in the same format as SoundServer::CreateShortSound().
+ * @return The sample (never @c NULL; unsupported formats result in silence).
+ */
+SoundMixer::SamplePtr SoundMixer::LoadSample(const char *pData)
+{
+	const MR_UInt8 *p = reinterpret_cast<const MR_UInt8*>(pData);
+	MR_UInt32 len = p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+	const MR_UInt8 *fmt = p + 4;
+	int channels = fmt[2] | (fmt[3] << 8);
+	int rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | (fmt[7] << 24);
+	int bits = fmt[14] | (fmt[15] << 8);
+	const MR_UInt8 *src = fmt + 18;  // sizeof(WAVEFORMATEX)
+
+	Sample *sample = new Sample();
+	sample->channels = (channels == 2) ? 2 : 1;
+	sample->rate = (rate > 0) ? rate : 22050;
+	sample->frames = 0;
+
+	if ((bits == 8 || bits == 16) && (channels == 1 || channels == 2)) {
+		size_t ct = len / (bits / 8);
+		sample->frames = ct / channels;
+		ct = sample->frames * channels;
+		sample->data.resize(ct);
+		if (bits == 8) {
+			for (size_t i = 0; i < ct; ++i) {
+				sample->data[i] = (static_cast<int>(src[i]) - 128) / 128.0f;
+			}
+		}
+		else {
+			for (size_t i = 0; i < ct; ++i, src += 2) {
+				MR_Int16 s = static_cast<MR_Int16>(src[0] | (src[1] << 8));
+				sample->data[i] = s / 32768.0f;
+			}
+		}
+	}
+
+	return SamplePtr(sample);
+}
+
+/**
+ * Start the audio thread.
+ */
+void SoundMixer::Start()
+{
+	if (thread == NULL) {
+		thread = new boost::thread(&SoundMixer::Run, this);
+	}
+}
+
+/**
+ * Stop the audio thread.
+ * Queued commands that have not yet been applied are kept.
+ */
+void SoundMixer::Stop()
+{
+	if (thread != NULL) {
+		thread->interrupt();
+		thread->join();
+		delete thread;
+		thread = NULL;
+	}
+}
+
+/**
+ * Create a voice that can be looped and paused.
+ * @param sample The sample to play.
+ * @return The voice ID.
+ */
+int SoundMixer::AllocVoice(SamplePtr sample)
+{
+	int id;
+	if (freeIds.empty()) {
+		id = nextId++;
+	}
+	else {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+
+	Command cmd;
+	cmd.type = Command::ALLOC;
+	cmd.voice = id;
+	cmd.sample = sample;
+	pending.push_back(cmd);
+
+	return id;
+}
+
+/**
+ * Release a voice created by AllocVoice().
+ * @param voice The voice ID.
+ */
+void SoundMixer::FreeVoice(int voice)
+{
+	Command cmd;
+	cmd.type = Command::FREE;
+	cmd.voice = voice;
+	pending.push_back(cmd);
+
+	freeIds.push_back(voice);
+}
+
+/**
+ * Start or continue looping a voice.
+ * If the voice was paused, it resumes where it left off.
+ * @param voice The voice ID.
+ * @param gain The linear volume (0.0 - 1.0).
+ * @param speed The playback speed (1.0 is normal).
+ * @param pan The pan, in millibels (negative is left, positive is right).
+ */
+void SoundMixer::Loop(int voice, float gain, double speed, int pan)
+{
+	Command cmd;
+	cmd.type = Command::LOOP;
+	cmd.voice = voice;
+	cmd.gain = gain;
+	cmd.speed = speed;
+	cmd.pan = pan;
+	pending.push_back(cmd);
+}
+
+/**
+ * Pause a looping voice.
+ * @param voice The voice ID.
+ */
+void SoundMixer::Pause(int voice)
+{
+	Command cmd;
+	cmd.type = Command::PAUSE;
+	cmd.voice = voice;
+	pending.push_back(cmd);
+}
+
+/**
+ * Play a sample from the start, once.
+ * Unlike the fixed copies of the classic backend, any number of these may
+ * overlap.
+ * @param sample The sample to play.
+ * @param gain The linear volume (0.0 - 1.0).
+ * @param speed The playback speed (1.0 is normal).
+ * @param pan The pan, in millibels (negative is left, positive is right).
+ */
+void SoundMixer::PlayOnce(SamplePtr sample, float gain, double speed, int pan)
+{
+	Command cmd;
+	cmd.type = Command::PLAY_ONCE;
+	cmd.voice = -1;
+	cmd.sample = sample;
+	cmd.gain = gain;
+	cmd.speed = speed;
+	cmd.pan = pan;
+	pending.push_back(cmd);
+}
+
+/**
+ * Hand all of the commands queued since the last call to the audio thread.
+ * Call this once per frame from the game thread.
+ */
+void SoundMixer::Commit()
+{
+	if (pending.empty()) return;
+
+	boost::mutex::scoped_lock lock(mutex);
+	if (published.empty()) {
+		published.swap(pending);
+	}
+	else {
+		published.insert(published.end(), pending.begin(), pending.end());
+		pending.clear();
+	}
+}
+
+/**
+ * Mix and output frames on the calling thread.
+ * This is meant for benchmarking with a NullSoundSink or WavFileSoundSink,
+ * and must not be used while the audio thread is running.
+ * @param frames The number of frames.
+ */
+void SoundMixer::Mix(size_t frames)
+{
+	ASSERT(thread == NULL);
+
+	while (frames > 0) {
+		size_t ct = std::min(frames, BLOCK_FRAMES);
+		MixBlock(ct);
+		sink->Write(&output[0], ct);
+		frames -= ct;
+	}
+}
+
+/**
+ * Retrieve the mixer statistics.
+ * @return A snapshot of the stats.
+ */
+SoundMixer::Stats SoundMixer::GetStats() const
+{
+	boost::mutex::scoped_lock lock(mutex);
+	return stats;
+}
+
+void SoundMixer::SetVoiceParams(Voice &voice, float gain, double speed, int pan) const
+{
+	if (gain < 0.0f) gain = 0.0f;
+	else if (gain > 1.0f) gain = 1.0f;
+
+	if (speed < 0.01) speed = 0.01;
+	else if (speed > 100.0) speed = 100.0;
+
+	// Same convention as DirectSound: a positive pan attenuates the left.
+	voice.gainL = (pan > 0) ? gain * MillibelsToLinear(-pan) : gain;
+	voice.gainR = (pan < 0) ? gain * MillibelsToLinear(pan) : gain;
+
+	voice.step = static_cast<MR_UInt64>(
+		speed * voice.sample->rate / rate * FIXED_ONE);
+}
+
+void SoundMixer::ApplyCommands()
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		applying.swap(published);
+	}
+
+	for (commands_t::iterator iter = applying.begin();
+		iter != applying.end(); ++iter)
+	{
+		const Command &cmd = *iter;
+		switch (cmd.type) {
+			case Command::ALLOC:
+				if (cmd.voice >= static_cast<int>(voices.size())) {
+					voices.resize(cmd.voice + 1);
+				}
+				voices[cmd.voice] = Voice();
+				voices[cmd.voice].sample = cmd.sample;
+				break;
+
+			case Command::FREE:
+				voices[cmd.voice] = Voice();
+				break;
+
+			case Command::LOOP: {
+				Voice &voice = voices[cmd.voice];
+				if (!voice.playing) {
+					voice.playing = (voice.sample->frames > 0);
+					voice.looping = true;
+				}
+				SetVoiceParams(voice, cmd.gain, cmd.speed, cmd.pan);
+				break;
+			}
+
+			case Command::PAUSE:
+				voices[cmd.voice].playing = false;
+				break;
+
+			case Command::PLAY_ONCE:
+				if (oneShots.size() < MAX_ONE_SHOTS && cmd.sample->frames > 0) {
+					oneShots.push_back(Voice());
+					Voice &voice = oneShots.back();
+					voice.sample = cmd.sample;
+					voice.playing = true;
+					voice.looping = false;
+					voice.pos = 0;
+					SetVoiceParams(voice, cmd.gain, cmd.speed, cmd.pan);
+				}
+				break;
+		}
+	}
+
+	applying.clear();
+}
+
+/**
+ * Move a voice ahead.
+ * @param voice The voice.
+ * @param frames The number of output frames.
+ * @return @c true if the voice is still playing.
+ */
+bool SoundMixer::Advance(Voice &voice, size_t frames) const
+{
+	MR_UInt64 end = static_cast<MR_UInt64>(voice.sample->frames) << 32;
+	voice.pos += voice.step * frames;
+	if (voice.pos >= end) {
+		if (voice.looping) {
+			voice.pos %= end;
+		}
+		else {
+			voice.playing = false;
+		}
+	}
+	return voice.playing;
+}
+
+/**
+ * Resample (linear interpolation) a block of a voice at the output rate.
+ * The voice position is not changed.
+ * @param voice The voice.
+ * @param frames The number of output frames.
+ * @param dest The destination, with room for @p frames frames of the
+ *             sample's channel count.
+ */
+void SoundMixer::Resample(const Voice &voice, size_t frames, float *dest) const
+{
+	const Sample &sample = *voice.sample;
+	const size_t len = sample.frames;
+	const int channels = sample.channels;
+	const float *src = &sample.data[0];
+	const float fracScale = static_cast<float>(1.0 / FIXED_ONE);
+
+	MR_UInt64 pos = voice.pos;
+	for (size_t i = 0; i < frames; ++i) {
+		size_t idx = static_cast<size_t>(pos >> 32);
+		if (idx >= len) {
+			if (voice.looping) {
+				pos %= static_cast<MR_UInt64>(len) << 32;
+				idx = static_cast<size_t>(pos >> 32);
+			}
+			else {
+				std::fill(dest + i * channels, dest + frames * channels, 0.0f);
+				return;
+			}
+		}
+		size_t next = idx + 1;
+		if (next >= len) {
+			next = voice.looping ? 0 : idx;
+		}
+		float frac = static_cast<float>(pos & 0xffffffff) * fracScale;
+
+		for (int c = 0; c < channels; ++c) {
+			float a = src[idx * channels + c];
+			float b = src[next * channels + c];
+			*dest++ = a + (b - a) * frac;
+		}
+		pos += voice.step;
+	}
+}
+
+void SoundMixer::MixVoice(Voice &voice, size_t frames)
+{
+	const float gainL = voice.gainL;
+	const float gainR = voice.gainR;
+	float *acc = &accum[0];
+	const float *src = &scratch[0];
+
+	Resample(voice, frames, &scratch[0]);
+
+	size_t i = 0;
+	if (voice.sample->channels == 1) {
+#		ifdef HR_MIXER_SSE2
+			const __m128 gain = _mm_setr_ps(gainL, gainR, gainL, gainR);
+			for (; i + 4 <= frames; i += 4) {
+				__m128 s = _mm_loadu_ps(src + i);
+				__m128 lo = _mm_unpacklo_ps(s, s);
+				__m128 hi = _mm_unpackhi_ps(s, s);
+				float *a = acc + i * 2;
+				_mm_storeu_ps(a, _mm_add_ps(_mm_loadu_ps(a), _mm_mul_ps(lo, gain)));
+				_mm_storeu_ps(a + 4, _mm_add_ps(_mm_loadu_ps(a + 4), _mm_mul_ps(hi, gain)));
+			}
+#		endif
+		for (; i < frames; ++i) {
+			acc[i * 2] += src[i] * gainL;
+			acc[i * 2 + 1] += src[i] * gainR;
+		}
+	}
+	else {
+		const size_t ct = frames * 2;
+#		ifdef HR_MIXER_SSE2
+			const __m128 gain = _mm_setr_ps(gainL, gainR, gainL, gainR);
+			for (; i + 4 <= ct; i += 4) {
+				_mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i),
+					_mm_mul_ps(_mm_loadu_ps(src + i), gain)));
+			}
+#		endif
+		for (; i < ct; i += 2) {
+			acc[i] += src[i] * gainL;
+			acc[i + 1] += src[i + 1] * gainR;
+		}
+	}
+
+	Advance(voice, frames);
+}
+
+void SoundMixer::MixBlock(size_t frames)
+{
+	pt::ptime startTime = pt::microsec_clock::universal_time();
+
+	ApplyCommands();
+
+	accum.assign(frames * 2, 0.0f);
+	scratch.resize(frames * 2);
+	output.resize(frames * 2);
+
+	// Pick the loudest voices to mix; the rest are virtual.
+	active.clear();
+	size_t virtualVoices = 0;
+	for (voices_t::iterator iter = voices.begin(); iter != voices.end(); ++iter) {
+		if (!iter->playing) continue;
+		if (std::max(iter->gainL, iter->gainR) < SILENT_GAIN) {
+			Advance(*iter, frames);
+			++virtualVoices;
+		}
+		else {
+			active.push_back(&*iter);
+		}
+	}
+	for (voices_t::iterator iter = oneShots.begin(); iter != oneShots.end(); ++iter) {
+		if (std::max(iter->gainL, iter->gainR) < SILENT_GAIN) {
+			Advance(*iter, frames);
+			++virtualVoices;
+		}
+		else {
+			active.push_back(&*iter);
+		}
+	}
+	size_t realVoices = active.size();
+	if (realVoices > static_cast<size_t>(maxVoices)) {
+		realVoices = maxVoices;
+		std::nth_element(active.begin(), active.begin() + realVoices,
+			active.end(), LouderThan());
+		for (size_t i = realVoices; i < active.size(); ++i) {
+			Advance(*active[i], frames);
+		}
+		virtualVoices += active.size() - realVoices;
+	}
+
+	for (size_t i = 0; i < realVoices; ++i) {
+		MixVoice(*active[i], frames);
+	}
+
+	// One-shots are done once they reach the end.
+	voices_t::iterator newEnd = oneShots.begin();
+	for (voices_t::iterator iter = oneShots.begin(); iter != oneShots.end(); ++iter) {
+		if (iter->playing) {
+			if (newEnd != iter) {
+				*newEnd = *iter;
+			}
+			++newEnd;
+		}
+	}
+	oneShots.erase(newEnd, oneShots.end());
+
+	// Convert to 16-bit, saturating.
+	const size_t ct = frames * 2;
+	const float *acc = &accum[0];
+	MR_Int16 *out = &output[0];
+	size_t i = 0;
+#	ifdef HR_MIXER_SSE2
+		const __m128 scale = _mm_set1_ps(32767.0f);
+		const __m128 hi = _mm_set1_ps(32767.0f);
+		const __m128 lo = _mm_set1_ps(-32768.0f);
+		for (; i + 8 <= ct; i += 8) {
+			__m128 a = _mm_mul_ps(_mm_loadu_ps(acc + i), scale);
+			__m128 b = _mm_mul_ps(_mm_loadu_ps(acc + i + 4), scale);
+			a = _mm_max_ps(_mm_min_ps(a, hi), lo);
+			b = _mm_max_ps(_mm_min_ps(b, hi), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+				_mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+		}
+#	endif
+	for (; i < ct; ++i) {
+		float s = acc[i] * 32767.0f;
+		if (s > 32767.0f) s = 32767.0f;
+		else if (s < -32768.0f) s = -32768.0f;
+		out[i] = static_cast<MR_Int16>(s < 0 ? s - 0.5f : s + 0.5f);
+	}
+
+	pt::time_duration elapsed = pt::microsec_clock::universal_time() - startTime;
+
+	boost::mutex::scoped_lock lock(mutex);
+	stats.realVoices = static_cast<int>(realVoices);
+	stats.virtualVoices = static_cast<int>(virtualVoices);
+	stats.blocks++;
+	stats.mixUsec += elapsed.total_microseconds();
+}
+
+void SoundMixer::Run()
+{
+	const pt::time_duration blockTime =
+		pt::microseconds(static_cast<long>(BLOCK_FRAMES * 1000000 / rate));
+	pt::ptime next = pt::microsec_clock::universal_time();
+
+	try {
+		for (;;) {
+			MixBlock(BLOCK_FRAMES);
+			sink->Write(&output[0], BLOCK_FRAMES);
+
+			if (sink->IsPaced()) {
+				boost::this_thread::interruption_point();
+			}
+			else {
+				// Keep to real time, but don't try to catch up after a stall.
+				next += blockTime;
+				pt::ptime now = pt::microsec_clock::universal_time();
+				if (next < now - blockTime) {
+					next = now;
+				}
+				boost::this_thread::sleep(next);
+			}
+		}
+	}
+	catch (boost::thread_interrupted&) {
+		// Stop() was called.
+	}
+}
+
+}  // namespace VideoServices
+}  // namespace HoverRace
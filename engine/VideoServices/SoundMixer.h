@@ -0,0 +1,165 @@
+// SoundMixer.h
+// Software mixer for sound effects.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../Util/MR_Types.h"
+
+#include "SoundSink.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace VideoServices {
+
+/**
+ * Mixes all active sound effects into a single output stream.
+ *
+ * The game thread only queues commands (which cost no more than a vector
+ * append) and publishes them once per frame with Commit(); the audio thread
+ * does all of the resampling and mixing.  Voices that are too quiet to hear,
+ * or that don't make the cut when there are more than @c maxVoices playing,
+ * are "virtual": they keep their place in the sample, but aren't mixed.
+ *
+ * Voice IDs are allocated by the game thread, so AllocVoice() never waits
+ * on the audio thread.
+ *
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare SoundMixer
+{
+	public:
+		/// Sample data, converted to floating-point at load time.
+		struct Sample
+		{
+			int channels;  ///< 1 (mono) or 2 (stereo, interleaved).
+			int rate;
+			size_t frames;
+			std::vector<float> data;
+		};
+		typedef boost::shared_ptr<const Sample> SamplePtr;
+
+		struct Stats
+		{
+			int realVoices;  ///< Voices mixed in the last block.
+			int virtualVoices;  ///< Voices skipped in the last block.
+			MR_UInt64 blocks;  ///< Total number of blocks mixed.
+			MR_UInt64 mixUsec;  ///< Total time spent mixing.
+		};
+
+	public:
+		SoundMixer(SoundSinkPtr sink, int maxVoices=32);
+		~SoundMixer();
+
+	public:
+		static SamplePtr LoadSample(const char *pData);
+
+		void Start();
+		void Stop();
+
+		int AllocVoice(SamplePtr sample);
+		void FreeVoice(int voice);
+		void Loop(int voice, float gain, double speed, int pan);
+		void Pause(int voice);
+		void PlayOnce(SamplePtr sample, float gain, double speed, int pan);
+		void Commit();
+
+		void Mix(size_t frames);
+
+		Stats GetStats() const;
+
+	private:
+		struct Command
+		{
+			enum type_t { ALLOC, FREE, LOOP, PAUSE, PLAY_ONCE } type;
+			int voice;
+			SamplePtr sample;
+			float gain;
+			double speed;
+			int pan;
+		};
+		typedef std::vector<Command> commands_t;
+
+		struct Voice
+		{
+			Voice() : playing(false), looping(false), pos(0), step(0),
+				gainL(0), gainR(0) { }
+
+			SamplePtr sample;
+			bool playing;
+			bool looping;
+			MR_UInt64 pos;  ///< 32.32 fixed-point frame position.
+			MR_UInt64 step;  ///< 32.32 fixed-point frames per output frame.
+			float gainL, gainR;
+		};
+		typedef std::vector<Voice> voices_t;
+
+		void SetVoiceParams(Voice &voice, float gain, double speed, int pan) const;
+		void ApplyCommands();
+		bool Advance(Voice &voice, size_t frames) const;
+		void Resample(const Voice &voice, size_t frames, float *dest) const;
+		void MixVoice(Voice &voice, size_t frames);
+		void MixBlock(size_t frames);
+		void Run();
+
+	private:
+		SoundSinkPtr sink;
+		int rate;
+		int maxVoices;
+
+		// Game thread.
+		commands_t pending;
+		std::vector<int> freeIds;
+		int nextId;
+
+		// Shared.
+		mutable boost::mutex mutex;
+		commands_t published;
+		Stats stats;
+
+		// Audio thread.
+		commands_t applying;
+		voices_t voices;
+		voices_t oneShots;
+		std::vector<Voice*> active;
+		std::vector<float> accum;
+		std::vector<float> scratch;
+		std::vector<MR_Int16> output;
+		boost::thread *thread;
+};
+
+}  // namespace VideoServices
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
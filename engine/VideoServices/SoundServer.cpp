@@ -36,8 +36,13 @@
 #	include <dsound.h>
 #endif
 
+#include "../Exception.h"
 #include "../Util/MR_Types.h"
 #include "../Util/Config.h"
+#include "../Util/Str.h"
+
+#include "SoundMixer.h"
+#include "SoundSink.h"
 
 #include "SoundServer.h"
 
@@ -53,6 +58,10 @@ static bool soundDisabled = false;
 	static ALenum initErrorCode = ALUT_ERROR_NO_ERROR;
 #endif
 
+/// The software mixer, if enabled (otherwise, one source per sound copy).
+static SoundMixer *mixer = NULL;
+static std::string mixerError;
+
 #ifndef WITH_OPENAL
 // Adapted from http://www.gamedev.net/community/forums/topic.asp?topic_id=337397
 //   and http://en.wikipedia.org/wiki/Decibel
@@ -73,6 +82,61 @@ static float DirectXToLinear(int value)
 		powf(10.0f, (float)value / 2000.0f);
 } 
 
+/// Convert millibels to linear, with the global sound effect volume applied.
+static float SfxGain(int pDB)
+{
+	float attenuatedVolume = Config::GetInstance()->audio.sfxVolume * DirectXToLinear(pDB);
+
+	// Clamp volume to accepted range.
+	if (attenuatedVolume < 0.0f) attenuatedVolume = 0.0f;
+	else if (attenuatedVolume > 1.0f) attenuatedVolume = 1.0f;
+
+	return attenuatedVolume;
+}
+
+/**
+ * Sample data shared by every SoundBuffer created from the same resource
+ * data, so each resource is decoded and uploaded only once no matter how
+ * many copies are made.
+ * Banks are keyed by the address of the resource data, which stays put for
+ * as long as the resource (and therefore the bank) exists.
+ */
+class SoundBank
+{
+	private:
+		SoundBank(const char *pData);
+		~SoundBank();
+
+	public:
+		static SoundBank *Acquire(const char *pData);
+		static void Release(SoundBank *pBank);
+
+		bool IsValid() const;
+		int GetFreq() const { return mFreq; }
+
+#		ifdef WITH_OPENAL
+			ALuint GetBuffer() const { return mBuffer; }
+#		else
+			IDirectSoundBuffer *GetBuffer() const { return mBuffer; }
+#		endif
+		SoundMixer::SamplePtr GetSample() const { return mSample; }
+
+	private:
+		typedef std::map<const char*, SoundBank*> banks_t;
+		static banks_t mBanks;
+
+		const char *mKey;
+		int mRefCount;
+		int mFreq;
+
+#		ifdef WITH_OPENAL
+			ALuint mBuffer;
+#		else
+			IDirectSoundBuffer *mBuffer;
+#		endif
+		SoundMixer::SamplePtr mSample;
+};
+
 class SoundBuffer
 {
 	private:
@@ -82,8 +146,8 @@ class SoundBuffer
 	protected:
 
 		int mNbCopy;
+		SoundBank *mBank;
 #		ifdef WITH_OPENAL
-			ALuint mBuffer;
 			ALuint mSoundBuffer[MR_MAX_SOUND_COPY];  // Actually the sources.
 #		else
 			IDirectSoundBuffer *mSoundBuffer[MR_MAX_SOUND_COPY];
@@ -91,6 +155,10 @@ class SoundBuffer
 
 		int mNormalFreq;
 
+#		ifdef WITH_OPENAL
+			ALuint GetSource(int pCopy);
+#		endif
+
 	public:
 		SoundBuffer();
 		virtual ~ SoundBuffer();
@@ -129,6 +197,10 @@ class ContinuousSound : public SoundBuffer
 		int mMaxDB[MR_MAX_SOUND_COPY];
 		double mMaxSpeed[MR_MAX_SOUND_COPY];
 
+		// Mixer voices, allocated on first use.
+		int mVoice[MR_MAX_SOUND_COPY];
+		BOOL mPlaying[MR_MAX_SOUND_COPY];
+
 		void ResetCumStat();
 
 	public:
@@ -144,26 +216,183 @@ class ContinuousSound : public SoundBuffer
 };
 
 // Variables
+SoundBank::banks_t SoundBank::mBanks;
 SoundBuffer *SoundBuffer::mList = NULL;
 
 #ifndef WITH_OPENAL
 IDirectSound *gDirectSound = NULL;
 #endif
 
+// Implementation
+
+/**
+ * Constructor.
+ * Check IsValid() afterwards to see if the data could be loaded.
+ * @param pData Data buffer.  First 32 bits are the data length, followed by
+ *              a WAVEFORMATEX describing the data, followed by the data itself.
+ */
+SoundBank::SoundBank(const char *pData) :
+	mKey(pData), mRefCount(0), mFreq(0)
+{
 #ifdef WITH_OPENAL
-static const char* const waveHeader =
-	"RIFF----WAVE"
-	"fmt \022\0\0\0" "----" "----" "----" "----\0\0"
-	"data----";
+	mBuffer = 0;
+#else
+	mBuffer = NULL;
 #endif
 
-// Implementation
-SoundBuffer::SoundBuffer()
+	if (mixer != NULL) {
+		mSample = SoundMixer::LoadSample(pData);
+		mFreq = mSample->rate;
+		return;
+	}
+
+	// Parse pData
+	MR_UInt32 lBufferLen = *(MR_UInt32 *) pData;
+#ifdef WITH_OPENAL
+	const MR_UInt8 *lFormatData = (const MR_UInt8 *) (pData + sizeof(MR_UInt32));
+	int lChannels = lFormatData[2] | (lFormatData[3] << 8);
+	int lBits = lFormatData[14] | (lFormatData[15] << 8);
+	mFreq = lFormatData[4] | (lFormatData[5] << 8) | (lFormatData[6] << 16) | (lFormatData[7] << 24);
+	const char *lSoundData = pData + sizeof(MR_UInt32) + 18;  // sizeof(WAVEFORMATEX)
+
+	// Upload the PCM directly; there's no need to go through a WAV image.
+	ALenum lFormat;
+	if (lChannels == 1) {
+		lFormat = (lBits == 16) ? AL_FORMAT_MONO16 : AL_FORMAT_MONO8;
+	}
+	else {
+		lFormat = (lBits == 16) ? AL_FORMAT_STEREO16 : AL_FORMAT_STEREO8;
+	}
+
+	alGetError();
+	alGenBuffers(1, &mBuffer);
+#	ifdef WORDS_BIGENDIAN
+		if (lBits == 16) {
+			std::vector<char> lSwapped(lSoundData, lSoundData + lBufferLen);
+			for (size_t i = 0; i + 1 < lSwapped.size(); i += 2) {
+				std::swap(lSwapped[i], lSwapped[i + 1]);
+			}
+			alBufferData(mBuffer, lFormat, &lSwapped[0], lBufferLen, mFreq);
+		}
+		else
+#	endif
+	alBufferData(mBuffer, lFormat, lSoundData, lBufferLen, mFreq);
+
+	if (alGetError() != AL_NO_ERROR) {
+		ASSERT(FALSE);
+		alDeleteBuffers(1, &mBuffer);
+		mBuffer = 0;
+	}
+#else
+	// Copied, since the resource data may be read-only.
+	WAVEFORMATEX lWaveFormat;
+	memcpy(&lWaveFormat, pData + sizeof(MR_UInt32), sizeof(WAVEFORMATEX));
+	lWaveFormat.cbSize = 0;
+	const char *lSoundData = pData + sizeof(MR_UInt32) + sizeof(WAVEFORMATEX);
+
+	mFreq = lWaveFormat.nSamplesPerSec;
+
+	DSBUFFERDESC lDesc;
+
+	lDesc.dwSize = sizeof(lDesc);
+	lDesc.dwFlags = DSBCAPS_CTRLPAN | DSBCAPS_CTRLVOLUME | DSBCAPS_CTRLFREQUENCY | DSBCAPS_STATIC;
+	lDesc.dwReserved = 0;
+	lDesc.dwBufferBytes = lBufferLen;
+	lDesc.lpwfxFormat = &lWaveFormat;
+
+	int lCode;
+	if((lCode = gDirectSound->CreateSoundBuffer(&lDesc, &mBuffer, NULL)) != DS_OK) {
+		ASSERT(lCode != DSERR_ALLOCATED);
+		ASSERT(lCode != DSERR_BADFORMAT);
+		ASSERT(lCode != DSERR_INVALIDPARAM);
+		ASSERT(lCode != DSERR_NOAGGREGATION);
+		ASSERT(lCode != DSERR_OUTOFMEMORY);
+		ASSERT(FALSE);
+		mBuffer = NULL;
+	}
+	else {
+		void *lSoundBuffer;
+		unsigned long lSoundBufferLen;
+
+		if(mBuffer->Lock(0, lBufferLen, &lSoundBuffer, &lSoundBufferLen, NULL, NULL, 0) == DS_OK) {
+			ASSERT(lSoundBufferLen == lBufferLen);
+
+			memcpy(lSoundBuffer, lSoundData, lSoundBufferLen);
+
+			mBuffer->Unlock(lSoundBuffer, lSoundBufferLen, NULL, 0);
+		}
+		else {
+			ASSERT(FALSE);
+			mBuffer->Release();
+			mBuffer = NULL;
+		}
+	}
+#endif
+}
+
+SoundBank::~SoundBank()
 {
-	mNbCopy = 0;
 #ifdef WITH_OPENAL
-	mBuffer = 0;
+	if (mBuffer != 0) {
+		alDeleteBuffers(1, &mBuffer);
+	}
+#else
+	if (mBuffer != NULL) {
+		mBuffer->Release();
+	}
 #endif
+}
+
+/**
+ * Retrieve the bank for a resource, loading it if necessary.
+ * Each call must be matched with a call to Release().
+ * @param pData The resource data (see SoundBank::SoundBank()).
+ * @return The bank (never @c NULL, but may not be valid).
+ */
+SoundBank *SoundBank::Acquire(const char *pData)
+{
+	SoundBank *lBank;
+
+	banks_t::iterator iter = mBanks.find(pData);
+	if (iter != mBanks.end()) {
+		lBank = iter->second;
+	}
+	else {
+		lBank = new SoundBank(pData);
+		mBanks.insert(banks_t::value_type(pData, lBank));
+	}
+
+	lBank->mRefCount++;
+	return lBank;
+}
+
+/**
+ * Release a bank retrieved from Acquire().
+ * The bank is deleted when the last user releases it.
+ * @param pBank The bank (may be @c NULL).
+ */
+void SoundBank::Release(SoundBank *pBank)
+{
+	if (pBank != NULL && --pBank->mRefCount <= 0) {
+		mBanks.erase(pBank->mKey);
+		delete pBank;
+	}
+}
+
+bool SoundBank::IsValid() const
+{
+#ifdef WITH_OPENAL
+	return mSample || mBuffer != 0;
+#else
+	return mSample || mBuffer != NULL;
+#endif
+}
+
+SoundBuffer::SoundBuffer()
+{
+	mNbCopy = 0;
+	mBank = NULL;
+	mNormalFreq = 0;
 
 	for(int lCounter = 0; lCounter < MR_MAX_SOUND_COPY; lCounter++) {
 #ifdef WITH_OPENAL
@@ -200,17 +429,22 @@ SoundBuffer::~SoundBuffer()
 	}
 
 	// Delete the sound buffers
+	for(int lCounter = 0; lCounter < mNbCopy; lCounter++) {
 #ifdef WITH_OPENAL
-	alDeleteSources(mNbCopy, mSoundBuffer);
-	alDeleteBuffers(1, &mBuffer);
+		if(mSoundBuffer[lCounter] != 0) {
+			alDeleteSources(1, &mSoundBuffer[lCounter]);
+			mSoundBuffer[lCounter] = 0;
+		}
 #else
-	for(int lCounter = 0; lCounter < mNbCopy; lCounter++) {
 		if(mSoundBuffer[lCounter] != NULL) {
 			mSoundBuffer[lCounter]->Release();
 			mSoundBuffer[lCounter] = NULL;
 		}
-	}
 #endif
+	}
+
+	SoundBank::Release(mBank);
+	mBank = NULL;
 }
 
 void SoundBuffer::ApplyCumCommand()
@@ -248,7 +482,7 @@ BOOL SoundBuffer::Init(const char *pData, int pNbCopy)
 
 	BOOL lReturnValue = TRUE;
 
-	ASSERT(!mSoundBuffer[0]);			  // Already initialized
+	ASSERT(mBank == NULL);			  // Already initialized
 
 	if(pNbCopy > MR_MAX_SOUND_COPY) {
 		ASSERT(FALSE);
@@ -257,86 +491,22 @@ BOOL SoundBuffer::Init(const char *pData, int pNbCopy)
 
 	mNbCopy = pNbCopy;
 
-	// Parse pData
-	MR_UInt32 lBufferLen = *(MR_UInt32 *) pData;
-#ifdef WITH_OPENAL
-	const char *lSoundData = pData + sizeof(MR_UInt32);
-	
-	// Temporary WAV format buffer to pass to ALUT.
-	int bufSize = 12 + (8 + 18) + (8 + lBufferLen);
-	MR_UInt32 chunkSize = bufSize - 8;
-	char *buf = (char*)malloc(bufSize);
-	memcpy(buf, waveHeader, 12 + (8 + 18) + 8);
-	memcpy(buf + 0x04, &chunkSize, 4);
-	memcpy(buf + 0x14, lSoundData, 16);
-	memcpy(buf + 0x2a, &lBufferLen, 4);
-	lSoundData += 18;  // sizeof(WAVEFORMATEX)
-	memcpy(buf + 0x2e, lSoundData, lBufferLen);
-
-	mBuffer = alutCreateBufferFromFileImage(buf, bufSize);
-	//mBuffer = alutCreateBufferHelloWorld();
-	if (mBuffer == AL_NONE) {
-		//MessageBox(NULL, alutGetErrorString(alutGetError()), "AIEEE", MB_OK);
-		ASSERT(FALSE);
-		lReturnValue = FALSE;
-	} else {
-		alGenSources(mNbCopy, mSoundBuffer);
-		for (int i = 0; i < mNbCopy; ++i) {
-			alSourcei(mSoundBuffer[i], AL_BUFFER, mBuffer);
-		}
-	}
-
-	free(buf);
-#else
-	DSBUFFERDESC lDesc;
-	WAVEFORMATEX *lWaveFormat = (WAVEFORMATEX *) (pData + sizeof(MR_UInt32));
-	const char *lSoundData = pData + sizeof(MR_UInt32) + sizeof(WAVEFORMATEX);
-
-	lWaveFormat->cbSize = 0;
-
-	lDesc.dwSize = sizeof(lDesc);
-	lDesc.dwFlags = DSBCAPS_CTRLPAN | DSBCAPS_CTRLVOLUME | DSBCAPS_CTRLFREQUENCY | DSBCAPS_STATIC;
-	lDesc.dwReserved = 0;
-	lDesc.dwBufferBytes = lBufferLen;
-	lDesc.lpwfxFormat = lWaveFormat;
-
-	mNormalFreq = lWaveFormat->nSamplesPerSec;
-
-	// Initialize the first copy
-	int lCode;
-	if((lCode = gDirectSound->CreateSoundBuffer(&lDesc, &(mSoundBuffer[0]), NULL)) != DS_OK) {
-		ASSERT(lCode != DSERR_ALLOCATED);
-		ASSERT(lCode != DSERR_BADFORMAT);
-		ASSERT(lCode != DSERR_INVALIDPARAM);
-		ASSERT(lCode != DSERR_NOAGGREGATION);
-		ASSERT(lCode != DSERR_OUTOFMEMORY);
-		ASSERT(FALSE);
-		lReturnValue = FALSE;
+	mBank = SoundBank::Acquire(pData);
+	if (!mBank->IsValid()) {
+		return FALSE;
 	}
+	mNormalFreq = mBank->GetFreq();
 
-	if(lReturnValue) {
-		void *lSoundBuffer;
-		unsigned long lSoundBufferLen;
-
-		if(mSoundBuffer[0]->Lock(0, lBufferLen, &lSoundBuffer, &lSoundBufferLen, NULL, NULL, 0) == DS_OK) {
-			ASSERT(lSoundBufferLen == lBufferLen);
-
-			memcpy(lSoundBuffer, lSoundData, lSoundBufferLen);
-
-			mSoundBuffer[0]->Unlock(lSoundBuffer, lSoundBufferLen, NULL, 0);
-		}
-		else {
-			ASSERT(FALSE);
-			lReturnValue = FALSE;
-		}
-	}
-	// Init extra copy
-	for(int lCounter = 1; lReturnValue && (lCounter < mNbCopy); lCounter++) {
-		if(gDirectSound->DuplicateSoundBuffer(mSoundBuffer[0], &mSoundBuffer[lCounter]) != DS_OK) {
-			lReturnValue = FALSE;
+#ifndef WITH_OPENAL
+	// All copies share the bank's buffer memory.
+	if (mixer == NULL) {
+		for(int lCounter = 0; lReturnValue && (lCounter < mNbCopy); lCounter++) {
+			if(gDirectSound->DuplicateSoundBuffer(mBank->GetBuffer(), &mSoundBuffer[lCounter]) != DS_OK) {
+				lReturnValue = FALSE;
+			}
 		}
 	}
-#endif // WITH_OPENAL
+#endif
 
 	return lReturnValue;
 }
@@ -349,25 +519,21 @@ void SoundBuffer::SetParams(int pCopy, int pDB, double pSpeed, int pPan)
 		pCopy = mNbCopy - 1;
 	}
 
-	// Global sound effect volume setting.
-	float vol = Config::GetInstance()->audio.sfxVolume;
-
 #ifdef WITH_OPENAL
-	float attenuatedVolume = vol * DirectXToLinear(pDB);
-
-	// Clamp volume to accepted range.
-	if (attenuatedVolume < 0.0f) attenuatedVolume = 0.0f;
-	else if (attenuatedVolume > 1.0f) attenuatedVolume = 1.0f;
+	float attenuatedVolume = SfxGain(pDB);
 
 	if (pSpeed < 0.01f) pSpeed = 0.01f;
 
-	ALuint src = mSoundBuffer[pCopy];
+	ALuint src = GetSource(pCopy);
 	if (src) {
-		alSourcef(mSoundBuffer[pCopy], AL_GAIN, attenuatedVolume);
-		alSourcef(mSoundBuffer[pCopy], AL_PITCH, static_cast<float>(pSpeed));
+		alSourcef(src, AL_GAIN, attenuatedVolume);
+		alSourcef(src, AL_PITCH, static_cast<float>(pSpeed));
 		//TODO: Simulate panning by changing position.
 	}
 #else
+	// Global sound effect volume setting.
+	float vol = Config::GetInstance()->audio.sfxVolume;
+
 	long attenuatedVolume;
 	if (vol >= 0.99f) {
 		attenuatedVolume = pDB;
@@ -393,6 +559,29 @@ void SoundBuffer::SetParams(int pCopy, int pDB, double pSpeed, int pPan)
 #endif
 }
 
+#ifdef WITH_OPENAL
+/**
+ * Retrieve the source for a copy, creating it on first use.
+ * @param pCopy The copy.
+ * @return The source (@c 0 if it could not be created).
+ */
+ALuint SoundBuffer::GetSource(int pCopy)
+{
+	ALuint &lSource = mSoundBuffer[pCopy];
+	if (lSource == 0) {
+		alGetError();
+		alGenSources(1, &lSource);
+		if (alGetError() != AL_NO_ERROR) {
+			lSource = 0;
+		}
+		else {
+			alSourcei(lSource, AL_BUFFER, mBank->GetBuffer());
+		}
+	}
+	return lSource;
+}
+#endif
+
 int SoundBuffer::GetNbCopy() const
 {
 	return mNbCopy;
@@ -412,9 +601,16 @@ void ShortSound::Play(int pDB, double pSpeed, int pPan)
 {
 	if (soundDisabled) return;
 
+	if (mixer != NULL) {
+		mixer->PlayOnce(mBank->GetSample(), SfxGain(pDB), pSpeed, pPan);
+		return;
+	}
+
 #ifdef WITH_OPENAL
 	SetParams(mCurrentCopy, pDB, pSpeed, pPan);
-	alSourcePlay(mSoundBuffer[mCurrentCopy]);
+	if (mSoundBuffer[mCurrentCopy] != 0) {
+		alSourcePlay(mSoundBuffer[mCurrentCopy]);
+	}
 #else
 	mSoundBuffer[mCurrentCopy]->SetCurrentPosition(0);
 	SetParams(mCurrentCopy, pDB, pSpeed, pPan);
@@ -430,11 +626,22 @@ void ShortSound::Play(int pDB, double pSpeed, int pPan)
 // class ContinuousSound
 ContinuousSound::ContinuousSound()
 {
+	for(int lCounter = 0; lCounter < MR_MAX_SOUND_COPY; lCounter++) {
+		mVoice[lCounter] = -1;
+		mPlaying[lCounter] = FALSE;
+	}
 	ResetCumStat();
 }
 
 ContinuousSound::~ContinuousSound()
 {
+	if (mixer != NULL) {
+		for(int lCounter = 0; lCounter < MR_MAX_SOUND_COPY; lCounter++) {
+			if (mVoice[lCounter] >= 0) {
+				mixer->FreeVoice(mVoice[lCounter]);
+			}
+		}
+	}
 }
 
 void ContinuousSound::ResetCumStat()
@@ -455,7 +662,10 @@ void ContinuousSound::Pause(int pCopy)
 	}
 
 #ifdef WITH_OPENAL
-	alSourcePause(mSoundBuffer[pCopy]);
+	// Copies that have never played don't have a source yet.
+	if (mSoundBuffer[pCopy] != 0) {
+		alSourcePause(mSoundBuffer[pCopy]);
+	}
 #else
 	mSoundBuffer[pCopy]->Stop();
 #endif
@@ -470,11 +680,13 @@ void ContinuousSound::Restart(int pCopy)
 		pCopy = mNbCopy - 1;
 	}
 #ifdef WITH_OPENAL
-	alSourcei(mSoundBuffer[pCopy], AL_LOOPING, AL_TRUE);
+	ALuint src = GetSource(pCopy);
+	if (src == 0) return;
+	alSourcei(src, AL_LOOPING, AL_TRUE);
 	ALint state;
-	alGetSourcei(mSoundBuffer[pCopy], AL_SOURCE_STATE, &state);
+	alGetSourcei(src, AL_SOURCE_STATE, &state);
 	if (state != AL_PLAYING) {
-		alSourcePlay(mSoundBuffer[pCopy]);
+		alSourcePlay(src);
 	}
 #else
 	mSoundBuffer[pCopy]->Play(0, 0, DSBPLAY_LOOPING);
@@ -483,6 +695,25 @@ void ContinuousSound::Restart(int pCopy)
 
 void ContinuousSound::ApplyCumCommand()
 {
+	if (mixer != NULL) {
+		// Active voices are refreshed every frame; a voice is only paused
+		// once, and paused voices cost the mixer nothing.
+		for(int lCounter = 0; lCounter < mNbCopy; lCounter++) {
+			if(mOn[lCounter]) {
+				if(mVoice[lCounter] < 0) {
+					mVoice[lCounter] = mixer->AllocVoice(mBank->GetSample());
+				}
+				mixer->Loop(mVoice[lCounter], SfxGain(mMaxDB[lCounter]), mMaxSpeed[lCounter], 0);
+				mPlaying[lCounter] = TRUE;
+			}
+			else if(mPlaying[lCounter]) {
+				mixer->Pause(mVoice[lCounter]);
+				mPlaying[lCounter] = FALSE;
+			}
+		}
+		ResetCumStat();
+		return;
+	}
 
 	for(int lCounter = 0; lCounter < mNbCopy; lCounter++) {
 		if(mOn[lCounter]) {
@@ -511,6 +742,48 @@ void ContinuousSound::CumPlay(int pCopy, int pDB, double pSpeed)
 
 // namespace SoundServer
 
+/**
+ * Start the software mixer.
+ * @param sinkName The output: "null", "wav:" followed by a filename, or
+ *                 (OpenAL only) "device".
+ * @return @c true if successful.
+ */
+static bool InitMixer(const std::string &sinkName)
+{
+	mixerError.clear();
+
+	try {
+		SoundSinkPtr sink;
+		if (sinkName == "null") {
+			sink.reset(new NullSoundSink());
+		}
+		else if (sinkName.compare(0, 4, "wav:") == 0) {
+			sink.reset(new WavFileSoundSink(
+				Util::Str::UP(sinkName.substr(4))));
+		}
+#		ifdef WITH_OPENAL
+			else if (sinkName == "device") {
+				sink.reset(new OpenAlSoundSink());
+			}
+#		endif
+		else {
+			mixerError = _("Unknown sound output");
+			mixerError += ": ";
+			mixerError += sinkName;
+			return false;
+		}
+
+		mixer = new SoundMixer(sink);
+		mixer->Start();
+	}
+	catch (Exception &ex) {
+		mixerError = ex.what();
+		return false;
+	}
+
+	return true;
+}
+
 bool SoundServer::Init(
 #	ifndef WITH_OPENAL
 		HWND pWindow
@@ -521,6 +794,7 @@ bool SoundServer::Init(
 	if (soundDisabled) return true;
 
 	bool lReturnValue = true;
+	const std::string &sinkName = Config::GetInstance()->runtime.soundSink;
 
 #ifdef WITH_OPENAL
 	lReturnValue = (alutInit(NULL, NULL) == AL_TRUE);
@@ -536,7 +810,8 @@ bool SoundServer::Init(
 		}
 	}
 #else
-	if(gDirectSound == NULL) {
+	// The mixer doesn't use DirectSound for any of its outputs.
+	if(sinkName.empty() && gDirectSound == NULL) {
 		if(DirectSoundCreate(NULL, &gDirectSound, NULL) == DS_OK) {
 
 			if(gDirectSound->SetCooperativeLevel(pWindow, DSSCL_NORMAL) != DS_OK) {
@@ -550,6 +825,13 @@ bool SoundServer::Init(
 	}
 #endif
 
+	if(lReturnValue && !soundDisabled && !sinkName.empty() && mixer == NULL) {
+		lReturnValue = InitMixer(sinkName);
+		if (!lReturnValue) {
+			Config::GetInstance()->runtime.silent = soundDisabled = true;
+		}
+	}
+
 	return lReturnValue;
 }
 
@@ -557,6 +839,10 @@ void SoundServer::Close()
 {
 	SoundBuffer::DeleteAll();
 
+	// Must be stopped before the device goes away.
+	delete mixer;
+	mixer = NULL;
+
 	if (soundDisabled) return;
 
 #ifdef WITH_OPENAL
@@ -576,6 +862,8 @@ void SoundServer::Close()
  */
 std::string SoundServer::GetInitError()
 {
+	if (!mixerError.empty()) return mixerError;
+
 #ifdef WITH_OPENAL
 	return (initErrorCode == ALUT_ERROR_NO_ERROR) ? "" :
 		alutGetErrorString(initErrorCode);
@@ -587,7 +875,7 @@ std::string SoundServer::GetInitError()
 ShortSound *SoundServer::CreateShortSound(const char *pData, int pNbCopy)
 {
 #ifndef WITH_OPENAL
-	if(gDirectSound != NULL) {
+	if(gDirectSound != NULL || mixer != NULL) {
 #endif
 		ShortSound *lReturnValue = new ShortSound;
 
@@ -628,7 +916,7 @@ int SoundServer::GetNbCopy(ShortSound * pSound)
 ContinuousSound *SoundServer::CreateContinuousSound(const char *pData, int pNbCopy)
 {
 #ifndef WITH_OPENAL
-	if(gDirectSound != NULL) {
+	if(gDirectSound != NULL || mixer != NULL) {
 #endif
 		ContinuousSound *lReturnValue = new ContinuousSound;
 
@@ -659,9 +947,12 @@ void SoundServer::Play(ContinuousSound * pSound, int pCopy, int pDB, double pSpe
 void SoundServer::ApplyContinuousPlay()
 {
 #ifndef WITH_OPENAL
-	if(gDirectSound != NULL) {
+	if(gDirectSound != NULL || mixer != NULL) {
 #endif
 		SoundBuffer::ApplyCumCommandForAll();
+		if (mixer != NULL) {
+			mixer->Commit();
+		}
 #ifndef WITH_OPENAL
 	}
 #endif
@@ -693,6 +984,15 @@ void SoundServer::SetParams( ContinuousSound* pSound, int pCopy, int pDB, double
 }
 */
 
+/**
+ * Retrieve the software mixer.
+ * @return The mixer, or @c NULL if the classic per-sound backend is in use.
+ */
+SoundMixer *SoundServer::GetMixer()
+{
+	return mixer;
+}
+
 int SoundServer::GetNbCopy(ContinuousSound * pSound)
 {
 	if(pSound != NULL) {
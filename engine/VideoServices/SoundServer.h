@@ -40,6 +40,7 @@ namespace VideoServices {
 
 class ShortSound;
 class ContinuousSound;
+class SoundMixer;
 
 namespace SoundServer
 {
@@ -76,6 +77,8 @@ namespace SoundServer
 
 	MR_DllDeclare void ApplyContinuousPlay();
 
+	MR_DllDeclare SoundMixer *GetMixer();
+
 };
 
 }  // namespace VideoServices
@@ -0,0 +1,177 @@
+// SoundSink.cpp
+// Output devices for the software sound mixer.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "StdAfx.h"
+
+#include <boost/thread/thread.hpp>
+
+#ifdef WITH_OPENAL
+#	include <AL/al.h>
+#endif
+
+#include "../Exception.h"
+#include "../Util/Str.h"
+
+#include "SoundSink.h"
+
+namespace HoverRace {
+namespace VideoServices {
+
+namespace {
+	void PutUInt16(MR_UInt8 *dest, MR_UInt16 i)
+	{
+		dest[0] = static_cast<MR_UInt8>(i);
+		dest[1] = static_cast<MR_UInt8>(i >> 8);
+	}
+
+	void PutUInt32(MR_UInt8 *dest, MR_UInt32 i)
+	{
+		PutUInt16(dest, static_cast<MR_UInt16>(i));
+		PutUInt16(dest + 2, static_cast<MR_UInt16>(i >> 16));
+	}
+}
+
+// WavFileSoundSink
+
+/**
+ * Constructor.
+ * @param filename The output file (will be overwritten).
+ * @param rate The sample rate.
+ * @throw Exception The file could not be opened.
+ */
+WavFileSoundSink::WavFileSoundSink(const Util::OS::path_t &filename, int rate) :
+	SUPER(), rate(rate), dataLen(0)
+{
+	file = Util::OS::FOpen(filename, "wb");
+	if (file == NULL) {
+		std::string msg = "Unable to open sound output file: ";
+		msg += (const char*)Util::Str::PU(filename);
+		throw Exception(msg);
+	}
+	WriteHeader();
+}
+
+WavFileSoundSink::~WavFileSoundSink()
+{
+	// Now that the length is known, fill it in.
+	fseek(file, 0, SEEK_SET);
+	WriteHeader();
+	fclose(file);
+}
+
+void WavFileSoundSink::WriteHeader()
+{
+	MR_UInt8 hdr[44];
+	memcpy(hdr, "RIFF", 4);
+	PutUInt32(hdr + 4, 36 + dataLen);
+	memcpy(hdr + 8, "WAVEfmt ", 8);
+	PutUInt32(hdr + 16, 16);
+	PutUInt16(hdr + 20, 1);  // PCM
+	PutUInt16(hdr + 22, 2);
+	PutUInt32(hdr + 24, rate);
+	PutUInt32(hdr + 28, rate * 4);
+	PutUInt16(hdr + 32, 4);
+	PutUInt16(hdr + 34, 16);
+	memcpy(hdr + 36, "data", 4);
+	PutUInt32(hdr + 40, dataLen);
+	fwrite(hdr, sizeof(hdr), 1, file);
+}
+
+void WavFileSoundSink::Write(const MR_Int16 *buf, size_t frames)
+{
+#	ifdef WORDS_BIGENDIAN
+		std::vector<MR_UInt8> tmp(frames * 4);
+		for (size_t i = 0; i < frames * 2; ++i) {
+			PutUInt16(&tmp[i * 2], static_cast<MR_UInt16>(buf[i]));
+		}
+		fwrite(&tmp[0], 4, frames, file);
+#	else
+		fwrite(buf, 4, frames, file);
+#	endif
+	dataLen += static_cast<MR_UInt32>(frames * 4);
+}
+
+#ifdef WITH_OPENAL
+
+// OpenAlSoundSink
+
+/**
+ * Constructor.
+ * @param rate The sample rate.
+ * @throw Exception The source could not be created.
+ */
+OpenAlSoundSink::OpenAlSoundSink(int rate) :
+	SUPER(), rate(rate), source(0), buffersQueued(0)
+{
+	alGetError();
+	alGenSources(1, &source);
+	alGenBuffers(NUM_BUFFERS, buffers);
+	if (alGetError() != AL_NO_ERROR) {
+		throw Exception("Unable to create OpenAL stream");
+	}
+	alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+}
+
+OpenAlSoundSink::~OpenAlSoundSink()
+{
+	alSourceStop(source);
+	alSourcei(source, AL_BUFFER, 0);
+	alDeleteSources(1, &source);
+	alDeleteBuffers(NUM_BUFFERS, buffers);
+}
+
+void OpenAlSoundSink::Write(const MR_Int16 *buf, size_t frames)
+{
+	ALuint buffer;
+
+	if (buffersQueued < NUM_BUFFERS) {
+		// Still priming the queue.
+		buffer = buffers[buffersQueued++];
+	}
+	else {
+		// Wait for the device to finish with one of the buffers.
+		for (;;) {
+			ALint processed = 0;
+			alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+			if (processed > 0) break;
+			boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+		}
+		alSourceUnqueueBuffers(source, 1, &buffer);
+	}
+
+	alBufferData(buffer, AL_FORMAT_STEREO16, buf,
+		static_cast<ALsizei>(frames * 4), rate);
+	alSourceQueueBuffers(source, 1, &buffer);
+
+	// Start playing once primed, and restart if we ever fell behind.
+	if (buffersQueued == NUM_BUFFERS) {
+		ALint state;
+		alGetSourcei(source, AL_SOURCE_STATE, &state);
+		if (state != AL_PLAYING) {
+			alSourcePlay(source);
+		}
+	}
+}
+
+#endif  // WITH_OPENAL
+
+}  // namespace VideoServices
+}  // namespace HoverRace
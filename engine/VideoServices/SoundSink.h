@@ -0,0 +1,145 @@
+// SoundSink.h
+// Output devices for the software sound mixer.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include "../Util/MR_Types.h"
+#include "../Util/OS.h"
+
+#ifdef _WIN32
+#	ifdef MR_ENGINE
+#		define MR_DllDeclare   __declspec( dllexport )
+#	else
+#		define MR_DllDeclare   __declspec( dllimport )
+#	endif
+#else
+#	define MR_DllDeclare
+#endif
+
+namespace HoverRace {
+namespace VideoServices {
+
+/**
+ * Destination for the output of the SoundMixer.
+ * All sinks take interleaved 16-bit signed stereo frames.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare SoundSink
+{
+	public:
+		SoundSink() { }
+		virtual ~SoundSink() { }
+
+	public:
+		/// The output sample rate, in frames per second.
+		virtual int GetRate() const = 0;
+
+		/**
+		 * Check if Write() blocks to keep pace with real time.
+		 * If not, the mixer thread sleeps between blocks instead.
+		 */
+		virtual bool IsPaced() const = 0;
+
+		/**
+		 * Output a block of frames.
+		 * @param buf The frames (left and right samples interleaved).
+		 * @param frames The number of frames.
+		 */
+		virtual void Write(const MR_Int16 *buf, size_t frames) = 0;
+};
+typedef boost::shared_ptr<SoundSink> SoundSinkPtr;
+
+/**
+ * Sink that discards everything, for running the mixer headless.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare NullSoundSink : public SoundSink
+{
+	typedef SoundSink SUPER;
+	public:
+		NullSoundSink(int rate=44100) : SUPER(), rate(rate) { }
+		virtual ~NullSoundSink() { }
+
+	public:
+		virtual int GetRate() const { return rate; }
+		virtual bool IsPaced() const { return false; }
+		virtual void Write(const MR_Int16*, size_t) { }
+
+	private:
+		int rate;
+};
+
+/**
+ * Sink that records to a WAV file.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare WavFileSoundSink : public SoundSink
+{
+	typedef SoundSink SUPER;
+	public:
+		WavFileSoundSink(const Util::OS::path_t &filename, int rate=44100);
+		virtual ~WavFileSoundSink();
+
+	public:
+		virtual int GetRate() const { return rate; }
+		virtual bool IsPaced() const { return false; }
+		virtual void Write(const MR_Int16 *buf, size_t frames);
+
+	private:
+		void WriteHeader();
+
+	private:
+		FILE *file;
+		int rate;
+		MR_UInt32 dataLen;
+};
+
+#ifdef WITH_OPENAL
+/**
+ * Sink that streams to the OpenAL device through a single source.
+ * OpenAL must already be initialized.
+ * @author HoverRace contributors
+ */
+class MR_DllDeclare OpenAlSoundSink : public SoundSink
+{
+	typedef SoundSink SUPER;
+	public:
+		OpenAlSoundSink(int rate=44100);
+		virtual ~OpenAlSoundSink();
+
+	public:
+		virtual int GetRate() const { return rate; }
+		virtual bool IsPaced() const { return true; }
+		virtual void Write(const MR_Int16 *buf, size_t frames);
+
+	private:
+		static const int NUM_BUFFERS = 4;
+		int rate;
+		unsigned int source;
+		unsigned int buffers[NUM_BUFFERS];
+		int buffersQueued;
+};
+#endif
+
+}  // namespace VideoServices
+}  // namespace HoverRace
+
+#undef MR_DllDeclare
@@ -0,0 +1,150 @@
+// Impairment.cpp
+// Model of an imperfect network link (latency, jitter, loss, bandwidth).
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "Impairment.h"
+
+using namespace HoverRace::NetSim;
+
+ImpairmentProfile::ImpairmentProfile() :
+	delay(0), jitter(0), distribution(UNIFORM),
+	loss(0), lossBurst(0), reorder(0), duplicate(0), bandwidth(0)
+{
+}
+
+/**
+ * Set one parameter from its command-line form.
+ * Percentages are given as percentages (e.g. "2.5") and stored as
+ * probabilities.
+ * @param key The parameter name (e.g. "delay", "loss").
+ * @param value The value, as text.
+ * @return @c true if the parameter was recognized.
+ */
+bool ImpairmentProfile::Parse(const std::string &key, const std::string &value)
+{
+	double num = atof(value.c_str());
+
+	if (key == "delay") delay = num;
+	else if (key == "jitter") jitter = num;
+	else if (key == "loss") loss = num / 100.0;
+	else if (key == "loss-burst") lossBurst = num / 100.0;
+	else if (key == "reorder") reorder = num / 100.0;
+	else if (key == "duplicate") duplicate = num / 100.0;
+	else if (key == "bandwidth") bandwidth = num;
+	else if (key == "dist") {
+		if (value == "uniform") distribution = UNIFORM;
+		else if (value == "normal") distribution = NORMAL;
+		else if (value == "pareto") distribution = PARETO;
+		else return false;
+	}
+	else return false;
+
+	return true;
+}
+
+/**
+ * Constructor.
+ * @param profile The link parameters.
+ * @param seed Seed for the random generator, so that runs can be repeated.
+ */
+Impairment::Impairment(const ImpairmentProfile &profile, unsigned int seed) :
+	profile(profile), rng(seed), unit(0.0, 1.0), lastLost(false),
+	linkFreeAt(simClock_t::now()), lastDelivery(simClock_t::now())
+{
+}
+
+/**
+ * Decide when (and whether) a packet arrives at the other end.
+ * @param len Size of the packet, in bytes.
+ * @param reliable @c true for stream (TCP) data, which is never lost and
+ *                 never reordered; loss on a real stream shows up as delay.
+ * @param[out] deliverAt When the packet should be delivered.
+ * @return @c false if the packet is lost.
+ */
+bool Impairment::Schedule(size_t len, bool reliable, simClock_t::time_point &deliverAt)
+{
+	simClock_t::time_point now = simClock_t::now();
+
+	if (!reliable) {
+		double lossChance = lastLost ? std::max(profile.loss, profile.lossBurst) : profile.loss;
+		lastLost = unit(rng) < lossChance;
+		if (lastLost) return false;
+	}
+
+	// Serialization delay: the packet has to wait for the wire to be free.
+	simClock_t::time_point sent = now;
+	if (profile.bandwidth > 0) {
+		sent = std::max(now, linkFreeAt) + std::chrono::microseconds(
+			static_cast<long long>(len * 8 * 1000.0 / profile.bandwidth));
+		linkFreeAt = sent;
+	}
+
+	double delayMs = profile.delay;
+	if (reliable || unit(rng) >= profile.reorder) {
+		delayMs += SampleDelay();
+	}
+	else {
+		// A reordered packet jumps ahead of the ones still in flight.
+		delayMs = 0;
+	}
+
+	deliverAt = sent + std::chrono::microseconds(static_cast<long long>(std::max(0.0, delayMs) * 1000.0));
+
+	if (reliable) {
+		deliverAt = std::max(deliverAt, lastDelivery);
+		lastDelivery = deliverAt;
+	}
+
+	return true;
+}
+
+bool Impairment::ShouldDuplicate()
+{
+	return unit(rng) < profile.duplicate;
+}
+
+/**
+ * Pick the jitter for one packet.
+ * @return The delay to add to the base delay, in ms (may be negative).
+ */
+double Impairment::SampleDelay()
+{
+	if (profile.jitter <= 0) return 0;
+
+	switch (profile.distribution) {
+		case ImpairmentProfile::NORMAL:
+			return std::normal_distribution<double>(0, profile.jitter)(rng);
+
+		case ImpairmentProfile::PARETO: {
+			// Shape 3 keeps the variance finite; scale chosen so the mean is
+			// the requested jitter.
+			const double shape = 3.0;
+			double scale = profile.jitter * (shape - 1) / shape;
+			return scale / pow(1.0 - unit(rng), 1.0 / shape);
+		}
+
+		default:
+			return (unit(rng) * 2 - 1) * profile.jitter;
+	}
+}
@@ -0,0 +1,86 @@
+// Impairment.h
+// Model of an imperfect network link (latency, jitter, loss, bandwidth).
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <random>
+#include <string>
+
+namespace HoverRace {
+namespace NetSim {
+
+typedef std::chrono::steady_clock simClock_t;
+
+/**
+ * Parameters of a simulated link.
+ * All times are in milliseconds.
+ */
+struct ImpairmentProfile
+{
+	enum distribution_t {
+		UNIFORM,  ///< Jitter spread evenly over [-jitter, +jitter].
+		NORMAL,   ///< Jitter is the standard deviation of a normal distribution.
+		PARETO,   ///< Heavy tail; jitter is the mean of the extra delay.
+	};
+
+	ImpairmentProfile();
+
+	bool Parse(const std::string &key, const std::string &value);
+
+	double delay;         ///< Base one-way delay.
+	double jitter;        ///< Spread of the delay, see distribution.
+	distribution_t distribution;
+	double loss;          ///< Probability of losing a packet (0..1).
+	double lossBurst;     ///< Probability that a loss is followed by another.
+	double reorder;       ///< Probability that a packet skips the delay queue.
+	double duplicate;     ///< Probability of delivering a packet twice.
+	double bandwidth;     ///< Link capacity in kbit/s (0 for unlimited).
+};
+
+/**
+ * Decides the fate of each packet crossing one direction of a link.
+ * Each direction of each link has its own instance so that bandwidth and
+ * loss bursts are tracked independently.
+ */
+class Impairment
+{
+	public:
+		Impairment(const ImpairmentProfile &profile, unsigned int seed);
+
+	public:
+		bool Schedule(size_t len, bool reliable, simClock_t::time_point &deliverAt);
+		bool ShouldDuplicate();
+
+	private:
+		double SampleDelay();
+
+	private:
+		ImpairmentProfile profile;
+		std::mt19937 rng;
+		std::uniform_real_distribution<double> unit;
+		bool lastLost;
+		simClock_t::time_point linkFreeAt;   ///< When the simulated wire is idle again.
+		simClock_t::time_point lastDelivery; ///< For streams, which must stay ordered.
+};
+
+}  // namespace NetSim
+}  // namespace HoverRace
@@ -0,0 +1,110 @@
+// Link.cpp
+// One direction of a simulated link.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "Link.h"
+
+using namespace HoverRace::NetSim;
+
+/**
+ * Constructor.
+ * @param io The I/O service that runs the timers.
+ * @param name Name of the link, for reports.
+ * @param profile The link parameters.
+ * @param seed Seed for the random generator.
+ * @param reliable @c true for stream data, which is delayed but never lost
+ *                 or reordered.
+ * @param deliver Called with each packet when it reaches the far end.
+ */
+Link::Link(boost::asio::io_service &io, const std::string &name,
+	const ImpairmentProfile &profile, unsigned int seed,
+	bool reliable, deliver_t deliver) :
+	io(io), impairment(profile, seed), stats(name), reliable(reliable),
+	deliver(deliver), streamTimer(io)
+{
+}
+
+void Link::Send(const packetPtr_t &packet)
+{
+	stats.Sent(packet->size());
+
+	InFlight flight;
+	flight.packet = packet;
+	flight.sentAt = simClock_t::now();
+	flight.duplicate = false;
+
+	if (!impairment.Schedule(packet->size(), reliable, flight.deliverAt)) {
+		stats.Lost();
+		return;
+	}
+
+	if (reliable) {
+		bool idle = streamQueue.empty();
+		streamQueue.push_back(flight);
+		if (idle) ArmStreamTimer();
+		return;
+	}
+
+	int copies = 1;
+	if (impairment.ShouldDuplicate()) {
+		stats.Duplicated();
+		copies = 2;
+	}
+
+	for (int i = 0; i < copies; ++i) {
+		std::shared_ptr<boost::asio::steady_timer> timer =
+			std::make_shared<boost::asio::steady_timer>(io, flight.deliverAt);
+		timer->async_wait([this, timer, flight](const boost::system::error_code &err) {
+			if (!err) Deliver(flight);
+		});
+		flight.duplicate = true;
+	}
+}
+
+void Link::Deliver(const InFlight &flight)
+{
+	// Our own duplicates are not decoded, so they don't show up as resends
+	// or as zero-length state gaps.
+	stats.Delivered(flight.packet->data(), flight.packet->size(),
+		flight.sentAt, !reliable && !flight.duplicate);
+	deliver(flight.packet);
+}
+
+void Link::ArmStreamTimer()
+{
+	streamTimer.expires_at(streamQueue.front().deliverAt);
+	streamTimer.async_wait([this](const boost::system::error_code &err) {
+		OnStreamTimer(err);
+	});
+}
+
+void Link::OnStreamTimer(const boost::system::error_code &err)
+{
+	if (err) return;
+
+	simClock_t::time_point now = simClock_t::now();
+	while (!streamQueue.empty() && streamQueue.front().deliverAt <= now) {
+		InFlight flight = streamQueue.front();
+		streamQueue.pop_front();
+		Deliver(flight);
+	}
+
+	if (!streamQueue.empty()) ArmStreamTimer();
+}
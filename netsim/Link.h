@@ -0,0 +1,87 @@
+// Link.h
+// One direction of a simulated link.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "Impairment.h"
+#include "LinkStats.h"
+
+namespace HoverRace {
+namespace NetSim {
+
+typedef std::vector<unsigned char> packet_t;
+typedef std::shared_ptr<packet_t> packetPtr_t;
+
+/**
+ * One direction of a simulated link.
+ * Packets go in through Send() and come out, late or not at all, through
+ * the delivery callback.
+ */
+class Link
+{
+	public:
+		typedef std::function<void(const packetPtr_t&)> deliver_t;
+
+		Link(boost::asio::io_service &io, const std::string &name,
+			const ImpairmentProfile &profile, unsigned int seed,
+			bool reliable, deliver_t deliver);
+
+	public:
+		void Send(const packetPtr_t &packet);
+
+		const LinkStats &GetStats() const { return stats; }
+
+	private:
+		struct InFlight
+		{
+			packetPtr_t packet;
+			simClock_t::time_point sentAt;
+			simClock_t::time_point deliverAt;
+			bool duplicate;  ///< Extra copy injected by the link itself.
+		};
+
+		void Deliver(const InFlight &flight);
+		void ArmStreamTimer();
+		void OnStreamTimer(const boost::system::error_code &err);
+
+	private:
+		boost::asio::io_service &io;
+		Impairment impairment;
+		LinkStats stats;
+		bool reliable;
+		deliver_t deliver;
+
+		// Stream data must come out in order, so it goes through one queue
+		// and one timer instead of a timer per packet.
+		std::deque<InFlight> streamQueue;
+		boost::asio::steady_timer streamTimer;
+};
+
+}  // namespace NetSim
+}  // namespace HoverRace
@@ -0,0 +1,153 @@
+// LinkStats.cpp
+// Counters and HoverRace protocol metrics for a simulated link.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include <iomanip>
+
+#include "LinkStats.h"
+
+using namespace HoverRace::NetSim;
+
+namespace {
+	// Must match the client's NetMessageBuffer header and message IDs.
+	const size_t HEADER_LEN = 4;
+	const int MRNM_SET_MAIN_ELEM_STATE = 3;
+
+	// Must match the client's ReliableChannel.
+	const int RELIABLE_QUEUE = 2;
+	const size_t RELIABLE_HEADER_LEN = 11;
+	const int RELIABLE_SEQ_SPACE = 0x10000;
+
+	double ToMs(simClock_t::duration d)
+	{
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+}
+
+LinkStats::LinkStats(const std::string &name) :
+	name(name), packets(0), bytes(0), lost(0), duplicated(0), delivered(0),
+	reordered(0), resends(0), delayTotal(0), delayMax(0)
+{
+}
+
+void LinkStats::Sent(size_t len)
+{
+	packets++;
+	bytes += len;
+}
+
+void LinkStats::Lost()
+{
+	lost++;
+}
+
+void LinkStats::Duplicated()
+{
+	duplicated++;
+}
+
+/**
+ * Record a packet coming out of the far end of the link.
+ * @param data The packet.
+ * @param len Length of the packet.
+ * @param sentAt When the packet entered the link.
+ * @param decode @c true to decode the packet as a HoverRace datagram.
+ */
+void LinkStats::Delivered(const unsigned char *data, size_t len,
+	simClock_t::time_point sentAt, bool decode)
+{
+	simClock_t::time_point now = simClock_t::now();
+
+	delivered++;
+	double delay = ToMs(now - sentAt);
+	delayTotal += delay;
+	if (delay > delayMax) delayMax = delay;
+
+	// Overtook a packet that was sent before it.
+	if (sentAt < lastSentDelivered) reordered++;
+	else lastSentDelivered = sentAt;
+
+	if (!decode || len < HEADER_LEN) return;
+
+	// MR_UInt16 mDatagramNumber:8, mDatagramQueue:2, mMessageType:6 (LSB first)
+	int number = data[0];
+	int queue = data[1] & 0x03;
+	int type = data[1] >> 2;
+	int client = data[2];
+
+	if (queue == RELIABLE_QUEUE) {
+		// The datagram number is always 0 here; the real sequence number is
+		// the first field of the reliable header.  Ack-only packets carry
+		// no payload and reuse the next unsent number, so they are skipped.
+		if (len > HEADER_LEN + RELIABLE_HEADER_LEN) {
+			int seq = data[HEADER_LEN] | (data[HEADER_LEN + 1] << 8);
+
+			std::vector<bool> &seen = reliableSeen[client];
+			if (seen.empty()) seen.resize(RELIABLE_SEQ_SPACE);
+			if (seen[seq]) resends++;
+			seen[seq] = true;
+
+			// Forget the number half a wrap ahead so that it can be reused.
+			seen[(seq + RELIABLE_SEQ_SPACE / 2) % RELIABLE_SEQ_SPACE] = false;
+		}
+	}
+	else {
+		int key = (client << 2) | queue;
+		std::map<int, int>::iterator iter = lastDatagram.find(key);
+		if (iter != lastDatagram.end() && iter->second == number) resends++;
+		lastDatagram[key] = number;
+	}
+
+	if (type == MRNM_SET_MAIN_ELEM_STATE) {
+		Staleness &st = staleness[client];
+		if (st.count > 0) {
+			double gap = ToMs(now - st.last);
+			st.total += gap;
+			if (gap > st.max) st.max = gap;
+		}
+		st.count++;
+		st.last = now;
+	}
+}
+
+void LinkStats::Report(std::ostream &os) const
+{
+	os << std::fixed << std::setprecision(1) <<
+		name << ": " << packets << " pkts " << bytes << " bytes, " <<
+		lost << " lost, " << duplicated << " dup, " <<
+		reordered << " reordered, " << resends << " resends";
+
+	if (delivered > 0) {
+		os << ", delay avg " << (delayTotal / delivered) <<
+			" max " << delayMax << " ms";
+	}
+	os << std::endl;
+
+	for (std::map<int, Staleness>::const_iterator iter = staleness.begin();
+		iter != staleness.end(); ++iter)
+	{
+		const Staleness &st = iter->second;
+		if (st.count < 2) continue;
+
+		os << "  client " << iter->first << ": " << st.count <<
+			" state updates, staleness avg " << (st.total / (st.count - 1)) <<
+			" max " << st.max << " ms" << std::endl;
+	}
+}
@@ -0,0 +1,90 @@
+// LinkStats.h
+// Counters and HoverRace protocol metrics for a simulated link.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Impairment.h"
+
+namespace HoverRace {
+namespace NetSim {
+
+/**
+ * Statistics for one direction of a link.
+ *
+ * Besides raw packet counters, datagrams are decoded as HoverRace
+ * NetMessageBuffers (one message per datagram) to report the metrics that
+ * matter to the game:
+ *  - resends: a datagram number seen twice on the same queue (on the
+ *    reliable queue, the sequence number from the reliable header);
+ *  - state staleness: the gap between two hovercraft state updates
+ *    (MRNM_SET_MAIN_ELEM_STATE) from the same client, as delivered.
+ */
+class LinkStats
+{
+	public:
+		LinkStats(const std::string &name);
+
+	public:
+		void Sent(size_t len);
+		void Lost();
+		void Duplicated();
+		void Delivered(const unsigned char *data, size_t len,
+			simClock_t::time_point sentAt, bool decode);
+
+		void Report(std::ostream &os) const;
+
+	private:
+		struct Staleness
+		{
+			Staleness() : count(0), total(0), max(0) { }
+			simClock_t::time_point last;
+			unsigned long count;
+			double total;
+			double max;
+		};
+
+	private:
+		std::string name;
+
+		unsigned long packets;
+		unsigned long bytes;
+		unsigned long lost;
+		unsigned long duplicated;
+		unsigned long delivered;
+		unsigned long reordered;
+		unsigned long resends;
+
+		double delayTotal;
+		double delayMax;
+		simClock_t::time_point lastSentDelivered;
+
+		std::map<int, int> lastDatagram;  ///< (client << 2 | queue) -> number
+		std::map<int, std::vector<bool> > reliableSeen;  ///< client -> sequence numbers
+		std::map<int, Staleness> staleness;  ///< client -> state gaps
+};
+
+}  // namespace NetSim
+}  // namespace HoverRace
@@ -0,0 +1,85 @@
+// LoadGenerator.cpp
+// Synthetic headless clients for exercising a simulated link.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include "LoadGenerator.h"
+
+using namespace HoverRace::NetSim;
+using boost::asio::ip::udp;
+
+namespace {
+	// Must match the client's NetMessageBuffer and MainCharacterState.
+	const int MRNM_SET_MAIN_ELEM_STATE = 3;
+	const int STATE_LEN = 23;
+	const int MAIN_ELEM_QUEUE = 1;
+}
+
+LoadGenerator::Client::Client(boost::asio::io_service &io, int id) :
+	id(id), datagramNumber(0), socket(io, udp::endpoint(udp::v4(), 0)), timer(io)
+{
+}
+
+/**
+ * Constructor.
+ * @param io The I/O service.
+ * @param numClients Number of clients to simulate.
+ * @param rate State updates per second, per client.
+ * @param proxy Where the clients send to (the proxy's listen port).
+ * @param sinkPort Local port to swallow the relayed traffic on
+ *                 (the proxy's target).
+ */
+LoadGenerator::LoadGenerator(boost::asio::io_service &io, int numClients,
+	double rate, const udp::endpoint &proxy, unsigned short sinkPort) :
+	proxy(proxy),
+	period(std::chrono::microseconds(static_cast<long long>(1000000.0 / rate))),
+	sink(io, udp::endpoint(udp::v4(), sinkPort))
+{
+	for (int i = 0; i < numClients; ++i) {
+		clients.push_back(std::unique_ptr<Client>(new Client(io, i)));
+		Tick(clients.back().get());
+	}
+	Drain();
+}
+
+void LoadGenerator::Tick(Client *client)
+{
+	unsigned char buf[4 + STATE_LEN] = { 0 };
+
+	buf[0] = ++client->datagramNumber;
+	buf[1] = static_cast<unsigned char>(MAIN_ELEM_QUEUE | (MRNM_SET_MAIN_ELEM_STATE << 2));
+	buf[2] = static_cast<unsigned char>(client->id);
+	buf[3] = STATE_LEN;
+
+	boost::system::error_code err;
+	client->socket.send_to(boost::asio::buffer(buf), proxy, 0, err);
+
+	client->timer.expires_from_now(period);
+	client->timer.async_wait([this, client](const boost::system::error_code &err) {
+		if (!err) Tick(client);
+	});
+}
+
+void LoadGenerator::Drain()
+{
+	sink.async_receive_from(boost::asio::buffer(sinkBuf), sinkFrom,
+		[this](const boost::system::error_code &, size_t) {
+			Drain();
+		});
+}
@@ -0,0 +1,71 @@
+// LoadGenerator.h
+// Synthetic headless clients for exercising a simulated link.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace HoverRace {
+namespace NetSim {
+
+/**
+ * A set of headless clients that send hovercraft state updates the way a
+ * NetworkSession does (one MRNM_SET_MAIN_ELEM_STATE datagram per update),
+ * plus a sink that swallows them on the other side of the proxy.
+ * Run through a UdpProxy, the proxy's statistics then show the staleness
+ * the game would see under the simulated conditions.
+ */
+class LoadGenerator
+{
+	public:
+		LoadGenerator(boost::asio::io_service &io, int numClients, double rate,
+			const boost::asio::ip::udp::endpoint &proxy, unsigned short sinkPort);
+
+	private:
+		struct Client
+		{
+			Client(boost::asio::io_service &io, int id);
+
+			int id;
+			unsigned char datagramNumber;
+			boost::asio::ip::udp::socket socket;
+			boost::asio::steady_timer timer;
+		};
+
+		void Tick(Client *client);
+		void Drain();
+
+	private:
+		boost::asio::ip::udp::endpoint proxy;
+		boost::asio::steady_timer::duration period;
+		std::vector<std::unique_ptr<Client>> clients;
+
+		boost::asio::ip::udp::socket sink;
+		boost::asio::ip::udp::endpoint sinkFrom;
+		unsigned char sinkBuf[512];
+};
+
+}  // namespace NetSim
+}  // namespace HoverRace
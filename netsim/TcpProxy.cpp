@@ -0,0 +1,133 @@
+// TcpProxy.cpp
+// Impairing TCP relay.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include <sstream>
+
+#include "TcpProxy.h"
+
+using namespace HoverRace::NetSim;
+using boost::asio::ip::tcp;
+
+TcpProxy::Pipe::Pipe(tcp::socket &src, tcp::socket &dest) :
+	src(src), dest(dest)
+{
+}
+
+TcpProxy::Session::Session(boost::asio::io_service &io) :
+	peer(io), upstream(io), toTarget(peer, upstream), toPeer(upstream, peer)
+{
+}
+
+/**
+ * Constructor.
+ * @param io The I/O service.
+ * @param listenPort Local port the peers connect to.
+ * @param target Where to relay the connections.
+ * @param profile The link parameters, used for both directions.
+ * @param seed Seed for the random generators.
+ */
+TcpProxy::TcpProxy(boost::asio::io_service &io, unsigned short listenPort,
+	const tcp::endpoint &target, const ImpairmentProfile &profile,
+	unsigned int seed) :
+	io(io), acceptor(io, tcp::endpoint(tcp::v4(), listenPort)),
+	target(target), profile(profile), seed(seed)
+{
+	Accept();
+}
+
+void TcpProxy::Accept()
+{
+	SessionPtr session = std::make_shared<Session>(io);
+
+	acceptor.async_accept(session->peer, [this, session](const boost::system::error_code &err) {
+		if (!err) {
+			session->upstream.async_connect(target, [this, session](const boost::system::error_code &err) {
+				if (err) {
+					Close(session);
+					return;
+				}
+
+				std::ostringstream oss;
+				oss << "tcp " << session->peer.remote_endpoint() << " -> " << target;
+				Session *s = session.get();
+				s->toTarget.link.reset(new Link(io, oss.str(), profile, seed++, true,
+					[this, s](const packetPtr_t &packet) {
+						s->toTarget.writeQueue.push_back(packet);
+						if (s->toTarget.writeQueue.size() == 1) Write(s->shared_from_this(), s->toTarget);
+					}));
+
+				oss.str("");
+				oss << "tcp " << target << " -> " << session->peer.remote_endpoint();
+				s->toPeer.link.reset(new Link(io, oss.str(), profile, seed++, true,
+					[this, s](const packetPtr_t &packet) {
+						s->toPeer.writeQueue.push_back(packet);
+						if (s->toPeer.writeQueue.size() == 1) Write(s->shared_from_this(), s->toPeer);
+					}));
+
+				sessions.push_back(session);
+				Read(session, session->toTarget);
+				Read(session, session->toPeer);
+			});
+		}
+		Accept();
+	});
+}
+
+void TcpProxy::Read(const SessionPtr &session, Pipe &pipe)
+{
+	pipe.src.async_read_some(boost::asio::buffer(pipe.buf),
+		[this, session, &pipe](const boost::system::error_code &err, size_t len) {
+			if (err) {
+				Close(session);
+				return;
+			}
+			pipe.link->Send(std::make_shared<packet_t>(pipe.buf, pipe.buf + len));
+			Read(session, pipe);
+		});
+}
+
+void TcpProxy::Write(const SessionPtr &session, Pipe &pipe)
+{
+	boost::asio::async_write(pipe.dest, boost::asio::buffer(*pipe.writeQueue.front()),
+		[this, session, &pipe](const boost::system::error_code &err, size_t) {
+			if (err) {
+				Close(session);
+				return;
+			}
+			pipe.writeQueue.pop_front();
+			if (!pipe.writeQueue.empty()) Write(session, pipe);
+		});
+}
+
+void TcpProxy::Close(const SessionPtr &session)
+{
+	boost::system::error_code ignored;
+	session->peer.close(ignored);
+	session->upstream.close(ignored);
+}
+
+void TcpProxy::Report(std::ostream &os) const
+{
+	for (auto iter = sessions.begin(); iter != sessions.end(); ++iter) {
+		(*iter)->toTarget.link->GetStats().Report(os);
+		(*iter)->toPeer.link->GetStats().Report(os);
+	}
+}
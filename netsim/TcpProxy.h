@@ -0,0 +1,94 @@
+// TcpProxy.h
+// Impairing TCP relay.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <list>
+#include <memory>
+#include <ostream>
+
+#include <boost/asio.hpp>
+
+#include "Link.h"
+
+namespace HoverRace {
+namespace NetSim {
+
+/**
+ * Relays TCP connections from a local port to a target.
+ * The stream is cut into the chunks it was read in, and each chunk is
+ * delayed and rate-limited by the simulated link; it is never lost or
+ * reordered since the real TCP stack would hide that as extra delay.
+ */
+class TcpProxy
+{
+	public:
+		TcpProxy(boost::asio::io_service &io, unsigned short listenPort,
+			const boost::asio::ip::tcp::endpoint &target,
+			const ImpairmentProfile &profile, unsigned int seed);
+
+	public:
+		void Report(std::ostream &os) const;
+
+	private:
+		enum { CHUNK_SIZE = 4096 };
+
+		/// One direction of a relayed connection.
+		struct Pipe
+		{
+			Pipe(boost::asio::ip::tcp::socket &src, boost::asio::ip::tcp::socket &dest);
+
+			boost::asio::ip::tcp::socket &src;
+			boost::asio::ip::tcp::socket &dest;
+			std::unique_ptr<Link> link;
+			std::deque<packetPtr_t> writeQueue;
+			unsigned char buf[CHUNK_SIZE];
+		};
+
+		struct Session : public std::enable_shared_from_this<Session>
+		{
+			Session(boost::asio::io_service &io);
+
+			boost::asio::ip::tcp::socket peer;
+			boost::asio::ip::tcp::socket upstream;
+			Pipe toTarget;
+			Pipe toPeer;
+		};
+		typedef std::shared_ptr<Session> SessionPtr;
+
+		void Accept();
+		void Read(const SessionPtr &session, Pipe &pipe);
+		void Write(const SessionPtr &session, Pipe &pipe);
+		void Close(const SessionPtr &session);
+
+	private:
+		boost::asio::io_service &io;
+		boost::asio::ip::tcp::acceptor acceptor;
+		boost::asio::ip::tcp::endpoint target;
+		ImpairmentProfile profile;
+		unsigned int seed;
+
+		std::list<SessionPtr> sessions;
+};
+
+}  // namespace NetSim
+}  // namespace HoverRace
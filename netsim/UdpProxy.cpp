@@ -0,0 +1,117 @@
+// UdpProxy.cpp
+// Impairing UDP relay.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include <sstream>
+
+#include "UdpProxy.h"
+
+using namespace HoverRace::NetSim;
+using boost::asio::ip::udp;
+
+UdpProxy::Session::Session(boost::asio::io_service &io) :
+	upstream(io, udp::endpoint(udp::v4(), 0))
+{
+}
+
+/**
+ * Constructor.
+ * @param io The I/O service.
+ * @param listenPort Local port the peers send to.
+ * @param target Where to relay the datagrams.
+ * @param profile The link parameters, used for both directions.
+ * @param seed Seed for the random generators.
+ */
+UdpProxy::UdpProxy(boost::asio::io_service &io, unsigned short listenPort,
+	const udp::endpoint &target, const ImpairmentProfile &profile,
+	unsigned int seed) :
+	io(io), socket(io, udp::endpoint(udp::v4(), listenPort)),
+	target(target), profile(profile), seed(seed)
+{
+	ReceiveFromPeer();
+}
+
+void UdpProxy::ReceiveFromPeer()
+{
+	socket.async_receive_from(boost::asio::buffer(buf), peer,
+		[this](const boost::system::error_code &err, size_t len) {
+			if (!err) {
+				Session *session = GetSession(peer);
+				session->toTarget->Send(std::make_shared<packet_t>(buf, buf + len));
+			}
+			ReceiveFromPeer();
+		});
+}
+
+void UdpProxy::ReceiveFromTarget(Session *session)
+{
+	session->upstream.async_receive_from(boost::asio::buffer(session->buf), session->from,
+		[this, session](const boost::system::error_code &err, size_t len) {
+			if (err == boost::asio::error::operation_aborted) return;
+			if (!err) {
+				session->toPeer->Send(std::make_shared<packet_t>(session->buf, session->buf + len));
+			}
+			ReceiveFromTarget(session);
+		});
+}
+
+/**
+ * Find or create the relay session for a peer.
+ * @param peer The sender.
+ * @return The session (never @c NULL).
+ */
+UdpProxy::Session *UdpProxy::GetSession(const udp::endpoint &peer)
+{
+	std::unique_ptr<Session> &session = sessions[peer];
+
+	if (!session) {
+		session.reset(new Session(io));
+		session->peer = peer;
+
+		std::ostringstream oss;
+		oss << "udp " << peer << " -> " << target;
+		Session *s = session.get();
+		session->toTarget.reset(new Link(io, oss.str(), profile, seed++, false,
+			[this, s](const packetPtr_t &packet) {
+				boost::system::error_code err;  // Lost is lost.
+				s->upstream.send_to(boost::asio::buffer(*packet), target, 0, err);
+			}));
+
+		oss.str("");
+		oss << "udp " << target << " -> " << peer;
+		session->toPeer.reset(new Link(io, oss.str(), profile, seed++, false,
+			[this, s](const packetPtr_t &packet) {
+				boost::system::error_code err;
+				socket.send_to(boost::asio::buffer(*packet), s->peer, 0, err);
+			}));
+
+		ReceiveFromTarget(s);
+	}
+
+	return session.get();
+}
+
+void UdpProxy::Report(std::ostream &os) const
+{
+	for (auto iter = sessions.begin(); iter != sessions.end(); ++iter) {
+		iter->second->toTarget->GetStats().Report(os);
+		iter->second->toPeer->GetStats().Report(os);
+	}
+}
@@ -0,0 +1,84 @@
+// UdpProxy.h
+// Impairing UDP relay.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <ostream>
+
+#include <boost/asio.hpp>
+
+#include "Link.h"
+
+namespace HoverRace {
+namespace NetSim {
+
+/**
+ * Relays UDP datagrams from a local port to a target, through a simulated
+ * link in each direction.
+ * Each distinct sender gets its own upstream socket, so that the target's
+ * replies find their way back to the right sender.
+ */
+class UdpProxy
+{
+	public:
+		UdpProxy(boost::asio::io_service &io, unsigned short listenPort,
+			const boost::asio::ip::udp::endpoint &target,
+			const ImpairmentProfile &profile, unsigned int seed);
+
+	public:
+		void Report(std::ostream &os) const;
+
+	private:
+		enum { MAX_DATAGRAM = 65536 };
+
+		struct Session
+		{
+			Session(boost::asio::io_service &io);
+
+			boost::asio::ip::udp::socket upstream;
+			boost::asio::ip::udp::endpoint peer;
+			boost::asio::ip::udp::endpoint from;
+			std::unique_ptr<Link> toTarget;
+			std::unique_ptr<Link> toPeer;
+			unsigned char buf[MAX_DATAGRAM];
+		};
+
+		void ReceiveFromPeer();
+		void ReceiveFromTarget(Session *session);
+		Session *GetSession(const boost::asio::ip::udp::endpoint &peer);
+
+	private:
+		boost::asio::io_service &io;
+		boost::asio::ip::udp::socket socket;
+		boost::asio::ip::udp::endpoint target;
+		ImpairmentProfile profile;
+		unsigned int seed;
+
+		boost::asio::ip::udp::endpoint peer;
+		unsigned char buf[MAX_DATAGRAM];
+
+		std::map<boost::asio::ip::udp::endpoint, std::unique_ptr<Session>> sessions;
+};
+
+}  // namespace NetSim
+}  // namespace HoverRace
@@ -0,0 +1,230 @@
+// main.cpp
+// Network impairment proxy for testing NetworkSession without remote machines.
+//
+// Copyright (c) 2026 HoverRace contributors.
+//
+// Licensed under GrokkSoft HoverRace SourceCode License v1.0(the "License");
+// you may not use this file except in compliance with the License.
+//
+// A copy of the license should have been attached to the package from which
+// you have taken this file. If you can not find the license you can not use
+// this file.
+//
+//
+// The author makes no representations about the suitability of
+// this software for any purpose.  It is provided "as is" "AS IS",
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.
+//
+// See the License for the specific language governing permissions
+// and limitations under the License.
+
+#include <getopt.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "Impairment.h"
+#include "LoadGenerator.h"
+#include "TcpProxy.h"
+#include "UdpProxy.h"
+
+using namespace HoverRace::NetSim;
+
+namespace {
+
+struct Mapping
+{
+	unsigned short listenPort;
+	std::string host;
+	std::string port;
+};
+
+void Usage(const char *prog)
+{
+	std::cerr <<
+		"Usage: " << prog << " [options]\n"
+		"Relays traffic between HoverRace peers through a simulated network.\n"
+		"\n"
+		"Relays (repeatable):\n"
+		"  -u, --udp LPORT:HOST:PORT  relay UDP from local LPORT to HOST:PORT\n"
+		"  -t, --tcp LPORT:HOST:PORT  relay TCP from local LPORT to HOST:PORT\n"
+		"\n"
+		"Link (applied to each direction of each relay):\n"
+		"  --delay MS        base one-way delay\n"
+		"  --jitter MS       delay spread\n"
+		"  --dist NAME       jitter distribution: uniform, normal, pareto\n"
+		"  --loss PCT        datagram loss\n"
+		"  --loss-burst PCT  chance that a loss is followed by another\n"
+		"  --reorder PCT     datagrams that skip the delay queue\n"
+		"  --duplicate PCT   datagrams delivered twice\n"
+		"  --bandwidth KBPS  link capacity\n"
+		"  --seed N          random seed, for repeatable runs\n"
+		"\n"
+		"Headless clients:\n"
+		"  -c, --clients N   send state updates from N synthetic clients\n"
+		"                    through the first UDP relay, to a sink on its\n"
+		"                    target port (which must be local)\n"
+		"  -r, --rate HZ     state updates per second per client (default 20)\n"
+		"\n"
+		"Reporting:\n"
+		"  -i, --interval S  print statistics every S seconds (default 5)\n"
+		"  -d, --duration S  stop after S seconds (default: run forever)\n";
+}
+
+bool ParseMapping(const std::string &spec, Mapping &mapping)
+{
+	std::string::size_type first = spec.find(':');
+	std::string::size_type last = spec.rfind(':');
+	if (first == std::string::npos || first == last) return false;
+
+	mapping.listenPort = static_cast<unsigned short>(atoi(spec.substr(0, first).c_str()));
+	mapping.host = spec.substr(first + 1, last - first - 1);
+	mapping.port = spec.substr(last + 1);
+	return mapping.listenPort != 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+	static const struct option longOpts[] = {
+		{ "udp", required_argument, NULL, 'u' },
+		{ "tcp", required_argument, NULL, 't' },
+		{ "clients", required_argument, NULL, 'c' },
+		{ "rate", required_argument, NULL, 'r' },
+		{ "interval", required_argument, NULL, 'i' },
+		{ "duration", required_argument, NULL, 'd' },
+		{ "seed", required_argument, NULL, 's' },
+		{ "help", no_argument, NULL, 'h' },
+		{ "delay", required_argument, NULL, 0 },
+		{ "jitter", required_argument, NULL, 0 },
+		{ "dist", required_argument, NULL, 0 },
+		{ "loss", required_argument, NULL, 0 },
+		{ "loss-burst", required_argument, NULL, 0 },
+		{ "reorder", required_argument, NULL, 0 },
+		{ "duplicate", required_argument, NULL, 0 },
+		{ "bandwidth", required_argument, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	std::list<Mapping> udpMappings;
+	std::list<Mapping> tcpMappings;
+	ImpairmentProfile profile;
+	int numClients = 0;
+	double rate = 20;
+	int interval = 5;
+	int duration = 0;
+	unsigned int seed = 1;
+
+	int opt, optIdx;
+	while ((opt = getopt_long(argc, argv, "u:t:c:r:i:d:s:h", longOpts, &optIdx)) != -1) {
+		Mapping mapping;
+		switch (opt) {
+			case 0:
+				if (!profile.Parse(longOpts[optIdx].name, optarg)) {
+					std::cerr << "Bad value for --" << longOpts[optIdx].name << ": " << optarg << std::endl;
+					return EXIT_FAILURE;
+				}
+				break;
+			case 'u':
+			case 't':
+				if (!ParseMapping(optarg, mapping)) {
+					std::cerr << "Bad relay: " << optarg << std::endl;
+					return EXIT_FAILURE;
+				}
+				(opt == 'u' ? udpMappings : tcpMappings).push_back(mapping);
+				break;
+			case 'c': numClients = atoi(optarg); break;
+			case 'r': rate = atof(optarg); break;
+			case 'i': interval = atoi(optarg); break;
+			case 'd': duration = atoi(optarg); break;
+			case 's': seed = static_cast<unsigned int>(atoi(optarg)); break;
+			default:
+				Usage(argv[0]);
+				return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (udpMappings.empty() && tcpMappings.empty()) {
+		Usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (numClients > 0 && (udpMappings.empty() || rate <= 0)) {
+		std::cerr << "Headless clients need a UDP relay and a positive rate." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	boost::asio::io_service io;
+
+	std::list<std::unique_ptr<UdpProxy>> udpProxies;
+	std::list<std::unique_ptr<TcpProxy>> tcpProxies;
+	std::unique_ptr<LoadGenerator> loadGen;
+
+	try {
+		boost::asio::ip::udp::resolver udpResolver(io);
+		for (auto iter = udpMappings.begin(); iter != udpMappings.end(); ++iter) {
+			boost::asio::ip::udp::endpoint target = *udpResolver.resolve(
+				boost::asio::ip::udp::resolver::query(boost::asio::ip::udp::v4(), iter->host, iter->port));
+			udpProxies.push_back(std::unique_ptr<UdpProxy>(
+				new UdpProxy(io, iter->listenPort, target, profile, seed)));
+			seed += 1000;
+		}
+
+		boost::asio::ip::tcp::resolver tcpResolver(io);
+		for (auto iter = tcpMappings.begin(); iter != tcpMappings.end(); ++iter) {
+			boost::asio::ip::tcp::endpoint target = *tcpResolver.resolve(
+				boost::asio::ip::tcp::resolver::query(boost::asio::ip::tcp::v4(), iter->host, iter->port));
+			tcpProxies.push_back(std::unique_ptr<TcpProxy>(
+				new TcpProxy(io, iter->listenPort, target, profile, seed)));
+			seed += 1000;
+		}
+
+		if (numClients > 0) {
+			const Mapping &mapping = udpMappings.front();
+			loadGen.reset(new LoadGenerator(io, numClients, rate,
+				boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), mapping.listenPort),
+				static_cast<unsigned short>(atoi(mapping.port.c_str()))));
+		}
+	}
+	catch (boost::system::system_error &ex) {
+		std::cerr << "Unable to start: " << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	auto report = [&]() {
+		std::cout << "----" << std::endl;
+		for (auto iter = udpProxies.begin(); iter != udpProxies.end(); ++iter) (*iter)->Report(std::cout);
+		for (auto iter = tcpProxies.begin(); iter != tcpProxies.end(); ++iter) (*iter)->Report(std::cout);
+	};
+
+	boost::asio::steady_timer reportTimer(io);
+	std::function<void()> scheduleReport = [&]() {
+		reportTimer.expires_from_now(std::chrono::seconds(interval));
+		reportTimer.async_wait([&](const boost::system::error_code &err) {
+			if (err) return;
+			report();
+			scheduleReport();
+		});
+	};
+	if (interval > 0) scheduleReport();
+
+	boost::asio::steady_timer stopTimer(io);
+	if (duration > 0) {
+		stopTimer.expires_from_now(std::chrono::seconds(duration));
+		stopTimer.async_wait([&](const boost::system::error_code &err) {
+			if (!err) io.stop();
+		});
+	}
+
+	io.run();
+	report();
+
+	return EXIT_SUCCESS;
+}
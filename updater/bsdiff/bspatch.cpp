@@ -22,6 +22,10 @@
 #include "bspatch.h"
 #include <string>
 
+/* Size of the blocks the old and new files are streamed in. */
+#define PATCH_CHUNK (64 * 1024)
+#define PATCH_MIN(x,y) (((x)<(y)) ? (x) : (y))
+
 void errx(char a, char* format, char* param)
 {
 	printf("bspatch error: ");
@@ -87,6 +91,25 @@ off_t offtin(u_char *buf)
 	return y;
 }
 
+/* Add the old file's bytes at [pos, pos+len) to buf; bytes outside the
+ * old file are left as they are (as the in-memory version did). */
+static void addold(FILE *fd, off_t oldsize, off_t pos, u_char *buf, off_t len,
+                   u_char *oldbuf, char *oldFile)
+{
+	off_t lo = (pos < 0) ? 0 : pos;
+	off_t hi = (pos + len > oldsize) ? oldsize : pos + len;
+	off_t i;
+
+	if(lo >= hi) return;
+
+	if((fseek(fd, lo, SEEK_SET) != 0) ||
+		(fread(oldbuf, 1, hi - lo, fd) != (size_t) (hi - lo)))
+		errx(1, "%s", oldFile);
+
+	for(i = 0; i < hi - lo; i++)
+		buf[lo - pos + i] += oldbuf[i];
+}
+
 //int main(int argc,char * argv[])
 /**
  * I have rewritten this function so it can be called from other places;
@@ -94,22 +117,26 @@ off_t offtin(u_char *buf)
  * buffer; the bsdiff patch is already in memory.
  *
  * ryan, 7.2.09
+ *
+ * The old and new files are now streamed a block at a time instead of
+ * being loaded whole, so the memory used no longer depends on the size of
+ * the file being patched.
  */
 int bsdiff_patch_file(char *patchFile, char *oldFile, char *newFile)
 {
     FILE* ctrlpipe,*diffpipe,*extrapipe;
     BZFILE* ctrlbz, *diffbz, *extrabz;
     int ctrlerror, differror, extraerror;
-	FILE* fd;
+	FILE* fd, *outfd;
 	ssize_t patchsize,oldsize,newsize;
 	ssize_t bzctrllen,bzdatalen;
 	u_char header[32],buf[8];
 	int version=0;
-	u_char *old, *pnew;
+	u_char *chunk, *oldbuf;
 	off_t oldpos,newpos;
 	off_t ctrl[3];
 	off_t lenread;
-	off_t i;
+	off_t i, n;
 
 	//if(argc!=4) errx(1,"usage: %s oldfile newfile patchfile\n",argv[0]);
 
@@ -170,14 +197,12 @@ int bsdiff_patch_file(char *patchFile, char *oldFile, char *newFile)
 	};
 
 	if(fclose(fd)==-1) errx(1,"Problem closing %s",patchFile);
-	if(((fd=fopen(oldFile,"rb"))<=0) ||
+	if(((fd=fopen(oldFile,"rb"))==NULL) ||
 		(fseek(fd,0,SEEK_END)!=0) ||
-		((oldsize=ftell(fd))==-1) ||
-		((old=(u_char*)malloc(oldsize+1))==NULL) ||
-		(fseek(fd,0,SEEK_SET)!=0) ||
-		(fread(old,1,oldsize,fd)!=oldsize) ||
-		(fclose(fd)==-1)) errx(1,"%s",oldFile);
-	if((pnew=(u_char*)malloc(newsize+1))==NULL) errx(1,NULL);
+		((oldsize=ftell(fd))==-1)) errx(1,"%s",oldFile);
+	if((outfd=fopen(newFile,"wb"))==NULL) errx(1,"%s",newFile);
+	if(((chunk=(u_char*)malloc(PATCH_CHUNK))==NULL) ||
+		((oldbuf=(u_char*)malloc(PATCH_CHUNK))==NULL)) errx(1,NULL);
 
 	oldpos=0;newpos=0;
 	while(newpos<newsize) {
@@ -189,21 +214,27 @@ int bsdiff_patch_file(char *patchFile, char *oldFile, char *newFile)
 
 		if(version==1) oldpos+=ctrl[1];
 
-		if(newpos+ctrl[0]>newsize) errx(1,"2: Corrupt patch\n");
-		if((lenread=loopread(diffbz,&differror,pnew+newpos,ctrl[0]))<0)
-			errx(1,NULL);
-		if(lenread!=ctrl[0]) errx(1,"3: Corrupt patch\n");
-		for(i=0;i<ctrl[0];i++)
-			if((oldpos+i>=0) && (oldpos+i<oldsize))
-				pnew[newpos+i]+=old[oldpos+i];
+		if((ctrl[0]<0) || (newpos+ctrl[0]>newsize)) errx(1,"2: Corrupt patch\n");
+		for(i=0;i<ctrl[0];i+=n) {
+			n=PATCH_MIN(ctrl[0]-i, PATCH_CHUNK);
+			if((lenread=loopread(diffbz,&differror,chunk,n))<0)
+				errx(1,NULL);
+			if(lenread!=n) errx(1,"3: Corrupt patch\n");
+			addold(fd,oldsize,oldpos+i,chunk,n,oldbuf,oldFile);
+			if(fwrite(chunk,1,n,outfd)!=(size_t)n) errx(1,"%s",newFile);
+		};
 		newpos+=ctrl[0];
 		oldpos+=ctrl[0];
 
 		if(version==2) {
-			if(newpos+ctrl[1]>newsize) errx(1,"4: Corrupt patch\n");
-			if((lenread=loopread(extrabz,&extraerror,pnew+newpos,ctrl[1]))<0)
-				errx(1,NULL);
-			if(lenread!=ctrl[1]) errx(1,"5: Corrupt patch\n");
+			if((ctrl[1]<0) || (newpos+ctrl[1]>newsize)) errx(1,"4: Corrupt patch\n");
+			for(i=0;i<ctrl[1];i+=n) {
+				n=PATCH_MIN(ctrl[1]-i, PATCH_CHUNK);
+				if((lenread=loopread(extrabz,&extraerror,chunk,n))<0)
+					errx(1,NULL);
+				if(lenread!=n) errx(1,"5: Corrupt patch\n");
+				if(fwrite(chunk,1,n,outfd)!=(size_t)n) errx(1,"%s",newFile);
+			};
 
 			newpos+=ctrl[1];
 			oldpos+=ctrl[2];
@@ -226,12 +257,11 @@ int bsdiff_patch_file(char *patchFile, char *oldFile, char *newFile)
 		((version==2) && fclose(extrapipe)))
 		errx(1,NULL);
 
-	if(((fd=fopen(newFile,"wb"))<=0) ||
-		(fwrite(pnew,1,newsize,fd)!=newsize) || (fclose(fd)==-1))
-		errx(1,"%s",newFile);
+	if(fclose(fd)==-1) errx(1,"%s",oldFile);
+	if(fclose(outfd)==-1) errx(1,"%s",newFile);
 
-	free(pnew);
-	free(old);
+	free(oldbuf);
+	free(chunk);
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -20,6 +20,8 @@
 // and limitations under the License.
 
 #include "StdAfx.h"
+#include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 #include <stdio.h>
@@ -31,7 +33,13 @@
 	#include <unistd.h>
 #endif
 
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <windows.h>
 
 #include "bsdiff/bspatch.h"
@@ -52,6 +60,55 @@ void waitExit(int code);
 
 vector<string> EnumerateDirectory(string dir);
 
+bool HashFile(const string &filename, string &hash);
+void ParallelFor(size_t count, int threads, boost::function<void(size_t)> fn);
+
+/// Limits how much memory the running diffs may use between them.
+struct MemoryBudget {
+	boost::mutex mutex;
+	boost::condition_variable freed;
+	boost::uintmax_t limit;
+	boost::uintmax_t used;
+
+	void Acquire(boost::uintmax_t amount);
+	void Release(boost::uintmax_t amount);
+};
+
+/// A file that exists in both versions.
+struct CreateJob {
+	string name;
+	string oldFile;
+	string newFile;
+	string patchName;
+	string patchFile;
+	boost::uintmax_t size;
+	string oldHash;
+	string newHash;
+	bool changed;
+	bool failed;
+};
+bool BiggerJob(const CreateJob &a, const CreateJob &b);
+void CreateFilePatch(vector<CreateJob> *jobs, MemoryBudget *budget, size_t i);
+
+/// Hashes of a file before and after the patch (from the HASHES file).
+struct FileHashes {
+	string oldHash; /// "-" for added files
+	string newHash;
+};
+map<string, FileHashes> ReadHashes(const string &filename);
+
+/// A file to patch in place.
+struct ApplyJob {
+	string name;
+	string patchFile;
+	string fileToPatch;
+	string newFile;
+	const FileHashes *hashes; /// NULL if the patch has no HASHES file
+	bool upToDate;
+	bool failed;
+};
+void ApplyFilePatch(vector<ApplyJob> *jobs, size_t i);
+
 int main(int argc, const char **argv) {
 	printf("HoverRace automatic updater and patch generator\n");
 	//Sleep(25000); // time to attach
@@ -60,6 +117,8 @@ int main(int argc, const char **argv) {
 	string targetDir = "";
 	string sourceDir = "";
 	string patchFile = "";
+	int threads = max<int>(1, boost::thread::hardware_concurrency());
+	int memoryLimit = 1024; // in MB
 
 	// Windows has no getopt() therefore we must do it by hand and as a result my implementation is not the best or the
 	// cleanest but it does work
@@ -74,9 +133,20 @@ int main(int argc, const char **argv) {
 				} else {
 					sourceDir = argv[++i];
 				}
+			} else if(argv[i][1] == 'j' || argv[i][1] == 'm') {
+				if(i == argc - 1 || atoi(argv[i + 1]) < 1) {
+					fprintf(stderr, "Option %s needs a positive number!\n", argv[i]);
+					waitExit(1);
+				} else if(argv[i][1] == 'j') {
+					threads = atoi(argv[++i]);
+				} else {
+					memoryLimit = atoi(argv[++i]);
+				}
 			} else if(argv[i][1] == 'h') {
-				fprintf(stderr, "Usage: %s [-c /path/to/updated/version/] /path/to/hoverrace/ patchfile.zip\n", argv[0]);
+				fprintf(stderr, "Usage: %s [-j threads] [-m megabytes] [-c /path/to/updated/version/] /path/to/hoverrace/ patchfile.zip\n", argv[0]);
 				fprintf(stderr, "  The -c option specifies that an update should be created\n");
+				fprintf(stderr, "  The -j option sets how many files are diffed or patched at once (default: one per CPU)\n");
+				fprintf(stderr, "  The -m option sets how much memory the diffs may use at once (default: 1024)\n");
 				waitExit(1);
 			} else {
 				// no gettext here... this should not ever be used by users
@@ -138,8 +208,9 @@ int main(int argc, const char **argv) {
 
 			// set up vectors for the possible actions needed to take on each file
 			// the vectors will hold the filenames
-			vector<string> patchFiles;
+			vector<CreateJob> patchJobs; // need to be compared and maybe patched
 			vector<string> newFiles; // need to be added
+			map<string, string> newHashes; // for the added files
 
 			// create directory for temporary files
 			// if this directory already exists we throw an error and exit
@@ -150,48 +221,79 @@ int main(int argc, const char **argv) {
 
 			create_directory("temp_patch");
 
-			// now we must create an individual patchfile for each listed file we must diff
 			for(vector<string>::iterator it = dirListing.begin(); it != dirListing.end(); it++) {
-				printf("Creating patch for %s\n", (*it).c_str());
+				// erase any leading slashes
+				if((*it).at(0) == '\\' || (*it).at(0) == '/')
+					(*it).erase(0, 1);
 
 				// see if this file exists in the old directory structure
-				vector<string>::iterator index = find(oldListing.begin(), oldListing.end(), *it);
+				vector<string>::iterator index = oldListing.end();
+				for(vector<string>::iterator old = oldListing.begin(); old != oldListing.end(); old++) {
+					if(*old == *it || (old->length() == it->length() + 1 && old->substr(1) == *it)) {
+						index = old;
+						break;
+					}
+				}
+
 				if(index == oldListing.end()) {
 					// file does not exist in old directory
 					// so we have to copy the file over directly
+					printf("Adding %s\n", (*it).c_str());
+
 					string oldFile = path(sourceDir).file_string() + "\\" + *it;
 					string patchName = "\\temp_patch\\" + *it; // same filename
 					string newFile = current_path().file_string() + patchName;
 
+					create_directories(path(newFile).branch_path());
 					copy_file(path(oldFile), path(newFile));
 
+					if(!HashFile(newFile, newHashes[*it])) {
+						fprintf(stderr, "Error reading %s! Exiting...\n", newFile.c_str());
+						return -1;
+					}
+
 					newFiles.push_back(*it);
 				} else {
-					// we must create a patch
-					string oldFile = path(sourceDir).file_string() + "/" + *index;
-					string newFile = path(targetDir).file_string() + "/" + *it;
+					// we must compare the two versions, and create a patch if they differ
+					CreateJob job;
+					job.name = *it;
+					job.oldFile = path(targetDir).file_string() + "/" + *it;
+					job.newFile = path(sourceDir).file_string() + "/" + *it;
 					// separate the actual filename to construct the patch filename and add '.bsdiff'
-					string patchName = *it + ".bsdiff";
-					string curPatchFile = current_path().file_string() + "/temp_patch/" + patchName;
+					job.patchName = *it + ".bsdiff";
+					job.patchFile = current_path().file_string() + "/temp_patch/" + job.patchName;
+					job.size = file_size(job.oldFile) + file_size(job.newFile);
+					job.changed = false;
+					job.failed = false;
 
 					// remove from old listing vector (not necessary to remove from new listing vector)
 					index = oldListing.erase(index);
 
 					// ensure directory exists
-					if(!exists("temp_patch/" + path(patchName).branch_path().file_string()))
-						create_directory("temp_patch/" + path(patchName).branch_path().file_string());
+					create_directories(path(job.patchFile).branch_path());
 
-					// now create the patch
-					bsdiff_create_patch((char *) curPatchFile.c_str(), (char *) oldFile.c_str(), (char *) newFile.c_str());
+					patchJobs.push_back(job);
+				}
+			}
 
-					// verify patch file exists
-					if(!exists(curPatchFile)) {
-						fprintf(stderr, "Error creating patch file %s! Exiting...\n", patchFile.c_str());
-						return -1;
-					}
+			// Start the biggest files first, so that one large file (like
+			// ObjFac1.dat) isn't left running alone at the end.
+			sort(patchJobs.begin(), patchJobs.end(), BiggerJob);
+
+			printf("Comparing %d files (%d at a time)...\n", (int) patchJobs.size(), threads);
+
+			MemoryBudget budget;
+			budget.limit = (boost::uintmax_t) memoryLimit * 1024 * 1024;
+			budget.used = 0;
 
-					// with the patch created we must add to our list of files that need patching
-					patchFiles.push_back(patchName);
+			ParallelFor(patchJobs.size(), threads,
+				boost::bind(&CreateFilePatch, &patchJobs, &budget, _1));
+
+			// a file we couldn't compare may have changed, so the patch would be incomplete
+			for(vector<CreateJob>::iterator it = patchJobs.begin(); it != patchJobs.end(); it++) {
+				if(it->failed) {
+					fprintf(stderr, "Unable to compare %s! Exiting...\n", it->name.c_str());
+					return -1;
 				}
 			}
 
@@ -200,20 +302,23 @@ int main(int argc, const char **argv) {
 			FILE *digest = fopen(digestFile.c_str(), "wb");
 			printf("Creating DIGEST file...");
 
+			// the hashes let the updater check each file before and after patching
+			string hashesFile = current_path().file_string() + "/temp_patch/HASHES";
+			FILE *hashes = fopen(hashesFile.c_str(), "wb");
+
 			// write files to patch to digest
-			for(vector<string>::iterator it = patchFiles.begin(); it != patchFiles.end(); it++) {
-				// erase any leading slashes
-				if((*it).at(0) == '\\' || (*it).at(0) == '/')
-					(*it).erase(0, 1);
-				fprintf(digest, "P %s\n", (*it).c_str());
-				printf("P %s\n", (*it).c_str());
+			for(vector<CreateJob>::iterator it = patchJobs.begin(); it != patchJobs.end(); it++) {
+				if(!it->changed)
+					continue;
+				fprintf(digest, "P %s\n", it->patchName.c_str());
+				fprintf(hashes, "%s %s %s\n", it->oldHash.c_str(), it->newHash.c_str(), it->name.c_str());
+				printf("P %s\n", it->patchName.c_str());
 			}
 
 			// write files to add to digest
 			for(vector<string>::iterator it = newFiles.begin(); it != newFiles.end(); it++) {
-				if((*it).at(0) == '\\' || (*it).at(0) == '/')
-					(*it).erase(0, 1);
 				fprintf(digest, "A %s\n", (*it).c_str());
+				fprintf(hashes, "- %s %s\n", newHashes[*it].c_str(), (*it).c_str());
 				printf("A %s\n", (*it).c_str());
 			}
 
@@ -225,6 +330,7 @@ int main(int argc, const char **argv) {
 				printf("D %s\n", (*it).c_str());
 			}
 
+			fclose(hashes);
 			fclose(digest);
 
 			// now, we zip everything up
@@ -307,11 +413,10 @@ int main(int argc, const char **argv) {
 				return -1;
 			}
 
-			// unpack each file
-			// we do not have to worry about changing directory as the compressed files
-			// are in a directory with the same name as the patch file
-			bool fail = false;
-			while(!feof(digest) && !fail) {
+			// read the whole digest first, so that nothing is touched until
+			// every patch has been applied successfully
+			vector<pair<char, string> > entries;
+			while(!feof(digest)) {
 				char digLine[1024];
 				fgets(digLine, 1024, digest);
 
@@ -321,6 +426,8 @@ int main(int argc, const char **argv) {
 				// strip newline from end of string
 				if(digLine[strlen(digLine) - 1] == 0x0A)
 					digLine[strlen(digLine) - 1] = 0;
+				if(strlen(digLine) < 3)
+					continue;
 
 				char action = digLine[0];
 				string filename = &digLine[2]; // first character is action, second char is space
@@ -328,68 +435,134 @@ int main(int argc, const char **argv) {
 				if(filename.at(0) == '\\' || filename.at(0) == '/') // strip leading slash
 					filename.erase(0, 1);
 
+				entries.push_back(make_pair(action, filename));
+			}
+
+			// close and remove digest
+			fclose(digest);
+			remove(path(current_path().file_string() + "\\DIGEST"));
+
+			// patches made by older versions of the updater have no HASHES file
+			map<string, FileHashes> hashes;
+			lstrcpy(ze.Name, "HASHES");
+			ze.Index = 0;
+			if(UnzipFindItem(huz, &ze, 0) != ZR_NOTFOUND) {
+				UnzipItemToFile(huz, ze.Name, &ze);
+				hashes = ReadHashes("HASHES");
+				remove(path(current_path().file_string() + "\\HASHES"));
+			}
+
+			// unpack each file
+			// we do not have to worry about changing directory as the compressed files
+			// are in a directory with the same name as the patch file
+			// deleted files are not in the archive
+			bool fail = false;
+			vector<ApplyJob> patchJobs;
+			for(vector<pair<char, string> >::iterator it = entries.begin(); it != entries.end() && !fail; it++) {
+				char action = it->first;
+				const string &filename = it->second;
+
+				if(action == 'D')
+					continue;
+
 				//printf("Searching for %s\n", filename.c_str());
 				lstrcpy(ze.Name, filename.c_str());
 				ze.Index = 0;
 				if(UnzipFindItem(huz, &ze, 0) == ZR_NOTFOUND) {
 					fprintf(stderr, "Not found in archive: %s\n", filename.c_str());
+					fail = true;
 					break;
 				}
 
 				UnzipItemToFile(huz, ze.Name, &ze);
 
+				if(action == 'P') {
+					string bsdiffPatch = filename;
+
+					// now that	we have the filename, patch it
+					// we will have to strip the patch directory from the filename and the suffix
+					// of the patch file (i.e. hoverrace-1.23.2/bin/HoverRace.exe.bsdiff ->
+					//							bin/HoverRace.exe
+					size_t bsdiffLoc = bsdiffPatch.rfind(".bsdiff");
+					if(bsdiffLoc == string::npos) {
+						fprintf(stderr, "Invalid patchfile name %s\n", bsdiffPatch.c_str());
+						fail = true;
+					} else {
+						ApplyJob job;
+						job.name = bsdiffPatch.substr(0, bsdiffLoc);
+						job.patchFile = current_path().file_string() + "\\" + bsdiffPatch;
+						job.fileToPatch = targetDir + "/" + job.name;
+						job.newFile = job.fileToPatch + ".tmp"; // append .tmp for temporary file, we will move it later
+
+						map<string, FileHashes>::const_iterator hash = hashes.find(job.name);
+						job.hashes = (hash == hashes.end()) ? NULL : &hash->second;
+						job.upToDate = false;
+						job.failed = false;
+
+						patchJobs.push_back(job);
+					}
+				}
+			}
+
+			UnzipClose(huz);
+
+			// the patches are independent of each other, so apply them all at once
+			// (into the .tmp files; the originals are left alone for now)
+			if(!fail) {
+				ParallelFor(patchJobs.size(), threads, boost::bind(&ApplyFilePatch, &patchJobs, _1));
+
+				for(vector<ApplyJob>::iterator it = patchJobs.begin(); it != patchJobs.end(); it++)
+					fail = fail || it->failed;
+			}
+
+			if(fail) {
+				// leave the installation as it was
+				for(vector<ApplyJob>::iterator it = patchJobs.begin(); it != patchJobs.end(); it++)
+					remove(path(it->newFile));
+			} else {
+				for(vector<ApplyJob>::iterator it = patchJobs.begin(); it != patchJobs.end() && !fail; it++) {
+					if(it->upToDate) {
+						fprintf(stdout, "File %s already up to date\n", it->fileToPatch.c_str());
+						continue;
+					}
+
+					// now move .tmp to original
+					if(remove(it->fileToPatch.c_str()) != 0) {
+						fprintf(stderr, "Error removing %s\n", it->fileToPatch.c_str());
+						fail = true;
+					} else if(rename(it->newFile.c_str(), it->fileToPatch.c_str()) != 0) {
+						fprintf(stderr, "Error moving %s to %s\n", it->newFile.c_str(), it->fileToPatch.c_str());
+						fail = true;
+					} else {
+						// file has been patched successfully...
+						// now we should update the statusbar but unfortunately it does not exist yet
+						fprintf(stdout, "File %s patched\n", it->fileToPatch.c_str());
+					}
+				}
+			}
+
+			for(vector<pair<char, string> >::iterator it = entries.begin(); it != entries.end() && !fail; it++) {
+				char action = it->first;
+				const string &filename = it->second;
+
 				switch(action) {
-					case 'P': // patch file
-						{
-							string bsdiffPatch = filename;
-
-							// now that	we have the filename, patch it
-							// we will have to strip the patch directory from the filename and the suffix
-							// of the patch file (i.e. hoverrace-1.23.2/bin/HoverRace.exe.bsdiff ->
-							//							bin/HoverRace.exe
-							size_t bsdiffLoc = bsdiffPatch.rfind(".bsdiff");
-							if(bsdiffLoc == string::npos) {
-								fprintf(stderr, "Invalid patchfile name %s\n", bsdiffPatch.c_str());
-								fail = true;
-							} else {
-								// strip patch directory (it may not exist)
-								size_t slashLoc = bsdiffPatch.find("/");
-
-								string absPatchLoc = current_path().file_string() + "\\" + bsdiffPatch;
-								string fileToPatch = targetDir + "/" + (bsdiffPatch.substr(0, bsdiffLoc));
-								string newFile = fileToPatch + ".tmp"; // append .tmp for temporary file, we will move it later
-
-								bsdiff_patch_file((char *) absPatchLoc.c_str(),
-												  (char *) fileToPatch.c_str(),
-												  (char *) newFile.c_str());
-
-								// now move .tmp to original
-								if(remove(fileToPatch.c_str()) != 0) {
-									fprintf(stderr, "Error removing %s\n", fileToPatch.c_str());
-									fail = true;
-								} else {
-									if(rename(newFile.c_str(), fileToPatch.c_str()) != 0) {
-										fprintf(stderr, "Error moving %s to %s\n", newFile.c_str(), fileToPatch.c_str());
-										fail = true;
-									}
-							
-									// file has been patched successfully...
-									// now we should update the statusbar but unfortunately it does not exist yet
-									fprintf(stdout, "File %s patched\n", fileToPatch.c_str());
-								}
-							}
-						}
-						break;
-	
 					case 'A': // add file
 						{
 							string oldFile = current_path().file_string() + "\\" + filename;
 							string newFile = targetDir + "\\" + filename;
 
-							if(exists(newFile)) {
+							map<string, FileHashes>::const_iterator hash = hashes.find(filename);
+							string curHash;
+
+							if(exists(newFile) && hash != hashes.end() &&
+								HashFile(newFile, curHash) && curHash == hash->second.newHash)
+							{
+								fprintf(stdout, "File %s already up to date\n", filename.c_str());
+							} else if(exists(newFile)) {
 								fprintf(stderr, "File %s already exists!\n", newFile.c_str());
 								fail = true;
 							} else {
+								create_directories(path(newFile).branch_path());
 								rename(path(oldFile), path(newFile));
 								fprintf(stdout, "File %s added\n", filename.c_str());
 							}
@@ -398,26 +571,29 @@ int main(int argc, const char **argv) {
 						}
 
 					case 'D': // delete file
-						remove(path(targetDir + "\\" + filename));
-						fprintf(stdout, "File %s removed\n", filename);
+						if(exists(targetDir + "\\" + filename))
+							remove(path(targetDir + "\\" + filename));
+						fprintf(stdout, "File %s removed\n", filename.c_str());
 						break;
 				}
+			}
+
+			// remove extracted files (only once they have all been moved, since
+			// removing a parent directory takes its siblings with it)
+			for(vector<pair<char, string> >::iterator it = entries.begin(); it != entries.end(); it++) {
+				char action = it->first;
+				const string &filename = it->second;
 
 				if(action != 'D') {
 					// remove extracted file
-					remove(path(current_path().file_string() + "\\" + filename));
+					if(exists(current_path().file_string() + "\\" + filename))
+						remove(path(current_path().file_string() + "\\" + filename));
 
 					if(strcmp(path(filename).branch_path().file_string().c_str(), "") != 0) // must remove parent directory if it exists
 						remove_all(path(filename).branch_path());
 				}
 			}
 
-			// close and remove digest
-			fclose(digest);
-			remove(path(current_path().file_string() + "\\DIGEST"));
-
-			UnzipClose(huz);
-
 			if(!fail)
 				fprintf(stdout, "Patching complete!\n");
 		}
@@ -458,3 +634,194 @@ vector<string> EnumerateDirectory(string directory) {
 
 	return ret;
 }
+
+/**
+ * Compute a hash of a file's contents (64-bit FNV-1a, as 16 hex digits).
+ * The file is read in blocks so that large files are not loaded at once.
+ * @return @c false if the file could not be read.
+ */
+bool HashFile(const string &filename, string &hash) {
+	FILE *f = fopen(filename.c_str(), "rb");
+	if(f == NULL)
+		return false;
+
+	boost::uint64_t h = 14695981039346656037ULL;
+	unsigned char buf[65536];
+	size_t len;
+	while((len = fread(buf, 1, sizeof(buf), f)) > 0) {
+		for(size_t i = 0; i < len; i++) {
+			h ^= buf[i];
+			h *= 1099511628211ULL;
+		}
+	}
+
+	bool ok = (ferror(f) == 0);
+	fclose(f);
+
+	char hex[17];
+	sprintf(hex, "%08x%08x", (unsigned int) (h >> 32), (unsigned int) (h & 0xffffffff));
+	hash = hex;
+
+	return ok;
+}
+
+/// Run fn(0) ... fn(count - 1), on up to the given number of threads.
+static void ParallelWorker(size_t count, boost::function<void(size_t)> *fn,
+                           boost::mutex *mutex, size_t *next)
+{
+	for(;;) {
+		size_t i;
+		{
+			boost::mutex::scoped_lock lock(*mutex);
+			if(*next >= count)
+				return;
+			i = (*next)++;
+		}
+		(*fn)(i);
+	}
+}
+
+void ParallelFor(size_t count, int threads, boost::function<void(size_t)> fn) {
+	boost::mutex mutex;
+	size_t next = 0;
+
+	if(threads <= 1 || count <= 1) {
+		ParallelWorker(count, &fn, &mutex, &next);
+		return;
+	}
+
+	boost::thread_group group;
+	for(int i = 0; i < threads && i < (int) count; i++)
+		group.create_thread(boost::bind(&ParallelWorker, count, &fn, &mutex, &next));
+	group.join_all();
+}
+
+/**
+ * Wait until the amount of memory is available.
+ * A job bigger than the whole budget is allowed to run once nothing else is.
+ */
+void MemoryBudget::Acquire(boost::uintmax_t amount) {
+	boost::mutex::scoped_lock lock(mutex);
+	while(used > 0 && used + amount > limit)
+		freed.wait(lock);
+	used += amount;
+}
+
+void MemoryBudget::Release(boost::uintmax_t amount) {
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		used -= amount;
+	}
+	freed.notify_all();
+}
+
+bool BiggerJob(const CreateJob &a, const CreateJob &b) {
+	return a.size > b.size;
+}
+
+/**
+ * Compare the old and new versions of a file and create a patch if they differ.
+ * Called from worker threads; each job only touches its own entry.
+ */
+void CreateFilePatch(vector<CreateJob> *jobs, MemoryBudget *budget, size_t i) {
+	CreateJob &job = (*jobs)[i];
+
+	if(!HashFile(job.oldFile, job.oldHash) || !HashFile(job.newFile, job.newHash)) {
+		fprintf(stderr, "Error reading %s!\n", job.name.c_str());
+		job.failed = true;
+		return;
+	}
+
+	if(job.oldHash == job.newHash)
+		return; // unchanged; nothing to do
+
+	// bsdiff keeps both files plus the suffix array of the old file in memory
+	boost::uintmax_t oldSize = file_size(job.oldFile);
+	boost::uintmax_t newSize = file_size(job.newFile);
+	boost::uintmax_t needed = (1 + 2 * sizeof(off_t)) * oldSize + 3 * newSize;
+
+	budget->Acquire(needed);
+	printf("Creating patch for %s\n", job.name.c_str());
+	bsdiff_create_patch((char *) job.patchFile.c_str(),
+	                    (char *) job.oldFile.c_str(),
+	                    (char *) job.newFile.c_str());
+	budget->Release(needed);
+
+	job.changed = true;
+}
+
+/**
+ * Read the HASHES file from a patch.
+ * Each line is "oldhash newhash filename".
+ */
+map<string, FileHashes> ReadHashes(const string &filename) {
+	map<string, FileHashes> ret;
+
+	FILE *f = fopen(filename.c_str(), "rb");
+	if(f == NULL)
+		return ret;
+
+	char line[1100];
+	while(fgets(line, sizeof(line), f) != NULL) {
+		size_t len = strlen(line);
+		while(len > 0 && (line[len - 1] == 0x0A || line[len - 1] == 0x0D))
+			line[--len] = 0;
+
+		char *sep1 = strchr(line, ' ');
+		char *sep2 = (sep1 == NULL) ? NULL : strchr(sep1 + 1, ' ');
+		if(sep2 == NULL)
+			continue;
+
+		string name = sep2 + 1;
+		if(name.empty())
+			continue;
+		if(name.at(0) == '\\' || name.at(0) == '/')
+			name.erase(0, 1);
+
+		FileHashes &hashes = ret[name];
+		hashes.oldHash = string(line, sep1);
+		hashes.newHash = string(sep1 + 1, sep2);
+	}
+
+	fclose(f);
+	return ret;
+}
+
+/**
+ * Patch one file into its .tmp file, checking the hashes if we have them.
+ * Called from worker threads; each job only touches its own entry.
+ */
+void ApplyFilePatch(vector<ApplyJob> *jobs, size_t i) {
+	ApplyJob &job = (*jobs)[i];
+
+	if(job.hashes != NULL) {
+		string curHash;
+		if(!HashFile(job.fileToPatch, curHash)) {
+			fprintf(stderr, "Cannot read %s\n", job.fileToPatch.c_str());
+			job.failed = true;
+			return;
+		}
+		if(curHash == job.hashes->newHash) {
+			// already patched (e.g. by an earlier, interrupted run)
+			job.upToDate = true;
+			return;
+		}
+		if(curHash != job.hashes->oldHash) {
+			fprintf(stderr, "File %s does not match the version this patch is for\n", job.fileToPatch.c_str());
+			job.failed = true;
+			return;
+		}
+	}
+
+	bsdiff_patch_file((char *) job.patchFile.c_str(),
+	                  (char *) job.fileToPatch.c_str(),
+	                  (char *) job.newFile.c_str());
+
+	if(job.hashes != NULL) {
+		string newHash;
+		if(!HashFile(job.newFile, newHash) || newHash != job.hashes->newHash) {
+			fprintf(stderr, "Patched %s does not match the expected result\n", job.fileToPatch.c_str());
+			job.failed = true;
+		}
+	}
+}